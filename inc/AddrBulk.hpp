@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	enum class AddrCategory : u32
+	{
+		UNSPECIFIED,
+		LOCALHOST,
+		BROADCAST,
+		PRIVATE,
+		LINKLOCAL,
+		DOCUMENTATION,
+		BENCHMARKING,
+		MULTICAST,
+		IPV4_MAPPED
+	};
+
+	inline constexpr usize ADDR_CATEGORY_COUNT = 9;
+
+	[[nodiscard]] constexpr usize addr_mask_words(usize count) noexcept
+	{
+		return (count + 63) / 64;
+	}
+
+	[[nodiscard]] constexpr usize addr_mask_offset(AddrCategory category, usize count) noexcept
+	{
+		return static_cast<usize>(category) * addr_mask_words(count);
+	}
+
+	void classify_ipv4_bulk(const AddrIPv4* addrs, usize count, u64* masks) noexcept;
+	void classify_ipv6_bulk(const AddrIPv6* addrs, usize count, u64* masks) noexcept;
+
+	usize match_ipv4_bulk(const AddrIPv4* addrs, usize count, const AddrIPv4& value, u64* mask) noexcept;
+	usize match_ipv6_bulk(const AddrIPv6* addrs, usize count, const AddrIPv6& value, u64* mask) noexcept;
+
+	usize match_prefix_ipv4_bulk(const AddrIPv4* addrs, usize count, const CidrIPv4& prefix, u64* mask) noexcept;
+	usize match_prefix_ipv6_bulk(const AddrIPv6* addrs, usize count, const CidrIPv6& prefix, u64* mask) noexcept;
+}
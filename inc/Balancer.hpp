@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct _BalancerBackend;
+	struct _BalancerState;
+
+	class Balancer;
+
+	struct BalancerConfig
+	{
+		u64 max_outstanding = 0;
+		usize fallback_candidates = 2;
+	};
+
+	class BackendLease
+	{
+	private:
+		friend Balancer;
+
+		_BalancerBackend* m_backend;
+
+		BackendLease(_BalancerBackend* backend) noexcept;
+
+	public:
+		BackendLease(const BackendLease&) = delete;
+		BackendLease(BackendLease&& other) noexcept;
+
+		~BackendLease();
+
+		[[nodiscard]] const SockAddr& addr() const noexcept;
+		[[nodiscard]] u64 outstanding() const noexcept;
+
+		void release() noexcept;
+	};
+
+	class Balancer
+	{
+	private:
+		_BalancerState* m_state;
+
+	public:
+		static constexpr usize MAX_FALLBACK_CANDIDATES = 8;
+
+		explicit Balancer(const BalancerConfig& config = BalancerConfig{});
+		Balancer(const Balancer&) = delete;
+		Balancer(Balancer&& other) noexcept;
+
+		~Balancer();
+
+		void add(const SockAddr& addr, f64 weight = 1.0);
+		bool remove(const SockAddr& addr);
+
+		[[nodiscard]] usize size() const noexcept;
+		[[nodiscard]] u64 fallbacks() const noexcept;
+		[[nodiscard]] u64 outstanding(const SockAddr& addr) const noexcept;
+
+		[[nodiscard]] Maybe<SockAddr> owner_hashed(u64 key_hash) const;
+		[[nodiscard]] Maybe<BackendLease> pick_hashed(u64 key_hash);
+
+		template<class Key>
+		[[nodiscard]] Maybe<SockAddr> owner(const Key& key) const
+		{
+			return owner_hashed(Hash<Key>{}(key));
+		}
+
+		template<class Key>
+		[[nodiscard]] Maybe<BackendLease> pick(const Key& key)
+		{
+			return pick_hashed(Hash<Key>{}(key));
+		}
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct _ServerConn
+	{
+		Socket m_sock;
+
+		::std::atomic<bool> m_done;
+		::std::thread m_reader;
+
+		explicit _ServerConn(Socket&& sock)
+			: m_sock{ move(sock) }, m_done{ false }
+		{
+		}
+	};
+
+	template<class Conn>
+	class _ConnServer
+	{
+	private:
+		mutable ::std::mutex m_mutex;
+		::std::vector<Conn*> m_connections;
+		bool m_stopping;
+
+		void reap()
+		{
+			auto last = ::std::partition(m_connections.begin(), m_connections.end(), [](Conn* conn) {
+				return !conn->is_finished();
+			});
+
+			for (auto it = last; it != m_connections.end(); ++it)
+			{
+				(*it)->m_reader.join();
+				delete *it;
+			}
+
+			m_connections.erase(last, m_connections.end());
+		}
+
+	public:
+		_ConnServer() noexcept
+			: m_stopping{ false }
+		{
+		}
+
+		_ConnServer(const _ConnServer&) = delete;
+
+		template<class Start>
+		void serve(Conn* conn, Start&& start)
+		{
+			conn->m_sock.set_nodelay(true).discard();
+
+			::std::lock_guard<::std::mutex> lock{ m_mutex };
+
+			if (m_stopping)
+			{
+				delete conn;
+				return;
+			}
+
+			reap();
+
+			m_connections.push_back(conn);
+			start(*conn);
+		}
+
+		template<class Serve>
+		[[nodiscard]] Result<Unit, SocketAcceptError> run(TCPServer& server, Serve&& serve)
+		{
+			for (;;)
+			{
+				Result<Socket, SocketAcceptError> sock = server.accept();
+
+				if (sock.is_error())
+				{
+					::std::lock_guard<::std::mutex> lock{ m_mutex };
+
+					if (m_stopping)
+						return Unit{};
+
+					return sock.expect_error();
+				}
+
+				serve(sock.expect());
+			}
+		}
+
+		[[nodiscard]] usize active() const noexcept
+		{
+			::std::lock_guard<::std::mutex> lock{ m_mutex };
+
+			usize count = 0;
+
+			for (const Conn* conn : m_connections)
+				if (!conn->m_done.load(::std::memory_order_acquire))
+					++count;
+
+			return count;
+		}
+
+		template<class F>
+		void for_each(F&& f) const
+		{
+			::std::lock_guard<::std::mutex> lock{ m_mutex };
+
+			for (const Conn* conn : m_connections)
+				f(*conn);
+		}
+
+		[[nodiscard]] ::std::vector<Conn*> stop()
+		{
+			::std::vector<Conn*> connections;
+
+			::std::lock_guard<::std::mutex> lock{ m_mutex };
+
+			m_stopping = true;
+			connections.swap(m_connections);
+
+			return connections;
+		}
+
+		static void join(::std::vector<Conn*>& connections)
+		{
+			for (Conn* conn : connections)
+			{
+				conn->m_reader.join();
+				delete conn;
+			}
+
+			connections.clear();
+		}
+	};
+}
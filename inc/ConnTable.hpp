@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Net.hpp"
+#include "FlatMap.hpp"
+
+namespace bsl::net
+{
+	class FiveTuple
+	{
+	private:
+		AddrIPv6 m_local;
+		AddrIPv6 m_remote;
+		u16 m_local_port;
+		u16 m_remote_port;
+		Proto m_proto;
+
+		FiveTuple(Proto proto, const AddrIPv6& local, u16 local_port, const AddrIPv6& remote, u16 remote_port) noexcept
+			: m_local{ local }, m_remote{ remote }, m_local_port{ local_port }, m_remote_port{ remote_port }, m_proto{ proto }
+		{
+		}
+
+	public:
+		FiveTuple(Proto proto, const SockAddrV4& local, const SockAddrV4& remote) noexcept
+			: FiveTuple{ proto, AddrIPv6{ local.addr() }, local.port(), AddrIPv6{ remote.addr() }, remote.port() }
+		{
+		}
+
+		FiveTuple(Proto proto, const SockAddrV6& local, const SockAddrV6& remote) noexcept
+			: FiveTuple{ proto, local.addr(), local.port(), remote.addr(), remote.port() }
+		{
+		}
+
+		[[nodiscard]] static Maybe<FiveTuple> from(Proto proto, const SockAddr& local, const SockAddr& remote) noexcept
+		{
+			if (local.is_unix() || remote.is_unix())
+				return {};
+
+			AddrIPv6 local_addr = local.is_ipv4() ? AddrIPv6{ local.to_ipv4().value().addr() } : local.to_ipv6().value().addr();
+			u16 local_port = local.is_ipv4() ? local.to_ipv4().value().port() : local.to_ipv6().value().port();
+
+			AddrIPv6 remote_addr = remote.is_ipv4() ? AddrIPv6{ remote.to_ipv4().value().addr() } : remote.to_ipv6().value().addr();
+			u16 remote_port = remote.is_ipv4() ? remote.to_ipv4().value().port() : remote.to_ipv6().value().port();
+
+			return FiveTuple{ proto, local_addr, local_port, remote_addr, remote_port };
+		}
+
+		[[nodiscard]] Proto proto() const noexcept
+		{
+			return m_proto;
+		}
+
+		[[nodiscard]] const AddrIPv6& local_addr() const noexcept
+		{
+			return m_local;
+		}
+
+		[[nodiscard]] u16 local_port() const noexcept
+		{
+			return m_local_port;
+		}
+
+		[[nodiscard]] const AddrIPv6& remote_addr() const noexcept
+		{
+			return m_remote;
+		}
+
+		[[nodiscard]] u16 remote_port() const noexcept
+		{
+			return m_remote_port;
+		}
+
+		[[nodiscard]] SockAddr local() const noexcept
+		{
+			if (m_local.is_ipv4_mapped())
+				return SockAddrV4{ m_local.to_ipv4().value(), m_local_port };
+
+			return SockAddrV6{ m_local, m_local_port };
+		}
+
+		[[nodiscard]] SockAddr remote() const noexcept
+		{
+			if (m_remote.is_ipv4_mapped())
+				return SockAddrV4{ m_remote.to_ipv4().value(), m_remote_port };
+
+			return SockAddrV6{ m_remote, m_remote_port };
+		}
+
+		[[nodiscard]] FiveTuple reversed() const noexcept
+		{
+			return FiveTuple{ m_proto, m_remote, m_remote_port, m_local, m_local_port };
+		}
+
+		[[nodiscard]] bool operator==(const FiveTuple& rhs) const noexcept
+		{
+			return m_local_port == rhs.m_local_port &&
+				m_remote_port == rhs.m_remote_port &&
+				m_proto == rhs.m_proto &&
+				m_remote == rhs.m_remote &&
+				m_local == rhs.m_local;
+		}
+
+		[[nodiscard]] bool operator!=(const FiveTuple& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+	};
+}
+
+namespace bsl
+{
+	template<>
+	struct Hash<net::FiveTuple>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::FiveTuple& value) const noexcept
+		{
+			u64 state = hash_accumulate(seed, value.remote_addr().high_bits());
+			state = hash_accumulate(state, value.remote_addr().low_bits());
+			state = hash_accumulate(state, value.local_addr().high_bits());
+			state = hash_accumulate(state, value.local_addr().low_bits());
+
+			u64 tail = (static_cast<u64>(value.remote_port()) << 32) |
+				(static_cast<u64>(value.local_port()) << 16) |
+				static_cast<u64>(value.proto());
+
+			return hash_mix(hash_accumulate(state, tail));
+		}
+	};
+}
+
+namespace bsl::net
+{
+	template<class State>
+	using ConnTable = FlatMap<FiveTuple, State>;
+}
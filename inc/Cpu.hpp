@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Types.hpp"
+
+namespace bsl::cpu
+{
+	struct Features
+	{
+		bool sse2;
+		bool ssse3;
+		bool sse41;
+		bool sse42;
+		bool popcnt;
+		bool avx2;
+		bool bmi2;
+	};
+
+	[[nodiscard]] const Features& features() noexcept;
+
+	[[nodiscard]] inline bool has_ssse3() noexcept
+	{
+		return features().ssse3;
+	}
+
+	[[nodiscard]] inline bool has_sse41() noexcept
+	{
+		return features().sse41;
+	}
+
+	[[nodiscard]] inline bool has_avx2() noexcept
+	{
+		return features().avx2;
+	}
+}
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "Types.hpp"
+#include "Hash.hpp"
+
+namespace bsl
+{
+	template<class Key, class Value>
+	struct FlatMapSlot
+	{
+		Key key;
+		Value value;
+	};
+
+	template<class Key, class Value, class Hasher = Hash<Key>>
+	class FlatMap
+	{
+	private:
+		using Slot = FlatMapSlot<Key, Value>;
+
+		static constexpr u8 EMPTY_TAG = 0;
+		static constexpr usize MIN_CAPACITY = 16;
+
+		static constexpr bool SEEDED_HASHER = requires { Hasher{ u64{} }; };
+
+		u8* m_tags;
+		Slot* m_slots;
+		usize m_mask;
+		usize m_size;
+		u64 m_seed;
+
+		[[nodiscard]] static u8 tag_of(usize hash) noexcept
+		{
+			return static_cast<u8>(0x80 | (hash >> (sizeof(usize) * 8 - 7)));
+		}
+
+		[[nodiscard]] static usize capacity_for(usize count) noexcept
+		{
+			usize capacity = MIN_CAPACITY;
+
+			while (capacity - capacity / 4 < count)
+				capacity <<= 1;
+
+			return capacity;
+		}
+
+		[[nodiscard]] static Slot* allocate_slots(usize capacity)
+		{
+			return static_cast<Slot*>(::operator new(sizeof(Slot) * capacity, ::std::align_val_t{ alignof(Slot) }));
+		}
+
+		static void free_slots(Slot* slots) noexcept
+		{
+			::operator delete(slots, ::std::align_val_t{ alignof(Slot) });
+		}
+
+		[[nodiscard]] usize find_index(const Key& key, usize hash) const noexcept
+		{
+			u8 tag = tag_of(hash);
+			usize index = hash & m_mask;
+
+			while (m_tags[index] != EMPTY_TAG)
+			{
+				if (m_tags[index] == tag && m_slots[index].key == key)
+					return index;
+
+				index = (index + 1) & m_mask;
+			}
+
+			return ~static_cast<usize>(0);
+		}
+
+		[[nodiscard]] usize free_index(usize hash) const noexcept
+		{
+			usize index = hash & m_mask;
+
+			while (m_tags[index] != EMPTY_TAG)
+				index = (index + 1) & m_mask;
+
+			return index;
+		}
+
+		void grow_for(usize count)
+		{
+			if (m_tags != nullptr && count <= (m_mask + 1) - (m_mask + 1) / 4)
+				return;
+
+			usize capacity = capacity_for(count);
+
+			u8* tags = new u8[capacity]{};
+			Slot* slots = allocate_slots(capacity);
+
+			u8* old_tags = m_tags;
+			Slot* old_slots = m_slots;
+			usize old_capacity = m_tags != nullptr ? m_mask + 1 : 0;
+
+			m_tags = tags;
+			m_slots = slots;
+			m_mask = capacity - 1;
+
+			for (usize i = 0; i < old_capacity; ++i)
+			{
+				if (old_tags[i] == EMPTY_TAG)
+					continue;
+
+				usize hash = hash_of(old_slots[i].key);
+				usize index = free_index(hash);
+
+				::new (&m_slots[index]) Slot{ static_cast<Key&&>(old_slots[i].key), static_cast<Value&&>(old_slots[i].value) };
+				m_tags[index] = old_tags[i];
+				old_slots[i].~Slot();
+			}
+
+			delete[] old_tags;
+			free_slots(old_slots);
+		}
+
+		void erase_at(usize index) noexcept
+		{
+			m_slots[index].~Slot();
+			m_tags[index] = EMPTY_TAG;
+			--m_size;
+
+			usize hole = index;
+			usize next = (index + 1) & m_mask;
+
+			while (m_tags[next] != EMPTY_TAG)
+			{
+				usize home = hash_of(m_slots[next].key) & m_mask;
+
+				if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+				{
+					::new (&m_slots[hole]) Slot{ static_cast<Key&&>(m_slots[next].key), static_cast<Value&&>(m_slots[next].value) };
+					m_tags[hole] = m_tags[next];
+
+					m_slots[next].~Slot();
+					m_tags[next] = EMPTY_TAG;
+
+					hole = next;
+				}
+
+				next = (next + 1) & m_mask;
+			}
+		}
+
+	public:
+		FlatMap() noexcept
+			: m_tags{ nullptr }, m_slots{ nullptr }, m_mask{ 0 }, m_size{ 0 }, m_seed{ hash_random_seed() }
+		{
+		}
+
+		explicit FlatMap(usize expected)
+			: FlatMap{}
+		{
+			grow_for(expected);
+		}
+
+		FlatMap(const FlatMap&) = delete;
+
+		FlatMap(FlatMap&& other) noexcept
+			: m_tags{ other.m_tags }, m_slots{ other.m_slots }, m_mask{ other.m_mask }, m_size{ other.m_size }, m_seed{ other.m_seed }
+		{
+			other.m_tags = nullptr;
+			other.m_slots = nullptr;
+			other.m_mask = 0;
+			other.m_size = 0;
+		}
+
+		~FlatMap()
+		{
+			clear();
+
+			delete[] m_tags;
+			free_slots(m_slots);
+		}
+
+		[[nodiscard]] usize size() const noexcept
+		{
+			return m_size;
+		}
+
+		[[nodiscard]] bool is_empty() const noexcept
+		{
+			return m_size == 0;
+		}
+
+		[[nodiscard]] usize capacity() const noexcept
+		{
+			return m_tags != nullptr ? m_mask + 1 : 0;
+		}
+
+		[[nodiscard]] usize hash_of(const Key& key) const noexcept
+		{
+			if constexpr (SEEDED_HASHER)
+				return Hasher{ m_seed }(key);
+			else
+				return hash_mix(static_cast<u64>(Hasher{}(key)) ^ m_seed);
+		}
+
+		void reserve(usize count)
+		{
+			grow_for(count);
+		}
+
+		void prefetch(usize hash) const noexcept
+		{
+			if (m_tags == nullptr)
+				return;
+
+			usize index = hash & m_mask;
+
+#if defined(_MSC_VER)
+			_mm_prefetch(reinterpret_cast<const char*>(&m_tags[index]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(&m_slots[index]), _MM_HINT_T0);
+#else
+			__builtin_prefetch(&m_tags[index]);
+			__builtin_prefetch(&m_slots[index]);
+#endif
+		}
+
+		[[nodiscard]] Value* find(const Key& key, usize hash) noexcept
+		{
+			if (m_size == 0)
+				return nullptr;
+
+			usize index = find_index(key, hash);
+
+			return index != ~static_cast<usize>(0) ? &m_slots[index].value : nullptr;
+		}
+
+		[[nodiscard]] const Value* find(const Key& key, usize hash) const noexcept
+		{
+			if (m_size == 0)
+				return nullptr;
+
+			usize index = find_index(key, hash);
+
+			return index != ~static_cast<usize>(0) ? &m_slots[index].value : nullptr;
+		}
+
+		[[nodiscard]] Value* find(const Key& key) noexcept
+		{
+			return find(key, hash_of(key));
+		}
+
+		[[nodiscard]] const Value* find(const Key& key) const noexcept
+		{
+			return find(key, hash_of(key));
+		}
+
+		[[nodiscard]] bool contains(const Key& key) const noexcept
+		{
+			return find(key) != nullptr;
+		}
+
+		template<class... Args>
+		Value& emplace_hashed(const Key& key, usize hash, bool& inserted, Args&&... args)
+		{
+			if (m_size != 0)
+			{
+				usize found = find_index(key, hash);
+
+				if (found != ~static_cast<usize>(0))
+				{
+					inserted = false;
+					return m_slots[found].value;
+				}
+			}
+
+			grow_for(m_size + 1);
+
+			usize index = free_index(hash);
+
+			::new (&m_slots[index]) Slot{ key, Value{ static_cast<Args&&>(args)... } };
+			m_tags[index] = tag_of(hash);
+			++m_size;
+
+			inserted = true;
+			return m_slots[index].value;
+		}
+
+		template<class... Args>
+		Value& emplace(const Key& key, Args&&... args)
+		{
+			bool inserted;
+
+			return emplace_hashed(key, hash_of(key), inserted, static_cast<Args&&>(args)...);
+		}
+
+		bool insert_or_assign(const Key& key, const Value& value)
+		{
+			bool inserted;
+			Value& slot = emplace_hashed(key, hash_of(key), inserted, value);
+
+			if (!inserted)
+				slot = value;
+
+			return inserted;
+		}
+
+		bool erase(const Key& key) noexcept
+		{
+			if (m_size == 0)
+				return false;
+
+			usize index = find_index(key, hash_of(key));
+
+			if (index == ~static_cast<usize>(0))
+				return false;
+
+			erase_at(index);
+
+			return true;
+		}
+
+		template<class Pred>
+		usize erase_if(Pred&& pred)
+		{
+			usize erased = 0;
+
+			if (m_size == 0)
+				return erased;
+
+			usize start = 0;
+
+			while (m_tags[start] != EMPTY_TAG)
+				++start;
+
+			usize step = 1;
+
+			while (step <= m_mask)
+			{
+				usize index = (start + step) & m_mask;
+
+				if (m_tags[index] != EMPTY_TAG && pred(const_cast<const Key&>(m_slots[index].key), m_slots[index].value))
+				{
+					erase_at(index);
+					++erased;
+
+					continue;
+				}
+
+				++step;
+			}
+
+			return erased;
+		}
+
+		template<class Func>
+		void for_each(Func&& func)
+		{
+			for (usize i = 0; m_tags != nullptr && i <= m_mask; ++i)
+				if (m_tags[i] != EMPTY_TAG)
+					func(const_cast<const Key&>(m_slots[i].key), m_slots[i].value);
+		}
+
+		template<class Func>
+		void for_each(Func&& func) const
+		{
+			for (usize i = 0; m_tags != nullptr && i <= m_mask; ++i)
+				if (m_tags[i] != EMPTY_TAG)
+					func(m_slots[i].key, const_cast<const Value&>(m_slots[i].value));
+		}
+
+		void clear() noexcept
+		{
+			for (usize i = 0; m_tags != nullptr && i <= m_mask; ++i)
+			{
+				if (m_tags[i] != EMPTY_TAG)
+				{
+					m_slots[i].~Slot();
+					m_tags[i] = EMPTY_TAG;
+				}
+			}
+
+			m_size = 0;
+		}
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	enum class FrameCompression
+	{
+		NONE,
+		LZ4
+	};
+
+	struct FrameConfig
+	{
+		usize max_frame = 16 << 20;
+		usize min_compress_bytes = 256;
+		FrameCompression compression = FrameCompression::NONE;
+	};
+
+	struct FrameStats
+	{
+		u64 frames_sent;
+		u64 frames_received;
+		u64 payload_bytes_sent;
+		u64 payload_bytes_received;
+		u64 wire_bytes_sent;
+		u64 wire_bytes_received;
+		u64 compressed_frames;
+		u64 incompressible_frames;
+	};
+
+	struct _FramedStreamState;
+
+	class FramedStream
+	{
+	private:
+		Socket* m_sock;
+
+		_FramedStreamState* m_state;
+
+		[[nodiscard]] Result<Unit, SocketSendError> send_all(const u8* buffer, usize length);
+		[[nodiscard]] Result<usize, SocketReceiveError> recv_some(u8* buffer, usize length);
+		[[nodiscard]] Result<Unit, SocketReceiveError> fill(usize length);
+
+	public:
+		static constexpr usize HEADER_SIZE = 4;
+
+		explicit FramedStream(Socket& sock, const FrameConfig& config = FrameConfig{});
+		FramedStream(const FramedStream&) = delete;
+		FramedStream(FramedStream&& other) noexcept;
+
+		~FramedStream();
+
+		[[nodiscard]] FrameCompression compression() const noexcept;
+		void set_compression(FrameCompression compression) noexcept;
+
+		[[nodiscard]] FrameStats stats() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketSendError> send_frame(const u8* buffer, usize length);
+
+		[[nodiscard]] Result<usize, SocketReceiveError> next_frame_size();
+		[[nodiscard]] Result<usize, SocketReceiveError> recv_frame(u8* buffer, usize capacity);
+	};
+}
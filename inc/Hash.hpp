@@ -36,6 +36,28 @@ namespace bsl
 	{
 	};
 
+	inline constexpr u64 HASH_SEED = 0x9E3779B97F4A7C15ULL;
+
+	[[nodiscard]] u64 hash_random_seed() noexcept;
+
+	[[nodiscard]] constexpr u64 hash_mix(u64 value) noexcept
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDULL;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ULL;
+		value ^= value >> 33;
+
+		return value;
+	}
+
+	[[nodiscard]] constexpr u64 hash_accumulate(u64 state, u64 word) noexcept
+	{
+		state = (state ^ word) * 0x87C37B91114253D5ULL;
+
+		return (state << 31) | (state >> 33);
+	}
+
 	template<class T>
 	[[nodiscard]] constexpr usize hash_combine(const usize& seed, const T& value) noexcept
 	{
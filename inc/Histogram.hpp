@@ -0,0 +1,164 @@
+#pragma once
+
+#include <bit>
+
+#include "Types.hpp"
+
+namespace bsl
+{
+	template<u32 SubBucketBits, u32 MaxValueBits>
+	class BasicHistogram
+	{
+	private:
+		static_assert(SubBucketBits > 0 && SubBucketBits < MaxValueBits && MaxValueBits <= 64);
+
+		static constexpr u32 SUB_BUCKET_BITS = SubBucketBits;
+		static constexpr u64 SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+		static constexpr u64 MAX_VALUE = MaxValueBits == 64 ? ~0ull : (1ull << MaxValueBits) - 1;
+
+	public:
+		static constexpr usize BUCKET_COUNT = (MaxValueBits - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+
+	private:
+		u64 m_counts[BUCKET_COUNT];
+		u64 m_total;
+		u64 m_min;
+		u64 m_max;
+		f64 m_sum;
+
+	public:
+		[[nodiscard]] static constexpr usize index_of(u64 value) noexcept
+		{
+			if (value > MAX_VALUE)
+				value = MAX_VALUE;
+
+			if (value < 2 * SUB_BUCKET_COUNT)
+				return static_cast<usize>(value);
+
+			u32 shift = static_cast<u32>(63 - ::std::countl_zero(value)) - SUB_BUCKET_BITS;
+
+			return static_cast<usize>((static_cast<u64>(shift) << SUB_BUCKET_BITS) + (value >> shift));
+		}
+
+		[[nodiscard]] static constexpr u64 highest_equivalent(usize index) noexcept
+		{
+			if (index < 2 * SUB_BUCKET_COUNT)
+				return static_cast<u64>(index);
+
+			u32 shift = static_cast<u32>(index >> SUB_BUCKET_BITS) - 1;
+			u64 sub = static_cast<u64>(index) - (static_cast<u64>(shift) << SUB_BUCKET_BITS);
+
+			return (sub << shift) + ((1ull << shift) - 1);
+		}
+
+		BasicHistogram() noexcept
+		{
+			reset();
+		}
+
+		void reset() noexcept
+		{
+			for (usize i = 0; i < BUCKET_COUNT; ++i)
+				m_counts[i] = 0;
+
+			m_total = 0;
+			m_min = ~0ull;
+			m_max = 0;
+			m_sum = 0.0;
+		}
+
+		void record(u64 value, u64 count = 1) noexcept
+		{
+			m_counts[index_of(value)] += count;
+			m_total += count;
+			m_sum += static_cast<f64>(value) * static_cast<f64>(count);
+
+			if (value < m_min)
+				m_min = value;
+
+			if (value > m_max)
+				m_max = value;
+		}
+
+		void record_corrected(u64 value, u64 expected_interval) noexcept
+		{
+			record(value);
+
+			if (expected_interval == 0)
+				return;
+
+			for (u64 missing = value - (value < expected_interval ? value : expected_interval);
+				missing >= expected_interval; missing -= expected_interval)
+				record(missing);
+		}
+
+		void merge(const BasicHistogram& other) noexcept
+		{
+			for (usize i = 0; i < BUCKET_COUNT; ++i)
+				m_counts[i] += other.m_counts[i];
+
+			m_total += other.m_total;
+			m_sum += other.m_sum;
+
+			if (other.m_min < m_min)
+				m_min = other.m_min;
+
+			if (other.m_max > m_max)
+				m_max = other.m_max;
+		}
+
+		[[nodiscard]] u64 count() const noexcept
+		{
+			return m_total;
+		}
+
+		[[nodiscard]] u64 min() const noexcept
+		{
+			return m_total == 0 ? 0 : m_min;
+		}
+
+		[[nodiscard]] u64 max() const noexcept
+		{
+			return m_max;
+		}
+
+		[[nodiscard]] f64 mean() const noexcept
+		{
+			return m_total == 0 ? 0.0 : m_sum / static_cast<f64>(m_total);
+		}
+
+		[[nodiscard]] u64 percentile(f64 p) const noexcept
+		{
+			if (m_total == 0)
+				return 0;
+
+			if (p <= 0.0)
+				return min();
+
+			u64 target = static_cast<u64>(p / 100.0 * static_cast<f64>(m_total) + 0.5);
+
+			if (target == 0)
+				target = 1;
+
+			if (target >= m_total)
+				return m_max;
+
+			u64 seen = 0;
+
+			for (usize i = 0; i < BUCKET_COUNT; ++i)
+			{
+				seen += m_counts[i];
+
+				if (seen >= target)
+				{
+					u64 value = highest_equivalent(i);
+					return value < m_max ? value : m_max;
+				}
+			}
+
+			return m_max;
+		}
+	};
+
+	using Histogram = BasicHistogram<7, 64>;
+}
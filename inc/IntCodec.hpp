@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Maybe.hpp"
+
+namespace bsl
+{
+	inline constexpr usize VARINT32_MAX_BYTES = 5;
+	inline constexpr usize VARINT64_MAX_BYTES = 10;
+
+	inline constexpr usize BITPACK_BLOCK_SIZE = 128;
+
+	[[nodiscard]] constexpr u32 zigzag_encode(i32 value) noexcept
+	{
+		return (static_cast<u32>(value) << 1) ^ static_cast<u32>(value >> 31);
+	}
+
+	[[nodiscard]] constexpr u64 zigzag_encode(i64 value) noexcept
+	{
+		return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+	}
+
+	[[nodiscard]] constexpr i32 zigzag_decode(u32 value) noexcept
+	{
+		return static_cast<i32>((value >> 1) ^ (0u - (value & 1)));
+	}
+
+	[[nodiscard]] constexpr i64 zigzag_decode(u64 value) noexcept
+	{
+		return static_cast<i64>((value >> 1) ^ (0ull - (value & 1)));
+	}
+
+	[[nodiscard]] constexpr usize varint_size(u64 value) noexcept
+	{
+		usize size = 1;
+
+		while (value >= 0x80)
+		{
+			value >>= 7;
+			++size;
+		}
+
+		return size;
+	}
+
+	[[nodiscard]] constexpr usize varint_bound_u32(usize count) noexcept
+	{
+		return count * VARINT32_MAX_BYTES;
+	}
+
+	[[nodiscard]] constexpr usize varint_bound_u64(usize count) noexcept
+	{
+		return count * VARINT64_MAX_BYTES;
+	}
+
+	[[nodiscard]] constexpr usize group_varint_bound(usize count) noexcept
+	{
+		return count * sizeof(u32) + (count + 3) / 4;
+	}
+
+	[[nodiscard]] constexpr usize bitpack_bound_u32(usize count) noexcept
+	{
+		return count * sizeof(u32) + (count / BITPACK_BLOCK_SIZE + 1) * (sizeof(u32) + 1);
+	}
+
+	[[nodiscard]] constexpr usize bitpack_bound_u64(usize count) noexcept
+	{
+		return count * sizeof(u64) + (count / BITPACK_BLOCK_SIZE + 1) * (sizeof(u64) + 1);
+	}
+
+	usize varint_encode(u64 value, u8* out) noexcept;
+	[[nodiscard]] usize varint_decode(const u8* in, usize length, u64& value) noexcept;
+
+	usize varint_encode_u32(const u32* values, usize count, u8* out) noexcept;
+	usize varint_encode_u64(const u64* values, usize count, u8* out) noexcept;
+
+	[[nodiscard]] Maybe<usize> varint_decode_u32(const u8* in, usize length, u32* values, usize count) noexcept;
+	[[nodiscard]] Maybe<usize> varint_decode_u64(const u8* in, usize length, u64* values, usize count) noexcept;
+
+	usize group_varint_encode(const u32* values, usize count, u8* out) noexcept;
+	[[nodiscard]] Maybe<usize> group_varint_decode(const u8* in, usize length, u32* values, usize count) noexcept;
+
+	usize bitpack_encode_u32(const u32* values, usize count, u8* out) noexcept;
+	usize bitpack_encode_u64(const u64* values, usize count, u8* out) noexcept;
+
+	[[nodiscard]] Maybe<usize> bitpack_decode_u32(const u8* in, usize length, u32* values, usize count) noexcept;
+	[[nodiscard]] Maybe<usize> bitpack_decode_u64(const u8* in, usize length, u64* values, usize count) noexcept;
+}
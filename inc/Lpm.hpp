@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct LpmError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "Prefix table error.";
+		}
+	};
+
+	struct LpmEntryIPv4
+	{
+		CidrIPv4 prefix;
+		u32 value;
+	};
+
+	struct LpmEntryIPv6
+	{
+		CidrIPv6 prefix;
+		u32 value;
+	};
+
+	struct _LpmIPv4State;
+	struct _LpmIPv6State;
+
+	class LpmTableIPv4
+	{
+	private:
+		_LpmIPv4State* m_state;
+
+	public:
+		static constexpr u32 NO_VALUE = ~0u;
+
+		LpmTableIPv4();
+		LpmTableIPv4(const LpmTableIPv4&) = delete;
+
+		~LpmTableIPv4();
+
+		[[nodiscard]] Result<Unit, LpmError> rebuild(const LpmEntryIPv4* entries, usize count);
+
+		[[nodiscard]] Maybe<u32> lookup(const AddrIPv4& addr) const noexcept;
+		usize lookup_bulk(const AddrIPv4* addrs, usize count, u32* values) const noexcept;
+
+		[[nodiscard]] usize prefixes() const noexcept;
+		[[nodiscard]] usize ranges() const noexcept;
+	};
+
+	class LpmTableIPv6
+	{
+	private:
+		_LpmIPv6State* m_state;
+
+	public:
+		static constexpr u32 NO_VALUE = ~0u;
+
+		LpmTableIPv6();
+		LpmTableIPv6(const LpmTableIPv6&) = delete;
+
+		~LpmTableIPv6();
+
+		[[nodiscard]] Result<Unit, LpmError> rebuild(const LpmEntryIPv6* entries, usize count);
+
+		[[nodiscard]] Maybe<u32> lookup(const AddrIPv6& addr) const noexcept;
+		usize lookup_bulk(const AddrIPv6* addrs, usize count, u32* values) const noexcept;
+
+		[[nodiscard]] usize prefixes() const noexcept;
+		[[nodiscard]] usize ranges() const noexcept;
+	};
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct CompressionError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "Compression error.";
+		}
+	};
+
+	inline constexpr usize LZ4_MAX_INPUT_SIZE = 0x7E000000;
+
+	[[nodiscard]] constexpr usize lz4_compress_bound(usize length) noexcept
+	{
+		return length + length / 255 + 16;
+	}
+
+	[[nodiscard]] Result<usize, CompressionError> lz4_compress(const u8* source, usize length, u8* dest, usize capacity) noexcept;
+	[[nodiscard]] Result<usize, CompressionError> lz4_decompress(const u8* source, usize length, u8* dest, usize capacity) noexcept;
+}
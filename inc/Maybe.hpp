@@ -77,41 +77,55 @@ namespace bsl
 				m_value.~value_type();
 		}
 
-		constexpr Maybe& operator=(const Maybe& other) noexcept(is_nothrow_copy_assignable_v<value_type>&& is_nothrow_destructible_v<value_type>)
+		constexpr Maybe& operator=(const Maybe& other) noexcept(is_nothrow_copy_constructible_v<value_type>&& is_nothrow_destructible_v<value_type>)
 		{
+			if (this == &other)
+				return *this;
+
 			if (other.has_value())
-				m_value = other.m_value;
-			else if (has_value())
-				m_value.~T();
+				return *this = other.m_value;
 
-			m_has_value = other.m_has_value;
+			reset();
 
 			return *this;
 		}
 
-		constexpr Maybe& operator=(Maybe&& other) noexcept(is_nothrow_move_assignable_v<value_type>&& is_nothrow_destructible_v<value_type>)
+		constexpr Maybe& operator=(Maybe&& other) noexcept(is_nothrow_move_constructible_v<value_type>&& is_nothrow_destructible_v<value_type>)
 		{
+			if (this == &other)
+				return *this;
+
 			if (other.has_value())
-				m_value = move(other.m_value);
-			else if (has_value())
-				m_value.~value_type();
+				return *this = move(other.m_value);
 
-			m_has_value = other.m_has_value;
+			reset();
 
 			return *this;
 		}
 
-		constexpr Maybe& operator=(const_reference_type value) noexcept(is_nothrow_copy_assignable_v<value_type>)
+		constexpr Maybe& operator=(const_reference_type value) noexcept(is_nothrow_copy_constructible_v<value_type>&& is_nothrow_destructible_v<value_type>)
 		{
-			m_value = value;
+			if (has_value() && &m_value == &value)
+				return *this;
+
+			reset();
+
+			::new(&m_value) value_type{ value };
 			m_has_value = true;
+
 			return *this;
 		}
 
-		constexpr Maybe& operator=(value_type&& value) noexcept(is_nothrow_move_assignable_v<value_type>)
+		constexpr Maybe& operator=(value_type&& value) noexcept(is_nothrow_move_constructible_v<value_type>&& is_nothrow_destructible_v<value_type>)
 		{
-			m_value = move(value);
+			if (has_value() && &m_value == &value)
+				return *this;
+
+			reset();
+
+			::new(&m_value) value_type{ move(value) };
 			m_has_value = true;
+
 			return *this;
 		}
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct MemNetworkConfig
+	{
+		usize max_endpoints = 1024;
+		usize stream_capacity = 1 << 16;
+		usize accept_queue = 128;
+		usize datagram_queue = 256;
+		usize max_datagram = 2048;
+		usize pipe_pool = 64;
+	};
+
+	struct _MemNetworkState;
+	struct _MemSocketState;
+
+	class MemSocket;
+
+	class MemNetwork
+	{
+	private:
+		friend MemSocket;
+
+		_MemNetworkState* m_state;
+
+	public:
+		MemNetwork(const MemNetworkConfig& config = MemNetworkConfig{});
+		MemNetwork(const MemNetwork&) = delete;
+		MemNetwork(MemNetwork&&) = delete;
+
+		~MemNetwork();
+
+		[[nodiscard]] const MemNetworkConfig& config() const noexcept;
+	};
+
+	class MemSocket
+	{
+	private:
+		_MemSocketState* m_sock;
+
+		AddrFamily m_family;
+		SockType m_type;
+		Proto m_proto;
+
+		MemSocket(_MemSocketState* state, AddrFamily family, SockType type, Proto proto) noexcept;
+
+	public:
+		MemSocket(MemNetwork& network, AddrFamily family, SockType type, Proto proto);
+		MemSocket(const MemSocket&) = delete;
+		MemSocket(MemSocket&& other) noexcept;
+
+		~MemSocket();
+
+		[[nodiscard]] AddrFamily addr_family() const noexcept;
+		[[nodiscard]] SockType sock_type() const noexcept;
+		[[nodiscard]] Proto proto() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketConnectError> connect(const SockAddr& addr);
+		[[nodiscard]] Result<Unit, SocketCloseError> close();
+		[[nodiscard]] Result<Unit, SocketError> shutdown();
+
+		[[nodiscard]] Result<Unit, SocketBindError> bind(const SockAddr& addr);
+
+		[[nodiscard]] Result<Unit, SocketListenError> listen(usize backlog);
+		[[nodiscard]] Result<MemSocket, SocketAcceptError> accept();
+
+		[[nodiscard]] Result<SockAddr, SocketError> addr() const;
+		[[nodiscard]] Result<SockAddr, SocketError> peer() const;
+
+		[[nodiscard]] bool is_connected() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketError> set_nonblocking(bool enable);
+		[[nodiscard]] Result<Unit, SocketError> set_send_timeout(u64 timeout_ms);
+		[[nodiscard]] Result<Unit, SocketError> set_recv_timeout(u64 timeout_ms);
+
+		[[nodiscard]] IoCounters stats() const noexcept;
+
+		[[nodiscard]] Result<usize, SocketSendError> send(const u8* buffer, usize length);
+		[[nodiscard]] Result<usize, SocketReceiveError> recv(u8* buffer, usize length);
+		[[nodiscard]] Result<bool, SocketError> wait_readable(u64 timeout_ms);
+
+		[[nodiscard]] Result<usize, SocketSendError> send_vectored(const IoSlice* slices, usize count);
+
+		[[nodiscard]] Result<usize, SocketSendError> send_to(const SockAddr& addr, const u8* buffer, usize length);
+		[[nodiscard]] Result<Tuple<usize, SockAddr>, SocketReceiveError> recv_from(u8* buffer, usize length);
+	};
+}
@@ -1,17 +1,71 @@
 #pragma once
 
+#include <cstring>
+
 #include "Error.hpp"
 #include "Types.hpp"
 #include "Variant.hpp"
 #include "Result.hpp"
 #include "Maybe.hpp"
 #include "Tuple.hpp"
+#include "NetMetrics.hpp"
 
 namespace bsl::net
 {
-	struct NetError : Error
+	enum class NetErrorKind : u8
+	{
+		UNKNOWN,
+		WOULD_BLOCK,
+		INTERRUPTED,
+		INVALID_ARGUMENT,
+		NO_BUFFERS,
+		MESSAGE_TOO_LONG,
+		ADDRESS_IN_USE,
+		ADDRESS_UNAVAILABLE,
+		NETWORK_UNREACHABLE,
+		HOST_UNREACHABLE,
+		HOST_NOT_FOUND,
+		CONNECTION_REFUSED,
+		CONNECTION_RESET,
+		CONNECTION_ABORTED,
+		NOT_CONNECTED,
+		TIMED_OUT,
+		CLOSED
+	};
+
+	class NetError
 	{
-		virtual [[nodiscard]] const char* msg() const noexcept override
+	private:
+		i32 m_code;
+		NetErrorKind m_kind;
+
+	public:
+		constexpr NetError() noexcept
+			: m_code{ 0 }, m_kind{ NetErrorKind::UNKNOWN }
+		{
+		}
+
+		constexpr NetError(NetErrorKind kind, i32 native_code = 0) noexcept
+			: m_code{ native_code }, m_kind{ kind }
+		{
+		}
+
+		[[nodiscard]] constexpr i32 native_code() const noexcept
+		{
+			return m_code;
+		}
+
+		[[nodiscard]] constexpr NetErrorKind kind() const noexcept
+		{
+			return m_kind;
+		}
+
+		[[nodiscard]] constexpr bool would_block() const noexcept
+		{
+			return m_kind == NetErrorKind::WOULD_BLOCK;
+		}
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Network error.";
 		}
@@ -19,7 +73,9 @@ namespace bsl::net
 
 	struct HostnameResolutionError : NetError
 	{
-		virtual [[nodiscard]] const char* msg() const noexcept override
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Hostname resolution error.";
 		}
@@ -27,7 +83,9 @@ namespace bsl::net
 
 	struct SocketError : NetError
 	{
-		virtual [[nodiscard]] const char* msg() const noexcept override
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket error.";
 		}
@@ -35,7 +93,9 @@ namespace bsl::net
 
 	struct SocketConnectError : SocketError
 	{
-		virtual [[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket connect error.";
 		}
@@ -43,7 +103,9 @@ namespace bsl::net
 
 	struct SocketCloseError : SocketError
 	{
-		[[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket close error.";
 		}
@@ -51,7 +113,9 @@ namespace bsl::net
 
 	struct SocketSendError : SocketError
 	{
-		[[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket send error.";
 		}
@@ -59,7 +123,9 @@ namespace bsl::net
 
 	struct SocketReceiveError : SocketError
 	{
-		[[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket receive error.";
 		}
@@ -67,7 +133,9 @@ namespace bsl::net
 
 	struct SocketBindError : SocketError
 	{
-		[[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket bind error.";
 		}
@@ -75,7 +143,9 @@ namespace bsl::net
 
 	struct SocketListenError : SocketError
 	{
-		[[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket listen error.";
 		}
@@ -83,12 +153,19 @@ namespace bsl::net
 
 	struct SocketAcceptError : SocketError
 	{
-		[[nodiscard]] const char* msg() const noexcept override
+		using SocketError::SocketError;
+
+		[[nodiscard]] const char* msg() const noexcept
 		{
 			return "Socket accept error.";
 		}
 	};
 
+	static_assert(sizeof(SocketError) == 8, "Socket errors must stay register-sized");
+
+	[[nodiscard]] Result<Unit, NetError> try_setup();
+	[[nodiscard]] Result<Unit, NetError> try_cleanup();
+
 	void setup();
 	void cleanup();
 
@@ -100,23 +177,31 @@ namespace bsl::net
 
 	class SockAddrV4;
 	class SockAddrV6;
+	class SockAddrUnix;
 	class SockAddr;
 
 	struct _NativeSocket;
 
 	class Socket;
+	class MemSocket;
+
+	struct _TrafficRecorderState;
+	class TrafficRecorder;
+
+	struct _ConnTrackerState;
+	struct _DeferredAcceptState;
+	class ConnTracker;
+
+	class TCPServer;
 
 	class AddrIPv4
 	{
 	private:
-		u8 m_addr[4];
+		u32 m_bits;
 
 		u32 int_value() const noexcept
 		{
-			return (static_cast<u32>(m_addr[0]) << 24) | 
-				(static_cast<u32>(m_addr[1]) << 16) | 
-				(static_cast<u32>(m_addr[2]) << 8) | 
-				static_cast<u32>(m_addr[3]);
+			return m_bits;
 		}
 
 	public:
@@ -124,47 +209,86 @@ namespace bsl::net
 		static const AddrIPv4 UNSPECIFIED;
 		static const AddrIPv4 BROADCAST;
 
+		static constexpr usize MAX_TEXT_LENGTH = 15;
+
 		AddrIPv4(u8 a, u8 b, u8 c, u8 d) noexcept
-			: m_addr{ a, b, c, d }
+			: m_bits{ (static_cast<u32>(a) << 24) | (static_cast<u32>(b) << 16) | (static_cast<u32>(c) << 8) | static_cast<u32>(d) }
 		{
 		}
 
+		[[nodiscard]] static AddrIPv4 from_bits(u32 bits) noexcept
+		{
+			return AddrIPv4{
+				static_cast<u8>(bits >> 24),
+				static_cast<u8>(bits >> 16),
+				static_cast<u8>(bits >> 8),
+				static_cast<u8>(bits)
+			};
+		}
+
+		[[nodiscard]] static Maybe<AddrIPv4> from_text(const char* text, usize length) noexcept;
+		[[nodiscard]] static Maybe<AddrIPv4> from_text(const char* text) noexcept;
+
+		usize to_text(char* dest) const noexcept;
+
 		[[nodiscard]] bool is_localhost() const noexcept
 		{
-			return *this == LOCALHOST;
+			return m_bits == 0x7F000001;
 		}
 
 		[[nodiscard]] bool is_unspecified() const noexcept
 		{
-			return *this == UNSPECIFIED;
+			return m_bits == 0;
 		}
 
 		[[nodiscard]] bool is_broadcast() const noexcept
 		{
-			return *this == BROADCAST;
+			return m_bits == 0xFFFFFFFF;
+		}
+
+		[[nodiscard]] bool is_private() const noexcept
+		{
+			return (m_bits & 0xFF000000) == 0x0A000000 ||
+				(m_bits & 0xFFF00000) == 0xAC100000 ||
+				(m_bits & 0xFFFF0000) == 0xC0A80000;
+		}
+
+		[[nodiscard]] bool is_linklocal() const noexcept
+		{
+			return (m_bits & 0xFFFF0000) == 0xA9FE0000;
 		}
 
 		[[nodiscard]] bool is_documentation() const noexcept
 		{
-			return (m_addr[0] == 192 && m_addr[1] == 0 && m_addr[2] == 2) ||
-				(m_addr[0] == 192 && m_addr[1] == 51 && m_addr[2] == 100) ||
-				(m_addr[0] == 203 && m_addr[1] == 0 && m_addr[2] == 113) ||
-				(m_addr[0] == 233 && m_addr[1] == 252 && m_addr[2] == 0);
+			return (m_bits & 0xFFFFFF00) == 0xC0000200 ||
+				(m_bits & 0xFFFFFF00) == 0xC6336400 ||
+				(m_bits & 0xFFFFFF00) == 0xCB007100 ||
+				(m_bits & 0xFFFFFF00) == 0xE9FC0000;
 		}
 
-		[[nodiscard]] const u8* octets() const noexcept
+		[[nodiscard]] bool is_benchmarking() const noexcept
 		{
-			return m_addr;
+			return (m_bits & 0xFFFE0000) == 0xC6120000;
+		}
+
+		[[nodiscard]] bool is_multicast() const noexcept
+		{
+			return (m_bits & 0xF0000000) == 0xE0000000;
+		}
+
+		[[nodiscard]] u32 to_bits() const noexcept
+		{
+			return m_bits;
 		}
 
 		[[nodiscard]] u8 operator[](usize idx) const
 		{
-			return m_addr[idx];
+			return static_cast<u8>(m_bits >> ((3 - idx) * 8));
 		}
 
 		[[nodiscard]] bool operator<(const AddrIPv4& rhs) const noexcept
 		{
-			return int_value() < rhs.int_value();
+			return m_bits < rhs.m_bits;
 		}
 
 		[[nodiscard]] bool operator>(const AddrIPv4& rhs) const noexcept
@@ -184,7 +308,7 @@ namespace bsl::net
 
 		[[nodiscard]] bool operator==(const AddrIPv4& rhs) const noexcept
 		{
-			return (*this <= rhs) && (*this >= rhs);
+			return m_bits == rhs.m_bits;
 		}
 
 		[[nodiscard]] bool operator!=(const AddrIPv4& rhs) const noexcept
@@ -196,79 +320,89 @@ namespace bsl::net
 	class AddrIPv6
 	{
 	private:
-		u16 m_addr[8];
+		u64 m_high;
+		u64 m_low;
 
 		u64 high_int_value() const noexcept
 		{
-			return (static_cast<u64>(m_addr[0]) << 48) |
-				(static_cast<u64>(m_addr[1]) << 32) |
-				(static_cast<u64>(m_addr[2]) << 16) |
-				static_cast<u64>(m_addr[3]);
+			return m_high;
 		}
 
 		u64 low_int_value() const noexcept
 		{
-			return (static_cast<u64>(m_addr[4]) << 48) |
-				(static_cast<u64>(m_addr[5]) << 32) |
-				(static_cast<u64>(m_addr[6]) << 16) |
-				static_cast<u64>(m_addr[7]);
+			return m_low;
 		}
 
 	public:
 		static const AddrIPv6 LOCALHOST;
 		static const AddrIPv6 UNSPECIFIED;
 
+		static constexpr usize MAX_TEXT_LENGTH = 45;
+
 		AddrIPv6(u16 a, u16 b, u16 c, u16 d, u16 e, u16 f, u16 g, u16 h) noexcept
-			: m_addr{ a, b, c, d, e, f, g, h }
+			: m_high{ (static_cast<u64>(a) << 48) | (static_cast<u64>(b) << 32) | (static_cast<u64>(c) << 16) | static_cast<u64>(d) },
+			m_low{ (static_cast<u64>(e) << 48) | (static_cast<u64>(f) << 32) | (static_cast<u64>(g) << 16) | static_cast<u64>(h) }
 		{
 		}
 
 		AddrIPv6(const AddrIPv4& addr) noexcept
-			: AddrIPv6{ 0, 0, 0, 0, 0, 0xFFFF, 
-				static_cast<u16>((m_addr[0] << 8) | m_addr[1]),
-				static_cast<u16>((m_addr[2] << 8) | m_addr[3])
-			}
+			: m_high{ 0 }, m_low{ 0x0000FFFF00000000ULL | addr.to_bits() }
 		{
 		}
 
+		[[nodiscard]] static AddrIPv6 from_bits(u64 high, u64 low) noexcept
+		{
+			return AddrIPv6{
+				static_cast<u16>(high >> 48), static_cast<u16>(high >> 32),
+				static_cast<u16>(high >> 16), static_cast<u16>(high),
+				static_cast<u16>(low >> 48), static_cast<u16>(low >> 32),
+				static_cast<u16>(low >> 16), static_cast<u16>(low)
+			};
+		}
+
+		[[nodiscard]] static Maybe<AddrIPv6> from_text(const char* text, usize length) noexcept;
+		[[nodiscard]] static Maybe<AddrIPv6> from_text(const char* text) noexcept;
+
+		usize to_text(char* dest) const noexcept;
+
 		[[nodiscard]] bool is_localhost() const noexcept
 		{
-			return *this == LOCALHOST;
+			return m_high == 0 && m_low == 1;
 		}
 
 		[[nodiscard]] bool is_unspecified() const noexcept
 		{
-			return *this == UNSPECIFIED;
+			return m_high == 0 && m_low == 0;
 		}
 
 		[[nodiscard]] bool is_linklocal() const noexcept
 		{
-			return (m_addr[0] & 0xFFC0) == 0xFE80;
+			return (m_high & 0xFFC0000000000000ULL) == 0xFE80000000000000ULL;
 		}
 
 		[[nodiscard]] bool is_ipv4_mapped() const noexcept
 		{
-			return m_addr[0] == 0 &&
-				m_addr[1] == 0 &&
-				m_addr[2] == 0 &&
-				m_addr[3] == 0 &&
-				m_addr[4] == 0 &&
-				m_addr[5] == 0xFFFF;
+			return m_high == 0 && (m_low >> 32) == 0xFFFF;
 		}
 
 		[[nodiscard]] bool is_documentation() const noexcept
 		{
-			return m_addr[0] == 0x2001 && m_addr[1] == 0x0DB8;
+			return (m_high >> 32) == 0x20010DB8;
 		}
 
 		[[nodiscard]] bool is_benchmarking() const noexcept
 		{
-			return m_addr[0] == 0x2001 && m_addr[1] == 2 && m_addr[1] == 0;
+			return (m_high >> 16) == 0x200100020000ULL;
 		}
 
 		[[nodiscard]] bool is_private() const noexcept
 		{
-			return (m_addr[0] & 0xFE00) == 0xFC00;
+			return (m_high & 0xFE00000000000000ULL) == 0xFC00000000000000ULL;
+		}
+
+		[[nodiscard]] bool is_multicast() const noexcept
+		{
+			return (m_high >> 56) == 0xFF;
 		}
 
 		[[nodiscard]] Maybe<AddrIPv4> to_ipv4() const noexcept
@@ -282,32 +416,27 @@ namespace bsl::net
 			if (!is_ipv4_mapped())
 				return {};
 
-			return AddrIPv4{
-				static_cast<u8>((m_addr[6] >> 8) & 0xFF),
-				static_cast<u8>(m_addr[6] & 0xFF),
-				static_cast<u8>((m_addr[7] >> 8) & 0xFF),
-				static_cast<u8>(m_addr[7] & 0xFF)
-			};
+			return AddrIPv4::from_bits(static_cast<u32>(m_low));
 		}
 
-		[[nodiscard]] const u16* hextets() const noexcept
+		[[nodiscard]] u64 high_bits() const noexcept
 		{
-			return m_addr;
+			return m_high;
+		}
+
+		[[nodiscard]] u64 low_bits() const noexcept
+		{
+			return m_low;
 		}
 
 		[[nodiscard]] u16 operator[](usize idx) const
 		{
-			return m_addr[idx];
+			return static_cast<u16>((idx < 4 ? m_high : m_low) >> ((3 - idx % 4) * 16));
 		}
 
 		[[nodiscard]] bool operator<(const AddrIPv6& rhs) const noexcept
 		{
-			if (high_int_value() < rhs.high_int_value())
-				return true;
-			else if (high_int_value() > rhs.high_int_value())
-				return false;
-
-			return low_int_value() < rhs.low_int_value();
+			return m_high < rhs.m_high || (m_high == rhs.m_high && m_low < rhs.m_low);
 		}
 
 		[[nodiscard]] bool operator>(const AddrIPv6& rhs) const noexcept
@@ -327,7 +456,7 @@ namespace bsl::net
 
 		[[nodiscard]] bool operator==(const AddrIPv6& rhs) const noexcept
 		{
-			return (*this <= rhs) && (*this >= rhs);
+			return m_high == rhs.m_high && m_low == rhs.m_low;
 		}
 
 		[[nodiscard]] bool operator!=(const AddrIPv6& rhs) const noexcept
@@ -339,6 +468,8 @@ namespace bsl::net
 	class IPAddr
 	{
 	private:
+		friend struct ::bsl::Hash<IPAddr>;
+
 		Variant<AddrIPv4, AddrIPv6> m_addr;
 
 	public:
@@ -395,8 +526,168 @@ namespace bsl::net
 		{
 			return get<1>(m_addr);
 		}
+
+		[[nodiscard]] bool operator==(const IPAddr& rhs) const noexcept
+		{
+			if (m_addr.index() != rhs.m_addr.index())
+				return false;
+
+			return m_addr.index() == 0 ?
+				get<0>(m_addr) == get<0>(rhs.m_addr) :
+				get<1>(m_addr) == get<1>(rhs.m_addr);
+		}
+
+		[[nodiscard]] bool operator!=(const IPAddr& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+
+		[[nodiscard]] static Maybe<IPAddr> from_text(const char* text, usize length) noexcept;
+		[[nodiscard]] static Maybe<IPAddr> from_text(const char* text) noexcept;
+
+		usize to_text(char* dest) const noexcept;
 	};
 
+	class CidrIPv4
+	{
+	private:
+		AddrIPv4 m_addr;
+		u8 m_length;
+
+		CidrIPv4(const AddrIPv4& addr, u8 length) noexcept
+			: m_addr{ addr }, m_length{ length }
+		{
+		}
+
+	public:
+		static constexpr usize MAX_LENGTH = 32;
+		static constexpr usize MAX_TEXT_LENGTH = AddrIPv4::MAX_TEXT_LENGTH + 3;
+
+		[[nodiscard]] static u32 mask_of(usize length) noexcept
+		{
+			return length == 0 ? 0 : ~0u << (32 - length);
+		}
+
+		[[nodiscard]] static Maybe<CidrIPv4> from(const AddrIPv4& addr, usize length) noexcept
+		{
+			if (length > MAX_LENGTH)
+				return {};
+
+			return CidrIPv4{ AddrIPv4::from_bits(addr.to_bits() & mask_of(length)), static_cast<u8>(length) };
+		}
+
+		[[nodiscard]] static Maybe<CidrIPv4> from_text(const char* text, usize length) noexcept;
+		[[nodiscard]] static Maybe<CidrIPv4> from_text(const char* text) noexcept;
+
+		usize to_text(char* dest) const noexcept;
+
+		[[nodiscard]] AddrIPv4 addr() const noexcept
+		{
+			return m_addr;
+		}
+
+		[[nodiscard]] usize length() const noexcept
+		{
+			return m_length;
+		}
+
+		[[nodiscard]] AddrIPv4 last() const noexcept
+		{
+			return AddrIPv4::from_bits(m_addr.to_bits() | ~mask_of(m_length));
+		}
+
+		[[nodiscard]] bool contains(const AddrIPv4& addr) const noexcept
+		{
+			return (addr.to_bits() & mask_of(m_length)) == m_addr.to_bits();
+		}
+
+		[[nodiscard]] bool operator==(const CidrIPv4& rhs) const noexcept
+		{
+			return m_length == rhs.m_length && m_addr == rhs.m_addr;
+		}
+
+		[[nodiscard]] bool operator!=(const CidrIPv4& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+	};
+
+	class CidrIPv6
+	{
+	private:
+		AddrIPv6 m_addr;
+		u8 m_length;
+
+		CidrIPv6(const AddrIPv6& addr, u8 length) noexcept
+			: m_addr{ addr }, m_length{ length }
+		{
+		}
+
+	public:
+		static constexpr usize MAX_LENGTH = 128;
+		static constexpr usize MAX_TEXT_LENGTH = AddrIPv6::MAX_TEXT_LENGTH + 4;
+
+		[[nodiscard]] static u64 high_mask_of(usize length) noexcept
+		{
+			return length == 0 ? 0 : length >= 64 ? ~0ull : ~0ull << (64 - length);
+		}
+
+		[[nodiscard]] static u64 low_mask_of(usize length) noexcept
+		{
+			return length <= 64 ? 0 : ~0ull << (128 - length);
+		}
+
+		[[nodiscard]] static Maybe<CidrIPv6> from(const AddrIPv6& addr, usize length) noexcept
+		{
+			if (length > MAX_LENGTH)
+				return {};
+
+			return CidrIPv6{
+				AddrIPv6::from_bits(addr.high_bits() & high_mask_of(length), addr.low_bits() & low_mask_of(length)),
+				static_cast<u8>(length)
+			};
+		}
+
+		[[nodiscard]] static Maybe<CidrIPv6> from_text(const char* text, usize length) noexcept;
+		[[nodiscard]] static Maybe<CidrIPv6> from_text(const char* text) noexcept;
+
+		usize to_text(char* dest) const noexcept;
+
+		[[nodiscard]] const AddrIPv6& addr() const noexcept
+		{
+			return m_addr;
+		}
+
+		[[nodiscard]] usize length() const noexcept
+		{
+			return m_length;
+		}
+
+		[[nodiscard]] AddrIPv6 last() const noexcept
+		{
+			return AddrIPv6::from_bits(m_addr.high_bits() | ~high_mask_of(m_length), m_addr.low_bits() | ~low_mask_of(m_length));
+		}
+
+		[[nodiscard]] bool contains(const AddrIPv6& addr) const noexcept
+		{
+			return (addr.high_bits() & high_mask_of(m_length)) == m_addr.high_bits() &&
+				(addr.low_bits() & low_mask_of(m_length)) == m_addr.low_bits();
+		}
+
+		[[nodiscard]] bool operator==(const CidrIPv6& rhs) const noexcept
+		{
+			return m_length == rhs.m_length && m_addr == rhs.m_addr;
+		}
+
+		[[nodiscard]] bool operator!=(const CidrIPv6& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+	};
+
+	[[nodiscard]] usize parse_ipv4_bulk(const char* const* texts, const usize* lengths, usize count, AddrIPv4* out, bool* valid) noexcept;
+	[[nodiscard]] usize parse_ip_lines(const char* buffer, usize length, AddrIPv6* out, bool* valid, usize max_lines, usize& consumed) noexcept;
+
 	[[nodiscard]] Result<IPAddr, HostnameResolutionError> resolve(const char* hostname, const char* service = nullptr);
 
 	class SockAddrV4
@@ -425,6 +716,16 @@ namespace bsl::net
 		{
 			return m_port;
 		}
+
+		[[nodiscard]] bool operator==(const SockAddrV4& rhs) const noexcept
+		{
+			return m_port == rhs.m_port && m_addr == rhs.m_addr;
+		}
+
+		[[nodiscard]] bool operator!=(const SockAddrV4& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
 	};
 
 	class SockAddrV6
@@ -453,17 +754,118 @@ namespace bsl::net
 		{
 			return m_port;
 		}
+
+		[[nodiscard]] bool operator==(const SockAddrV6& rhs) const noexcept
+		{
+			return m_port == rhs.m_port && m_addr == rhs.m_addr;
+		}
+
+		[[nodiscard]] bool operator!=(const SockAddrV6& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+	};
+
+	class SockAddrUnix
+	{
+	private:
+		friend SockAddr;
+
+		[[nodiscard]] _NativeSockAddr to_native() const noexcept;
+		[[nodiscard]] static Maybe<SockAddrUnix> from_native(const _NativeSockAddr& native) noexcept;
+
+		char m_path[108];
+		usize m_length;
+		bool m_is_abstract;
+
+		SockAddrUnix(const char* path, usize length, bool is_abstract) noexcept
+			: m_path{}, m_length{ length }, m_is_abstract{ is_abstract }
+		{
+			for (usize i = 0; i < length; ++i)
+				m_path[i] = path[i];
+		}
+
+		[[nodiscard]] static usize path_length(const char* path) noexcept
+		{
+			usize length = 0;
+
+			while (length <= MAX_PATH_LENGTH && path[length] != '\0')
+				++length;
+
+			return length;
+		}
+
+	public:
+		static constexpr usize MAX_PATH_LENGTH = 107;
+
+		[[nodiscard]] static Maybe<SockAddrUnix> from_path(const char* path) noexcept
+		{
+			usize length = path_length(path);
+
+			if (length == 0 || length > MAX_PATH_LENGTH)
+				return {};
+
+			return SockAddrUnix{ path, length, false };
+		}
+
+		[[nodiscard]] static Maybe<SockAddrUnix> from_abstract(const char* name) noexcept
+		{
+			usize length = path_length(name);
+
+			if (length > MAX_PATH_LENGTH)
+				return {};
+
+			return SockAddrUnix{ name, length, true };
+		}
+
+		[[nodiscard]] static SockAddrUnix unnamed() noexcept
+		{
+			return SockAddrUnix{ "", 0, false };
+		}
+
+		[[nodiscard]] const char* path() const noexcept
+		{
+			return m_path;
+		}
+
+		[[nodiscard]] usize length() const noexcept
+		{
+			return m_length;
+		}
+
+		[[nodiscard]] bool is_abstract() const noexcept
+		{
+			return m_is_abstract;
+		}
+
+		[[nodiscard]] bool is_unnamed() const noexcept
+		{
+			return !m_is_abstract && m_length == 0;
+		}
+
+		[[nodiscard]] bool operator==(const SockAddrUnix& rhs) const noexcept
+		{
+			return m_is_abstract == rhs.m_is_abstract &&
+				m_length == rhs.m_length &&
+				::std::memcmp(m_path, rhs.m_path, m_length) == 0;
+		}
+
+		[[nodiscard]] bool operator!=(const SockAddrUnix& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
 	};
 
 	class SockAddr
 	{
 	private:
 		friend Socket;
+		friend struct ::bsl::Hash<SockAddr>;
 
 		[[nodiscard]] _NativeSockAddr to_native() const noexcept;
 		[[nodiscard]] static Maybe<SockAddr> from_native(const _NativeSockAddr& native) noexcept;
 
-		Variant<SockAddrV4, SockAddrV6> m_addr;
+		Variant<SockAddrV4, SockAddrV6, SockAddrUnix> m_addr;
 
 	public:
 		SockAddr(const SockAddrV4& addr)
@@ -476,6 +878,11 @@ namespace bsl::net
 		{
 		}
 
+		SockAddr(const SockAddrUnix& addr)
+			: m_addr{ InPlaceIndex<2>{}, addr }
+		{
+		}
+
 		[[nodiscard]] bool is_ipv4() const noexcept
 		{
 			return m_addr.index() == 0;
@@ -486,6 +893,11 @@ namespace bsl::net
 			return m_addr.index() == 1;
 		}
 
+		[[nodiscard]] bool is_unix() const noexcept
+		{
+			return m_addr.index() == 2;
+		}
+
 		[[nodiscard]] Maybe<SockAddrV4> to_ipv4() const
 		{
 			if (m_addr.index() != 0)
@@ -501,13 +913,43 @@ namespace bsl::net
 
 			return get<1>(m_addr);
 		}
+
+		[[nodiscard]] Maybe<SockAddrUnix> to_unix() const
+		{
+			if (m_addr.index() != 2)
+				return {};
+
+			return get<2>(m_addr);
+		}
+
+		[[nodiscard]] bool operator==(const SockAddr& rhs) const noexcept
+		{
+			if (m_addr.index() != rhs.m_addr.index())
+				return false;
+
+			switch (m_addr.index())
+			{
+			case 0:
+				return get<0>(m_addr) == get<0>(rhs.m_addr);
+			case 1:
+				return get<1>(m_addr) == get<1>(rhs.m_addr);
+			default:
+				return get<2>(m_addr) == get<2>(rhs.m_addr);
+			}
+		}
+
+		[[nodiscard]] bool operator!=(const SockAddr& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
 	};
 
 	enum class AddrFamily
 	{
 		UNSPECIFIED,
 		IPv4,
-		IPv6
+		IPv6,
+		UNIX
 	};
 
 	enum class SockType
@@ -518,13 +960,42 @@ namespace bsl::net
 
 	enum class Proto
 	{
+		UNSPECIFIED,
 		TCP,
 		UDP
 	};
 
+	struct RecvTimestamp
+	{
+		u64 kernel_ns;
+		u64 user_ns;
+
+		[[nodiscard]] bool has_kernel() const noexcept
+		{
+			return kernel_ns != 0;
+		}
+
+		[[nodiscard]] Maybe<u64> queueing_ns() const noexcept
+		{
+			if (!has_kernel())
+				return {};
+
+			return user_ns > kernel_ns ? user_ns - kernel_ns : 0;
+		}
+	};
+
+	struct IoSlice
+	{
+		const u8* data;
+		usize length;
+	};
+
 	class Socket
 	{
 	private:
+		friend TrafficRecorder;
+		friend TCPServer;
+
 		_NativeSocket* m_sock;
 
 		AddrFamily m_family;
@@ -535,8 +1006,15 @@ namespace bsl::net
 
 		Socket(const _NativeSocket& native, AddrFamily family, SockType type, Proto proto);
 
+		void set_recorder(_TrafficRecorderState* recorder);
+
 	public:
+		static constexpr usize MAX_IO_SLICES = 64;
+
+		[[nodiscard]] static Result<Socket, SocketError> create(AddrFamily family, SockType type, Proto proto);
+
 		Socket(AddrFamily family, SockType type, Proto proto);
+		explicit Socket(MemSocket&& sock);
 		Socket(const Socket&) = delete;
 		Socket(Socket&& other) noexcept;
 
@@ -547,7 +1025,9 @@ namespace bsl::net
 		[[nodiscard]] Proto proto() const noexcept;
 
 		[[nodiscard]] Result<Unit, SocketConnectError> connect(const SockAddr& addr);
+		[[nodiscard]] Result<usize, SocketConnectError> connect_with_data(const SockAddr& addr, const u8* buffer, usize length);
 		[[nodiscard]] Result<Unit, SocketCloseError> close();
+		[[nodiscard]] Result<Unit, SocketError> shutdown();
 
 		[[nodiscard]] Result<Unit, SocketBindError> bind(const SockAddr& addr);
 		
@@ -559,11 +1039,87 @@ namespace bsl::net
 
 		[[nodiscard]] bool is_connected() const noexcept;
 
+		[[nodiscard]] Result<Unit, SocketError> set_nonblocking(bool enable);
+		[[nodiscard]] Result<Unit, SocketError> set_nodelay(bool enable);
+		[[nodiscard]] Result<Unit, SocketError> set_send_timeout(u64 timeout_ms);
+		[[nodiscard]] Result<Unit, SocketError> set_recv_timeout(u64 timeout_ms);
+		[[nodiscard]] Result<Unit, SocketError> set_fast_open(bool enable);
+		[[nodiscard]] Result<Unit, SocketError> set_pacing_rate(const SockAddr& dest, u64 bits_per_second);
+
+		[[nodiscard]] Result<Unit, SocketError> set_busy_poll(u64 spin_budget_ns);
+		[[nodiscard]] u64 busy_poll_budget() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketError> set_rx_timestamps(bool enable);
+
+		[[nodiscard]] IoCounters stats() const noexcept;
+
 		[[nodiscard]] Result<usize, SocketSendError> send(const u8* buffer, usize length);
 		[[nodiscard]] Result<usize, SocketReceiveError> recv(u8* buffer, usize length);
+		[[nodiscard]] Result<bool, SocketError> wait_readable(u64 timeout_ms);
+
+		[[nodiscard]] Result<usize, SocketSendError> send_vectored(const IoSlice* slices, usize count);
 
 		[[nodiscard]] Result<usize, SocketSendError> send_to(const SockAddr& addr, const u8* buffer, usize length);
 		[[nodiscard]] Result<Tuple<usize, SockAddr>, SocketReceiveError> recv_from(u8* buffer, usize length);
+
+		[[nodiscard]] Result<Tuple<usize, RecvTimestamp>, SocketReceiveError> recv_timestamped(u8* buffer, usize length);
+		[[nodiscard]] Result<Tuple<usize, SockAddr, RecvTimestamp>, SocketReceiveError> recv_from_timestamped(u8* buffer, usize length);
+
+		[[nodiscard]] Result<Unit, SocketSendError> send_socket(const Socket& sock);
+		[[nodiscard]] Result<Socket, SocketReceiveError> recv_socket();
+	};
+
+	class ConnGuard
+	{
+	private:
+		friend ConnTracker;
+
+		_ConnTrackerState* m_state;
+
+		ConnGuard(_ConnTrackerState* state) noexcept;
+
+	public:
+		ConnGuard(const ConnGuard&) = delete;
+		ConnGuard(ConnGuard&& other) noexcept;
+
+		~ConnGuard();
+	};
+
+	class ConnTracker
+	{
+	private:
+		friend TCPServer;
+
+		_ConnTrackerState* m_state;
+
+		[[nodiscard]] bool enter_accept() noexcept;
+		void leave_accept() noexcept;
+		void stop_accepts() noexcept;
+		[[nodiscard]] bool accepts_stopped() const noexcept;
+		[[nodiscard]] bool wait_accepts(u64 timeout_ms) const;
+
+	public:
+		ConnTracker();
+		ConnTracker(const ConnTracker&) = delete;
+		ConnTracker(ConnTracker&& other) noexcept;
+
+		~ConnTracker();
+
+		[[nodiscard]] ConnGuard enter() noexcept;
+
+		void begin_drain() noexcept;
+		[[nodiscard]] bool is_draining() const noexcept;
+
+		[[nodiscard]] usize active() const noexcept;
+		[[nodiscard]] u64 total() const noexcept;
+
+		[[nodiscard]] bool wait_idle(u64 timeout_ms) const;
+	};
+
+	struct TrackedConn
+	{
+		Socket sock;
+		ConnGuard guard;
 	};
 
 	class TCPServer
@@ -572,17 +1128,181 @@ namespace bsl::net
 		Socket m_sock;
 
 		u16 m_port;
+		u64 m_defer_accept_ms;
+		_DeferredAcceptState* m_deferred;
+
+		ConnTracker m_conns;
+
+		TCPServer(Socket&& sock, u16 port);
+
+		[[nodiscard]] Result<Socket, SocketAcceptError> accept_when_ready();
+		[[nodiscard]] Result<Socket, SocketAcceptError> accept_deferred();
 
 	public:
+		[[nodiscard]] static Result<TCPServer, SocketError> create(u16 port);
+
 		TCPServer(u16 port);
+		TCPServer(const TCPServer&) = delete;
+		TCPServer(TCPServer&& other) noexcept;
+
+		~TCPServer();
+
+		[[nodiscard]] static Result<TCPServer, SocketReceiveError> inherit(Socket& channel);
 
 		[[nodiscard]] u16 port() const noexcept;
 
 		[[nodiscard]] Result<SockAddr, SocketError> addr() const noexcept;
 
+		[[nodiscard]] IoCounters stats() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketError> set_fast_open(bool enable);
+		void set_defer_accept(u64 timeout_ms);
+
 		[[nodiscard]] Result<Unit, SocketListenError> listen(usize backlog);
 		[[nodiscard]] Result<Socket, SocketAcceptError> accept();
+		[[nodiscard]] Result<TrackedConn, SocketAcceptError> accept_tracked();
+
+		[[nodiscard]] const ConnTracker& connections() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketSendError> hand_off(Socket& channel);
+		[[nodiscard]] bool drain(u64 timeout_ms);
 
 		[[nodiscard]] Result<Unit, SocketCloseError> close();
 	};
 }
+
+namespace bsl
+{
+	template<>
+	struct Hash<net::AddrIPv4>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::AddrIPv4& value) const noexcept
+		{
+			return hash_mix(seed ^ value.to_bits());
+		}
+	};
+
+	template<>
+	struct Hash<net::AddrIPv6>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::AddrIPv6& value) const noexcept
+		{
+			return hash_mix(hash_accumulate(hash_accumulate(seed, value.high_bits()), value.low_bits()));
+		}
+	};
+
+	template<>
+	struct Hash<net::IPAddr>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::IPAddr& value) const noexcept
+		{
+			if (value.m_addr.index() == 0)
+				return Hash<net::AddrIPv4>{ seed }(get<0>(value.m_addr));
+
+			return Hash<net::AddrIPv6>{ seed }(get<1>(value.m_addr));
+		}
+	};
+
+	template<>
+	struct Hash<net::SockAddrV4>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::SockAddrV4& value) const noexcept
+		{
+			return hash_mix(seed ^ ((static_cast<u64>(value.addr().to_bits()) << 16) | value.port()));
+		}
+	};
+
+	template<>
+	struct Hash<net::SockAddrV6>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::SockAddrV6& value) const noexcept
+		{
+			u64 state = hash_accumulate(seed, value.addr().high_bits());
+			state = hash_accumulate(state, value.addr().low_bits());
+
+			return hash_mix(hash_accumulate(state, value.port()));
+		}
+	};
+
+	template<>
+	struct Hash<net::SockAddrUnix>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::SockAddrUnix& value) const noexcept
+		{
+			u64 state = hash_accumulate(seed, (static_cast<u64>(value.length()) << 1) | (value.is_abstract() ? 1 : 0));
+			usize i = 0;
+
+			for (; i + sizeof(u64) <= value.length(); i += sizeof(u64))
+			{
+				u64 word;
+				::std::memcpy(&word, value.path() + i, sizeof(word));
+				state = hash_accumulate(state, word);
+			}
+
+			if (i < value.length())
+			{
+				u64 word = 0;
+				::std::memcpy(&word, value.path() + i, value.length() - i);
+				state = hash_accumulate(state, word);
+			}
+
+			return hash_mix(state);
+		}
+	};
+
+	template<>
+	struct Hash<net::SockAddr>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::SockAddr& value) const noexcept
+		{
+			switch (value.m_addr.index())
+			{
+			case 0:
+				return Hash<net::SockAddrV4>{ seed }(get<0>(value.m_addr));
+			case 1:
+				return Hash<net::SockAddrV6>{ seed }(get<1>(value.m_addr));
+			default:
+				return Hash<net::SockAddrUnix>{ seed }(get<2>(value.m_addr));
+			}
+		}
+	};
+
+	template<>
+	struct Hash<net::CidrIPv4>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::CidrIPv4& value) const noexcept
+		{
+			return hash_mix(seed ^ ((static_cast<u64>(value.addr().to_bits()) << 8) | value.length()));
+		}
+	};
+
+	template<>
+	struct Hash<net::CidrIPv6>
+	{
+		u64 seed = HASH_SEED;
+
+		[[nodiscard]] usize operator()(const net::CidrIPv6& value) const noexcept
+		{
+			u64 state = hash_accumulate(seed, value.addr().high_bits());
+			state = hash_accumulate(state, value.addr().low_bits());
+
+			return hash_mix(hash_accumulate(state, value.length()));
+		}
+	};
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+
+#include "Types.hpp"
+#include "Histogram.hpp"
+
+namespace bsl::net
+{
+	enum class IoOp
+	{
+		CONNECT,
+		ACCEPT,
+		SEND,
+		RECV,
+		SEND_TO,
+		RECV_FROM
+	};
+
+	inline constexpr usize IO_OP_COUNT = 6;
+
+	using IoLatencyHistogram = BasicHistogram<5, 40>;
+
+	struct IoCounters
+	{
+		u64 bytes_sent = 0;
+		u64 bytes_received = 0;
+		u64 syscalls = 0;
+		u64 short_writes = 0;
+		u64 would_block = 0;
+		u64 connects = 0;
+		u64 connect_failures = 0;
+		u64 accepts = 0;
+		u64 accept_failures = 0;
+		u64 send_failures = 0;
+		u64 recv_failures = 0;
+		u64 spin_ns = 0;
+		u64 spin_hits = 0;
+		u64 spin_misses = 0;
+		u64 poll_wait_ns = 0;
+
+		void merge(const IoCounters& other) noexcept
+		{
+			bytes_sent += other.bytes_sent;
+			bytes_received += other.bytes_received;
+			syscalls += other.syscalls;
+			short_writes += other.short_writes;
+			would_block += other.would_block;
+			connects += other.connects;
+			connect_failures += other.connect_failures;
+			accepts += other.accepts;
+			accept_failures += other.accept_failures;
+			send_failures += other.send_failures;
+			recv_failures += other.recv_failures;
+			spin_ns += other.spin_ns;
+			spin_hits += other.spin_hits;
+			spin_misses += other.spin_misses;
+			poll_wait_ns += other.poll_wait_ns;
+		}
+	};
+
+	struct IoCounterCells
+	{
+		::std::atomic<u64> bytes_sent{ 0 };
+		::std::atomic<u64> bytes_received{ 0 };
+		::std::atomic<u64> syscalls{ 0 };
+		::std::atomic<u64> short_writes{ 0 };
+		::std::atomic<u64> would_block{ 0 };
+		::std::atomic<u64> connects{ 0 };
+		::std::atomic<u64> connect_failures{ 0 };
+		::std::atomic<u64> accepts{ 0 };
+		::std::atomic<u64> accept_failures{ 0 };
+		::std::atomic<u64> send_failures{ 0 };
+		::std::atomic<u64> recv_failures{ 0 };
+		::std::atomic<u64> spin_ns{ 0 };
+		::std::atomic<u64> spin_hits{ 0 };
+		::std::atomic<u64> spin_misses{ 0 };
+		::std::atomic<u64> poll_wait_ns{ 0 };
+
+		static void bump(::std::atomic<u64>& counter, u64 value = 1) noexcept
+		{
+			counter.store(counter.load(::std::memory_order_relaxed) + value, ::std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] IoCounters snapshot() const noexcept
+		{
+			IoCounters counters;
+			counters.bytes_sent = bytes_sent.load(::std::memory_order_relaxed);
+			counters.bytes_received = bytes_received.load(::std::memory_order_relaxed);
+			counters.syscalls = syscalls.load(::std::memory_order_relaxed);
+			counters.short_writes = short_writes.load(::std::memory_order_relaxed);
+			counters.would_block = would_block.load(::std::memory_order_relaxed);
+			counters.connects = connects.load(::std::memory_order_relaxed);
+			counters.connect_failures = connect_failures.load(::std::memory_order_relaxed);
+			counters.accepts = accepts.load(::std::memory_order_relaxed);
+			counters.accept_failures = accept_failures.load(::std::memory_order_relaxed);
+			counters.send_failures = send_failures.load(::std::memory_order_relaxed);
+			counters.recv_failures = recv_failures.load(::std::memory_order_relaxed);
+			counters.spin_ns = spin_ns.load(::std::memory_order_relaxed);
+			counters.spin_hits = spin_hits.load(::std::memory_order_relaxed);
+			counters.spin_misses = spin_misses.load(::std::memory_order_relaxed);
+			counters.poll_wait_ns = poll_wait_ns.load(::std::memory_order_relaxed);
+
+			return counters;
+		}
+	};
+
+	struct SocketIoCounters
+	{
+		alignas(64) IoCounterCells tx;
+		alignas(64) IoCounterCells rx;
+
+		[[nodiscard]] IoCounters snapshot() const noexcept
+		{
+			IoCounters counters = tx.snapshot();
+			counters.merge(rx.snapshot());
+
+			return counters;
+		}
+	};
+
+	struct IoMetrics
+	{
+		IoCounters counters;
+		IoLatencyHistogram latency[IO_OP_COUNT];
+
+		[[nodiscard]] const IoLatencyHistogram& latency_of(IoOp op) const noexcept
+		{
+			return latency[static_cast<usize>(op)];
+		}
+	};
+
+	namespace metrics
+	{
+		void set_latency_enabled(bool enabled) noexcept;
+		[[nodiscard]] bool latency_enabled() noexcept;
+
+		void snapshot(IoMetrics& out);
+	}
+}
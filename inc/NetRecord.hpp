@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Net.hpp"
+#include "Histogram.hpp"
+
+namespace bsl::net
+{
+	struct RecordError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "Traffic record error.";
+		}
+	};
+
+	struct ReplayError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "Traffic replay error.";
+		}
+	};
+
+	enum class TrafficDirection : u8
+	{
+		OUTBOUND,
+		INBOUND
+	};
+
+	struct _TrafficRecorderState;
+
+	[[nodiscard]] u32 _traffic_session_open(_TrafficRecorderState* state);
+	void _traffic_session_close(_TrafficRecorderState* state, u32 session);
+	void _traffic_record(_TrafficRecorderState* state, u32 session, TrafficDirection dir, const u8* buffer, usize length);
+
+	class TrafficRecorder
+	{
+	private:
+		_TrafficRecorderState* m_state;
+
+		TrafficRecorder(_TrafficRecorderState* state) noexcept;
+
+	public:
+		[[nodiscard]] static Result<TrafficRecorder, RecordError> create(const char* path);
+
+		TrafficRecorder(const TrafficRecorder&) = delete;
+		TrafficRecorder(TrafficRecorder&& other) noexcept;
+
+		~TrafficRecorder();
+
+		void attach(Socket& sock);
+
+		[[nodiscard]] u64 sessions() const noexcept;
+		[[nodiscard]] u64 bytes_recorded() const noexcept;
+
+		[[nodiscard]] Result<Unit, RecordError> flush();
+	};
+
+	enum class ReplayPerspective
+	{
+		AS_RECORDED,
+		MIRRORED
+	};
+
+	struct ReplayOptions
+	{
+		f64 speed = 1.0;
+		ReplayPerspective perspective = ReplayPerspective::AS_RECORDED;
+		usize max_sessions = 0;
+	};
+
+	struct ReplayReport
+	{
+		u64 sessions = 0;
+		u64 failed_sessions = 0;
+		u64 bytes_sent = 0;
+		u64 bytes_received = 0;
+		u64 exchanges = 0;
+		u64 duration_ns = 0;
+		Histogram exchange_latency;
+	};
+
+	struct _TrafficLogState;
+
+	class TrafficLog
+	{
+	private:
+		_TrafficLogState* m_state;
+
+		TrafficLog(_TrafficLogState* state) noexcept;
+
+	public:
+		[[nodiscard]] static Result<TrafficLog, ReplayError> load(const char* path);
+
+		TrafficLog(const TrafficLog&) = delete;
+		TrafficLog(TrafficLog&& other) noexcept;
+
+		~TrafficLog();
+
+		[[nodiscard]] usize sessions() const noexcept;
+		[[nodiscard]] u64 bytes(TrafficDirection dir) const noexcept;
+		[[nodiscard]] u64 duration_ns() const noexcept;
+
+		[[nodiscard]] Result<Unit, ReplayError> replay(const SockAddr& target, const ReplayOptions& options, ReplayReport& report) const;
+	};
+}
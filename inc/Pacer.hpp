@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	enum class PacingMode
+	{
+		USER_SPACE,
+		KERNEL
+	};
+
+	class PacedSender
+	{
+	private:
+		Socket* m_sock;
+
+		u64 m_bits_per_second;
+		u64 m_burst_ns;
+		u64 m_next_ns;
+
+		PacingMode m_mode;
+		Maybe<SockAddr> m_kernel_dest;
+
+		[[nodiscard]] u64 wire_time_ns(usize length) const noexcept;
+		[[nodiscard]] bool is_kernel_dest(const SockAddr& addr) const noexcept;
+
+		void apply_rate(u64 bits_per_second, usize burst_bytes) noexcept;
+
+		void wait_until(u64 deadline_ns) const noexcept;
+		[[nodiscard]] u64 reserve() noexcept;
+
+	public:
+		PacedSender(Socket& sock, u64 bits_per_second, usize burst_bytes = 0) noexcept;
+		PacedSender(const PacedSender&) = delete;
+		PacedSender(PacedSender&& other) noexcept;
+
+		PacedSender& operator=(const PacedSender&) = delete;
+		PacedSender& operator=(PacedSender&&) = delete;
+
+		[[nodiscard]] static u64 now() noexcept;
+
+		[[nodiscard]] Result<Unit, SocketError> enable_kernel_pacing(const SockAddr& dest);
+		[[nodiscard]] Result<Unit, SocketError> disable_kernel_pacing();
+
+		[[nodiscard]] PacingMode mode() const noexcept;
+		[[nodiscard]] const Maybe<SockAddr>& kernel_destination() const noexcept;
+		[[nodiscard]] u64 rate() const noexcept;
+		[[nodiscard]] u64 next_departure() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketError> set_rate(u64 bits_per_second, usize burst_bytes = 0);
+
+		[[nodiscard]] Result<usize, SocketSendError> send(const u8* buffer, usize length);
+		[[nodiscard]] Result<usize, SocketSendError> send_to(const SockAddr& addr, const u8* buffer, usize length);
+		[[nodiscard]] Result<usize, SocketSendError> send_to_at(const SockAddr& addr, const u8* buffer, usize length, u64 departure_ns);
+	};
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	enum class SlowSubscriberPolicy
+	{
+		DROP_OLDEST,
+		DROP_NEWEST,
+		DISCONNECT
+	};
+
+	struct BrokerConfig
+	{
+		usize writers = 4;
+		usize max_queue = 1024;
+		usize max_queued_bytes = 4 << 20;
+		usize max_message = 1 << 20;
+		SlowSubscriberPolicy policy = SlowSubscriberPolicy::DROP_OLDEST;
+		u64 send_timeout_ms = 1000;
+	};
+
+	struct BrokerStats
+	{
+		u64 published;
+		u64 delivered;
+		u64 dropped;
+		u64 disconnected;
+		u64 bytes_published;
+		u64 bytes_written;
+		u64 batches_written;
+	};
+
+	struct _PubSubBuffer;
+	struct _BrokerState;
+
+	class PubSubMessage
+	{
+	private:
+		friend class Broker;
+		friend class PubSubClient;
+
+		_PubSubBuffer* m_buffer;
+
+		explicit PubSubMessage(_PubSubBuffer* buffer) noexcept;
+
+	public:
+		static constexpr usize MAX_TOPIC_LENGTH = 255;
+
+		[[nodiscard]] static Maybe<PubSubMessage> create(const char* topic, usize topic_length, const u8* payload, usize length);
+
+		PubSubMessage(const PubSubMessage& other) noexcept;
+		PubSubMessage(PubSubMessage&& other) noexcept;
+
+		~PubSubMessage();
+
+		PubSubMessage& operator=(const PubSubMessage& other) noexcept;
+		PubSubMessage& operator=(PubSubMessage&& other) noexcept;
+
+		[[nodiscard]] const char* topic() const noexcept;
+		[[nodiscard]] usize topic_length() const noexcept;
+
+		[[nodiscard]] const u8* payload() const noexcept;
+		[[nodiscard]] usize payload_size() const noexcept;
+
+		[[nodiscard]] const u8* wire_data() const noexcept;
+		[[nodiscard]] usize wire_size() const noexcept;
+
+		[[nodiscard]] u32 use_count() const noexcept;
+	};
+
+	class Broker
+	{
+	private:
+		_BrokerState* m_state;
+
+	public:
+		explicit Broker(const BrokerConfig& config = BrokerConfig{});
+		Broker(const Broker&) = delete;
+		Broker(Broker&& other) noexcept;
+
+		~Broker();
+
+		usize publish(const PubSubMessage& message);
+		usize publish(const char* topic, usize topic_length, const u8* payload, usize length);
+
+		void serve(Socket&& sock);
+
+		[[nodiscard]] Result<Unit, SocketAcceptError> run(TCPServer& server);
+
+		[[nodiscard]] usize connections() const noexcept;
+		[[nodiscard]] usize subscribers(const char* topic, usize topic_length) const noexcept;
+
+		[[nodiscard]] BrokerStats stats() const noexcept;
+
+		void shutdown();
+	};
+
+	struct _PubSubClientState;
+
+	class PubSubClient
+	{
+	private:
+		_PubSubClientState* m_state;
+
+		[[nodiscard]] Result<Unit, SocketSendError> send_command(u8 op, const char* topic, usize topic_length, const u8* payload, usize length);
+
+	public:
+		explicit PubSubClient(Socket&& sock, usize max_message = BrokerConfig{}.max_message);
+		PubSubClient(const PubSubClient&) = delete;
+		PubSubClient(PubSubClient&& other) noexcept;
+
+		~PubSubClient();
+
+		[[nodiscard]] Result<Unit, SocketSendError> subscribe(const char* topic, usize topic_length);
+		[[nodiscard]] Result<Unit, SocketSendError> unsubscribe(const char* topic, usize topic_length);
+
+		[[nodiscard]] Result<Unit, SocketSendError> publish(const char* topic, usize topic_length, const u8* payload, usize length);
+
+		[[nodiscard]] Result<PubSubMessage, SocketReceiveError> recv();
+	};
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct RespError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "RESP protocol error.";
+		}
+	};
+
+	enum class RespType : u8
+	{
+		SIMPLE_STRING,
+		ERROR,
+		INTEGER,
+		BULK_STRING,
+		ARRAY,
+		NULL_VALUE,
+		BOOLEAN,
+		DOUBLE,
+		BIG_NUMBER,
+		BULK_ERROR,
+		VERBATIM_STRING,
+		MAP,
+		SET,
+		PUSH
+	};
+
+	struct RespNode
+	{
+		RespType type;
+		u32 end;
+		u32 count;
+		usize offset;
+		usize length;
+		i64 integer;
+	};
+
+	class RespView
+	{
+	private:
+		const RespNode* m_nodes;
+		const u8* m_base;
+		u32 m_index;
+
+	public:
+		constexpr RespView(const RespNode* nodes, const u8* base, u32 index = 0) noexcept
+			: m_nodes{ nodes }, m_base{ base }, m_index{ index }
+		{
+		}
+
+		[[nodiscard]] RespType type() const noexcept
+		{
+			return m_nodes[m_index].type;
+		}
+
+		[[nodiscard]] bool is_null() const noexcept
+		{
+			return type() == RespType::NULL_VALUE;
+		}
+
+		[[nodiscard]] bool is_error() const noexcept
+		{
+			return type() == RespType::ERROR || type() == RespType::BULK_ERROR;
+		}
+
+		[[nodiscard]] bool is_aggregate() const noexcept
+		{
+			RespType kind = type();
+
+			return kind == RespType::ARRAY || kind == RespType::MAP || kind == RespType::SET || kind == RespType::PUSH;
+		}
+
+		[[nodiscard]] const char* data() const noexcept
+		{
+			return reinterpret_cast<const char*>(m_base + m_nodes[m_index].offset);
+		}
+
+		[[nodiscard]] usize length() const noexcept
+		{
+			return m_nodes[m_index].length;
+		}
+
+		[[nodiscard]] bool equals(const char* text, usize length) const noexcept
+		{
+			return this->length() == length && (length == 0 || ::std::memcmp(data(), text, length) == 0);
+		}
+
+		[[nodiscard]] i64 integer() const noexcept
+		{
+			return m_nodes[m_index].integer;
+		}
+
+		[[nodiscard]] usize size() const noexcept
+		{
+			return m_nodes[m_index].count;
+		}
+
+		[[nodiscard]] RespView first_child() const noexcept
+		{
+			return RespView{ m_nodes, m_base, m_index + 1 };
+		}
+
+		[[nodiscard]] RespView next_sibling() const noexcept
+		{
+			return RespView{ m_nodes, m_base, m_nodes[m_index].end };
+		}
+
+		[[nodiscard]] RespView at(usize index) const
+		{
+			if (!is_aggregate() || index >= size())
+				throw OutOfRange{};
+
+			u32 child = m_index + 1;
+
+			for (usize i = 0; i < index; ++i)
+				child = m_nodes[child].end;
+
+			return RespView{ m_nodes, m_base, child };
+		}
+
+		[[nodiscard]] RespView operator[](usize index) const
+		{
+			return at(index);
+		}
+	};
+
+	struct RespArg
+	{
+		const char* data;
+		usize length;
+
+		RespArg(const char* text) noexcept
+			: data{ text }, length{ ::std::strlen(text) }
+		{
+		}
+
+		constexpr RespArg(const char* text, usize length) noexcept
+			: data{ text }, length{ length }
+		{
+		}
+	};
+
+	struct _RespEncoderState;
+
+	class RespEncoder
+	{
+	private:
+		_RespEncoderState* m_state;
+
+	public:
+		RespEncoder();
+		RespEncoder(const RespEncoder&) = delete;
+		RespEncoder(RespEncoder&& other) noexcept;
+
+		~RespEncoder();
+
+		[[nodiscard]] const u8* data() const noexcept;
+		[[nodiscard]] usize size() const noexcept;
+
+		void clear() noexcept;
+
+		void simple_string(const char* text, usize length);
+		void error(const char* text, usize length);
+		void integer(i64 value);
+		void bulk_string(const u8* data, usize length);
+		void null(bool resp3 = false);
+		void boolean(bool value);
+		void double_value(f64 value);
+		void array(usize count);
+		void map(usize count);
+		void set(usize count);
+		void push(usize count);
+
+		void command(const RespArg* args, usize count);
+	};
+
+	struct _RespParserState;
+
+	class RespParser
+	{
+	private:
+		_RespParserState* m_state;
+
+	public:
+		static constexpr usize MAX_DEPTH = 64;
+
+		RespParser();
+		RespParser(const RespParser&) = delete;
+		RespParser(RespParser&& other) noexcept;
+
+		~RespParser();
+
+		[[nodiscard]] Result<usize, RespError> parse(const u8* in, usize length);
+
+		[[nodiscard]] RespView root(const u8* base) const noexcept;
+		[[nodiscard]] usize node_count() const noexcept;
+
+		void reset() noexcept;
+	};
+
+	struct RespClientConfig
+	{
+		usize max_reply = 512 << 20;
+	};
+
+	struct _RespClientState;
+
+	class RespClient
+	{
+	private:
+		Socket* m_sock;
+
+		_RespClientState* m_state;
+
+	public:
+		explicit RespClient(Socket& sock, const RespClientConfig& config = RespClientConfig{});
+		RespClient(const RespClient&) = delete;
+		RespClient(RespClient&& other) noexcept;
+
+		~RespClient();
+
+		template<class... Args>
+		void command(const Args&... args)
+		{
+			const RespArg list[] = { RespArg{ args }... };
+
+			command_list(list, sizeof...(Args));
+		}
+
+		void command_list(const RespArg* args, usize count);
+
+		[[nodiscard]] usize queued() const noexcept;
+		[[nodiscard]] usize pending() const noexcept;
+
+		[[nodiscard]] Result<Unit, RespError> flush();
+		[[nodiscard]] Result<RespView, RespError> next_reply();
+
+		template<class... Args>
+		[[nodiscard]] Result<RespView, RespError> call(const Args&... args)
+		{
+			command(args...);
+
+			return next_reply();
+		}
+	};
+
+	struct RespServerConfig
+	{
+		usize max_request = 64 << 20;
+		usize max_output = 16 << 20;
+	};
+
+	struct RespServerStats
+	{
+		u64 commands;
+		u64 batches;
+		u64 bytes_received;
+		u64 bytes_sent;
+	};
+
+	struct _RespServerState;
+
+	class RespServer
+	{
+	private:
+		_RespServerState* m_state;
+
+	public:
+		explicit RespServer(const RespServerConfig& config = RespServerConfig{});
+		RespServer(const RespServer&) = delete;
+		RespServer(RespServer&& other) noexcept;
+
+		~RespServer();
+
+		void serve(Socket&& sock);
+
+		[[nodiscard]] Result<Unit, SocketAcceptError> run(TCPServer& server);
+
+		[[nodiscard]] usize connections() const noexcept;
+		[[nodiscard]] usize keys() const noexcept;
+
+		[[nodiscard]] RespServerStats stats() const noexcept;
+
+		void shutdown();
+	};
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "Net.hpp"
+#include "Wire.hpp"
+
+namespace bsl::net
+{
+	enum class RpcStatus : u8
+	{
+		OK,
+		APPLICATION_ERROR,
+		UNKNOWN_METHOD,
+		BAD_REQUEST,
+		BAD_REPLY,
+		HANDLER_FAILED,
+		CONNECTION_LOST
+	};
+
+	template<u32 Id, class Args, class R, class E>
+	struct RpcMethod
+	{
+		static constexpr u32 ID = Id;
+
+		using ArgsType = Args;
+		using OkType = R;
+		using ErrorType = E;
+	};
+
+	template<class E>
+	class RpcError
+	{
+	private:
+		E m_error;
+		RpcStatus m_status;
+		NetErrorKind m_kind;
+
+	public:
+		constexpr RpcError(E&& error) noexcept(is_nothrow_move_constructible_v<E>)
+			: m_error{ move(error) }, m_status{ RpcStatus::APPLICATION_ERROR }, m_kind{ NetErrorKind::UNKNOWN }
+		{
+		}
+
+		constexpr RpcError(RpcStatus status, NetErrorKind kind = NetErrorKind::UNKNOWN) noexcept(is_nothrow_default_constructible_v<E>)
+			: m_error{}, m_status{ status }, m_kind{ kind }
+		{
+		}
+
+		[[nodiscard]] constexpr RpcStatus status() const noexcept
+		{
+			return m_status;
+		}
+
+		[[nodiscard]] constexpr NetErrorKind kind() const noexcept
+		{
+			return m_kind;
+		}
+
+		[[nodiscard]] constexpr bool is_application_error() const noexcept
+		{
+			return m_status == RpcStatus::APPLICATION_ERROR;
+		}
+
+		[[nodiscard]] constexpr const E& application_error() const
+		{
+			if (!is_application_error())
+				throw BadAccess{};
+
+			return m_error;
+		}
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			switch (m_status)
+			{
+			case RpcStatus::APPLICATION_ERROR: return "Method returned an error.";
+			case RpcStatus::UNKNOWN_METHOD: return "Unknown method.";
+			case RpcStatus::BAD_REQUEST: return "Malformed request.";
+			case RpcStatus::BAD_REPLY: return "Malformed reply.";
+			case RpcStatus::HANDLER_FAILED: return "Handler failed.";
+			case RpcStatus::CONNECTION_LOST: return "Connection lost.";
+			default: return "Unknown RPC error.";
+			}
+		}
+	};
+
+	struct RpcStats
+	{
+		u64 calls;
+		u64 replies;
+		u64 frames_written;
+		u64 batches_written;
+	};
+
+	struct RpcClientConfig
+	{
+		usize max_reply = 16 << 20;
+	};
+
+	struct RpcServerConfig
+	{
+		usize workers = 4;
+		usize max_request = 16 << 20;
+		usize max_in_flight = 256;
+	};
+
+	struct _RpcClientState;
+	struct _RpcCallState;
+	struct _RpcServerState;
+
+	class RpcPendingCall
+	{
+	private:
+		friend class RpcClient;
+
+		_RpcCallState* m_call;
+
+		explicit RpcPendingCall(_RpcCallState* call) noexcept;
+
+	public:
+		RpcPendingCall(const RpcPendingCall&) = delete;
+		RpcPendingCall(RpcPendingCall&& other) noexcept;
+
+		~RpcPendingCall();
+
+		[[nodiscard]] bool is_ready() const noexcept;
+
+		RpcStatus wait();
+
+		[[nodiscard]] NetErrorKind kind() const noexcept;
+
+		[[nodiscard]] const u8* payload() const noexcept;
+		[[nodiscard]] usize payload_size() const noexcept;
+	};
+
+	template<class M>
+	class RpcCall
+	{
+	private:
+		RpcPendingCall m_call;
+
+	public:
+		using OkType = typename M::OkType;
+		using ErrorType = typename M::ErrorType;
+
+		explicit RpcCall(RpcPendingCall&& call) noexcept
+			: m_call{ move(call) }
+		{
+		}
+
+		[[nodiscard]] bool is_ready() const noexcept
+		{
+			return m_call.is_ready();
+		}
+
+		[[nodiscard]] Result<OkType, RpcError<ErrorType>> wait()
+		{
+			RpcStatus status = m_call.wait();
+
+			if (status == RpcStatus::OK)
+			{
+				if (m_call.payload_size() != wire_size_v<OkType> || !Wire<OkType>::validate(m_call.payload()))
+					return RpcError<ErrorType>{ RpcStatus::BAD_REPLY };
+
+				return wire_decode<OkType>(m_call.payload());
+			}
+
+			if (status == RpcStatus::APPLICATION_ERROR)
+			{
+				if (m_call.payload_size() != wire_size_v<ErrorType> || !Wire<ErrorType>::validate(m_call.payload()))
+					return RpcError<ErrorType>{ RpcStatus::BAD_REPLY };
+
+				return RpcError<ErrorType>{ wire_decode<ErrorType>(m_call.payload()) };
+			}
+
+			return RpcError<ErrorType>{ status, m_call.kind() };
+		}
+	};
+
+	class RpcClient
+	{
+	private:
+		_RpcClientState* m_state;
+
+		[[nodiscard]] RpcPendingCall start(u32 method, const u8* args, usize length);
+
+	public:
+		static constexpr usize INLINE_ARGS = 256;
+
+		explicit RpcClient(Socket&& sock, const RpcClientConfig& config = RpcClientConfig{});
+		RpcClient(const RpcClient&) = delete;
+		RpcClient(RpcClient&& other) noexcept;
+
+		~RpcClient();
+
+		template<class M>
+		[[nodiscard]] RpcCall<M> call(const typename M::ArgsType& args)
+		{
+			constexpr usize size = wire_size_v<typename M::ArgsType>;
+
+			if constexpr (size <= INLINE_ARGS)
+			{
+				u8 buffer[INLINE_ARGS];
+				wire_encode(args, buffer);
+
+				return RpcCall<M>{ start(M::ID, buffer, size) };
+			}
+			else
+			{
+				u8* buffer = new u8[size];
+				wire_encode(args, buffer);
+
+				RpcCall<M> pending{ start(M::ID, buffer, size) };
+				delete[] buffer;
+
+				return pending;
+			}
+		}
+
+		template<class M>
+		[[nodiscard]] Result<typename M::OkType, RpcError<typename M::ErrorType>> invoke(const typename M::ArgsType& args)
+		{
+			return call<M>(args).wait();
+		}
+
+		[[nodiscard]] bool is_connected() const noexcept;
+
+		[[nodiscard]] usize in_flight() const noexcept;
+
+		[[nodiscard]] RpcStats stats() const noexcept;
+
+		void close();
+	};
+
+	using _RpcInvokeFn = RpcStatus(*)(void* handler, const u8* args, usize length, u8* reply, usize& reply_length);
+	using _RpcDestroyFn = void(*)(void* handler);
+
+	template<class M, class F>
+	RpcStatus _rpc_invoke(void* handler, const u8* args, usize length, u8* reply, usize& reply_length)
+	{
+		using ArgsType = typename M::ArgsType;
+		using OkType = typename M::OkType;
+		using ErrorType = typename M::ErrorType;
+
+		if (length != wire_size_v<ArgsType> || !Wire<ArgsType>::validate(args))
+			return RpcStatus::BAD_REQUEST;
+
+		Result<OkType, ErrorType> result = (*static_cast<F*>(handler))(wire_decode<ArgsType>(args));
+
+		if (result.is_ok())
+		{
+			wire_encode(result.expect(), reply);
+			reply_length = wire_size_v<OkType>;
+
+			return RpcStatus::OK;
+		}
+
+		wire_encode(result.expect_error(), reply);
+		reply_length = wire_size_v<ErrorType>;
+
+		return RpcStatus::APPLICATION_ERROR;
+	}
+
+	template<class F>
+	void _rpc_destroy(void* handler)
+	{
+		delete static_cast<F*>(handler);
+	}
+
+	class RpcServer
+	{
+	private:
+		_RpcServerState* m_state;
+
+		void add_handler(u32 method, usize reply_capacity, void* handler, _RpcInvokeFn invoke, _RpcDestroyFn destroy);
+
+	public:
+		explicit RpcServer(const RpcServerConfig& config = RpcServerConfig{});
+		RpcServer(const RpcServer&) = delete;
+		RpcServer(RpcServer&& other) noexcept;
+
+		~RpcServer();
+
+		template<class M, class F>
+		void handle(F&& handler)
+		{
+			using Handler = remove_const_volatile_t<remove_reference_t<F>>;
+
+			constexpr usize ok_size = wire_size_v<typename M::OkType>;
+			constexpr usize error_size = wire_size_v<typename M::ErrorType>;
+
+			add_handler(
+				M::ID,
+				ok_size > error_size ? ok_size : error_size,
+				new Handler{ forward<F>(handler) },
+				&_rpc_invoke<M, Handler>,
+				&_rpc_destroy<Handler>);
+		}
+
+		void serve(Socket&& sock);
+
+		[[nodiscard]] Result<Unit, SocketAcceptError> run(TCPServer& server);
+
+		[[nodiscard]] usize connections() const noexcept;
+
+		[[nodiscard]] RpcStats stats() const noexcept;
+
+		void shutdown();
+	};
+}
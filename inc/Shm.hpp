@@ -0,0 +1,169 @@
+#pragma once
+
+#include "Net.hpp"
+#include "SpscRing.hpp"
+
+namespace bsl::net
+{
+	struct ShmError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "Shared memory error.";
+		}
+	};
+
+	enum class ShmWaitMode
+	{
+		BUSY_POLL,
+		BLOCKING
+	};
+
+	class ShmAddr
+	{
+	private:
+		char m_name[64];
+		usize m_length;
+
+		ShmAddr(const char* name, usize length) noexcept
+			: m_name{}, m_length{ length }
+		{
+			for (usize i = 0; i < length; ++i)
+				m_name[i] = name[i];
+		}
+
+	public:
+		static constexpr usize MAX_NAME_LENGTH = 63;
+
+		[[nodiscard]] static Maybe<ShmAddr> from_name(const char* name) noexcept
+		{
+			usize length = 0;
+
+			while (length <= MAX_NAME_LENGTH && name[length] != '\0')
+			{
+				if (name[length] == '\\')
+					return {};
+
+				++length;
+			}
+
+			if (length == 0 || length > MAX_NAME_LENGTH)
+				return {};
+
+			return ShmAddr{ name, length };
+		}
+
+		[[nodiscard]] const char* name() const noexcept
+		{
+			return m_name;
+		}
+
+		[[nodiscard]] usize length() const noexcept
+		{
+			return m_length;
+		}
+	};
+
+	struct _NativeShm;
+
+	class ShmSocket
+	{
+	private:
+		_NativeShm* m_shm;
+
+		SpscByteRing m_tx;
+		SpscByteRing m_rx;
+
+		ShmWaitMode m_mode;
+
+		ShmSocket(_NativeShm* native, bool is_creator, ShmWaitMode mode) noexcept;
+
+		void wait_readable();
+		void wait_writable();
+
+	public:
+		static constexpr usize DEFAULT_CAPACITY = 1 << 20;
+
+		[[nodiscard]] static Result<ShmSocket, ShmError> create(const ShmAddr& addr, usize capacity = DEFAULT_CAPACITY, ShmWaitMode mode = ShmWaitMode::BLOCKING);
+		[[nodiscard]] static Result<ShmSocket, ShmError> connect(const ShmAddr& addr, ShmWaitMode mode = ShmWaitMode::BLOCKING);
+
+		ShmSocket(const ShmSocket&) = delete;
+		ShmSocket(ShmSocket&& other) noexcept;
+
+		~ShmSocket();
+
+		[[nodiscard]] ShmWaitMode wait_mode() const noexcept;
+		void set_wait_mode(ShmWaitMode mode) noexcept;
+
+		[[nodiscard]] usize capacity() const noexcept;
+
+		[[nodiscard]] bool is_connected() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketCloseError> close();
+
+		[[nodiscard]] Result<usize, SocketSendError> send(const u8* buffer, usize length);
+		[[nodiscard]] Result<usize, SocketReceiveError> recv(u8* buffer, usize length);
+	};
+
+	class StreamAddr
+	{
+	private:
+		Variant<SockAddr, ShmAddr> m_addr;
+
+	public:
+		StreamAddr(const SockAddr& addr)
+			: m_addr{ InPlaceIndex<0>{}, addr }
+		{
+		}
+
+		StreamAddr(const ShmAddr& addr)
+			: m_addr{ InPlaceIndex<1>{}, addr }
+		{
+		}
+
+		[[nodiscard]] bool is_shm() const noexcept
+		{
+			return m_addr.index() == 1;
+		}
+
+		[[nodiscard]] Maybe<SockAddr> to_sock_addr() const
+		{
+			if (m_addr.index() != 0)
+				return {};
+
+			return get<0>(m_addr);
+		}
+
+		[[nodiscard]] Maybe<ShmAddr> to_shm() const
+		{
+			if (m_addr.index() != 1)
+				return {};
+
+			return get<1>(m_addr);
+		}
+	};
+
+	class StreamSocket
+	{
+	private:
+		Variant<Socket, ShmSocket> m_conn;
+
+	public:
+		explicit StreamSocket(Socket&& sock);
+		explicit StreamSocket(ShmSocket&& shm);
+		StreamSocket(const StreamSocket&) = delete;
+		StreamSocket(StreamSocket&& other);
+
+		[[nodiscard]] static Result<StreamSocket, SocketConnectError> connect(const StreamAddr& addr, ShmWaitMode mode = ShmWaitMode::BLOCKING);
+
+		[[nodiscard]] bool is_shm() const noexcept;
+		[[nodiscard]] bool is_connected() const noexcept;
+
+		[[nodiscard]] Result<Unit, SocketCloseError> close();
+
+		[[nodiscard]] Result<usize, SocketSendError> send(const u8* buffer, usize length);
+		[[nodiscard]] Result<usize, SocketReceiveError> recv(u8* buffer, usize length);
+	};
+}
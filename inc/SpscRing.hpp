@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+
+#include "Types.hpp"
+
+namespace bsl
+{
+	inline constexpr usize CACHE_LINE_SIZE = 64;
+
+	struct SpscRingControl
+	{
+		alignas(CACHE_LINE_SIZE) ::std::atomic<u64> head;
+		alignas(CACHE_LINE_SIZE) ::std::atomic<u64> tail;
+		alignas(CACHE_LINE_SIZE) ::std::atomic<u32> reader_waiting;
+		::std::atomic<u32> writer_waiting;
+		::std::atomic<u32> writer_closed;
+		::std::atomic<u32> reader_closed;
+
+		SpscRingControl() noexcept
+			: head{ 0 }, tail{ 0 }, reader_waiting{ 0 }, writer_waiting{ 0 }, writer_closed{ 0 }, reader_closed{ 0 }
+		{
+		}
+	};
+
+	class SpscByteRing
+	{
+	private:
+		SpscRingControl* m_ctrl;
+		u8* m_data;
+		u64 m_mask;
+
+		u64 m_cached_head;
+		u64 m_cached_tail;
+
+	public:
+		SpscByteRing() noexcept
+			: m_ctrl{ nullptr }, m_data{ nullptr }, m_mask{ 0 }, m_cached_head{ 0 }, m_cached_tail{ 0 }
+		{
+		}
+
+		SpscByteRing(SpscRingControl* ctrl, u8* data, usize capacity) noexcept
+			: m_ctrl{ ctrl }, m_data{ data }, m_mask{ static_cast<u64>(capacity) - 1 },
+			m_cached_head{ ctrl->head.load(::std::memory_order_acquire) },
+			m_cached_tail{ ctrl->tail.load(::std::memory_order_acquire) }
+		{
+		}
+
+		[[nodiscard]] static constexpr bool is_valid_capacity(usize capacity) noexcept
+		{
+			return capacity != 0 && (capacity & (capacity - 1)) == 0;
+		}
+
+		[[nodiscard]] usize capacity() const noexcept
+		{
+			return static_cast<usize>(m_mask + 1);
+		}
+
+		[[nodiscard]] SpscRingControl& control() const noexcept
+		{
+			return *m_ctrl;
+		}
+
+		[[nodiscard]] usize readable() noexcept
+		{
+			u64 tail = m_ctrl->tail.load(::std::memory_order_relaxed);
+
+			if (m_cached_head == tail)
+				m_cached_head = m_ctrl->head.load(::std::memory_order_acquire);
+
+			return static_cast<usize>(m_cached_head - tail);
+		}
+
+		[[nodiscard]] usize writable() noexcept
+		{
+			u64 head = m_ctrl->head.load(::std::memory_order_relaxed);
+
+			if (head - m_cached_tail > m_mask)
+				m_cached_tail = m_ctrl->tail.load(::std::memory_order_acquire);
+
+			return static_cast<usize>(m_mask + 1 - (head - m_cached_tail));
+		}
+
+		[[nodiscard]] usize write(const u8* buffer, usize length) noexcept
+		{
+			u64 head = m_ctrl->head.load(::std::memory_order_relaxed);
+			u64 free = m_mask + 1 - (head - m_cached_tail);
+
+			if (free < length)
+			{
+				m_cached_tail = m_ctrl->tail.load(::std::memory_order_acquire);
+				free = m_mask + 1 - (head - m_cached_tail);
+			}
+
+			usize count = length < free ? length : static_cast<usize>(free);
+
+			if (count == 0)
+				return 0;
+
+			usize offset = static_cast<usize>(head & m_mask);
+			usize first = capacity() - offset;
+
+			if (first >= count)
+			{
+				::std::memcpy(m_data + offset, buffer, count);
+			}
+			else
+			{
+				::std::memcpy(m_data + offset, buffer, first);
+				::std::memcpy(m_data, buffer + first, count - first);
+			}
+
+			m_ctrl->head.store(head + count, ::std::memory_order_release);
+
+			return count;
+		}
+
+		[[nodiscard]] usize read(u8* buffer, usize length) noexcept
+		{
+			u64 tail = m_ctrl->tail.load(::std::memory_order_relaxed);
+			u64 available = m_cached_head - tail;
+
+			if (available < length)
+			{
+				m_cached_head = m_ctrl->head.load(::std::memory_order_acquire);
+				available = m_cached_head - tail;
+			}
+
+			usize count = length < available ? length : static_cast<usize>(available);
+
+			if (count == 0)
+				return 0;
+
+			usize offset = static_cast<usize>(tail & m_mask);
+			usize first = capacity() - offset;
+
+			if (first >= count)
+			{
+				::std::memcpy(buffer, m_data + offset, count);
+			}
+			else
+			{
+				::std::memcpy(buffer, m_data + offset, first);
+				::std::memcpy(buffer + first, m_data, count - first);
+			}
+
+			m_ctrl->tail.store(tail + count, ::std::memory_order_release);
+
+			return count;
+		}
+	};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	inline void _store_u32(u8* ptr, u32 value) noexcept
+	{
+		ptr[0] = static_cast<u8>(value);
+		ptr[1] = static_cast<u8>(value >> 8);
+		ptr[2] = static_cast<u8>(value >> 16);
+		ptr[3] = static_cast<u8>(value >> 24);
+	}
+
+	[[nodiscard]] inline u32 _load_u32(const u8* ptr) noexcept
+	{
+		return static_cast<u32>(ptr[0]) | (static_cast<u32>(ptr[1]) << 8) | (static_cast<u32>(ptr[2]) << 16) | (static_cast<u32>(ptr[3]) << 24);
+	}
+
+	[[nodiscard]] inline Result<Unit, SocketSendError> _write_slices(Socket& sock, IoSlice* slices, usize count)
+	{
+		while (count != 0)
+		{
+			Result<usize, SocketSendError> result = sock.send_vectored(slices, count);
+
+			if (result.is_error())
+				return result.expect_error();
+
+			usize sent = result.expect();
+
+			if (sent == 0)
+				return SocketSendError{ NetErrorKind::CLOSED };
+
+			while (count != 0 && sent >= slices->length)
+			{
+				sent -= slices->length;
+				++slices;
+				--count;
+			}
+
+			if (count != 0)
+			{
+				slices->data += sent;
+				slices->length -= sent;
+			}
+		}
+
+		return Unit{};
+	}
+}
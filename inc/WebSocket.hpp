@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Net.hpp"
+
+namespace bsl::net
+{
+	struct WebSocketError : NetError
+	{
+		using NetError::NetError;
+
+		[[nodiscard]] const char* msg() const noexcept
+		{
+			return "WebSocket error.";
+		}
+	};
+
+	enum class WsOpcode : u8
+	{
+		CONTINUATION = 0x0,
+		TEXT = 0x1,
+		BINARY = 0x2,
+		CLOSE = 0x8,
+		PING = 0x9,
+		PONG = 0xA
+	};
+
+	enum class WsRole
+	{
+		CLIENT,
+		SERVER
+	};
+
+	enum class WsCloseCode : u16
+	{
+		NORMAL = 1000,
+		GOING_AWAY = 1001,
+		PROTOCOL_ERROR = 1002,
+		UNSUPPORTED_DATA = 1003,
+		INVALID_PAYLOAD = 1007,
+		POLICY_VIOLATION = 1008,
+		MESSAGE_TOO_BIG = 1009,
+		INTERNAL_ERROR = 1011
+	};
+
+	struct WsFrameHeader
+	{
+		bool fin;
+		u8 rsv;
+		WsOpcode opcode;
+		bool masked;
+		u32 mask_key;
+		u64 payload_length;
+
+		static constexpr usize MIN_SIZE = 2;
+		static constexpr usize MAX_SIZE = 14;
+		static constexpr usize MAX_CONTROL_PAYLOAD = 125;
+
+		[[nodiscard]] constexpr bool is_control() const noexcept
+		{
+			return (static_cast<u8>(opcode) & 0x8) != 0;
+		}
+
+		[[nodiscard]] constexpr usize size() const noexcept
+		{
+			usize length_size = payload_length < 126 ? 0 : payload_length <= 0xFFFF ? 2 : 8;
+
+			return MIN_SIZE + length_size + (masked ? 4 : 0);
+		}
+	};
+
+	void ws_mask(u8* data, usize length, u32 mask_key, usize offset = 0) noexcept;
+	void ws_mask_copy(const u8* source, u8* dest, usize length, u32 mask_key, usize offset = 0) noexcept;
+
+	usize ws_encode_header(const WsFrameHeader& header, u8* out) noexcept;
+	[[nodiscard]] Result<usize, WebSocketError> ws_decode_header(const u8* in, usize length, WsFrameHeader& header) noexcept;
+
+	struct WsMessage
+	{
+		WsOpcode opcode;
+		const u8* data;
+		usize length;
+
+		[[nodiscard]] bool is_control() const noexcept
+		{
+			return (static_cast<u8>(opcode) & 0x8) != 0;
+		}
+	};
+
+	struct WebSocketConfig
+	{
+		usize max_message = 16 << 20;
+		bool auto_pong = true;
+	};
+
+	struct _WebSocketState;
+
+	class WebSocket
+	{
+	private:
+		Socket* m_sock;
+
+		_WebSocketState* m_state;
+
+		[[nodiscard]] Result<Unit, WebSocketError> fill(usize length);
+		[[nodiscard]] Result<Unit, WebSocketError> send_frame(WsOpcode opcode, const u8* payload, usize length, bool fin);
+		[[nodiscard]] WebSocketError fail(WsCloseCode code, NetErrorKind kind);
+
+	public:
+		explicit WebSocket(Socket& sock, WsRole role, const WebSocketConfig& config = WebSocketConfig{});
+		WebSocket(const WebSocket&) = delete;
+		WebSocket(WebSocket&& other) noexcept;
+
+		~WebSocket();
+
+		[[nodiscard]] WsRole role() const noexcept;
+
+		[[nodiscard]] Result<Unit, WebSocketError> send(WsOpcode opcode, const u8* payload, usize length);
+		[[nodiscard]] Result<Unit, WebSocketError> send_fragment(WsOpcode opcode, const u8* payload, usize length, bool fin);
+
+		[[nodiscard]] Result<Unit, WebSocketError> ping(const u8* payload, usize length);
+		[[nodiscard]] Result<Unit, WebSocketError> close(WsCloseCode code, const char* reason = nullptr, usize reason_length = 0);
+
+		[[nodiscard]] Result<WsMessage, WebSocketError> recv();
+	};
+}
@@ -0,0 +1,517 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+
+#include "type_traits.hpp"
+#include "Types.hpp"
+#include "Sequence.hpp"
+#include "Array.hpp"
+#include "Maybe.hpp"
+#include "Tuple.hpp"
+#include "Variant.hpp"
+
+namespace bsl
+{
+	template<class T>
+	struct Wire;
+
+	template<class T>
+	class WireView;
+
+	template<class T>
+	inline constexpr usize wire_size_v = Wire<T>::SIZE;
+
+	template<class T>
+	struct _is_wire_scalar : is_any_of<T, bool, char, unsigned char, short, unsigned short, int, unsigned int, long long, unsigned long long, float, double> {};
+
+	template<class T>
+	inline constexpr bool _is_wire_scalar_v = _is_wire_scalar<T>::value;
+
+	template<class T>
+	inline constexpr bool _is_wire_memcpy_v = _is_wire_scalar_v<T> && (sizeof(T) == 1 || ::std::endian::native == ::std::endian::little);
+
+	template<usize I, class T, class... Rest>
+	struct _WireElem : _WireElem<I - 1, Rest...> {};
+
+	template<class T, class... Rest>
+	struct _WireElem<0, T, Rest...> : type_identity<T> {};
+
+	template<usize I, class... Types>
+	using _WireElemType = typename _WireElem<I, Types...>::type;
+
+	template<usize I, class T, class... Rest>
+	struct _WireOffset : value_type<usize, Wire<T>::SIZE + _WireOffset<I - 1, Rest...>::value> {};
+
+	template<class T, class... Rest>
+	struct _WireOffset<0, T, Rest...> : value_type<usize, 0> {};
+
+	template<usize I, class... Types>
+	inline constexpr usize _wire_offset_v = _WireOffset<I, Types...>::value;
+
+	template<class T>
+	requires _is_wire_scalar_v<T>
+	struct Wire<T>
+	{
+		static constexpr usize SIZE = sizeof(T);
+
+		static void encode(const T& value, u8* out) noexcept
+		{
+			if constexpr (_is_wire_memcpy_v<T>)
+			{
+				::std::memcpy(out, &value, sizeof(T));
+			}
+			else
+			{
+				u8 bytes[sizeof(T)];
+				::std::memcpy(bytes, &value, sizeof(T));
+
+				for (usize i = 0; i < sizeof(T); ++i)
+					out[i] = bytes[sizeof(T) - 1 - i];
+			}
+		}
+
+		[[nodiscard]] static T decode(const u8* in) noexcept
+		{
+			T value;
+
+			if constexpr (_is_wire_memcpy_v<T>)
+			{
+				::std::memcpy(&value, in, sizeof(T));
+			}
+			else
+			{
+				u8 bytes[sizeof(T)];
+
+				for (usize i = 0; i < sizeof(T); ++i)
+					bytes[i] = in[sizeof(T) - 1 - i];
+
+				::std::memcpy(&value, bytes, sizeof(T));
+			}
+
+			return value;
+		}
+
+		[[nodiscard]] static bool validate(const u8* in) noexcept
+		{
+			if constexpr (is_same_v<T, bool>)
+				return *in <= 1;
+			else
+				return true;
+		}
+	};
+
+	template<class T, usize S>
+	struct Wire<Array<T, S>>
+	{
+		static constexpr usize SIZE = S * Wire<T>::SIZE;
+
+		static void encode(const Array<T, S>& value, u8* out)
+		{
+			if constexpr (_is_wire_memcpy_v<T>)
+			{
+				::std::memcpy(out, &value[0], SIZE);
+			}
+			else
+			{
+				for (usize i = 0; i < S; ++i)
+					Wire<T>::encode(value[i], out + i * Wire<T>::SIZE);
+			}
+		}
+
+		[[nodiscard]] static Array<T, S> decode(const u8* in)
+		{
+			Array<T, S> value;
+
+			if constexpr (_is_wire_memcpy_v<T>)
+			{
+				::std::memcpy(&value[0], in, SIZE);
+			}
+			else
+			{
+				for (usize i = 0; i < S; ++i)
+					value[i] = Wire<T>::decode(in + i * Wire<T>::SIZE);
+			}
+
+			return value;
+		}
+
+		[[nodiscard]] static bool validate(const u8* in) noexcept
+		{
+			if constexpr (_is_wire_scalar_v<T> && !is_same_v<T, bool>)
+			{
+				return true;
+			}
+			else
+			{
+				for (usize i = 0; i < S; ++i)
+					if (!Wire<T>::validate(in + i * Wire<T>::SIZE))
+						return false;
+
+				return true;
+			}
+		}
+	};
+
+	template<class... Types>
+	struct Wire<Tuple<Types...>>
+	{
+		static constexpr usize SIZE = (usize{ 0 } + ... + Wire<Types>::SIZE);
+
+		template<usize... Idxs>
+		static void encode_impl(const Tuple<Types...>& value, u8* out, IndexSequence<Idxs...>)
+		{
+			(Wire<Types>::encode(get<Idxs>(value), out + _wire_offset_v<Idxs, Types...>), ...);
+		}
+
+		template<usize... Idxs>
+		[[nodiscard]] static Tuple<Types...> decode_impl(const u8* in, IndexSequence<Idxs...>)
+		{
+			return Tuple<Types...>{ Wire<Types>::decode(in + _wire_offset_v<Idxs, Types...>)... };
+		}
+
+		template<usize... Idxs>
+		[[nodiscard]] static bool validate_impl(const u8* in, IndexSequence<Idxs...>) noexcept
+		{
+			return (true && ... && Wire<Types>::validate(in + _wire_offset_v<Idxs, Types...>));
+		}
+
+		static void encode(const Tuple<Types...>& value, u8* out)
+		{
+			encode_impl(value, out, MakeIndexSequenceType<sizeof...(Types)>{});
+		}
+
+		[[nodiscard]] static Tuple<Types...> decode(const u8* in)
+		{
+			return decode_impl(in, MakeIndexSequenceType<sizeof...(Types)>{});
+		}
+
+		[[nodiscard]] static bool validate(const u8* in) noexcept
+		{
+			return validate_impl(in, MakeIndexSequenceType<sizeof...(Types)>{});
+		}
+	};
+
+	template<class T>
+	struct Wire<Maybe<T>>
+	{
+		static constexpr usize SIZE = 1 + Wire<T>::SIZE;
+
+		static void encode(const Maybe<T>& value, u8* out)
+		{
+			out[0] = value.has_value() ? 1 : 0;
+
+			if (value.has_value())
+				Wire<T>::encode(value.value(), out + 1);
+			else
+				::std::memset(out + 1, 0, Wire<T>::SIZE);
+		}
+
+		[[nodiscard]] static Maybe<T> decode(const u8* in)
+		{
+			if (in[0] == 0)
+				return {};
+
+			return Wire<T>::decode(in + 1);
+		}
+
+		[[nodiscard]] static bool validate(const u8* in) noexcept
+		{
+			return in[0] == 0 || (in[0] == 1 && Wire<T>::validate(in + 1));
+		}
+	};
+
+	template<class... Types>
+	struct Wire<Variant<Types...>>
+	{
+		static_assert(sizeof...(Types) <= 256, "Variant index must fit in one byte.");
+
+		static constexpr usize SIZE = 1 + max_of_v<usize, Wire<Types>::SIZE...>;
+
+		template<usize I = 0>
+		static void encode_at(const Variant<Types...>& value, u8* out)
+		{
+			using elem_type = _WireElemType<I, Types...>;
+
+			if (value.index() == I)
+			{
+				Wire<elem_type>::encode(get<I>(value), out + 1);
+				::std::memset(out + 1 + Wire<elem_type>::SIZE, 0, SIZE - 1 - Wire<elem_type>::SIZE);
+				return;
+			}
+
+			if constexpr (I + 1 < sizeof...(Types))
+				encode_at<I + 1>(value, out);
+		}
+
+		template<usize I = 0>
+		[[nodiscard]] static Variant<Types...> decode_at(const u8* in)
+		{
+			if constexpr (I + 1 < sizeof...(Types))
+				if (in[0] != I)
+					return decode_at<I + 1>(in);
+
+			return Variant<Types...>{ InPlaceIndex<I>{}, Wire<_WireElemType<I, Types...>>::decode(in + 1) };
+		}
+
+		template<usize I = 0>
+		[[nodiscard]] static bool validate_at(const u8* in) noexcept
+		{
+			if (in[0] == I)
+				return Wire<_WireElemType<I, Types...>>::validate(in + 1);
+
+			if constexpr (I + 1 < sizeof...(Types))
+				return validate_at<I + 1>(in);
+			else
+				return false;
+		}
+
+		static void encode(const Variant<Types...>& value, u8* out)
+		{
+			out[0] = static_cast<u8>(value.index());
+			encode_at(value, out);
+		}
+
+		[[nodiscard]] static Variant<Types...> decode(const u8* in)
+		{
+			return decode_at(in);
+		}
+
+		[[nodiscard]] static bool validate(const u8* in) noexcept
+		{
+			return validate_at(in);
+		}
+	};
+
+	template<class T>
+	class WireView
+	{
+	private:
+		const u8* m_data;
+
+	public:
+		explicit constexpr WireView(const u8* data) noexcept
+			: m_data{ data }
+		{
+		}
+
+		[[nodiscard]] static constexpr usize wire_size() noexcept
+		{
+			return Wire<T>::SIZE;
+		}
+
+		[[nodiscard]] constexpr const u8* data() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]] T decode() const
+		{
+			return Wire<T>::decode(m_data);
+		}
+	};
+
+	template<class T, usize S>
+	class WireView<Array<T, S>>
+	{
+	private:
+		const u8* m_data;
+
+	public:
+		explicit constexpr WireView(const u8* data) noexcept
+			: m_data{ data }
+		{
+		}
+
+		[[nodiscard]] static constexpr usize wire_size() noexcept
+		{
+			return Wire<Array<T, S>>::SIZE;
+		}
+
+		[[nodiscard]] constexpr const u8* data() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]] constexpr usize size() const noexcept
+		{
+			return S;
+		}
+
+		[[nodiscard]] WireView<T> at(usize i) const noexcept(false)
+		{
+			if (i >= S)
+				throw OutOfRange{};
+
+			return WireView<T>{ m_data + i * Wire<T>::SIZE };
+		}
+
+		[[nodiscard]] WireView<T> operator[](usize i) const noexcept(false)
+		{
+			return at(i);
+		}
+
+		[[nodiscard]] Array<T, S> decode() const
+		{
+			return Wire<Array<T, S>>::decode(m_data);
+		}
+	};
+
+	template<class... Types>
+	class WireView<Tuple<Types...>>
+	{
+	private:
+		const u8* m_data;
+
+	public:
+		explicit constexpr WireView(const u8* data) noexcept
+			: m_data{ data }
+		{
+		}
+
+		[[nodiscard]] static constexpr usize wire_size() noexcept
+		{
+			return Wire<Tuple<Types...>>::SIZE;
+		}
+
+		[[nodiscard]] constexpr const u8* data() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]] constexpr usize size() const noexcept
+		{
+			return sizeof...(Types);
+		}
+
+		[[nodiscard]] Tuple<Types...> decode() const
+		{
+			return Wire<Tuple<Types...>>::decode(m_data);
+		}
+	};
+
+	template<usize I, class... Types>
+	[[nodiscard]] constexpr WireView<_WireElemType<I, Types...>> get(const WireView<Tuple<Types...>>& view) noexcept
+	{
+		static_assert(I < sizeof...(Types), "Tuple index is out of range.");
+
+		return WireView<_WireElemType<I, Types...>>{ view.data() + _wire_offset_v<I, Types...> };
+	}
+
+	template<class T>
+	class WireView<Maybe<T>>
+	{
+	private:
+		const u8* m_data;
+
+	public:
+		explicit constexpr WireView(const u8* data) noexcept
+			: m_data{ data }
+		{
+		}
+
+		[[nodiscard]] static constexpr usize wire_size() noexcept
+		{
+			return Wire<Maybe<T>>::SIZE;
+		}
+
+		[[nodiscard]] constexpr const u8* data() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]] constexpr bool has_value() const noexcept
+		{
+			return m_data[0] != 0;
+		}
+
+		[[nodiscard]] constexpr operator bool() const noexcept
+		{
+			return has_value();
+		}
+
+		[[nodiscard]] WireView<T> value() const noexcept(false)
+		{
+			if (!has_value())
+				throw BadMaybeAccess{};
+
+			return WireView<T>{ m_data + 1 };
+		}
+
+		[[nodiscard]] Maybe<T> decode() const
+		{
+			return Wire<Maybe<T>>::decode(m_data);
+		}
+	};
+
+	template<class... Types>
+	class WireView<Variant<Types...>>
+	{
+	private:
+		const u8* m_data;
+
+	public:
+		explicit constexpr WireView(const u8* data) noexcept
+			: m_data{ data }
+		{
+		}
+
+		[[nodiscard]] static constexpr usize wire_size() noexcept
+		{
+			return Wire<Variant<Types...>>::SIZE;
+		}
+
+		[[nodiscard]] constexpr const u8* data() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]] constexpr usize index() const noexcept
+		{
+			return m_data[0];
+		}
+
+		[[nodiscard]] Variant<Types...> decode() const
+		{
+			return Wire<Variant<Types...>>::decode(m_data);
+		}
+	};
+
+	template<usize I, class... Types>
+	[[nodiscard]] constexpr WireView<_WireElemType<I, Types...>> get(const WireView<Variant<Types...>>& view)
+	{
+		static_assert(I < sizeof...(Types), "Variant index is out of range.");
+
+		if (view.index() != I)
+			throw BadVariantAccess{};
+
+		return WireView<_WireElemType<I, Types...>>{ view.data() + 1 };
+	}
+
+	template<class T>
+	void wire_encode(const T& value, u8* out)
+	{
+		Wire<T>::encode(value, out);
+	}
+
+	template<class T>
+	[[nodiscard]] T wire_decode(const u8* in)
+	{
+		return Wire<T>::decode(in);
+	}
+
+	template<class T>
+	[[nodiscard]] bool wire_validate(const u8* in, usize length) noexcept
+	{
+		return length >= Wire<T>::SIZE && Wire<T>::validate(in);
+	}
+
+	template<class T>
+	[[nodiscard]] Maybe<WireView<T>> wire_view(const u8* in, usize length) noexcept
+	{
+		if (!wire_validate<T>(in, length))
+			return {};
+
+		return WireView<T>{ in };
+	}
+}
@@ -0,0 +1,472 @@
+#include "AddrBulk.hpp"
+#include "Cpu.hpp"
+#include "Sequence.hpp"
+
+#include <bit>
+#include <cstring>
+
+#include <intrin.h>
+
+namespace bsl::net
+{
+	static_assert(sizeof(AddrIPv4) == sizeof(u32), "AddrIPv4 must be a packed u32");
+	static_assert(sizeof(AddrIPv6) == 2 * sizeof(u64), "AddrIPv6 must be two packed u64");
+
+	struct _AddrRuleIPv4
+	{
+		u32 mask;
+		u32 value;
+		AddrCategory category;
+	};
+
+	struct _AddrRuleIPv6
+	{
+		u64 high_mask;
+		u64 high_value;
+		u64 low_mask;
+		u64 low_value;
+		AddrCategory category;
+	};
+
+	static constexpr _AddrRuleIPv4 IPV4_RULES[] = {
+		{ 0xFFFFFFFF, 0x00000000, AddrCategory::UNSPECIFIED },
+		{ 0xFFFFFFFF, 0x7F000001, AddrCategory::LOCALHOST },
+		{ 0xFFFFFFFF, 0xFFFFFFFF, AddrCategory::BROADCAST },
+		{ 0xFF000000, 0x0A000000, AddrCategory::PRIVATE },
+		{ 0xFFF00000, 0xAC100000, AddrCategory::PRIVATE },
+		{ 0xFFFF0000, 0xC0A80000, AddrCategory::PRIVATE },
+		{ 0xFFFF0000, 0xA9FE0000, AddrCategory::LINKLOCAL },
+		{ 0xFFFFFF00, 0xC0000200, AddrCategory::DOCUMENTATION },
+		{ 0xFFFFFF00, 0xC6336400, AddrCategory::DOCUMENTATION },
+		{ 0xFFFFFF00, 0xCB007100, AddrCategory::DOCUMENTATION },
+		{ 0xFFFFFF00, 0xE9FC0000, AddrCategory::DOCUMENTATION },
+		{ 0xFFFE0000, 0xC6120000, AddrCategory::BENCHMARKING },
+		{ 0xF0000000, 0xE0000000, AddrCategory::MULTICAST }
+	};
+
+	static constexpr _AddrRuleIPv6 IPV6_RULES[] = {
+		{ ~0ULL, 0, ~0ULL, 0, AddrCategory::UNSPECIFIED },
+		{ ~0ULL, 0, ~0ULL, 1, AddrCategory::LOCALHOST },
+		{ 0xFE00000000000000ULL, 0xFC00000000000000ULL, 0, 0, AddrCategory::PRIVATE },
+		{ 0xFFC0000000000000ULL, 0xFE80000000000000ULL, 0, 0, AddrCategory::LINKLOCAL },
+		{ 0xFFFFFFFF00000000ULL, 0x20010DB800000000ULL, 0, 0, AddrCategory::DOCUMENTATION },
+		{ 0xFFFFFFFFFFFF0000ULL, 0x2001000200000000ULL, 0, 0, AddrCategory::BENCHMARKING },
+		{ 0xFF00000000000000ULL, 0xFF00000000000000ULL, 0, 0, AddrCategory::MULTICAST },
+		{ ~0ULL, 0, 0xFFFFFFFF00000000ULL, 0x0000FFFF00000000ULL, AddrCategory::IPV4_MAPPED }
+	};
+
+	static constexpr usize IPV4_RULE_COUNT = sizeof(IPV4_RULES) / sizeof(IPV4_RULES[0]);
+
+	static u32 classify_ipv4(const AddrIPv4& addr) noexcept
+	{
+		u32 bits = 0;
+
+		for (const _AddrRuleIPv4& rule : IPV4_RULES)
+			if ((addr.to_bits() & rule.mask) == rule.value)
+				bits |= 1u << static_cast<u32>(rule.category);
+
+		return bits;
+	}
+
+	static u32 classify_ipv6(const AddrIPv6& addr) noexcept
+	{
+		u32 bits = 0;
+
+		for (const _AddrRuleIPv6& rule : IPV6_RULES)
+			if ((addr.high_bits() & rule.high_mask) == rule.high_value && (addr.low_bits() & rule.low_mask) == rule.low_value)
+				bits |= 1u << static_cast<u32>(rule.category);
+
+		return bits;
+	}
+
+	static u32 pack_hits_sse2(const __m128i* hits) noexcept
+	{
+		__m128i bytes = _mm_packs_epi16(_mm_packs_epi32(hits[0], hits[1]), _mm_packs_epi32(hits[2], hits[3]));
+
+		return static_cast<u32>(_mm_movemask_epi8(bytes));
+	}
+
+	static u64 pack_block_sse2(const __m128i* hits) noexcept
+	{
+		return static_cast<u64>(pack_hits_sse2(hits)) |
+			(static_cast<u64>(pack_hits_sse2(hits + 4)) << 16) |
+			(static_cast<u64>(pack_hits_sse2(hits + 8)) << 32) |
+			(static_cast<u64>(pack_hits_sse2(hits + 12)) << 48);
+	}
+
+	static u32 pack_hits_avx2(const __m256i* hits) noexcept
+	{
+		__m256i bytes = _mm256_packs_epi16(_mm256_packs_epi32(hits[0], hits[1]), _mm256_packs_epi32(hits[2], hits[3]));
+		bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+		return static_cast<u32>(_mm256_movemask_epi8(bytes));
+	}
+
+	static u64 pack_block_avx2(const __m256i* hits) noexcept
+	{
+		return static_cast<u64>(pack_hits_avx2(hits)) | (static_cast<u64>(pack_hits_avx2(hits + 4)) << 32);
+	}
+
+	static u64 match_ipv4_block_sse2(const AddrIPv4* addrs, u32 mask, u32 value) noexcept
+	{
+		__m128i masks = _mm_set1_epi32(static_cast<i32>(mask));
+		__m128i values = _mm_set1_epi32(static_cast<i32>(value));
+		__m128i hits[16];
+
+		for (usize j = 0; j < 16; ++j)
+		{
+			__m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addrs + j * 4));
+			hits[j] = _mm_cmpeq_epi32(_mm_and_si128(input, masks), values);
+		}
+
+		return pack_block_sse2(hits);
+	}
+
+	static u64 match_ipv4_block_avx2(const AddrIPv4* addrs, u32 mask, u32 value) noexcept
+	{
+		__m256i masks = _mm256_set1_epi32(static_cast<i32>(mask));
+		__m256i values = _mm256_set1_epi32(static_cast<i32>(value));
+		__m256i hits[8];
+
+		for (usize j = 0; j < 8; ++j)
+		{
+			__m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addrs + j * 8));
+			hits[j] = _mm256_cmpeq_epi32(_mm256_and_si256(input, masks), values);
+		}
+
+		return pack_block_avx2(hits);
+	}
+
+	template<usize... Rules>
+	static void classify_ipv4_lanes_sse2(__m128i input, __m128i* hits, IndexSequence<Rules...>) noexcept
+	{
+		((hits[static_cast<usize>(IPV4_RULES[Rules].category)] = _mm_or_si128(
+			hits[static_cast<usize>(IPV4_RULES[Rules].category)],
+			_mm_cmpeq_epi32(
+				_mm_and_si128(input, _mm_set1_epi32(static_cast<i32>(IPV4_RULES[Rules].mask))),
+				_mm_set1_epi32(static_cast<i32>(IPV4_RULES[Rules].value))))), ...);
+	}
+
+	template<usize... Rules>
+	static void classify_ipv4_lanes_avx2(__m256i input, __m256i* hits, IndexSequence<Rules...>) noexcept
+	{
+		((hits[static_cast<usize>(IPV4_RULES[Rules].category)] = _mm256_or_si256(
+			hits[static_cast<usize>(IPV4_RULES[Rules].category)],
+			_mm256_cmpeq_epi32(
+				_mm256_and_si256(input, _mm256_set1_epi32(static_cast<i32>(IPV4_RULES[Rules].mask))),
+				_mm256_set1_epi32(static_cast<i32>(IPV4_RULES[Rules].value))))), ...);
+	}
+
+	template<usize... Categories>
+	static void store_lanes_sse2(const __m128i* hits, u8 (*lanes)[16], usize j, IndexSequence<Categories...>) noexcept
+	{
+		((lanes[Categories][j] = static_cast<u8>(_mm_movemask_ps(_mm_castsi128_ps(hits[Categories])))), ...);
+	}
+
+	template<usize... Categories>
+	static void store_lanes_avx2(const __m256i* hits, u8 (*lanes)[8], usize j, IndexSequence<Categories...>) noexcept
+	{
+		((lanes[Categories][j] = static_cast<u8>(_mm256_movemask_ps(_mm256_castsi256_ps(hits[Categories])))), ...);
+	}
+
+	static void classify_ipv4_block_sse2(const AddrIPv4* addrs, u64* block) noexcept
+	{
+		u8 lanes[ADDR_CATEGORY_COUNT][16];
+
+		for (usize j = 0; j < 16; ++j)
+		{
+			__m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addrs + j * 4));
+			__m128i hits[ADDR_CATEGORY_COUNT] = {};
+
+			classify_ipv4_lanes_sse2(input, hits, MakeIndexSequenceType<IPV4_RULE_COUNT>{});
+			store_lanes_sse2(hits, lanes, j, MakeIndexSequenceType<ADDR_CATEGORY_COUNT>{});
+		}
+
+		for (usize category = 0; category < ADDR_CATEGORY_COUNT; ++category)
+		{
+			__m128i nibbles = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes[category]));
+			__m128i bytes = _mm_or_si128(nibbles, _mm_srli_epi64(nibbles, 4));
+
+			bytes = _mm_and_si128(bytes, _mm_set1_epi16(0x00FF));
+			bytes = _mm_packus_epi16(bytes, bytes);
+
+			block[category] = static_cast<u64>(_mm_cvtsi128_si64(bytes));
+		}
+	}
+
+	static void classify_ipv4_block_avx2(const AddrIPv4* addrs, u64* block) noexcept
+	{
+		u8 lanes[ADDR_CATEGORY_COUNT][8];
+
+		for (usize j = 0; j < 8; ++j)
+		{
+			__m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addrs + j * 8));
+			__m256i hits[ADDR_CATEGORY_COUNT] = {};
+
+			classify_ipv4_lanes_avx2(input, hits, MakeIndexSequenceType<IPV4_RULE_COUNT>{});
+			store_lanes_avx2(hits, lanes, j, MakeIndexSequenceType<ADDR_CATEGORY_COUNT>{});
+		}
+
+		for (usize category = 0; category < ADDR_CATEGORY_COUNT; ++category)
+			::std::memcpy(&block[category], lanes[category], sizeof(u64));
+	}
+
+	static __m128i cmpeq_epi64_sse2(__m128i lhs, __m128i rhs) noexcept
+	{
+		__m128i equal = _mm_cmpeq_epi32(lhs, rhs);
+
+		return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+
+	static void load_ipv6_block_sse2(const AddrIPv6* addrs, __m128i* highs, __m128i* lows) noexcept
+	{
+		for (usize j = 0; j < 32; ++j)
+		{
+			__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addrs + j * 2));
+			__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addrs + j * 2 + 1));
+
+			highs[j] = _mm_unpacklo_epi64(first, second);
+			lows[j] = _mm_unpackhi_epi64(first, second);
+		}
+	}
+
+	static __m128i match_ipv6_pair_sse2(__m128i high, __m128i low, const _AddrRuleIPv6& rule) noexcept
+	{
+		__m128i hit = cmpeq_epi64_sse2(
+			_mm_and_si128(high, _mm_set1_epi64x(static_cast<i64>(rule.high_mask))),
+			_mm_set1_epi64x(static_cast<i64>(rule.high_value)));
+
+		if (rule.low_mask == 0)
+			return hit;
+
+		return _mm_and_si128(hit, cmpeq_epi64_sse2(
+			_mm_and_si128(low, _mm_set1_epi64x(static_cast<i64>(rule.low_mask))),
+			_mm_set1_epi64x(static_cast<i64>(rule.low_value))));
+	}
+
+	static u64 match_ipv6_block_sse2(const __m128i* highs, const __m128i* lows, const _AddrRuleIPv6& rule) noexcept
+	{
+		__m128i hits[16];
+
+		for (usize j = 0; j < 16; ++j)
+		{
+			__m128i first = match_ipv6_pair_sse2(highs[j * 2], lows[j * 2], rule);
+			__m128i second = match_ipv6_pair_sse2(highs[j * 2 + 1], lows[j * 2 + 1], rule);
+
+			hits[j] = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(first), _mm_castsi128_ps(second), _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+
+		return pack_block_sse2(hits);
+	}
+
+	static void load_ipv6_block_avx2(const AddrIPv6* addrs, __m256i* highs, __m256i* lows) noexcept
+	{
+		for (usize j = 0; j < 16; ++j)
+		{
+			__m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addrs + j * 4));
+			__m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addrs + j * 4 + 2));
+
+			highs[j] = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+			lows[j] = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+		}
+	}
+
+	static __m256i match_ipv6_quad_avx2(__m256i high, __m256i low, const _AddrRuleIPv6& rule) noexcept
+	{
+		__m256i hit = _mm256_cmpeq_epi64(
+			_mm256_and_si256(high, _mm256_set1_epi64x(static_cast<i64>(rule.high_mask))),
+			_mm256_set1_epi64x(static_cast<i64>(rule.high_value)));
+
+		if (rule.low_mask == 0)
+			return hit;
+
+		return _mm256_and_si256(hit, _mm256_cmpeq_epi64(
+			_mm256_and_si256(low, _mm256_set1_epi64x(static_cast<i64>(rule.low_mask))),
+			_mm256_set1_epi64x(static_cast<i64>(rule.low_value))));
+	}
+
+	static u64 match_ipv6_block_avx2(const __m256i* highs, const __m256i* lows, const _AddrRuleIPv6& rule) noexcept
+	{
+		__m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+		__m256i hits[8];
+
+		for (usize j = 0; j < 8; ++j)
+		{
+			__m256i first = match_ipv6_quad_avx2(highs[j * 2], lows[j * 2], rule);
+			__m256i second = match_ipv6_quad_avx2(highs[j * 2 + 1], lows[j * 2 + 1], rule);
+
+			hits[j] = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(first, second, 0xAA), order);
+		}
+
+		return pack_block_avx2(hits);
+	}
+
+	static void classify_ipv6_block_sse2(const AddrIPv6* addrs, u64* block) noexcept
+	{
+		__m128i highs[32];
+		__m128i lows[32];
+
+		load_ipv6_block_sse2(addrs, highs, lows);
+
+		for (const _AddrRuleIPv6& rule : IPV6_RULES)
+			block[static_cast<usize>(rule.category)] |= match_ipv6_block_sse2(highs, lows, rule);
+	}
+
+	static void classify_ipv6_block_avx2(const AddrIPv6* addrs, u64* block) noexcept
+	{
+		__m256i highs[16];
+		__m256i lows[16];
+
+		load_ipv6_block_avx2(addrs, highs, lows);
+
+		for (const _AddrRuleIPv6& rule : IPV6_RULES)
+			block[static_cast<usize>(rule.category)] |= match_ipv6_block_avx2(highs, lows, rule);
+	}
+
+	template<class Addr, class BlockFn, class ScalarFn>
+	static void classify_bulk(const Addr* addrs, usize count, u64* masks, BlockFn block_fn, ScalarFn scalar_fn) noexcept
+	{
+		usize words = addr_mask_words(count);
+
+		for (usize word = 0; word < words; ++word)
+		{
+			u64 block[ADDR_CATEGORY_COUNT] = {};
+			usize base = word * 64;
+
+			if (base + 64 <= count)
+			{
+				block_fn(addrs + base, block);
+			}
+			else
+			{
+				for (usize i = base; i < count; ++i)
+				{
+					u32 bits = scalar_fn(addrs[i]);
+
+					for (usize category = 0; category < ADDR_CATEGORY_COUNT; ++category)
+						block[category] |= static_cast<u64>((bits >> category) & 1) << (i - base);
+				}
+			}
+
+			for (usize category = 0; category < ADDR_CATEGORY_COUNT; ++category)
+				masks[category * words + word] = block[category];
+		}
+	}
+
+	void classify_ipv4_bulk(const AddrIPv4* addrs, usize count, u64* masks) noexcept
+	{
+		if (cpu::has_avx2())
+			classify_bulk(addrs, count, masks, classify_ipv4_block_avx2, classify_ipv4);
+		else
+			classify_bulk(addrs, count, masks, classify_ipv4_block_sse2, classify_ipv4);
+	}
+
+	void classify_ipv6_bulk(const AddrIPv6* addrs, usize count, u64* masks) noexcept
+	{
+		if (cpu::has_avx2())
+			classify_bulk(addrs, count, masks, classify_ipv6_block_avx2, classify_ipv6);
+		else
+			classify_bulk(addrs, count, masks, classify_ipv6_block_sse2, classify_ipv6);
+	}
+
+	static usize match_ipv4_masked(const AddrIPv4* addrs, usize count, u32 mask, u32 value, u64* out) noexcept
+	{
+		bool avx2 = cpu::has_avx2();
+		usize matches = 0;
+
+		for (usize word = 0; word < addr_mask_words(count); ++word)
+		{
+			usize base = word * 64;
+			u64 bits = 0;
+
+			if (base + 64 <= count)
+			{
+				bits = avx2 ? match_ipv4_block_avx2(addrs + base, mask, value) : match_ipv4_block_sse2(addrs + base, mask, value);
+			}
+			else
+			{
+				for (usize i = base; i < count; ++i)
+					bits |= static_cast<u64>((addrs[i].to_bits() & mask) == value) << (i - base);
+			}
+
+			out[word] = bits;
+			matches += static_cast<usize>(::std::popcount(bits));
+		}
+
+		return matches;
+	}
+
+	static usize match_ipv6_masked(const AddrIPv6* addrs, usize count, const _AddrRuleIPv6& rule, u64* out) noexcept
+	{
+		bool avx2 = cpu::has_avx2();
+		usize matches = 0;
+
+		for (usize word = 0; word < addr_mask_words(count); ++word)
+		{
+			usize base = word * 64;
+			u64 bits = 0;
+
+			if (base + 64 <= count && avx2)
+			{
+				__m256i highs[16];
+				__m256i lows[16];
+
+				load_ipv6_block_avx2(addrs + base, highs, lows);
+				bits = match_ipv6_block_avx2(highs, lows, rule);
+			}
+			else if (base + 64 <= count)
+			{
+				__m128i highs[32];
+				__m128i lows[32];
+
+				load_ipv6_block_sse2(addrs + base, highs, lows);
+				bits = match_ipv6_block_sse2(highs, lows, rule);
+			}
+			else
+			{
+				for (usize i = base; i < count; ++i)
+				{
+					bool hit = (addrs[i].high_bits() & rule.high_mask) == rule.high_value &&
+						(addrs[i].low_bits() & rule.low_mask) == rule.low_value;
+
+					bits |= static_cast<u64>(hit) << (i - base);
+				}
+			}
+
+			out[word] = bits;
+			matches += static_cast<usize>(::std::popcount(bits));
+		}
+
+		return matches;
+	}
+
+	usize match_ipv4_bulk(const AddrIPv4* addrs, usize count, const AddrIPv4& value, u64* mask) noexcept
+	{
+		return match_ipv4_masked(addrs, count, 0xFFFFFFFF, value.to_bits(), mask);
+	}
+
+	usize match_ipv6_bulk(const AddrIPv6* addrs, usize count, const AddrIPv6& value, u64* mask) noexcept
+	{
+		_AddrRuleIPv6 rule{ ~0ULL, value.high_bits(), ~0ULL, value.low_bits(), AddrCategory::UNSPECIFIED };
+
+		return match_ipv6_masked(addrs, count, rule, mask);
+	}
+
+	usize match_prefix_ipv4_bulk(const AddrIPv4* addrs, usize count, const CidrIPv4& prefix, u64* mask) noexcept
+	{
+		return match_ipv4_masked(addrs, count, CidrIPv4::mask_of(prefix.length()), prefix.addr().to_bits(), mask);
+	}
+
+	usize match_prefix_ipv6_bulk(const AddrIPv6* addrs, usize count, const CidrIPv6& prefix, u64* mask) noexcept
+	{
+		_AddrRuleIPv6 rule{
+			CidrIPv6::high_mask_of(prefix.length()),
+			prefix.addr().high_bits(),
+			CidrIPv6::low_mask_of(prefix.length()),
+			prefix.addr().low_bits(),
+			AddrCategory::UNSPECIFIED
+		};
+
+		return match_ipv6_masked(addrs, count, rule, mask);
+	}
+}
@@ -0,0 +1,716 @@
+#include "Net.hpp"
+#include "Cpu.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+#include <intrin.h>
+
+namespace bsl::net
+{
+	struct _Ipv4Pattern
+	{
+		alignas(16) u8 shuffle[16];
+		u16 leading;
+	};
+
+	struct _Ipv4PatternTable
+	{
+		_Ipv4Pattern patterns[81];
+
+		constexpr _Ipv4PatternTable()
+			: patterns{}
+		{
+			for (usize index = 0; index < 81; ++index)
+			{
+				usize lengths[4] = { index / 27 + 1, index / 9 % 3 + 1, index / 3 % 3 + 1, index % 3 + 1 };
+				_Ipv4Pattern& pattern = patterns[index];
+				usize start = 0;
+
+				for (usize octet = 0; octet < 4; ++octet)
+				{
+					usize length = lengths[octet];
+					usize last = start + length - 1;
+
+					pattern.shuffle[4 * octet] = 0x80;
+					pattern.shuffle[4 * octet + 1] = length == 3 ? static_cast<u8>(start) : 0x80;
+					pattern.shuffle[4 * octet + 2] = length >= 2 ? static_cast<u8>(last - 1) : 0x80;
+					pattern.shuffle[4 * octet + 3] = static_cast<u8>(last);
+
+					if (length > 1)
+						pattern.leading |= static_cast<u16>(1u << start);
+
+					start += length + 1;
+				}
+			}
+		}
+	};
+
+	static constexpr _Ipv4PatternTable IPV4_PATTERNS{};
+
+	struct _Ipv4Text
+	{
+		char text[4];
+		u8 length;
+	};
+
+	struct _Ipv4TextTable
+	{
+		_Ipv4Text octets[256];
+
+		constexpr _Ipv4TextTable()
+			: octets{}
+		{
+			for (usize value = 0; value < 256; ++value)
+			{
+				_Ipv4Text& entry = octets[value];
+				usize n = 0;
+
+				if (value >= 100)
+					entry.text[n++] = static_cast<char>('0' + value / 100);
+
+				if (value >= 10)
+					entry.text[n++] = static_cast<char>('0' + value / 10 % 10);
+
+				entry.text[n++] = static_cast<char>('0' + value % 10);
+				entry.text[n] = '.';
+				entry.length = static_cast<u8>(n);
+			}
+		}
+	};
+
+	static constexpr _Ipv4TextTable IPV4_TEXT{};
+
+	struct _HexTable
+	{
+		u8 values[256];
+
+		constexpr _HexTable()
+			: values{}
+		{
+			for (usize c = 0; c < 256; ++c)
+				values[c] = 0xFF;
+
+			for (usize c = '0'; c <= '9'; ++c)
+				values[c] = static_cast<u8>(c - '0');
+
+			for (usize c = 'a'; c <= 'f'; ++c)
+			{
+				values[c] = static_cast<u8>(c - 'a' + 10);
+				values[c - 'a' + 'A'] = static_cast<u8>(c - 'a' + 10);
+			}
+		}
+	};
+
+	static constexpr _HexTable HEX_VALUES{};
+
+	static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+	static bool parse_ipv4_scalar(const char* text, usize length, u32& out) noexcept
+	{
+		if (length < 7 || length > AddrIPv4::MAX_TEXT_LENGTH)
+			return false;
+
+		u32 result = 0;
+		usize i = 0;
+
+		for (usize octet = 0; octet < 4; ++octet)
+		{
+			if (octet != 0)
+			{
+				if (i >= length || text[i] != '.')
+					return false;
+
+				++i;
+			}
+
+			usize start = i;
+			u32 value = 0;
+
+			while (i < length && i - start < 3 && static_cast<u8>(text[i] - '0') < 10)
+				value = value * 10 + static_cast<u32>(text[i++] - '0');
+
+			usize digits = i - start;
+
+			if (digits == 0 || value > 255 || (digits > 1 && text[start] == '0'))
+				return false;
+
+			result = (result << 8) | value;
+		}
+
+		if (i != length)
+			return false;
+
+		out = result;
+
+		return true;
+	}
+
+	static bool parse_ipv4_ssse3(const char* text, usize length, bool can_overread, u32& out) noexcept
+	{
+		if (length < 7 || length > AddrIPv4::MAX_TEXT_LENGTH)
+			return false;
+
+		__m128i input;
+
+		if (can_overread)
+		{
+			input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+		}
+		else
+		{
+			alignas(16) char buffer[16] = {};
+			::std::memcpy(buffer, text, length);
+			input = _mm_load_si128(reinterpret_cast<const __m128i*>(buffer));
+		}
+
+		u32 full = (1u << length) - 1;
+
+		__m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+		__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+		__m128i is_dot = _mm_cmpeq_epi8(input, _mm_set1_epi8('.'));
+
+		u32 dot_mask = static_cast<u32>(_mm_movemask_epi8(is_dot)) & full;
+		u32 digit_mask = static_cast<u32>(_mm_movemask_epi8(is_digit)) & full;
+
+		if ((dot_mask | digit_mask) != full || ::std::popcount(dot_mask) != 3)
+			return false;
+
+		u32 p1 = static_cast<u32>(::std::countr_zero(dot_mask));
+		u32 rest = dot_mask & (dot_mask - 1);
+		u32 p2 = static_cast<u32>(::std::countr_zero(rest));
+		rest &= rest - 1;
+		u32 p3 = static_cast<u32>(::std::countr_zero(rest));
+
+		u32 l1 = p1 - 1;
+		u32 l2 = p2 - p1 - 2;
+		u32 l3 = p3 - p2 - 2;
+		u32 l4 = static_cast<u32>(length) - p3 - 2;
+
+		if (l1 > 2 || l2 > 2 || l3 > 2 || l4 > 2)
+			return false;
+
+		const _Ipv4Pattern& pattern = IPV4_PATTERNS.patterns[l1 * 27 + l2 * 9 + l3 * 3 + l4];
+
+		u32 zero_mask = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(digits, _mm_setzero_si128())));
+
+		if ((zero_mask & pattern.leading) != 0)
+			return false;
+
+		__m128i shuffled = _mm_shuffle_epi8(digits, _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.shuffle)));
+		__m128i pairs = _mm_maddubs_epi16(shuffled, _mm_setr_epi8(0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1));
+		__m128i octets = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+
+		if (_mm_movemask_epi8(_mm_cmpgt_epi32(octets, _mm_set1_epi32(255))) != 0)
+			return false;
+
+		__m128i packed = _mm_shuffle_epi8(octets, _mm_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+
+		out = static_cast<u32>(_mm_cvtsi128_si32(packed));
+
+		return true;
+	}
+
+	static bool parse_ipv4(const char* text, usize length, bool can_overread, u32& out) noexcept
+	{
+		if (cpu::has_ssse3())
+			return parse_ipv4_ssse3(text, length, can_overread, out);
+
+		return parse_ipv4_scalar(text, length, out);
+	}
+
+	static void classify_ipv6(const char* text, usize length, u64& colon_mask, u64& dot_mask, u64& valid_mask) noexcept
+	{
+		alignas(16) char buffer[48] = {};
+		::std::memcpy(buffer, text, length);
+
+		colon_mask = 0;
+		dot_mask = 0;
+		valid_mask = 0;
+
+		for (usize chunk = 0; chunk * 16 < length; ++chunk)
+		{
+			__m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(buffer + chunk * 16));
+
+			__m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+			__m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+
+			__m128i letters = _mm_sub_epi8(_mm_or_si128(input, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+			__m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+
+			__m128i is_colon = _mm_cmpeq_epi8(input, _mm_set1_epi8(':'));
+			__m128i is_dot = _mm_cmpeq_epi8(input, _mm_set1_epi8('.'));
+
+			__m128i is_valid = _mm_or_si128(_mm_or_si128(is_digit, is_letter), _mm_or_si128(is_colon, is_dot));
+
+			u32 shift = static_cast<u32>(chunk * 16);
+
+			colon_mask |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(is_colon))) << shift;
+			dot_mask |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(is_dot))) << shift;
+			valid_mask |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(is_valid))) << shift;
+		}
+
+		u64 full = (1ull << length) - 1;
+
+		colon_mask &= full;
+		dot_mask &= full;
+		valid_mask &= full;
+	}
+
+	static bool parse_ipv6(const char* text, usize length, bool can_overread, u16 (&out)[8]) noexcept
+	{
+		if (length < 2 || length > AddrIPv6::MAX_TEXT_LENGTH)
+			return false;
+
+		u64 colon_mask, dot_mask, valid_mask;
+		classify_ipv6(text, length, colon_mask, dot_mask, valid_mask);
+
+		if (valid_mask != (1ull << length) - 1 || colon_mask == 0)
+			return false;
+
+		if ((colon_mask & (colon_mask >> 1) & (colon_mask >> 2)) != 0)
+			return false;
+
+		u64 double_colons = colon_mask & (colon_mask >> 1);
+
+		if (::std::popcount(double_colons) > 1)
+			return false;
+
+		usize end = length;
+		u32 tail_bits = 0;
+		bool has_tail = dot_mask != 0;
+
+		if (has_tail)
+		{
+			usize last_colon = 63 - static_cast<usize>(::std::countl_zero(colon_mask));
+
+			if (dot_mask >> (last_colon + 1) << (last_colon + 1) != dot_mask)
+				return false;
+
+			end = last_colon + 1;
+
+			if (!parse_ipv4(text + end, length - end, can_overread, tail_bits))
+				return false;
+		}
+
+		u16 head[8];
+		u16 tail[8];
+		usize head_count = 0;
+		usize tail_count = 0;
+		bool compressed = false;
+		usize i = 0;
+
+		if (text[0] == ':')
+		{
+			if (text[1] != ':')
+				return false;
+
+			compressed = true;
+			i = 2;
+		}
+
+		while (i < end)
+		{
+			u64 ahead = colon_mask >> i;
+			usize next = ahead == 0 ? end : i + static_cast<usize>(::std::countr_zero(ahead));
+
+			if (next > end)
+				next = end;
+
+			usize digits = next - i;
+
+			if (digits == 0 || digits > 4)
+				return false;
+
+			u32 value = 0;
+
+			for (usize k = i; k < next; ++k)
+				value = (value << 4) | HEX_VALUES.values[static_cast<u8>(text[k])];
+
+			if (value > 0xFFFF || head_count + tail_count >= 8)
+				return false;
+
+			if (compressed)
+				tail[tail_count++] = static_cast<u16>(value);
+			else
+				head[head_count++] = static_cast<u16>(value);
+
+			if (next == end)
+				break;
+
+			if (next + 1 < length && text[next + 1] == ':')
+			{
+				if (compressed)
+					return false;
+
+				compressed = true;
+				i = next + 2;
+			}
+			else
+			{
+				i = next + 1;
+
+				if (i == end && !has_tail)
+					return false;
+			}
+		}
+
+		usize total = head_count + tail_count + (has_tail ? 2 : 0);
+
+		if (compressed ? total > 7 : total != 8)
+			return false;
+
+		usize n = 0;
+
+		for (usize k = 0; k < head_count; ++k)
+			out[n++] = head[k];
+
+		for (usize k = total; k < 8; ++k)
+			out[n++] = 0;
+
+		for (usize k = 0; k < tail_count; ++k)
+			out[n++] = tail[k];
+
+		if (has_tail)
+		{
+			out[n++] = static_cast<u16>(tail_bits >> 16);
+			out[n++] = static_cast<u16>(tail_bits);
+		}
+
+		return true;
+	}
+
+	static usize format_ipv4(u32 bits, char* dest) noexcept
+	{
+		char* it = dest;
+
+		for (u32 octet = 0; octet < 4; ++octet)
+		{
+			const _Ipv4Text& entry = IPV4_TEXT.octets[(bits >> (24 - octet * 8)) & 0xFF];
+
+			::std::memcpy(it, entry.text, 4);
+			it += entry.length + 1;
+		}
+
+		--it;
+		*it = '\0';
+
+		return static_cast<usize>(it - dest);
+	}
+
+	static char* format_hextet(u16 value, char* it) noexcept
+	{
+		u32 digits = value == 0 ? 1 : (19 - static_cast<u32>(::std::countl_zero(value))) / 4;
+
+		for (u32 k = digits; k-- > 0;)
+			*it++ = HEX_DIGITS[(value >> (k * 4)) & 0xF];
+
+		return it;
+	}
+
+	static u32 zero_hextets(u64 high, u64 low) noexcept
+	{
+		__m128i input = _mm_set_epi64x(static_cast<i64>(low), static_cast<i64>(high));
+		input = _mm_shufflelo_epi16(input, _MM_SHUFFLE(0, 1, 2, 3));
+		input = _mm_shufflehi_epi16(input, _MM_SHUFFLE(0, 1, 2, 3));
+
+		__m128i zeros = _mm_cmpeq_epi16(input, _mm_setzero_si128());
+
+		return static_cast<u32>(_mm_movemask_epi8(_mm_packs_epi16(zeros, _mm_setzero_si128())));
+	}
+
+	Maybe<AddrIPv4> AddrIPv4::from_text(const char* text, usize length) noexcept
+	{
+		u32 bits;
+
+		if (!parse_ipv4(text, length, false, bits))
+			return {};
+
+		return AddrIPv4::from_bits(bits);
+	}
+
+	Maybe<AddrIPv4> AddrIPv4::from_text(const char* text) noexcept
+	{
+		return from_text(text, ::std::strlen(text));
+	}
+
+	usize AddrIPv4::to_text(char* dest) const noexcept
+	{
+		return format_ipv4(int_value(), dest);
+	}
+
+	Maybe<AddrIPv6> AddrIPv6::from_text(const char* text, usize length) noexcept
+	{
+		u16 hextets[8];
+
+		if (!parse_ipv6(text, length, false, hextets))
+			return {};
+
+		return AddrIPv6{ hextets[0], hextets[1], hextets[2], hextets[3], hextets[4], hextets[5], hextets[6], hextets[7] };
+	}
+
+	Maybe<AddrIPv6> AddrIPv6::from_text(const char* text) noexcept
+	{
+		return from_text(text, ::std::strlen(text));
+	}
+
+	usize AddrIPv6::to_text(char* dest) const noexcept
+	{
+		char* it = dest;
+
+		if (is_ipv4_mapped())
+		{
+			::std::memcpy(it, "::ffff:", 7);
+			it += 7;
+
+			return 7 + format_ipv4(static_cast<u32>(m_low), it);
+		}
+
+		u32 zeros = zero_hextets(m_high, m_low);
+		u32 best_start = 8;
+		u32 best_length = 1;
+
+		for (u32 rest = zeros; rest != 0;)
+		{
+			u32 start = static_cast<u32>(::std::countr_zero(rest));
+			u32 run = static_cast<u32>(::std::countr_one(rest >> start));
+
+			if (run > best_length)
+			{
+				best_start = start;
+				best_length = run;
+			}
+
+			rest &= ~(((1u << run) - 1) << start);
+		}
+
+		for (u32 k = 0; k < 8; ++k)
+		{
+			if (k == best_start)
+			{
+				*it++ = ':';
+
+				if (k == 0)
+					*it++ = ':';
+
+				k += best_length - 1;
+				continue;
+			}
+
+			it = format_hextet((*this)[k], it);
+
+			if (k != 7)
+				*it++ = ':';
+		}
+
+		*it = '\0';
+
+		return static_cast<usize>(it - dest);
+	}
+
+	Maybe<IPAddr> IPAddr::from_text(const char* text, usize length) noexcept
+	{
+		if (::std::memchr(text, ':', length) == nullptr)
+		{
+			Maybe<AddrIPv4> v4 = AddrIPv4::from_text(text, length);
+
+			if (!v4.has_value())
+				return {};
+
+			return IPAddr{ v4.unwrap() };
+		}
+
+		Maybe<AddrIPv6> v6 = AddrIPv6::from_text(text, length);
+
+		if (!v6.has_value())
+			return {};
+
+		return IPAddr{ v6.unwrap() };
+	}
+
+	Maybe<IPAddr> IPAddr::from_text(const char* text) noexcept
+	{
+		return from_text(text, ::std::strlen(text));
+	}
+
+	usize IPAddr::to_text(char* dest) const noexcept
+	{
+		return m_addr.index() == 0 ?
+			get<0>(m_addr).to_text(dest) :
+			get<1>(m_addr).to_text(dest);
+	}
+
+	static bool split_prefix(const char* text, usize length, usize max_prefix, usize& addr_length, usize& prefix) noexcept
+	{
+		const char* slash = static_cast<const char*>(::std::memchr(text, '/', length));
+
+		if (slash == nullptr)
+			return false;
+
+		addr_length = static_cast<usize>(slash - text);
+
+		const char* it = slash + 1;
+		const char* end = text + length;
+
+		if (it == end || end - it > 3 || (*it == '0' && end - it > 1))
+			return false;
+
+		prefix = 0;
+
+		for (; it != end; ++it)
+		{
+			if (static_cast<u8>(*it - '0') >= 10)
+				return false;
+
+			prefix = prefix * 10 + static_cast<usize>(*it - '0');
+		}
+
+		return prefix <= max_prefix;
+	}
+
+	Maybe<CidrIPv4> CidrIPv4::from_text(const char* text, usize length) noexcept
+	{
+		usize addr_length, prefix;
+
+		if (!split_prefix(text, length, MAX_LENGTH, addr_length, prefix))
+			return {};
+
+		Maybe<AddrIPv4> addr = AddrIPv4::from_text(text, addr_length);
+
+		if (!addr.has_value())
+			return {};
+
+		return from(addr.unwrap(), prefix);
+	}
+
+	Maybe<CidrIPv4> CidrIPv4::from_text(const char* text) noexcept
+	{
+		return from_text(text, ::std::strlen(text));
+	}
+
+	usize CidrIPv4::to_text(char* dest) const noexcept
+	{
+		usize n = m_addr.to_text(dest);
+
+		return n + static_cast<usize>(::std::snprintf(dest + n, 4, "/%u", static_cast<u32>(m_length)));
+	}
+
+	Maybe<CidrIPv6> CidrIPv6::from_text(const char* text, usize length) noexcept
+	{
+		usize addr_length, prefix;
+
+		if (!split_prefix(text, length, MAX_LENGTH, addr_length, prefix))
+			return {};
+
+		Maybe<AddrIPv6> addr = AddrIPv6::from_text(text, addr_length);
+
+		if (!addr.has_value())
+			return {};
+
+		return from(addr.unwrap(), prefix);
+	}
+
+	Maybe<CidrIPv6> CidrIPv6::from_text(const char* text) noexcept
+	{
+		return from_text(text, ::std::strlen(text));
+	}
+
+	usize CidrIPv6::to_text(char* dest) const noexcept
+	{
+		usize n = m_addr.to_text(dest);
+
+		return n + static_cast<usize>(::std::snprintf(dest + n, 5, "/%u", static_cast<u32>(m_length)));
+	}
+
+	usize parse_ipv4_bulk(const char* const* texts, const usize* lengths, usize count, AddrIPv4* out, bool* valid) noexcept
+	{
+		usize parsed = 0;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			u32 bits = 0;
+			bool ok = parse_ipv4(texts[i], lengths[i], false, bits);
+
+			out[i] = AddrIPv4::from_bits(bits);
+			valid[i] = ok;
+			parsed += ok ? 1 : 0;
+		}
+
+		return parsed;
+	}
+
+	static usize token_length(const char* it, const char* end) noexcept
+	{
+		usize limit = static_cast<usize>(end - it);
+
+		if (limit > AddrIPv6::MAX_TEXT_LENGTH + 1)
+			limit = AddrIPv6::MAX_TEXT_LENGTH + 1;
+
+		usize offset = 0;
+
+		for (; offset + 16 <= limit; offset += 16)
+		{
+			__m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + offset));
+			__m128i stop = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(input, _mm_set1_epi8('\t'))),
+				_mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(input, _mm_set1_epi8('\r'))));
+
+			u32 mask = static_cast<u32>(_mm_movemask_epi8(stop));
+
+			if (mask != 0)
+				return offset + static_cast<usize>(::std::countr_zero(mask));
+		}
+
+		for (; offset < limit; ++offset)
+		{
+			char c = it[offset];
+
+			if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+				return offset;
+		}
+
+		return limit;
+	}
+
+	usize parse_ip_lines(const char* buffer, usize length, AddrIPv6* out, bool* valid, usize max_lines, usize& consumed) noexcept
+	{
+		const char* it = buffer;
+		const char* end = buffer + length;
+		usize lines = 0;
+
+		while (lines < max_lines && it < end)
+		{
+			const char* newline = static_cast<const char*>(::std::memchr(it, '\n', static_cast<usize>(end - it)));
+
+			if (newline == nullptr)
+				break;
+
+			usize token = token_length(it, newline);
+			bool can_overread = end - it >= 64;
+			bool ok = false;
+
+			if (::std::memchr(it, ':', token) == nullptr)
+			{
+				u32 bits = 0;
+				ok = parse_ipv4(it, token, can_overread, bits);
+				out[lines] = AddrIPv6{ AddrIPv4::from_bits(bits) };
+			}
+			else
+			{
+				u16 hextets[8] = {};
+				ok = parse_ipv6(it, token, can_overread, hextets);
+				out[lines] = AddrIPv6{ hextets[0], hextets[1], hextets[2], hextets[3], hextets[4], hextets[5], hextets[6], hextets[7] };
+			}
+
+			valid[lines] = ok;
+			++lines;
+
+			it = newline + 1;
+		}
+
+		consumed = static_cast<usize>(it - buffer);
+
+		return lines;
+	}
+}
@@ -0,0 +1,257 @@
+#include "Balancer.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace bsl::net
+{
+	struct _BalancerBackend
+	{
+		SockAddr m_addr;
+		u64 m_id;
+		f64 m_weight;
+		::std::atomic<u64> m_outstanding;
+		::std::atomic<u32> m_refs;
+	};
+
+	struct _BalancerState
+	{
+		mutable ::std::shared_mutex m_mutex;
+		::std::vector<_BalancerBackend*> m_backends;
+		BalancerConfig m_config;
+		::std::atomic<u64> m_fallbacks;
+	};
+
+	static f64 rendezvous_score(u64 key_hash, const _BalancerBackend& backend) noexcept
+	{
+		u64 mixed = hash_mix(hash_accumulate(key_hash, backend.m_id));
+		f64 unit = (static_cast<f64>(mixed >> 11) + 0.5) * 0x1.0p-53;
+
+		return -backend.m_weight / ::std::log(unit);
+	}
+
+	static usize rank_backends(const _BalancerState& state, u64 key_hash, _BalancerBackend** ranked, usize limit) noexcept
+	{
+		f64 scores[Balancer::MAX_FALLBACK_CANDIDATES];
+		usize found = 0;
+
+		for (_BalancerBackend* backend : state.m_backends)
+		{
+			if (backend->m_weight <= 0.0)
+				continue;
+
+			f64 score = rendezvous_score(key_hash, *backend);
+
+			if (found == limit && score <= scores[found - 1])
+				continue;
+
+			usize pos = found < limit ? found++ : found - 1;
+
+			while (pos > 0 && scores[pos - 1] < score)
+			{
+				scores[pos] = scores[pos - 1];
+				ranked[pos] = ranked[pos - 1];
+				--pos;
+			}
+
+			scores[pos] = score;
+			ranked[pos] = backend;
+		}
+
+		return found;
+	}
+
+	static usize find_backend(const _BalancerState& state, const SockAddr& addr) noexcept
+	{
+		for (usize i = 0; i < state.m_backends.size(); ++i)
+			if (state.m_backends[i]->m_addr == addr)
+				return i;
+
+		return state.m_backends.size();
+	}
+
+	static void release_backend(_BalancerBackend* backend) noexcept
+	{
+		if (backend->m_refs.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
+			delete backend;
+	}
+
+	BackendLease::BackendLease(_BalancerBackend* backend) noexcept
+		: m_backend{ backend }
+	{
+	}
+
+	BackendLease::BackendLease(BackendLease&& other) noexcept
+		: m_backend{ other.m_backend }
+	{
+		other.m_backend = nullptr;
+	}
+
+	BackendLease::~BackendLease()
+	{
+		release();
+	}
+
+	const SockAddr& BackendLease::addr() const noexcept
+	{
+		return m_backend->m_addr;
+	}
+
+	u64 BackendLease::outstanding() const noexcept
+	{
+		return m_backend->m_outstanding.load(::std::memory_order_relaxed);
+	}
+
+	void BackendLease::release() noexcept
+	{
+		if (m_backend == nullptr)
+			return;
+
+		m_backend->m_outstanding.fetch_sub(1, ::std::memory_order_relaxed);
+		release_backend(m_backend);
+		m_backend = nullptr;
+	}
+
+	Balancer::Balancer(const BalancerConfig& config)
+		: m_state{ new _BalancerState{} }
+	{
+		m_state->m_config = config;
+
+		if (m_state->m_config.fallback_candidates == 0)
+			m_state->m_config.fallback_candidates = 1;
+
+		if (m_state->m_config.fallback_candidates > MAX_FALLBACK_CANDIDATES)
+			m_state->m_config.fallback_candidates = MAX_FALLBACK_CANDIDATES;
+	}
+
+	Balancer::Balancer(Balancer&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	Balancer::~Balancer()
+	{
+		if (m_state == nullptr)
+			return;
+
+		for (_BalancerBackend* backend : m_state->m_backends)
+			release_backend(backend);
+
+		delete m_state;
+	}
+
+	void Balancer::add(const SockAddr& addr, f64 weight)
+	{
+		::std::unique_lock<::std::shared_mutex> lock{ m_state->m_mutex };
+
+		::std::vector<_BalancerBackend*>& backends = m_state->m_backends;
+		usize index = find_backend(*m_state, addr);
+
+		if (index != backends.size())
+		{
+			backends[index]->m_weight = weight;
+			return;
+		}
+
+		backends.push_back(new _BalancerBackend{ addr, Hash<SockAddr>{}(addr), weight, 0, 1 });
+	}
+
+	bool Balancer::remove(const SockAddr& addr)
+	{
+		::std::unique_lock<::std::shared_mutex> lock{ m_state->m_mutex };
+
+		::std::vector<_BalancerBackend*>& backends = m_state->m_backends;
+		usize index = find_backend(*m_state, addr);
+
+		if (index == backends.size())
+			return false;
+
+		_BalancerBackend* backend = backends[index];
+
+		backends[index] = backends.back();
+		backends.pop_back();
+
+		release_backend(backend);
+
+		return true;
+	}
+
+	usize Balancer::size() const noexcept
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_backends.size();
+	}
+
+	u64 Balancer::fallbacks() const noexcept
+	{
+		return m_state->m_fallbacks.load(::std::memory_order_relaxed);
+	}
+
+	u64 Balancer::outstanding(const SockAddr& addr) const noexcept
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ m_state->m_mutex };
+
+		usize index = find_backend(*m_state, addr);
+
+		if (index == m_state->m_backends.size())
+			return 0;
+
+		return m_state->m_backends[index]->m_outstanding.load(::std::memory_order_relaxed);
+	}
+
+	Maybe<SockAddr> Balancer::owner_hashed(u64 key_hash) const
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ m_state->m_mutex };
+
+		_BalancerBackend* ranked[1];
+
+		if (rank_backends(*m_state, key_hash, ranked, 1) == 0)
+			return {};
+
+		return ranked[0]->m_addr;
+	}
+
+	Maybe<BackendLease> Balancer::pick_hashed(u64 key_hash)
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ m_state->m_mutex };
+
+		const BalancerConfig& config = m_state->m_config;
+		_BalancerBackend* ranked[MAX_FALLBACK_CANDIDATES];
+
+		usize limit = config.max_outstanding != 0 ? config.fallback_candidates : 1;
+		usize found = rank_backends(*m_state, key_hash, ranked, limit);
+
+		if (found == 0)
+			return {};
+
+		_BalancerBackend* chosen = ranked[0];
+		u64 least = chosen->m_outstanding.load(::std::memory_order_relaxed);
+
+		if (config.max_outstanding != 0 && least >= config.max_outstanding)
+		{
+			for (usize i = 1; i < found; ++i)
+			{
+				u64 outstanding = ranked[i]->m_outstanding.load(::std::memory_order_relaxed);
+
+				if (outstanding < least)
+				{
+					chosen = ranked[i];
+					least = outstanding;
+				}
+			}
+
+			if (chosen != ranked[0])
+				m_state->m_fallbacks.fetch_add(1, ::std::memory_order_relaxed);
+		}
+
+		chosen->m_outstanding.fetch_add(1, ::std::memory_order_relaxed);
+		chosen->m_refs.fetch_add(1, ::std::memory_order_relaxed);
+
+		return BackendLease{ chosen };
+	}
+}
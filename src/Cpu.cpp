@@ -0,0 +1,47 @@
+#include "Cpu.hpp"
+
+#include <intrin.h>
+
+namespace bsl::cpu
+{
+	static Features detect() noexcept
+	{
+		Features result{};
+
+		int info[4];
+		::__cpuid(info, 0);
+
+		int max_leaf = info[0];
+
+		if (max_leaf < 1)
+			return result;
+
+		::__cpuid(info, 1);
+
+		result.sse2 = (info[3] & (1 << 26)) != 0;
+		result.ssse3 = (info[2] & (1 << 9)) != 0;
+		result.sse41 = (info[2] & (1 << 19)) != 0;
+		result.sse42 = (info[2] & (1 << 20)) != 0;
+		result.popcnt = (info[2] & (1 << 23)) != 0;
+
+		bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+			(::_xgetbv(0) & 0x6) == 0x6;
+
+		if (max_leaf >= 7)
+		{
+			::__cpuidex(info, 7, 0);
+
+			result.avx2 = os_avx && (info[1] & (1 << 5)) != 0;
+			result.bmi2 = (info[1] & (1 << 8)) != 0;
+		}
+
+		return result;
+	}
+
+	const Features& features() noexcept
+	{
+		static const Features detected = detect();
+
+		return detected;
+	}
+}
@@ -0,0 +1,342 @@
+#include "Framed.hpp"
+#include "Lz4.hpp"
+#include "StreamIo.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace bsl::net
+{
+	static constexpr u32 FRAME_COMPRESSED = 0x80000000u;
+	static constexpr usize FRAME_RAW_LENGTH_SIZE = 4;
+	static constexpr usize FRAME_READ_CHUNK = 64 << 10;
+
+	struct _FramedStreamState
+	{
+		FrameConfig m_config;
+		FrameStats m_stats;
+
+		::std::vector<u8> m_tx;
+		::std::vector<u8> m_rx;
+
+		usize m_rx_begin;
+		usize m_rx_end;
+
+		bool m_tx_failed;
+		bool m_rx_failed;
+		SocketSendError m_tx_error;
+		SocketReceiveError m_rx_error;
+	};
+
+	FramedStream::FramedStream(Socket& sock, const FrameConfig& config)
+		: m_sock{ &sock }, m_state{ new _FramedStreamState{} }
+	{
+		m_state->m_config = config;
+
+		if (m_state->m_config.max_frame > LZ4_MAX_INPUT_SIZE)
+			m_state->m_config.max_frame = LZ4_MAX_INPUT_SIZE;
+
+		if (m_state->m_config.min_compress_bytes <= FRAME_RAW_LENGTH_SIZE + 1)
+			m_state->m_config.min_compress_bytes = FRAME_RAW_LENGTH_SIZE + 2;
+
+		m_state->m_rx.resize(FRAME_READ_CHUNK);
+	}
+
+	FramedStream::FramedStream(FramedStream&& other) noexcept
+		: m_sock{ other.m_sock }, m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	FramedStream::~FramedStream()
+	{
+		delete m_state;
+	}
+
+	FrameCompression FramedStream::compression() const noexcept
+	{
+		return m_state->m_config.compression;
+	}
+
+	void FramedStream::set_compression(FrameCompression compression) noexcept
+	{
+		m_state->m_config.compression = compression;
+	}
+
+	FrameStats FramedStream::stats() const noexcept
+	{
+		return m_state->m_stats;
+	}
+
+	Result<Unit, SocketSendError> FramedStream::send_all(const u8* buffer, usize length)
+	{
+		_FramedStreamState& state = *m_state;
+		IoSlice slice{ buffer, length };
+
+		Result<Unit, SocketSendError> result = _write_slices(*m_sock, &slice, 1);
+
+		if (result.is_error())
+		{
+			SocketSendError error = result.expect_error();
+
+			if (slice.length != length)
+			{
+				state.m_tx_failed = true;
+				state.m_tx_error = error;
+			}
+
+			return error;
+		}
+
+		return Unit{};
+	}
+
+	Result<usize, SocketReceiveError> FramedStream::recv_some(u8* buffer, usize length)
+	{
+		for (;;)
+		{
+			Result<usize, SocketReceiveError> result = m_sock->recv(buffer, length);
+
+			if (result.is_ok())
+				return result.expect();
+
+			SocketReceiveError error = result.expect_error();
+
+			if (!error.would_block())
+				return error;
+
+			Result<bool, SocketError> ready = m_sock->wait_readable(0);
+
+			if (ready.is_error())
+			{
+				SocketError wait_error = ready.expect_error();
+				return SocketReceiveError{ wait_error.kind(), wait_error.native_code() };
+			}
+		}
+	}
+
+	Result<Unit, SocketReceiveError> FramedStream::fill(usize length)
+	{
+		_FramedStreamState& state = *m_state;
+
+		if (state.m_rx_end - state.m_rx_begin >= length)
+			return Unit{};
+
+		if (state.m_rx_begin + length > state.m_rx.size())
+		{
+			::std::memmove(state.m_rx.data(), state.m_rx.data() + state.m_rx_begin, state.m_rx_end - state.m_rx_begin);
+			state.m_rx_end -= state.m_rx_begin;
+			state.m_rx_begin = 0;
+
+			if (length > state.m_rx.size())
+				state.m_rx.resize(length);
+		}
+
+		while (state.m_rx_end - state.m_rx_begin < length)
+		{
+			Result<usize, SocketReceiveError> result = recv_some(state.m_rx.data() + state.m_rx_end, state.m_rx.size() - state.m_rx_end);
+
+			if (result.is_error())
+				return result.expect_error();
+
+			usize received = result.expect();
+
+			if (received == 0)
+				return SocketReceiveError{ NetErrorKind::CLOSED };
+
+			state.m_rx_end += received;
+		}
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketSendError> FramedStream::send_frame(const u8* buffer, usize length)
+	{
+		_FramedStreamState& state = *m_state;
+
+		if (state.m_tx_failed)
+			return SocketSendError{ state.m_tx_error };
+
+		if (length > state.m_config.max_frame)
+			return SocketSendError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		usize body = length;
+		u32 flags = 0;
+
+		if (state.m_config.compression == FrameCompression::LZ4 && length >= state.m_config.min_compress_bytes)
+		{
+			state.m_tx.resize(HEADER_SIZE + FRAME_RAW_LENGTH_SIZE + length);
+
+			Result<usize, CompressionError> packed = lz4_compress(
+				buffer,
+				length,
+				state.m_tx.data() + HEADER_SIZE + FRAME_RAW_LENGTH_SIZE,
+				length - FRAME_RAW_LENGTH_SIZE - 1);
+
+			if (packed.is_ok())
+			{
+				body = FRAME_RAW_LENGTH_SIZE + packed.expect();
+				flags = FRAME_COMPRESSED;
+
+				_store_u32(state.m_tx.data() + HEADER_SIZE, static_cast<u32>(length));
+				++state.m_stats.compressed_frames;
+			}
+			else
+			{
+				++state.m_stats.incompressible_frames;
+			}
+		}
+
+		if (flags == 0)
+		{
+			state.m_tx.resize(HEADER_SIZE + length);
+
+			if (length != 0)
+				::std::memcpy(state.m_tx.data() + HEADER_SIZE, buffer, length);
+		}
+
+		_store_u32(state.m_tx.data(), static_cast<u32>(body) | flags);
+
+		Result<Unit, SocketSendError> result = send_all(state.m_tx.data(), HEADER_SIZE + body);
+
+		if (result.is_error())
+			return result.expect_error();
+
+		++state.m_stats.frames_sent;
+		state.m_stats.payload_bytes_sent += length;
+		state.m_stats.wire_bytes_sent += HEADER_SIZE + body;
+
+		return Unit{};
+	}
+
+	Result<usize, SocketReceiveError> FramedStream::next_frame_size()
+	{
+		_FramedStreamState& state = *m_state;
+
+		if (state.m_rx_failed)
+			return SocketReceiveError{ state.m_rx_error };
+
+		Result<Unit, SocketReceiveError> header_result = fill(HEADER_SIZE);
+
+		if (header_result.is_error())
+			return header_result.expect_error();
+
+		u32 header = _load_u32(state.m_rx.data() + state.m_rx_begin);
+		usize body = header & ~FRAME_COMPRESSED;
+
+		if ((header & FRAME_COMPRESSED) == 0)
+		{
+			if (body > state.m_config.max_frame)
+				return SocketReceiveError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+			return body;
+		}
+
+		if (body <= FRAME_RAW_LENGTH_SIZE || body > FRAME_RAW_LENGTH_SIZE + lz4_compress_bound(state.m_config.max_frame))
+			return SocketReceiveError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		Result<Unit, SocketReceiveError> length_result = fill(HEADER_SIZE + FRAME_RAW_LENGTH_SIZE);
+
+		if (length_result.is_error())
+			return length_result.expect_error();
+
+		usize length = _load_u32(state.m_rx.data() + state.m_rx_begin + HEADER_SIZE);
+
+		if (length > state.m_config.max_frame)
+			return SocketReceiveError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		return length;
+	}
+
+	Result<usize, SocketReceiveError> FramedStream::recv_frame(u8* buffer, usize capacity)
+	{
+		_FramedStreamState& state = *m_state;
+
+		Result<usize, SocketReceiveError> size = next_frame_size();
+
+		if (size.is_error())
+			return size.expect_error();
+
+		usize length = size.expect();
+
+		if (length > capacity)
+			return SocketReceiveError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		u32 header = _load_u32(state.m_rx.data() + state.m_rx_begin);
+		usize body = header & ~FRAME_COMPRESSED;
+
+		if ((header & FRAME_COMPRESSED) != 0)
+		{
+			Result<Unit, SocketReceiveError> body_result = fill(HEADER_SIZE + body);
+
+			if (body_result.is_error())
+				return body_result.expect_error();
+
+			Result<usize, CompressionError> unpacked = lz4_decompress(
+				state.m_rx.data() + state.m_rx_begin + HEADER_SIZE + FRAME_RAW_LENGTH_SIZE,
+				body - FRAME_RAW_LENGTH_SIZE,
+				buffer,
+				length);
+
+			state.m_rx_begin += HEADER_SIZE + body;
+
+			if (unpacked.is_error() || unpacked.expect() != length)
+				return SocketReceiveError{ NetErrorKind::INVALID_ARGUMENT };
+		}
+		else if (body <= FRAME_READ_CHUNK)
+		{
+			Result<Unit, SocketReceiveError> body_result = fill(HEADER_SIZE + body);
+
+			if (body_result.is_error())
+				return body_result.expect_error();
+
+			if (body != 0)
+				::std::memcpy(buffer, state.m_rx.data() + state.m_rx_begin + HEADER_SIZE, body);
+
+			state.m_rx_begin += HEADER_SIZE + body;
+		}
+		else
+		{
+			usize buffered = state.m_rx_end - state.m_rx_begin - HEADER_SIZE;
+
+			if (buffered > body)
+				buffered = body;
+
+			::std::memcpy(buffer, state.m_rx.data() + state.m_rx_begin + HEADER_SIZE, buffered);
+			state.m_rx_begin += HEADER_SIZE + buffered;
+
+			while (buffered < body)
+			{
+				Result<usize, SocketReceiveError> result = recv_some(buffer + buffered, body - buffered);
+				usize received = 0;
+
+				if (result.is_ok())
+					received = result.expect();
+
+				if (result.is_error() || received == 0)
+				{
+					SocketReceiveError error = result.is_error() ? result.expect_error() : SocketReceiveError{ NetErrorKind::CLOSED };
+
+					state.m_rx_failed = true;
+					state.m_rx_error = error;
+
+					return error;
+				}
+
+				buffered += received;
+			}
+		}
+
+		if (state.m_rx_begin == state.m_rx_end)
+		{
+			state.m_rx_begin = 0;
+			state.m_rx_end = 0;
+		}
+
+		++state.m_stats.frames_received;
+		state.m_stats.payload_bytes_received += length;
+		state.m_stats.wire_bytes_received += HEADER_SIZE + body;
+
+		return length;
+	}
+}
@@ -0,0 +1,31 @@
+#include "Hash.hpp"
+
+#include <atomic>
+
+#include <Windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+
+namespace bsl
+{
+	static u64 process_secret() noexcept
+	{
+		u64 secret = 0;
+
+		if (!BCRYPT_SUCCESS(::BCryptGenRandom(NULL, reinterpret_cast<::PUCHAR>(&secret), sizeof(secret), BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+			secret = hash_mix(HASH_SEED ^ static_cast<u64>(::GetTickCount64()) ^ (static_cast<u64>(::GetCurrentProcessId()) << 32));
+
+		return secret;
+	}
+
+	u64 hash_random_seed() noexcept
+	{
+		static const u64 secret = process_secret();
+		static ::std::atomic<u64> counter{ 0 };
+
+		u64 index = counter.fetch_add(1, ::std::memory_order_relaxed);
+
+		return hash_mix(secret + index * HASH_SEED);
+	}
+}
@@ -0,0 +1,788 @@
+#include "IntCodec.hpp"
+#include "Cpu.hpp"
+#include "Sequence.hpp"
+
+#include <bit>
+#include <cstring>
+
+#include <intrin.h>
+
+namespace bsl
+{
+	static constexpr u64 VARINT_STOP_BITS = 0x8080808080808080ull;
+
+	static constexpr usize BITPACK_LANES = 4;
+	static constexpr usize BITPACK_LANE_VALUES = BITPACK_BLOCK_SIZE / BITPACK_LANES;
+
+	struct _GroupVarintEntry
+	{
+		alignas(16) u8 shuffle[16];
+		u8 length;
+	};
+
+	struct _GroupVarintTable
+	{
+		_GroupVarintEntry entries[256];
+
+		constexpr _GroupVarintTable()
+			: entries{}
+		{
+			for (usize control = 0; control < 256; ++control)
+			{
+				_GroupVarintEntry& entry = entries[control];
+				usize start = 0;
+
+				for (usize value = 0; value < 4; ++value)
+				{
+					usize length = ((control >> (2 * value)) & 3) + 1;
+
+					for (usize byte = 0; byte < 4; ++byte)
+						entry.shuffle[4 * value + byte] = byte < length ? static_cast<u8>(start + byte) : 0x80;
+
+					start += length;
+				}
+
+				entry.length = static_cast<u8>(start);
+			}
+		}
+	};
+
+	static constexpr _GroupVarintTable GROUP_VARINT_TABLE{};
+
+	static constexpr usize VARINT_PAIR_PATTERNS = 64;
+	static constexpr usize VARINT_TRIPLE_PATTERNS = 81;
+	static constexpr usize VARINT_MASK_BITS = 12;
+
+	struct _VarintPattern
+	{
+		alignas(16) u8 shuffle[16];
+	};
+
+	struct _VarintMaskEntry
+	{
+		u8 pattern;
+		u8 consumed;
+		u8 count;
+	};
+
+	struct _VarintMaskTable
+	{
+		_VarintPattern patterns[VARINT_PAIR_PATTERNS + VARINT_TRIPLE_PATTERNS];
+		_VarintMaskEntry entries[1 << VARINT_MASK_BITS];
+
+		constexpr _VarintMaskTable()
+			: patterns{}, entries{}
+		{
+			for (usize id = 0; id < VARINT_PAIR_PATTERNS; ++id)
+			{
+				u8* shuffle = patterns[id].shuffle;
+				usize start = 0;
+
+				for (usize byte = 0; byte < 16; ++byte)
+					shuffle[byte] = 0x80;
+
+				for (usize value = 0; value < 6; ++value)
+				{
+					usize length = 1 + ((id >> value) & 1);
+
+					shuffle[2 * value] = static_cast<u8>(start);
+					shuffle[2 * value + 1] = length == 2 ? static_cast<u8>(start + 1) : 0x80;
+
+					start += length;
+				}
+			}
+
+			for (usize id = 0; id < VARINT_TRIPLE_PATTERNS; ++id)
+			{
+				u8* shuffle = patterns[VARINT_PAIR_PATTERNS + id].shuffle;
+				usize start = 0;
+				usize digits = id;
+
+				for (usize value = 0; value < 4; ++value)
+				{
+					usize length = digits % 3 + 1;
+					digits /= 3;
+
+					for (usize byte = 0; byte < 4; ++byte)
+						shuffle[4 * value + byte] = byte < length ? static_cast<u8>(start + byte) : 0x80;
+
+					start += length;
+				}
+			}
+
+			for (usize mask = 0; mask < (1 << VARINT_MASK_BITS); ++mask)
+			{
+				usize lengths[VARINT_MASK_BITS] = {};
+				usize found = 0;
+				usize start = 0;
+
+				for (usize byte = 0; byte < VARINT_MASK_BITS; ++byte)
+				{
+					if ((mask >> byte) & 1)
+						continue;
+
+					lengths[found++] = byte + 1 - start;
+					start = byte + 1;
+				}
+
+				_VarintMaskEntry& entry = entries[mask];
+				usize pair_id = 0;
+				usize pair_bytes = 0;
+				bool pairs = found >= 6;
+
+				for (usize value = 0; pairs && value < 6; ++value)
+				{
+					pairs = lengths[value] <= 2;
+					pair_id |= (lengths[value] - 1) << value;
+					pair_bytes += lengths[value];
+				}
+
+				if (pairs)
+				{
+					entry = _VarintMaskEntry{ static_cast<u8>(pair_id), static_cast<u8>(pair_bytes), 6 };
+					continue;
+				}
+
+				usize triple_id = 0;
+				usize triple_bytes = 0;
+				usize scale = 1;
+				bool triples = found >= 4;
+
+				for (usize value = 0; triples && value < 4; ++value)
+				{
+					triples = lengths[value] <= 3;
+					triple_id += (lengths[value] - 1) * scale;
+					triple_bytes += lengths[value];
+					scale *= 3;
+				}
+
+				if (triples)
+					entry = _VarintMaskEntry{ static_cast<u8>(VARINT_PAIR_PATTERNS + triple_id), static_cast<u8>(triple_bytes), 4 };
+			}
+		}
+	};
+
+	static constexpr _VarintMaskTable VARINT_MASK_TABLE{};
+
+	static u32 load_u32(const u8* ptr) noexcept
+	{
+		u32 value;
+		::std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static u64 load_u64(const u8* ptr) noexcept
+	{
+		u64 value;
+		::std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static void store_u32(u8* ptr, u32 value) noexcept
+	{
+		::std::memcpy(ptr, &value, sizeof(value));
+	}
+
+	static void store_u64(u8* ptr, u64 value) noexcept
+	{
+		::std::memcpy(ptr, &value, sizeof(value));
+	}
+
+	static u64 varint_compact(u64 word) noexcept
+	{
+		return (word & 0x7Full) |
+			((word >> 1) & (0x7Full << 7)) |
+			((word >> 2) & (0x7Full << 14)) |
+			((word >> 3) & (0x7Full << 21)) |
+			((word >> 4) & (0x7Full << 28)) |
+			((word >> 5) & (0x7Full << 35)) |
+			((word >> 6) & (0x7Full << 42)) |
+			((word >> 7) & (0x7Full << 49));
+	}
+
+	usize varint_encode(u64 value, u8* out) noexcept
+	{
+		usize length = 0;
+
+		while (value >= 0x80)
+		{
+			out[length++] = static_cast<u8>(value) | 0x80;
+			value >>= 7;
+		}
+
+		out[length++] = static_cast<u8>(value);
+
+		return length;
+	}
+
+	usize varint_decode(const u8* in, usize length, u64& value) noexcept
+	{
+		u64 result = 0;
+
+		for (usize i = 0; i < length && i < VARINT64_MAX_BYTES; ++i)
+		{
+			u64 byte = in[i];
+
+			if (i == VARINT64_MAX_BYTES - 1 && byte > 1)
+				return 0;
+
+			result |= (byte & 0x7F) << (7 * i);
+
+			if (byte < 0x80)
+			{
+				value = result;
+				return i + 1;
+			}
+		}
+
+		return 0;
+	}
+
+	template<class T>
+	static usize varint_encode_array(const T* values, usize count, u8* out) noexcept
+	{
+		u8* op = out;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			u64 value = values[i];
+
+			if (value < 0x80)
+				*op++ = static_cast<u8>(value);
+			else
+				op += varint_encode(value, op);
+		}
+
+		return static_cast<usize>(op - out);
+	}
+
+	template<class T>
+	static void widen_bytes_sse2(__m128i bytes, T* values) noexcept
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i words = _mm_unpacklo_epi8(bytes, zero);
+		__m128i low = _mm_unpacklo_epi16(words, zero);
+		__m128i high = _mm_unpackhi_epi16(words, zero);
+
+		if constexpr (sizeof(T) == sizeof(u32))
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values), low);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + 4), high);
+		}
+		else
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_unpacklo_epi32(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + 2), _mm_unpackhi_epi32(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + 4), _mm_unpacklo_epi32(high, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + 6), _mm_unpackhi_epi32(high, zero));
+		}
+	}
+
+	template<class T>
+	static void store_lanes_sse2(__m128i lanes, T* values) noexcept
+	{
+		if constexpr (sizeof(T) == sizeof(u32))
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values), lanes);
+		}
+		else
+		{
+			__m128i zero = _mm_setzero_si128();
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_unpacklo_epi32(lanes, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + 2), _mm_unpackhi_epi32(lanes, zero));
+		}
+	}
+
+	template<class T>
+	static usize varint_decode_masked_ssse3(__m128i chunk, u32 continuation, T* values, usize& consumed) noexcept
+	{
+		const _VarintMaskEntry& entry = VARINT_MASK_TABLE.entries[continuation & ((1 << VARINT_MASK_BITS) - 1)];
+
+		if (entry.count == 0)
+			return 0;
+
+		__m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(VARINT_MASK_TABLE.patterns[entry.pattern].shuffle));
+		__m128i bytes = _mm_shuffle_epi8(chunk, shuffle);
+
+		if (entry.count == 6)
+		{
+			__m128i low = _mm_and_si128(bytes, _mm_set1_epi16(0x007F));
+			__m128i high = _mm_srli_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x7F00)), 1);
+			__m128i words = _mm_or_si128(low, high);
+			__m128i zero = _mm_setzero_si128();
+
+			store_lanes_sse2(_mm_unpacklo_epi16(words, zero), values);
+			store_lanes_sse2(_mm_unpackhi_epi16(words, zero), values + 4);
+		}
+		else
+		{
+			__m128i first = _mm_and_si128(bytes, _mm_set1_epi32(0x7F));
+			__m128i second = _mm_srli_epi32(_mm_and_si128(bytes, _mm_set1_epi32(0x7F00)), 1);
+			__m128i third = _mm_srli_epi32(_mm_and_si128(bytes, _mm_set1_epi32(0x7F0000)), 2);
+
+			store_lanes_sse2(_mm_or_si128(_mm_or_si128(first, second), third), values);
+		}
+
+		consumed = entry.consumed;
+
+		return entry.count;
+	}
+
+	template<class T, bool Ssse3>
+	static Maybe<usize> varint_decode_array(const u8* in, usize length, T* values, usize count) noexcept
+	{
+		constexpr usize max_bytes = sizeof(T) == sizeof(u32) ? VARINT32_MAX_BYTES : VARINT64_MAX_BYTES;
+
+		usize pos = 0;
+		usize i = 0;
+
+		while (i < count)
+		{
+			if (length - pos >= 16 && count - i >= 8)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos));
+				u32 continuation = static_cast<u32>(_mm_movemask_epi8(chunk));
+
+				if ((continuation & 0xFF) == 0)
+				{
+					widen_bytes_sse2(chunk, values + i);
+
+					if (continuation == 0 && count - i >= 16)
+					{
+						widen_bytes_sse2(_mm_srli_si128(chunk, 8), values + i + 8);
+
+						pos += 16;
+						i += 16;
+						continue;
+					}
+
+					pos += 8;
+					i += 8;
+					continue;
+				}
+
+				if constexpr (Ssse3)
+				{
+					usize consumed;
+					usize decoded = varint_decode_masked_ssse3(chunk, continuation, values + i, consumed);
+
+					if (decoded != 0)
+					{
+						pos += consumed;
+						i += decoded;
+						continue;
+					}
+				}
+			}
+
+			if (length - pos >= sizeof(u64))
+			{
+				u64 word = load_u64(in + pos);
+				u64 stops = ~word & VARINT_STOP_BITS;
+
+				if (stops != 0)
+				{
+					usize bytes = static_cast<usize>(::std::countr_zero(stops)) / 8 + 1;
+
+					if (bytes > max_bytes)
+						return {};
+
+					if (bytes < sizeof(u64))
+						word &= (1ull << (8 * bytes)) - 1;
+
+					if constexpr (sizeof(T) == sizeof(u32))
+						if (bytes == VARINT32_MAX_BYTES && in[pos + 4] > 0x0F)
+							return {};
+
+					values[i++] = static_cast<T>(varint_compact(word));
+					pos += bytes;
+					continue;
+				}
+			}
+
+			u64 value;
+			usize bytes = varint_decode(in + pos, length - pos, value);
+
+			if (bytes == 0 || bytes > max_bytes)
+				return {};
+
+			if constexpr (sizeof(T) == sizeof(u32))
+				if (value > 0xFFFFFFFFull)
+					return {};
+
+			values[i++] = static_cast<T>(value);
+			pos += bytes;
+		}
+
+		return pos;
+	}
+
+	usize varint_encode_u32(const u32* values, usize count, u8* out) noexcept
+	{
+		return varint_encode_array(values, count, out);
+	}
+
+	usize varint_encode_u64(const u64* values, usize count, u8* out) noexcept
+	{
+		return varint_encode_array(values, count, out);
+	}
+
+	Maybe<usize> varint_decode_u32(const u8* in, usize length, u32* values, usize count) noexcept
+	{
+		if (cpu::has_ssse3())
+			return varint_decode_array<u32, true>(in, length, values, count);
+
+		return varint_decode_array<u32, false>(in, length, values, count);
+	}
+
+	Maybe<usize> varint_decode_u64(const u8* in, usize length, u64* values, usize count) noexcept
+	{
+		if (cpu::has_ssse3())
+			return varint_decode_array<u64, true>(in, length, values, count);
+
+		return varint_decode_array<u64, false>(in, length, values, count);
+	}
+
+	usize group_varint_encode(const u32* values, usize count, u8* out) noexcept
+	{
+		u8* control = out;
+		u8* op = out + (count + 3) / 4;
+
+		for (usize i = 0; i < count; i += 4)
+		{
+			usize group = count - i < 4 ? count - i : 4;
+			u32 lengths = 0;
+
+			for (usize k = 0; k < group; ++k)
+			{
+				u32 value = values[i + k];
+				u32 bytes = (static_cast<u32>(::std::bit_width(value | 1)) + 7) / 8;
+
+				store_u32(op, value);
+				op += bytes;
+				lengths |= (bytes - 1) << (2 * k);
+			}
+
+			*control++ = static_cast<u8>(lengths);
+		}
+
+		return static_cast<usize>(op - out);
+	}
+
+	static void group_varint_decode_ssse3(const u8*& control, const u8*& ip, const u8* iend, u32* values, usize& i, usize count) noexcept
+	{
+		while (count - i >= 4 && iend - ip >= 16)
+		{
+			const _GroupVarintEntry& entry = GROUP_VARINT_TABLE.entries[*control++];
+
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ip));
+			__m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(entry.shuffle));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_shuffle_epi8(data, shuffle));
+
+			ip += entry.length;
+			i += 4;
+		}
+	}
+
+	Maybe<usize> group_varint_decode(const u8* in, usize length, u32* values, usize count) noexcept
+	{
+		usize controls = (count + 3) / 4;
+
+		if (length < controls)
+			return {};
+
+		const u8* control = in;
+		const u8* ip = in + controls;
+		const u8* const iend = in + length;
+		usize i = 0;
+
+		if (cpu::has_ssse3())
+			group_varint_decode_ssse3(control, ip, iend, values, i, count);
+
+		while (i < count)
+		{
+			u32 lengths = *control++;
+			usize group = count - i < 4 ? count - i : 4;
+
+			for (usize k = 0; k < group; ++k)
+			{
+				usize bytes = ((lengths >> (2 * k)) & 3) + 1;
+
+				if (static_cast<usize>(iend - ip) < bytes)
+					return {};
+
+				u32 value = 0;
+				::std::memcpy(&value, ip, bytes);
+
+				values[i + k] = value;
+				ip += bytes;
+			}
+
+			i += group;
+		}
+
+		return static_cast<usize>(ip - in);
+	}
+
+	template<class T>
+	static void bitpack_range(const T* values, usize count, T& low, u32& bits) noexcept
+	{
+		T min = values[0];
+		T max = values[0];
+
+		for (usize i = 1; i < count; ++i)
+		{
+			min = values[i] < min ? values[i] : min;
+			max = values[i] > max ? values[i] : max;
+		}
+
+		low = min;
+		bits = static_cast<u32>(::std::bit_width(max - min));
+	}
+
+	template<class T>
+	static void pack_horizontal(const T* values, usize count, T reference, u32 bits, u8* out) noexcept
+	{
+		::std::memset(out, 0, (count * bits + 7) / 8);
+
+		if (bits == 0)
+			return;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			u64 value = values[i] - reference;
+			usize bitpos = i * bits;
+			usize byte = bitpos / 8;
+			u32 shift = bitpos % 8;
+
+			out[byte++] |= static_cast<u8>(value << shift);
+			value >>= 8 - shift;
+
+			for (u32 written = 8 - shift; written < bits; written += 8)
+			{
+				out[byte++] |= static_cast<u8>(value);
+				value >>= 8;
+			}
+		}
+	}
+
+	static u64 read_bits(const u8* in, usize bitpos, u32 bits) noexcept
+	{
+		usize byte = bitpos / 8;
+		u32 shift = bitpos % 8;
+
+		u64 value = static_cast<u64>(in[byte++]) >> shift;
+
+		for (u32 read = 8 - shift; read < bits; read += 8)
+			value |= static_cast<u64>(in[byte++]) << read;
+
+		return bits == 64 ? value : value & ((1ull << bits) - 1);
+	}
+
+	static void pack_vertical(const u32* values, u32 reference, u32 bits, u8* out) noexcept
+	{
+		u32 words[BITPACK_LANES * BITPACK_LANE_VALUES] = {};
+
+		for (usize k = 0; k < BITPACK_LANE_VALUES; ++k)
+		{
+			usize bitpos = k * bits;
+			usize word = bitpos / 32;
+			u32 shift = bitpos % 32;
+
+			for (usize lane = 0; lane < BITPACK_LANES; ++lane)
+			{
+				u32 value = values[BITPACK_LANES * k + lane] - reference;
+
+				words[BITPACK_LANES * word + lane] |= value << shift;
+
+				if (shift + bits > 32)
+					words[BITPACK_LANES * (word + 1) + lane] |= value >> (32 - shift);
+			}
+		}
+
+		::std::memcpy(out, words, BITPACK_LANES * sizeof(u32) * bits);
+	}
+
+	template<u32 Bits, usize K>
+	static void unpack_lanes_sse2(const __m128i* in, u32* out, __m128i reference) noexcept
+	{
+		constexpr usize bitpos = K * Bits;
+		constexpr usize word = bitpos / 32;
+		constexpr u32 shift = bitpos % 32;
+
+		__m128i value = reference;
+
+		if constexpr (Bits != 0)
+		{
+			value = _mm_srli_epi32(_mm_loadu_si128(in + word), shift);
+
+			if constexpr (shift + Bits > 32)
+				value = _mm_or_si128(value, _mm_slli_epi32(_mm_loadu_si128(in + word + 1), 32 - shift));
+
+			if constexpr (Bits < 32)
+				value = _mm_and_si128(value, _mm_set1_epi32(static_cast<i32>((1u << Bits) - 1)));
+
+			value = _mm_add_epi32(value, reference);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + BITPACK_LANES * K), value);
+	}
+
+	template<u32 Bits, usize... Ks>
+	static void unpack_block_sse2(const u8* in, u32* out, u32 reference, IndexSequence<Ks...>) noexcept
+	{
+		__m128i broadcast = _mm_set1_epi32(static_cast<i32>(reference));
+
+		(unpack_lanes_sse2<Bits, Ks>(reinterpret_cast<const __m128i*>(in), out, broadcast), ...);
+	}
+
+	template<u32 Bits>
+	static void unpack_block(const u8* in, u32* out, u32 reference) noexcept
+	{
+		unpack_block_sse2<Bits>(in, out, reference, MakeIndexSequenceType<BITPACK_LANE_VALUES>{});
+	}
+
+	using _UnpackBlockFn = void (*)(const u8*, u32*, u32) noexcept;
+
+	struct _UnpackBlockTable
+	{
+		_UnpackBlockFn fns[33];
+	};
+
+	template<usize... Bits>
+	static constexpr _UnpackBlockTable make_unpack_table(IndexSequence<Bits...>) noexcept
+	{
+		return _UnpackBlockTable{ { &unpack_block<static_cast<u32>(Bits)>... } };
+	}
+
+	static constexpr _UnpackBlockTable UNPACK_BLOCK_TABLE = make_unpack_table(MakeIndexSequenceType<33>{});
+
+	usize bitpack_encode_u32(const u32* values, usize count, u8* out) noexcept
+	{
+		u8* op = out;
+
+		for (usize i = 0; i < count; i += BITPACK_BLOCK_SIZE)
+		{
+			usize block = count - i < BITPACK_BLOCK_SIZE ? count - i : BITPACK_BLOCK_SIZE;
+			u32 reference;
+			u32 bits;
+
+			bitpack_range(values + i, block, reference, bits);
+
+			store_u32(op, reference);
+			op[sizeof(u32)] = static_cast<u8>(bits);
+			op += sizeof(u32) + 1;
+
+			if (block == BITPACK_BLOCK_SIZE)
+			{
+				pack_vertical(values + i, reference, bits, op);
+				op += BITPACK_LANES * sizeof(u32) * bits;
+			}
+			else
+			{
+				pack_horizontal(values + i, block, reference, bits, op);
+				op += (block * bits + 7) / 8;
+			}
+		}
+
+		return static_cast<usize>(op - out);
+	}
+
+	Maybe<usize> bitpack_decode_u32(const u8* in, usize length, u32* values, usize count) noexcept
+	{
+		const u8* ip = in;
+		const u8* const iend = in + length;
+
+		for (usize i = 0; i < count; i += BITPACK_BLOCK_SIZE)
+		{
+			usize block = count - i < BITPACK_BLOCK_SIZE ? count - i : BITPACK_BLOCK_SIZE;
+
+			if (static_cast<usize>(iend - ip) < sizeof(u32) + 1)
+				return {};
+
+			u32 reference = load_u32(ip);
+			u32 bits = ip[sizeof(u32)];
+			ip += sizeof(u32) + 1;
+
+			if (bits > 32)
+				return {};
+
+			usize payload = block == BITPACK_BLOCK_SIZE ? BITPACK_LANES * sizeof(u32) * bits : (block * bits + 7) / 8;
+
+			if (static_cast<usize>(iend - ip) < payload)
+				return {};
+
+			if (block == BITPACK_BLOCK_SIZE)
+			{
+				UNPACK_BLOCK_TABLE.fns[bits](ip, values + i, reference);
+			}
+			else
+			{
+				for (usize k = 0; k < block; ++k)
+					values[i + k] = reference + (bits == 0 ? 0 : static_cast<u32>(read_bits(ip, k * bits, bits)));
+			}
+
+			ip += payload;
+		}
+
+		return static_cast<usize>(ip - in);
+	}
+
+	usize bitpack_encode_u64(const u64* values, usize count, u8* out) noexcept
+	{
+		u8* op = out;
+
+		for (usize i = 0; i < count; i += BITPACK_BLOCK_SIZE)
+		{
+			usize block = count - i < BITPACK_BLOCK_SIZE ? count - i : BITPACK_BLOCK_SIZE;
+			u64 reference;
+			u32 bits;
+
+			bitpack_range(values + i, block, reference, bits);
+
+			store_u64(op, reference);
+			op[sizeof(u64)] = static_cast<u8>(bits);
+			op += sizeof(u64) + 1;
+
+			pack_horizontal(values + i, block, reference, bits, op);
+			op += (block * bits + 7) / 8;
+		}
+
+		return static_cast<usize>(op - out);
+	}
+
+	Maybe<usize> bitpack_decode_u64(const u8* in, usize length, u64* values, usize count) noexcept
+	{
+		const u8* ip = in;
+		const u8* const iend = in + length;
+
+		for (usize i = 0; i < count; i += BITPACK_BLOCK_SIZE)
+		{
+			usize block = count - i < BITPACK_BLOCK_SIZE ? count - i : BITPACK_BLOCK_SIZE;
+
+			if (static_cast<usize>(iend - ip) < sizeof(u64) + 1)
+				return {};
+
+			u64 reference = load_u64(ip);
+			u32 bits = ip[sizeof(u64)];
+			ip += sizeof(u64) + 1;
+
+			if (bits > 64)
+				return {};
+
+			usize payload = (block * bits + 7) / 8;
+
+			if (static_cast<usize>(iend - ip) < payload)
+				return {};
+
+			for (usize k = 0; k < block; ++k)
+				values[i + k] = reference + (bits == 0 ? 0 : read_bits(ip, k * bits, bits));
+
+			ip += payload;
+		}
+
+		return static_cast<usize>(ip - in);
+	}
+}
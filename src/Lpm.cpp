@@ -0,0 +1,485 @@
+#include "Lpm.hpp"
+#include "SpscRing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bsl::net
+{
+	static constexpr usize LPM_READER_STRIPES = 16;
+	static constexpr usize LPM_INDEX_BITS = 16;
+	static constexpr usize LPM_INDEX_SIZE = (1 << LPM_INDEX_BITS) + 1;
+
+	struct _LpmKey128
+	{
+		u64 high;
+		u64 low;
+
+		[[nodiscard]] bool operator<(const _LpmKey128& rhs) const noexcept
+		{
+			return high < rhs.high || (high == rhs.high && low < rhs.low);
+		}
+
+		[[nodiscard]] bool operator<=(const _LpmKey128& rhs) const noexcept
+		{
+			return !(rhs < *this);
+		}
+
+		[[nodiscard]] bool operator==(const _LpmKey128& rhs) const noexcept
+		{
+			return high == rhs.high && low == rhs.low;
+		}
+	};
+
+	static bool key_next(u32 key, u32& next) noexcept
+	{
+		if (key == ~0u)
+			return false;
+
+		next = key + 1;
+
+		return true;
+	}
+
+	static bool key_next(const _LpmKey128& key, _LpmKey128& next) noexcept
+	{
+		if (key.high == ~0ull && key.low == ~0ull)
+			return false;
+
+		next.low = key.low + 1;
+		next.high = key.high + (next.low == 0 ? 1 : 0);
+
+		return true;
+	}
+
+	template<class Key>
+	struct _LpmPrefix
+	{
+		Key start;
+		Key end;
+		u32 length;
+		u32 value;
+		usize order;
+	};
+
+	template<class Key>
+	static void build_ranges(::std::vector<_LpmPrefix<Key>>& prefixes, ::std::vector<Key>& starts, ::std::vector<u32>& values)
+	{
+		::std::sort(prefixes.begin(), prefixes.end(), [](const _LpmPrefix<Key>& lhs, const _LpmPrefix<Key>& rhs) {
+			if (!(lhs.start == rhs.start))
+				return lhs.start < rhs.start;
+
+			if (lhs.length != rhs.length)
+				return lhs.length < rhs.length;
+
+			return lhs.order < rhs.order;
+		});
+
+		starts.assign(1, Key{});
+		values.assign(1, LpmTableIPv4::NO_VALUE);
+
+		auto emit = [&starts, &values](const Key& start, u32 value) {
+			if (starts.back() == start)
+			{
+				values.back() = value;
+
+				if (starts.size() >= 2 && values[values.size() - 2] == value)
+				{
+					starts.pop_back();
+					values.pop_back();
+				}
+			}
+			else if (values.back() != value)
+			{
+				starts.push_back(start);
+				values.push_back(value);
+			}
+		};
+
+		::std::vector<const _LpmPrefix<Key>*> stack;
+
+		auto unwind = [&stack, &emit](const Key* limit) {
+			while (!stack.empty() && (limit == nullptr || stack.back()->end < *limit))
+			{
+				Key end = stack.back()->end;
+				stack.pop_back();
+
+				Key next;
+
+				if (!key_next(end, next))
+					continue;
+
+				emit(next, stack.empty() ? LpmTableIPv4::NO_VALUE : stack.back()->value);
+			}
+		};
+
+		for (const _LpmPrefix<Key>& prefix : prefixes)
+		{
+			unwind(&prefix.start);
+			emit(prefix.start, prefix.value);
+			stack.push_back(&prefix);
+		}
+
+		unwind(nullptr);
+	}
+
+	struct alignas(CACHE_LINE_SIZE) _LpmReaderCount
+	{
+		::std::atomic<u64> count;
+	};
+
+	template<class Snapshot>
+	struct _LpmState
+	{
+		::std::atomic<Snapshot*> m_current;
+		::std::atomic<u32> m_generation;
+		_LpmReaderCount m_readers[2][LPM_READER_STRIPES];
+		::std::mutex m_writer;
+	};
+
+	static usize reader_stripe() noexcept
+	{
+		static ::std::atomic<usize> next_stripe{ 0 };
+		thread_local usize stripe = next_stripe.fetch_add(1, ::std::memory_order_relaxed) % LPM_READER_STRIPES;
+
+		return stripe;
+	}
+
+	template<class Snapshot>
+	class _LpmReadGuard
+	{
+	private:
+		_LpmState<Snapshot>* m_state;
+		_LpmReaderCount* m_count;
+		const Snapshot* m_snapshot;
+
+	public:
+		explicit _LpmReadGuard(_LpmState<Snapshot>* state) noexcept
+			: m_state{ state }, m_count{ nullptr }, m_snapshot{ nullptr }
+		{
+			usize stripe = reader_stripe();
+
+			while (true)
+			{
+				u32 generation = state->m_generation.load(::std::memory_order_seq_cst);
+				_LpmReaderCount& count = state->m_readers[generation & 1][stripe];
+
+				count.count.fetch_add(1, ::std::memory_order_seq_cst);
+
+				if (state->m_generation.load(::std::memory_order_seq_cst) == generation)
+				{
+					m_count = &count;
+					break;
+				}
+
+				count.count.fetch_sub(1, ::std::memory_order_release);
+			}
+
+			m_snapshot = state->m_current.load(::std::memory_order_seq_cst);
+		}
+
+		_LpmReadGuard(const _LpmReadGuard&) = delete;
+
+		~_LpmReadGuard()
+		{
+			m_count->count.fetch_sub(1, ::std::memory_order_release);
+		}
+
+		[[nodiscard]] const Snapshot& snapshot() const noexcept
+		{
+			return *m_snapshot;
+		}
+	};
+
+	template<class Snapshot>
+	static void publish_snapshot(_LpmState<Snapshot>* state, Snapshot* next)
+	{
+		::std::lock_guard<::std::mutex> lock{ state->m_writer };
+
+		Snapshot* previous = state->m_current.exchange(next, ::std::memory_order_seq_cst);
+		u32 generation = state->m_generation.fetch_add(1, ::std::memory_order_seq_cst);
+
+		for (usize stripe = 0; stripe < LPM_READER_STRIPES; ++stripe)
+			while (state->m_readers[generation & 1][stripe].count.load(::std::memory_order_acquire) != 0)
+				::std::this_thread::yield();
+
+		delete previous;
+	}
+
+	template<class Snapshot>
+	static void destroy_state(_LpmState<Snapshot>* state)
+	{
+		delete state->m_current.load(::std::memory_order_acquire);
+	}
+
+	struct _LpmIPv4Snapshot
+	{
+		::std::vector<u32> m_starts;
+		::std::vector<u32> m_values;
+		u32 m_index[LPM_INDEX_SIZE];
+		usize m_prefixes;
+
+		[[nodiscard]] u32 find(u32 key) const noexcept
+		{
+			usize top = key >> (32 - LPM_INDEX_BITS);
+			usize base = m_index[top];
+			usize length = m_index[top + 1] - base + 1;
+			const u32* starts = m_starts.data();
+
+			while (length > 1)
+			{
+				usize half = length / 2;
+				base = starts[base + half] <= key ? base + half : base;
+				length -= half;
+			}
+
+			return m_values[base];
+		}
+	};
+
+	struct _LpmIPv6Snapshot
+	{
+		::std::vector<_LpmKey128> m_starts;
+		::std::vector<u32> m_values;
+		u32 m_index[LPM_INDEX_SIZE];
+		usize m_prefixes;
+
+		[[nodiscard]] u32 find(const _LpmKey128& key) const noexcept
+		{
+			usize top = static_cast<usize>(key.high >> (64 - LPM_INDEX_BITS));
+			usize base = m_index[top];
+			usize length = m_index[top + 1] - base + 1;
+			const _LpmKey128* starts = m_starts.data();
+
+			while (length > 1)
+			{
+				usize half = length / 2;
+				base = starts[base + half] <= key ? base + half : base;
+				length -= half;
+			}
+
+			return m_values[base];
+		}
+	};
+
+	struct _LpmIPv4State : _LpmState<_LpmIPv4Snapshot>
+	{
+	};
+
+	struct _LpmIPv6State : _LpmState<_LpmIPv6Snapshot>
+	{
+	};
+
+	template<class Snapshot, class BucketStart>
+	static void build_index(Snapshot& snapshot, BucketStart bucket_start)
+	{
+		usize count = snapshot.m_starts.size();
+		usize current = 0;
+
+		for (usize top = 0; top < LPM_INDEX_SIZE - 1; ++top)
+		{
+			while (current + 1 < count && snapshot.m_starts[current + 1] <= bucket_start(top))
+				++current;
+
+			snapshot.m_index[top] = static_cast<u32>(current);
+		}
+
+		snapshot.m_index[LPM_INDEX_SIZE - 1] = static_cast<u32>(count - 1);
+	}
+
+	static _LpmIPv4Snapshot* build_ipv4(const LpmEntryIPv4* entries, usize count)
+	{
+		::std::vector<_LpmPrefix<u32>> prefixes;
+		prefixes.reserve(count);
+
+		for (usize i = 0; i < count; ++i)
+		{
+			const CidrIPv4& prefix = entries[i].prefix;
+
+			prefixes.push_back(_LpmPrefix<u32>{
+				prefix.addr().to_bits(),
+				prefix.last().to_bits(),
+				static_cast<u32>(prefix.length()),
+				entries[i].value,
+				i
+			});
+		}
+
+		_LpmIPv4Snapshot* snapshot = new _LpmIPv4Snapshot{};
+
+		build_ranges(prefixes, snapshot->m_starts, snapshot->m_values);
+
+		snapshot->m_prefixes = count;
+
+		build_index(*snapshot, [](usize top) {
+			return static_cast<u32>(top << (32 - LPM_INDEX_BITS));
+		});
+
+		return snapshot;
+	}
+
+	static _LpmIPv6Snapshot* build_ipv6(const LpmEntryIPv6* entries, usize count)
+	{
+		::std::vector<_LpmPrefix<_LpmKey128>> prefixes;
+		prefixes.reserve(count);
+
+		for (usize i = 0; i < count; ++i)
+		{
+			const CidrIPv6& prefix = entries[i].prefix;
+			AddrIPv6 last = prefix.last();
+
+			prefixes.push_back(_LpmPrefix<_LpmKey128>{
+				_LpmKey128{ prefix.addr().high_bits(), prefix.addr().low_bits() },
+				_LpmKey128{ last.high_bits(), last.low_bits() },
+				static_cast<u32>(prefix.length()),
+				entries[i].value,
+				i
+			});
+		}
+
+		_LpmIPv6Snapshot* snapshot = new _LpmIPv6Snapshot{};
+
+		build_ranges(prefixes, snapshot->m_starts, snapshot->m_values);
+
+		snapshot->m_prefixes = count;
+
+		build_index(*snapshot, [](usize top) {
+			return _LpmKey128{ static_cast<u64>(top) << (64 - LPM_INDEX_BITS), 0 };
+		});
+
+		return snapshot;
+	}
+
+	LpmTableIPv4::LpmTableIPv4()
+		: m_state{ new _LpmIPv4State{} }
+	{
+		m_state->m_current.store(build_ipv4(nullptr, 0), ::std::memory_order_release);
+	}
+
+	LpmTableIPv4::~LpmTableIPv4()
+	{
+		destroy_state(m_state);
+		delete m_state;
+	}
+
+	Result<Unit, LpmError> LpmTableIPv4::rebuild(const LpmEntryIPv4* entries, usize count)
+	{
+		for (usize i = 0; i < count; ++i)
+			if (entries[i].value == NO_VALUE)
+				return LpmError{};
+
+		publish_snapshot(m_state, build_ipv4(entries, count));
+
+		return Unit{};
+	}
+
+	Maybe<u32> LpmTableIPv4::lookup(const AddrIPv4& addr) const noexcept
+	{
+		_LpmReadGuard<_LpmIPv4Snapshot> guard{ m_state };
+
+		u32 value = guard.snapshot().find(addr.to_bits());
+
+		if (value == NO_VALUE)
+			return {};
+
+		return value;
+	}
+
+	usize LpmTableIPv4::lookup_bulk(const AddrIPv4* addrs, usize count, u32* values) const noexcept
+	{
+		_LpmReadGuard<_LpmIPv4Snapshot> guard{ m_state };
+		const _LpmIPv4Snapshot& snapshot = guard.snapshot();
+
+		usize found = 0;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			values[i] = snapshot.find(addrs[i].to_bits());
+			found += values[i] != NO_VALUE ? 1 : 0;
+		}
+
+		return found;
+	}
+
+	usize LpmTableIPv4::prefixes() const noexcept
+	{
+		_LpmReadGuard<_LpmIPv4Snapshot> guard{ m_state };
+
+		return guard.snapshot().m_prefixes;
+	}
+
+	usize LpmTableIPv4::ranges() const noexcept
+	{
+		_LpmReadGuard<_LpmIPv4Snapshot> guard{ m_state };
+
+		return guard.snapshot().m_starts.size();
+	}
+
+	LpmTableIPv6::LpmTableIPv6()
+		: m_state{ new _LpmIPv6State{} }
+	{
+		m_state->m_current.store(build_ipv6(nullptr, 0), ::std::memory_order_release);
+	}
+
+	LpmTableIPv6::~LpmTableIPv6()
+	{
+		destroy_state(m_state);
+		delete m_state;
+	}
+
+	Result<Unit, LpmError> LpmTableIPv6::rebuild(const LpmEntryIPv6* entries, usize count)
+	{
+		for (usize i = 0; i < count; ++i)
+			if (entries[i].value == NO_VALUE)
+				return LpmError{};
+
+		publish_snapshot(m_state, build_ipv6(entries, count));
+
+		return Unit{};
+	}
+
+	Maybe<u32> LpmTableIPv6::lookup(const AddrIPv6& addr) const noexcept
+	{
+		_LpmReadGuard<_LpmIPv6Snapshot> guard{ m_state };
+
+		u32 value = guard.snapshot().find(_LpmKey128{ addr.high_bits(), addr.low_bits() });
+
+		if (value == NO_VALUE)
+			return {};
+
+		return value;
+	}
+
+	usize LpmTableIPv6::lookup_bulk(const AddrIPv6* addrs, usize count, u32* values) const noexcept
+	{
+		_LpmReadGuard<_LpmIPv6Snapshot> guard{ m_state };
+		const _LpmIPv6Snapshot& snapshot = guard.snapshot();
+
+		usize found = 0;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			values[i] = snapshot.find(_LpmKey128{ addrs[i].high_bits(), addrs[i].low_bits() });
+			found += values[i] != NO_VALUE ? 1 : 0;
+		}
+
+		return found;
+	}
+
+	usize LpmTableIPv6::prefixes() const noexcept
+	{
+		_LpmReadGuard<_LpmIPv6Snapshot> guard{ m_state };
+
+		return guard.snapshot().m_prefixes;
+	}
+
+	usize LpmTableIPv6::ranges() const noexcept
+	{
+		_LpmReadGuard<_LpmIPv6Snapshot> guard{ m_state };
+
+		return guard.snapshot().m_starts.size();
+	}
+}
@@ -0,0 +1,366 @@
+#include "Lz4.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace bsl::net
+{
+	static constexpr usize LZ4_MIN_MATCH = 4;
+	static constexpr usize LZ4_LAST_LITERALS = 5;
+	static constexpr usize LZ4_MATCH_FIND_LIMIT = 12;
+	static constexpr usize LZ4_MAX_DISTANCE = 65535;
+	static constexpr usize LZ4_WILD_COPY = 32;
+
+	static constexpr u32 LZ4_HASH_LOG = 12;
+	static constexpr u32 LZ4_SKIP_TRIGGER = 6;
+
+	static u32 read_u32(const u8* ptr) noexcept
+	{
+		u32 value;
+		::std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static u64 read_u64(const u8* ptr) noexcept
+	{
+		u64 value;
+		::std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static u32 hash_sequence(u32 sequence) noexcept
+	{
+		return (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+	}
+
+	static usize count_match(const u8* ip, const u8* ref, const u8* limit) noexcept
+	{
+		const u8* start = ip;
+
+		while (ip + sizeof(u64) <= limit)
+		{
+			u64 diff = read_u64(ip) ^ read_u64(ref);
+
+			if (diff != 0)
+				return static_cast<usize>(ip - start) + static_cast<usize>(::std::countr_zero(diff) >> 3);
+
+			ip += sizeof(u64);
+			ref += sizeof(u64);
+		}
+
+		while (ip < limit && *ip == *ref)
+		{
+			++ip;
+			++ref;
+		}
+
+		return static_cast<usize>(ip - start);
+	}
+
+	static u8* write_length(u8* op, usize length) noexcept
+	{
+		while (length >= 255)
+		{
+			*op++ = 255;
+			length -= 255;
+		}
+
+		*op++ = static_cast<u8>(length);
+
+		return op;
+	}
+
+	static void wild_copy(u8* dest, const u8* source, u8* dest_end) noexcept
+	{
+		do
+		{
+			::std::memcpy(dest, source, 16);
+			::std::memcpy(dest + 16, source + 16, 16);
+
+			dest += 32;
+			source += 32;
+		} while (dest < dest_end);
+	}
+
+	Result<usize, CompressionError> lz4_compress(const u8* source, usize length, u8* dest, usize capacity) noexcept
+	{
+		if (length > LZ4_MAX_INPUT_SIZE)
+			return CompressionError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		const u8* ip = source;
+		const u8* anchor = source;
+		const u8* const iend = source + length;
+		const u8* const mflimit = iend - (length >= LZ4_MATCH_FIND_LIMIT ? LZ4_MATCH_FIND_LIMIT : length);
+		const u8* const matchlimit = iend - (length >= LZ4_LAST_LITERALS ? LZ4_LAST_LITERALS : length);
+
+		u8* op = dest;
+		u8* const oend = dest + capacity;
+
+		if (length >= LZ4_MATCH_FIND_LIMIT + 1)
+		{
+			u32 table[1 << LZ4_HASH_LOG];
+			::std::memset(table, 0, sizeof(table));
+
+			table[hash_sequence(read_u32(ip))] = 0;
+			++ip;
+
+			for (;;)
+			{
+				const u8* ref;
+				const u8* forward = ip;
+				u32 attempts = 1 << LZ4_SKIP_TRIGGER;
+
+				do
+				{
+					u32 h = hash_sequence(read_u32(forward));
+
+					ip = forward;
+					forward += attempts++ >> LZ4_SKIP_TRIGGER;
+
+					if (forward > mflimit)
+						goto last_literals;
+
+					ref = source + table[h];
+					table[h] = static_cast<u32>(ip - source);
+				} while (static_cast<usize>(ip - ref) > LZ4_MAX_DISTANCE || read_u32(ref) != read_u32(ip));
+
+				while (ip > anchor && ref > source && ip[-1] == ref[-1])
+				{
+					--ip;
+					--ref;
+				}
+
+				usize literals = static_cast<usize>(ip - anchor);
+
+				if (static_cast<usize>(oend - op) < 1 + literals + literals / 255 + 2 + 1 + LZ4_LAST_LITERALS)
+					return CompressionError{ NetErrorKind::NO_BUFFERS };
+
+				u8* token = op++;
+
+				if (literals >= 15)
+				{
+					*token = 15 << 4;
+					op = write_length(op, literals - 15);
+				}
+				else
+				{
+					*token = static_cast<u8>(literals << 4);
+				}
+
+				::std::memcpy(op, anchor, literals);
+				op += literals;
+
+				for (;;)
+				{
+					usize offset = static_cast<usize>(ip - ref);
+
+					*op++ = static_cast<u8>(offset);
+					*op++ = static_cast<u8>(offset >> 8);
+
+					usize matched = count_match(ip + LZ4_MIN_MATCH, ref + LZ4_MIN_MATCH, matchlimit);
+					ip += LZ4_MIN_MATCH + matched;
+
+					if (static_cast<usize>(oend - op) < matched / 255 + 1 + LZ4_LAST_LITERALS)
+						return CompressionError{ NetErrorKind::NO_BUFFERS };
+
+					if (matched >= 15)
+					{
+						*token |= 15;
+						op = write_length(op, matched - 15);
+					}
+					else
+					{
+						*token |= static_cast<u8>(matched);
+					}
+
+					anchor = ip;
+
+					if (ip > mflimit)
+						goto last_literals;
+
+					table[hash_sequence(read_u32(ip - 2))] = static_cast<u32>(ip - 2 - source);
+
+					u32 h = hash_sequence(read_u32(ip));
+					ref = source + table[h];
+					table[h] = static_cast<u32>(ip - source);
+
+					if (static_cast<usize>(ip - ref) > LZ4_MAX_DISTANCE || read_u32(ref) != read_u32(ip))
+						break;
+
+					if (static_cast<usize>(oend - op) < 1 + 2 + 1 + LZ4_LAST_LITERALS)
+						return CompressionError{ NetErrorKind::NO_BUFFERS };
+
+					token = op++;
+					*token = 0;
+				}
+
+				++ip;
+			}
+		}
+
+	last_literals:
+		usize literals = static_cast<usize>(iend - anchor);
+
+		if (static_cast<usize>(oend - op) < 1 + literals + (literals + 255 - 15) / 255)
+			return CompressionError{ NetErrorKind::NO_BUFFERS };
+
+		if (literals >= 15)
+		{
+			*op++ = 15 << 4;
+			op = write_length(op, literals - 15);
+		}
+		else
+		{
+			*op++ = static_cast<u8>(literals << 4);
+		}
+
+		if (literals != 0)
+			::std::memcpy(op, anchor, literals);
+
+		op += literals;
+
+		return static_cast<usize>(op - dest);
+	}
+
+	static bool read_length(const u8*& ip, const u8* iend, usize& length) noexcept
+	{
+		u8 byte;
+
+		do
+		{
+			if (ip >= iend)
+				return false;
+
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	Result<usize, CompressionError> lz4_decompress(const u8* source, usize length, u8* dest, usize capacity) noexcept
+	{
+		const u8* ip = source;
+		const u8* const iend = source + length;
+
+		u8* op = dest;
+		u8* const oend = dest + capacity;
+
+		if (length == 0)
+			return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+		for (;;)
+		{
+			if (static_cast<usize>(iend - ip) >= LZ4_WILD_COPY && static_cast<usize>(oend - op) >= 2 * LZ4_WILD_COPY)
+			{
+				u8 token = *ip;
+				usize literals = token >> 4;
+				usize matched = token & 15;
+
+				if (literals != 15 && matched != 15)
+				{
+					usize offset = static_cast<usize>(ip[1 + literals]) | (static_cast<usize>(ip[2 + literals]) << 8);
+
+					if (offset >= 8 && offset <= static_cast<usize>(op - dest) + literals)
+					{
+						::std::memcpy(op, ip + 1, 16);
+
+						ip += 3 + literals;
+						op += literals;
+
+						const u8* match = op - offset;
+
+						::std::memcpy(op, match, 8);
+						::std::memcpy(op + 8, match + 8, 8);
+						::std::memcpy(op + 16, match + 16, 8);
+
+						op += matched + LZ4_MIN_MATCH;
+						continue;
+					}
+				}
+			}
+
+			if (ip >= iend)
+				return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+			u8 token = *ip++;
+			usize literals = token >> 4;
+
+			if (literals == 15 && !read_length(ip, iend, literals))
+				return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+			if (literals > static_cast<usize>(iend - ip))
+				return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+			if (literals > static_cast<usize>(oend - op))
+				return CompressionError{ NetErrorKind::NO_BUFFERS };
+
+			if (static_cast<usize>(iend - ip) >= literals + LZ4_WILD_COPY && static_cast<usize>(oend - op) >= literals + LZ4_WILD_COPY)
+				wild_copy(op, ip, op + literals);
+			else if (literals != 0)
+				::std::memmove(op, ip, literals);
+
+			ip += literals;
+			op += literals;
+
+			if (ip == iend)
+				break;
+
+			if (static_cast<usize>(iend - ip) < 2)
+				return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+			usize offset = static_cast<usize>(ip[0]) | (static_cast<usize>(ip[1]) << 8);
+			ip += 2;
+
+			if (offset == 0 || offset > static_cast<usize>(op - dest))
+				return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+			usize matched = token & 15;
+
+			if (matched == 15 && !read_length(ip, iend, matched))
+				return CompressionError{ NetErrorKind::INVALID_ARGUMENT };
+
+			matched += LZ4_MIN_MATCH;
+
+			if (matched > static_cast<usize>(oend - op))
+				return CompressionError{ NetErrorKind::NO_BUFFERS };
+
+			const u8* match = op - offset;
+			u8* const match_end = op + matched;
+
+			if (offset >= 16 && static_cast<usize>(oend - op) >= matched + LZ4_WILD_COPY)
+			{
+				do
+				{
+					::std::memcpy(op, match, 16);
+
+					op += 16;
+					match += 16;
+				} while (op < match_end);
+			}
+			else if (offset == 1)
+			{
+				::std::memset(op, *match, matched);
+			}
+			else if (offset >= 8 && static_cast<usize>(oend - op) >= matched + LZ4_WILD_COPY)
+			{
+				do
+				{
+					::std::memcpy(op, match, 8);
+
+					op += 8;
+					match += 8;
+				} while (op < match_end);
+			}
+			else
+			{
+				while (op < match_end)
+					*op++ = *match++;
+			}
+
+			op = match_end;
+		}
+
+		return static_cast<usize>(op - dest);
+	}
+}
@@ -0,0 +1,1468 @@
+#include "MemNet.hpp"
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <intrin.h>
+
+namespace bsl::net
+{
+	static constexpr usize MEM_KEY_WORDS = 16;
+	static constexpr u32 MEM_SPIN_LIMIT = 256;
+
+	static constexpr u16 MEM_EPHEMERAL_FIRST = 49152;
+	static constexpr u32 MEM_EPHEMERAL_COUNT = 65536 - MEM_EPHEMERAL_FIRST;
+
+	enum class _MemKeyTag : u64
+	{
+		IPv4 = 1,
+		IPv6 = 2,
+		UNIX_PATH = 3,
+		UNIX_ABSTRACT = 4
+	};
+
+	enum class _MemEndpointState : u32
+	{
+		FREE,
+		BOUND,
+		LISTENING,
+		DEAD
+	};
+
+	struct _MemKey
+	{
+		u64 words[MEM_KEY_WORDS];
+		usize count;
+	};
+
+	static usize round_up_pow2(usize value)
+	{
+		usize result = 1;
+
+		while (result < value)
+			result <<= 1;
+
+		return result;
+	}
+
+	static _MemKey make_key(const SockAddr& addr, SockType type)
+	{
+		_MemKey key{};
+		u64 header = static_cast<u64>(type) << 8;
+
+		if (addr.is_ipv4())
+		{
+			SockAddrV4 v4 = addr.to_ipv4().unwrap();
+
+			key.words[0] = header | static_cast<u64>(_MemKeyTag::IPv4) | (static_cast<u64>(v4.port()) << 16);
+			key.words[1] = v4.addr().to_bits();
+			key.count = 2;
+		}
+		else if (addr.is_ipv6())
+		{
+			SockAddrV6 v6 = addr.to_ipv6().unwrap();
+
+			key.words[0] = header | static_cast<u64>(_MemKeyTag::IPv6) | (static_cast<u64>(v6.port()) << 16);
+			key.words[1] = v6.addr().high_bits();
+			key.words[2] = v6.addr().low_bits();
+
+			key.count = 3;
+		}
+		else
+		{
+			SockAddrUnix un = addr.to_unix().unwrap();
+			_MemKeyTag tag = un.is_abstract() ? _MemKeyTag::UNIX_ABSTRACT : _MemKeyTag::UNIX_PATH;
+
+			key.words[0] = header | static_cast<u64>(tag) | (static_cast<u64>(un.length()) << 32);
+
+			for (usize i = 0; i < un.length(); ++i)
+				key.words[1 + i / 8] |= static_cast<u64>(static_cast<u8>(un.path()[i])) << ((i % 8) * 8);
+
+			key.count = 1 + (un.length() + 7) / 8;
+		}
+
+		return key;
+	}
+
+	static _MemKeyTag key_tag(const _MemKey& key)
+	{
+		return static_cast<_MemKeyTag>(key.words[0] & 0xFF);
+	}
+
+	static u16 key_port(const _MemKey& key)
+	{
+		return static_cast<u16>(key.words[0] >> 16);
+	}
+
+	static void set_key_port(_MemKey& key, u16 port)
+	{
+		key.words[0] = (key.words[0] & ~(0xFFFFull << 16)) | (static_cast<u64>(port) << 16);
+	}
+
+	static bool key_is_ip(const _MemKey& key)
+	{
+		return key_tag(key) == _MemKeyTag::IPv4 || key_tag(key) == _MemKeyTag::IPv6;
+	}
+
+	static SockAddr key_to_addr(const _MemKey& key)
+	{
+		switch (key_tag(key))
+		{
+		case _MemKeyTag::IPv4:
+			return SockAddrV4{ AddrIPv4::from_bits(static_cast<u32>(key.words[1])), key_port(key) };
+		case _MemKeyTag::IPv6:
+			return SockAddrV6{ AddrIPv6::from_bits(key.words[1], key.words[2]), key_port(key) };
+		default:
+		{
+			char path[SockAddrUnix::MAX_PATH_LENGTH + 1] = {};
+			usize length = static_cast<usize>(key.words[0] >> 32);
+
+			for (usize i = 0; i < length; ++i)
+				path[i] = static_cast<char>(key.words[1 + i / 8] >> ((i % 8) * 8));
+
+			if (key_tag(key) == _MemKeyTag::UNIX_ABSTRACT)
+				return SockAddrUnix::from_abstract(path).unwrap();
+
+			if (length == 0)
+				return SockAddrUnix::unnamed();
+
+			return SockAddrUnix::from_path(path).unwrap();
+		}
+		}
+	}
+
+	static _MemKey wildcard_key(const _MemKey& key)
+	{
+		_MemKey wildcard{};
+		wildcard.words[0] = key.words[0];
+		wildcard.count = key.count;
+
+		return wildcard;
+	}
+
+	static bool key_is_wildcard(const _MemKey& key)
+	{
+		return key_is_ip(key) && key.words[1] == 0 && key.words[2] == 0;
+	}
+
+	static _MemKey source_key(const _MemKey& local)
+	{
+		if (!key_is_wildcard(local))
+			return local;
+
+		_MemKey source = local;
+
+		if (key_tag(local) == _MemKeyTag::IPv4)
+			source.words[1] = 0x7F000001;
+		else
+			source.words[2] = 1;
+
+		return source;
+	}
+
+	static bool key_equals(const _MemKey& lhs, const _MemKey& rhs)
+	{
+		if (lhs.count != rhs.count)
+			return false;
+
+		for (usize i = 0; i < lhs.count; ++i)
+			if (lhs.words[i] != rhs.words[i])
+				return false;
+
+		return true;
+	}
+
+	static u64 hash_key(const _MemKey& key)
+	{
+		u64 hash = 0x9E3779B97F4A7C15ull;
+
+		for (usize i = 0; i < key.count; ++i)
+		{
+			hash ^= key.words[i];
+			hash *= 0xBF58476D1CE4E5B9ull;
+			hash ^= hash >> 31;
+		}
+
+		return hash;
+	}
+
+	static void spin_wait(u32& spins)
+	{
+		if (++spins < MEM_SPIN_LIMIT)
+		{
+			_mm_pause();
+			return;
+		}
+
+		::std::this_thread::yield();
+	}
+
+	static u64 mem_clock_ms()
+	{
+		return static_cast<u64>(::std::chrono::duration_cast<::std::chrono::milliseconds>(
+			::std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	[[nodiscard]] static bool spin_until(u32& spins, u64 timeout_ms, u64& deadline)
+	{
+		if (timeout_ms != 0)
+		{
+			u64 now = mem_clock_ms();
+
+			if (deadline == 0)
+				deadline = now + timeout_ms;
+			else if (now >= deadline)
+				return false;
+		}
+
+		spin_wait(spins);
+
+		return true;
+	}
+
+	template<class Cell>
+	struct _MemQueue
+	{
+		alignas(CACHE_LINE_SIZE) ::std::atomic<u64> m_enqueue;
+		alignas(CACHE_LINE_SIZE) ::std::atomic<u64> m_dequeue;
+
+		Cell* m_cells;
+		u64 m_mask;
+
+		void init(usize capacity)
+		{
+			m_cells = new Cell[capacity];
+			m_mask = static_cast<u64>(capacity) - 1;
+
+			for (usize i = 0; i < capacity; ++i)
+				m_cells[i].seq.store(i, ::std::memory_order_relaxed);
+
+			m_enqueue.store(0, ::std::memory_order_relaxed);
+			m_dequeue.store(0, ::std::memory_order_release);
+		}
+
+		template<class Fill>
+		[[nodiscard]] bool push(Fill&& fill)
+		{
+			u64 pos = m_enqueue.load(::std::memory_order_relaxed);
+
+			while (true)
+			{
+				Cell& cell = m_cells[pos & m_mask];
+				u64 seq = cell.seq.load(::std::memory_order_acquire);
+				i64 diff = static_cast<i64>(seq - pos);
+
+				if (diff == 0)
+				{
+					if (m_enqueue.compare_exchange_weak(pos, pos + 1, ::std::memory_order_relaxed))
+					{
+						fill(cell);
+						cell.seq.store(pos + 1, ::std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_enqueue.load(::std::memory_order_relaxed);
+				}
+			}
+		}
+
+		[[nodiscard]] bool ready() const noexcept
+		{
+			u64 pos = m_dequeue.load(::std::memory_order_relaxed);
+
+			return m_cells[pos & m_mask].seq.load(::std::memory_order_acquire) == pos + 1;
+		}
+
+		template<class Drain>
+		[[nodiscard]] bool pop(Drain&& drain)
+		{
+			u64 pos = m_dequeue.load(::std::memory_order_relaxed);
+
+			while (true)
+			{
+				Cell& cell = m_cells[pos & m_mask];
+				u64 seq = cell.seq.load(::std::memory_order_acquire);
+				i64 diff = static_cast<i64>(seq - (pos + 1));
+
+				if (diff == 0)
+				{
+					if (m_dequeue.compare_exchange_weak(pos, pos + 1, ::std::memory_order_relaxed))
+					{
+						drain(cell);
+						cell.seq.store(pos + m_mask + 1, ::std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_dequeue.load(::std::memory_order_relaxed);
+				}
+			}
+		}
+	};
+
+	struct _MemPipe
+	{
+		SpscRingControl m_rings[2];
+		::std::atomic<u32> m_refs;
+		_MemNetworkState* m_net;
+		u8* m_data;
+		usize m_capacity;
+	};
+
+	struct _MemAcceptCell
+	{
+		::std::atomic<u64> seq;
+		_MemPipe* pipe;
+		_MemKey local;
+		_MemKey peer;
+	};
+
+	struct _MemDatagramCell
+	{
+		::std::atomic<u64> seq;
+		u8* data;
+		usize length;
+		_MemKey source;
+	};
+
+	struct _MemEndpoint
+	{
+		::std::atomic<u32> m_gen;
+		::std::atomic<u32> m_state;
+		::std::atomic<u64> m_key_count;
+		::std::atomic<u64> m_key[MEM_KEY_WORDS];
+		::std::atomic<u32> m_senders;
+
+		_MemQueue<_MemAcceptCell> m_accepts;
+		_MemQueue<_MemDatagramCell> m_datagrams;
+		u8* m_datagram_data;
+	};
+
+	struct _MemNetworkState
+	{
+		MemNetworkConfig m_config;
+		_MemEndpoint* m_endpoints;
+		u64 m_mask;
+		::std::mutex m_mutex;
+		::std::atomic<u32> m_next_ephemeral;
+
+		::std::mutex m_pipe_mutex;
+		::std::vector<_MemPipe*> m_pipe_pool;
+	};
+
+	struct _MemSocketState
+	{
+		_MemNetworkState* m_net;
+		SockType m_type;
+
+		_MemEndpoint* m_endpoint;
+
+		_MemKey m_local;
+		_MemKey m_peer;
+		bool m_has_local;
+		bool m_has_peer;
+
+		_MemPipe* m_pipe;
+		usize m_side;
+		SpscByteRing m_tx;
+		SpscByteRing m_rx;
+
+		bool m_nonblocking;
+		bool m_is_closed;
+		::std::atomic<u32> m_shutdown;
+
+		u64 m_send_timeout_ms;
+		u64 m_recv_timeout_ms;
+
+		SocketIoCounters m_stats;
+	};
+
+	static _MemPipe* acquire_pipe(_MemNetworkState* net)
+	{
+		_MemPipe* pipe = nullptr;
+
+		{
+			::std::lock_guard<::std::mutex> lock{ net->m_pipe_mutex };
+
+			if (!net->m_pipe_pool.empty())
+			{
+				pipe = net->m_pipe_pool.back();
+				net->m_pipe_pool.pop_back();
+			}
+		}
+
+		if (pipe == nullptr)
+		{
+			usize capacity = net->m_config.stream_capacity;
+
+			pipe = new _MemPipe{};
+			pipe->m_net = net;
+			pipe->m_data = new u8[2 * capacity];
+			pipe->m_capacity = capacity;
+		}
+		else
+		{
+			for (SpscRingControl& ring : pipe->m_rings)
+			{
+				ring.head.store(0, ::std::memory_order_relaxed);
+				ring.tail.store(0, ::std::memory_order_relaxed);
+				ring.reader_waiting.store(0, ::std::memory_order_relaxed);
+				ring.writer_waiting.store(0, ::std::memory_order_relaxed);
+				ring.writer_closed.store(0, ::std::memory_order_relaxed);
+				ring.reader_closed.store(0, ::std::memory_order_relaxed);
+			}
+		}
+
+		pipe->m_refs.store(2, ::std::memory_order_relaxed);
+
+		return pipe;
+	}
+
+	static void recycle_pipe(_MemPipe* pipe)
+	{
+		_MemNetworkState* net = pipe->m_net;
+
+		{
+			::std::lock_guard<::std::mutex> lock{ net->m_pipe_mutex };
+
+			if (net->m_pipe_pool.size() < net->m_config.pipe_pool)
+			{
+				net->m_pipe_pool.push_back(pipe);
+				return;
+			}
+		}
+
+		delete[] pipe->m_data;
+		delete pipe;
+	}
+
+	static void release_pipe(_MemPipe* pipe)
+	{
+		if (pipe->m_refs.fetch_sub(1, ::std::memory_order_acq_rel) != 1)
+			return;
+
+		recycle_pipe(pipe);
+	}
+
+	static void shutdown_pipe(_MemPipe* pipe, usize side)
+	{
+		pipe->m_rings[side].writer_closed.store(1, ::std::memory_order_release);
+		pipe->m_rings[1 - side].reader_closed.store(1, ::std::memory_order_release);
+
+		release_pipe(pipe);
+	}
+
+	static void publish_endpoint(_MemEndpoint& ep, _MemEndpointState state, const _MemKey* key)
+	{
+		u32 gen = ep.m_gen.load(::std::memory_order_relaxed);
+
+		ep.m_gen.store(gen + 1, ::std::memory_order_relaxed);
+		::std::atomic_thread_fence(::std::memory_order_release);
+
+		ep.m_state.store(static_cast<u32>(state), ::std::memory_order_relaxed);
+
+		if (key != nullptr)
+		{
+			ep.m_key_count.store(key->count, ::std::memory_order_relaxed);
+
+			for (usize i = 0; i < MEM_KEY_WORDS; ++i)
+				ep.m_key[i].store(key->words[i], ::std::memory_order_relaxed);
+		}
+
+		ep.m_gen.store(gen + 2, ::std::memory_order_release);
+	}
+
+	static bool endpoint_matches(const _MemEndpoint& ep, const _MemKey& key)
+	{
+		if (ep.m_key_count.load(::std::memory_order_relaxed) != key.count)
+			return false;
+
+		for (usize i = 0; i < key.count; ++i)
+			if (ep.m_key[i].load(::std::memory_order_relaxed) != key.words[i])
+				return false;
+
+		return true;
+	}
+
+	static _MemEndpoint* find_exact(_MemNetworkState* net, const _MemKey& key, _MemEndpointState& state, u32& observed)
+	{
+		u64 start = hash_key(key);
+
+		for (u64 i = 0; i <= net->m_mask; ++i)
+		{
+			_MemEndpoint& ep = net->m_endpoints[(start + i) & net->m_mask];
+			u32 spins = 0;
+
+			while (true)
+			{
+				u32 gen = ep.m_gen.load(::std::memory_order_acquire);
+
+				if ((gen & 1) != 0)
+				{
+					spin_wait(spins);
+					continue;
+				}
+
+				_MemEndpointState current = static_cast<_MemEndpointState>(ep.m_state.load(::std::memory_order_relaxed));
+				bool live = current == _MemEndpointState::BOUND || current == _MemEndpointState::LISTENING;
+				bool match = live && endpoint_matches(ep, key);
+
+				::std::atomic_thread_fence(::std::memory_order_acquire);
+
+				if (ep.m_gen.load(::std::memory_order_relaxed) != gen)
+					continue;
+
+				if (current == _MemEndpointState::FREE)
+					return nullptr;
+
+				if (match)
+				{
+					state = current;
+					observed = gen;
+					return &ep;
+				}
+
+				break;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static _MemEndpoint* find_endpoint(_MemNetworkState* net, const _MemKey& key, _MemEndpointState& state, u32& observed)
+	{
+		_MemEndpoint* ep = find_exact(net, key, state, observed);
+
+		if (ep == nullptr && key_is_ip(key) && !key_is_wildcard(key))
+			ep = find_exact(net, wildcard_key(key), state, observed);
+
+		return ep;
+	}
+
+	static bool enter_endpoint(_MemEndpoint& ep, u32 observed)
+	{
+		ep.m_senders.fetch_add(1, ::std::memory_order_seq_cst);
+
+		if (ep.m_gen.load(::std::memory_order_seq_cst) == observed)
+			return true;
+
+		ep.m_senders.fetch_sub(1, ::std::memory_order_release);
+		return false;
+	}
+
+	static void leave_endpoint(_MemEndpoint& ep)
+	{
+		ep.m_senders.fetch_sub(1, ::std::memory_order_release);
+	}
+
+	static void wait_senders(_MemEndpoint& ep)
+	{
+		::std::atomic_thread_fence(::std::memory_order_seq_cst);
+
+		u32 spins = 0;
+
+		while (ep.m_senders.load(::std::memory_order_acquire) != 0)
+			spin_wait(spins);
+	}
+
+	static void drain_endpoint(_MemEndpoint& ep)
+	{
+		if (ep.m_accepts.m_cells != nullptr)
+			while (ep.m_accepts.pop([](_MemAcceptCell& cell) { shutdown_pipe(cell.pipe, 1); }));
+
+		if (ep.m_datagrams.m_cells != nullptr)
+			while (ep.m_datagrams.pop([](_MemDatagramCell&) {}));
+	}
+
+	static void prepare_datagrams(_MemNetworkState* net, _MemEndpoint* ep)
+	{
+		if (ep->m_datagrams.m_cells != nullptr)
+			return;
+
+		usize capacity = net->m_config.datagram_queue;
+
+		ep->m_datagram_data = new u8[capacity * net->m_config.max_datagram];
+		ep->m_datagrams.init(capacity);
+
+		for (usize i = 0; i < capacity; ++i)
+			ep->m_datagrams.m_cells[i].data = ep->m_datagram_data + i * net->m_config.max_datagram;
+	}
+
+	static _MemEndpoint* claim_endpoint(_MemNetworkState* net, const _MemKey& key, SockType type, NetErrorKind& error)
+	{
+		u64 start = hash_key(key);
+		_MemEndpoint* slot = nullptr;
+
+		for (u64 i = 0; i <= net->m_mask; ++i)
+		{
+			_MemEndpoint& ep = net->m_endpoints[(start + i) & net->m_mask];
+			_MemEndpointState state = static_cast<_MemEndpointState>(ep.m_state.load(::std::memory_order_relaxed));
+
+			if (state == _MemEndpointState::FREE)
+			{
+				if (slot == nullptr)
+					slot = &ep;
+
+				break;
+			}
+
+			if (state == _MemEndpointState::DEAD)
+			{
+				if (slot == nullptr)
+					slot = &ep;
+
+				continue;
+			}
+
+			if (endpoint_matches(ep, key))
+			{
+				error = NetErrorKind::ADDRESS_IN_USE;
+				return nullptr;
+			}
+		}
+
+		if (slot == nullptr)
+		{
+			error = NetErrorKind::NO_BUFFERS;
+			return nullptr;
+		}
+
+		wait_senders(*slot);
+		drain_endpoint(*slot);
+
+		if (type == SockType::DATAGRAM)
+			prepare_datagrams(net, slot);
+
+		publish_endpoint(*slot, _MemEndpointState::BOUND, &key);
+
+		return slot;
+	}
+
+	static _MemEndpointState endpoint_state(const _MemEndpoint& ep)
+	{
+		return static_cast<_MemEndpointState>(ep.m_state.load(::std::memory_order_relaxed));
+	}
+
+	static void reclaim_endpoints(_MemNetworkState* net, _MemEndpoint* ep)
+	{
+		u64 index = static_cast<u64>(ep - net->m_endpoints);
+
+		if (endpoint_state(net->m_endpoints[(index + 1) & net->m_mask]) != _MemEndpointState::FREE)
+			return;
+
+		for (u64 i = 0; i <= net->m_mask; ++i)
+		{
+			_MemEndpoint& slot = net->m_endpoints[(index - i) & net->m_mask];
+
+			if (endpoint_state(slot) != _MemEndpointState::DEAD)
+				break;
+
+			publish_endpoint(slot, _MemEndpointState::FREE, nullptr);
+		}
+	}
+
+	static void release_endpoint(_MemNetworkState* net, _MemEndpoint* ep)
+	{
+		::std::lock_guard<::std::mutex> lock{ net->m_mutex };
+
+		publish_endpoint(*ep, _MemEndpointState::DEAD, nullptr);
+		wait_senders(*ep);
+		drain_endpoint(*ep);
+
+		reclaim_endpoints(net, ep);
+	}
+
+	static _MemKey ephemeral_key(_MemNetworkState* net, const _MemKey& like, u32 n)
+	{
+		if (key_is_ip(like))
+		{
+			SockAddr addr = key_tag(like) == _MemKeyTag::IPv4 ?
+				SockAddr{ SockAddrV4{ AddrIPv4::LOCALHOST, 0 } } :
+				SockAddr{ SockAddrV6{ AddrIPv6::LOCALHOST, 0 } };
+
+			_MemKey key = make_key(addr, static_cast<SockType>((like.words[0] >> 8) & 0xFF));
+			set_key_port(key, static_cast<u16>(MEM_EPHEMERAL_FIRST + n % MEM_EPHEMERAL_COUNT));
+
+			return key;
+		}
+
+		char name[8];
+		::std::snprintf(name, sizeof(name), "%05x", n & 0xFFFFF);
+
+		return make_key(SockAddrUnix::from_abstract(name).unwrap(), static_cast<SockType>((like.words[0] >> 8) & 0xFF));
+	}
+
+	static bool bind_state(_MemSocketState* state, const _MemKey& requested, NetErrorKind& error)
+	{
+		_MemNetworkState* net = state->m_net;
+
+		::std::lock_guard<::std::mutex> lock{ net->m_mutex };
+
+		_MemEndpoint* ep = nullptr;
+		_MemKey key = requested;
+
+		if (key_is_ip(key) && key_port(key) == 0)
+		{
+			error = NetErrorKind::ADDRESS_UNAVAILABLE;
+
+			for (u32 attempt = 0; attempt < MEM_EPHEMERAL_COUNT && ep == nullptr; ++attempt)
+			{
+				u32 n = net->m_next_ephemeral.fetch_add(1, ::std::memory_order_relaxed);
+				set_key_port(key, static_cast<u16>(MEM_EPHEMERAL_FIRST + n % MEM_EPHEMERAL_COUNT));
+				ep = claim_endpoint(net, key, state->m_type, error);
+
+				if (error == NetErrorKind::NO_BUFFERS)
+					return false;
+			}
+
+			if (ep == nullptr)
+				error = NetErrorKind::ADDRESS_UNAVAILABLE;
+		}
+		else
+		{
+			ep = claim_endpoint(net, key, state->m_type, error);
+		}
+
+		if (ep == nullptr)
+			return false;
+
+		state->m_endpoint = ep;
+		state->m_local = key;
+		state->m_has_local = true;
+
+		return true;
+	}
+
+	static bool autobind_state(_MemSocketState* state, const _MemKey& like, NetErrorKind& error)
+	{
+		_MemNetworkState* net = state->m_net;
+
+		for (u32 attempt = 0; attempt < MEM_EPHEMERAL_COUNT; ++attempt)
+		{
+			if (bind_state(state, ephemeral_key(net, like, net->m_next_ephemeral.fetch_add(1, ::std::memory_order_relaxed)), error))
+				return true;
+
+			if (error == NetErrorKind::NO_BUFFERS)
+				return false;
+		}
+
+		error = NetErrorKind::ADDRESS_UNAVAILABLE;
+
+		return false;
+	}
+
+	static void attach_pipe(_MemSocketState* state, _MemPipe* pipe, usize side)
+	{
+		usize other = 1 - side;
+
+		state->m_pipe = pipe;
+		state->m_side = side;
+		state->m_tx = SpscByteRing{ &pipe->m_rings[side], pipe->m_data + side * pipe->m_capacity, pipe->m_capacity };
+		state->m_rx = SpscByteRing{ &pipe->m_rings[other], pipe->m_data + other * pipe->m_capacity, pipe->m_capacity };
+	}
+
+	static _MemSocketState* new_socket_state(_MemNetworkState* net, SockType type)
+	{
+		_MemSocketState* state = new _MemSocketState{};
+		state->m_net = net;
+		state->m_type = type;
+
+		return state;
+	}
+
+	static void close_state(_MemSocketState* state)
+	{
+		if (state->m_is_closed)
+			return;
+
+		state->m_is_closed = true;
+
+		if (state->m_pipe != nullptr)
+		{
+			shutdown_pipe(state->m_pipe, state->m_side);
+			state->m_pipe = nullptr;
+		}
+
+		if (state->m_endpoint != nullptr)
+		{
+			release_endpoint(state->m_net, state->m_endpoint);
+			state->m_endpoint = nullptr;
+		}
+	}
+
+	MemNetwork::MemNetwork(const MemNetworkConfig& config)
+		: m_state{ new _MemNetworkState{} }
+	{
+		m_state->m_config = config;
+		m_state->m_config.stream_capacity = round_up_pow2(config.stream_capacity < 64 ? 64 : config.stream_capacity);
+		m_state->m_config.accept_queue = round_up_pow2(config.accept_queue < 2 ? 2 : config.accept_queue);
+		m_state->m_config.datagram_queue = round_up_pow2(config.datagram_queue < 2 ? 2 : config.datagram_queue);
+
+		if (m_state->m_config.max_datagram == 0)
+			m_state->m_config.max_datagram = 1;
+
+		usize slots = round_up_pow2(config.max_endpoints < 2 ? 2 : config.max_endpoints);
+
+		m_state->m_endpoints = new _MemEndpoint[slots]{};
+		m_state->m_mask = static_cast<u64>(slots) - 1;
+	}
+
+	MemNetwork::~MemNetwork()
+	{
+		for (u64 i = 0; i <= m_state->m_mask; ++i)
+		{
+			_MemEndpoint& ep = m_state->m_endpoints[i];
+
+			drain_endpoint(ep);
+
+			delete[] ep.m_accepts.m_cells;
+			delete[] ep.m_datagrams.m_cells;
+			delete[] ep.m_datagram_data;
+		}
+
+		for (_MemPipe* pipe : m_state->m_pipe_pool)
+		{
+			delete[] pipe->m_data;
+			delete pipe;
+		}
+
+		delete[] m_state->m_endpoints;
+		delete m_state;
+	}
+
+	const MemNetworkConfig& MemNetwork::config() const noexcept
+	{
+		return m_state->m_config;
+	}
+
+	MemSocket::MemSocket(_MemSocketState* state, AddrFamily family, SockType type, Proto proto) noexcept
+		: m_sock{ state }, m_family{ family }, m_type{ type }, m_proto{ proto }
+	{
+	}
+
+	MemSocket::MemSocket(MemNetwork& network, AddrFamily family, SockType type, Proto proto)
+		: m_sock{ new_socket_state(network.m_state, type) }, m_family{ family }, m_type{ type }, m_proto{ proto }
+	{
+	}
+
+	MemSocket::MemSocket(MemSocket&& other) noexcept
+		: m_sock{ other.m_sock }, m_family{ other.m_family }, m_type{ other.m_type }, m_proto{ other.m_proto }
+	{
+		other.m_sock = nullptr;
+	}
+
+	MemSocket::~MemSocket()
+	{
+		if (m_sock != nullptr)
+		{
+			close_state(m_sock);
+			delete m_sock;
+		}
+	}
+
+	AddrFamily MemSocket::addr_family() const noexcept
+	{
+		return m_family;
+	}
+
+	SockType MemSocket::sock_type() const noexcept
+	{
+		return m_type;
+	}
+
+	Proto MemSocket::proto() const noexcept
+	{
+		return m_proto;
+	}
+
+	Result<Unit, SocketConnectError> MemSocket::connect(const SockAddr& addr)
+	{
+		_MemSocketState* state = m_sock;
+		_MemKey target = make_key(addr, m_type);
+
+		if (state->m_is_closed)
+		{
+			IoCounterCells::bump(state->m_stats.tx.connect_failures);
+			return SocketConnectError{ NetErrorKind::CLOSED };
+		}
+
+		if (state->m_pipe != nullptr)
+		{
+			IoCounterCells::bump(state->m_stats.tx.connect_failures);
+			return SocketConnectError{ NetErrorKind::INVALID_ARGUMENT };
+		}
+
+		if (m_type == SockType::DATAGRAM)
+		{
+			NetErrorKind error = NetErrorKind::UNKNOWN;
+
+			if (!state->m_has_local && !autobind_state(state, target, error))
+			{
+				IoCounterCells::bump(state->m_stats.tx.connect_failures);
+				return SocketConnectError{ error };
+			}
+
+			state->m_peer = target;
+			state->m_has_peer = true;
+			IoCounterCells::bump(state->m_stats.tx.connects);
+
+			return Unit{};
+		}
+
+		_MemEndpointState ep_state;
+		u32 ep_gen = 0;
+		_MemEndpoint* ep = find_endpoint(state->m_net, target, ep_state, ep_gen);
+
+		if (ep == nullptr || ep_state != _MemEndpointState::LISTENING || !enter_endpoint(*ep, ep_gen))
+		{
+			IoCounterCells::bump(state->m_stats.tx.connect_failures);
+			return SocketConnectError{ NetErrorKind::CONNECTION_REFUSED };
+		}
+
+		if (!state->m_has_local)
+		{
+			state->m_local = ephemeral_key(state->m_net, target,
+				state->m_net->m_next_ephemeral.fetch_add(1, ::std::memory_order_relaxed));
+			state->m_has_local = true;
+		}
+
+		_MemPipe* pipe = acquire_pipe(state->m_net);
+
+		_MemKey local = source_key(state->m_local);
+
+		bool queued = ep->m_accepts.push([pipe, &local, &target](_MemAcceptCell& cell) {
+			cell.pipe = pipe;
+			cell.local = target;
+			cell.peer = local;
+		});
+
+		leave_endpoint(*ep);
+
+		if (!queued)
+		{
+			recycle_pipe(pipe);
+
+			IoCounterCells::bump(state->m_stats.tx.connect_failures);
+			return SocketConnectError{ NetErrorKind::CONNECTION_REFUSED };
+		}
+
+		attach_pipe(state, pipe, 0);
+
+		state->m_peer = target;
+		state->m_has_peer = true;
+		IoCounterCells::bump(state->m_stats.tx.connects);
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketCloseError> MemSocket::close()
+	{
+		if (m_sock->m_is_closed)
+			return SocketCloseError{ NetErrorKind::CLOSED };
+
+		close_state(m_sock);
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketError> MemSocket::shutdown()
+	{
+		_MemSocketState* state = m_sock;
+
+		state->m_shutdown.store(1, ::std::memory_order_release);
+
+		_MemPipe* pipe = state->m_pipe;
+
+		if (pipe != nullptr)
+		{
+			for (SpscRingControl& ring : pipe->m_rings)
+			{
+				ring.writer_closed.store(1, ::std::memory_order_release);
+				ring.reader_closed.store(1, ::std::memory_order_release);
+			}
+		}
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketBindError> MemSocket::bind(const SockAddr& addr)
+	{
+		if (m_sock->m_is_closed)
+			return SocketBindError{ NetErrorKind::CLOSED };
+
+		if (m_sock->m_has_local || m_sock->m_pipe != nullptr)
+			return SocketBindError{ NetErrorKind::INVALID_ARGUMENT };
+
+		NetErrorKind error = NetErrorKind::UNKNOWN;
+
+		if (!bind_state(m_sock, make_key(addr, m_type), error))
+			return SocketBindError{ error };
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketListenError> MemSocket::listen(usize backlog)
+	{
+		_MemSocketState* state = m_sock;
+
+		if (state->m_is_closed)
+			return SocketListenError{ NetErrorKind::CLOSED };
+
+		if (m_type != SockType::STREAM || state->m_endpoint == nullptr)
+			return SocketListenError{ NetErrorKind::INVALID_ARGUMENT };
+
+		static_cast<void>(backlog);
+
+		_MemNetworkState* net = state->m_net;
+
+		::std::lock_guard<::std::mutex> lock{ net->m_mutex };
+
+		_MemEndpoint* ep = state->m_endpoint;
+
+		if (ep->m_accepts.m_cells == nullptr)
+			ep->m_accepts.init(net->m_config.accept_queue);
+
+		publish_endpoint(*ep, _MemEndpointState::LISTENING, nullptr);
+
+		return Unit{};
+	}
+
+	Result<MemSocket, SocketAcceptError> MemSocket::accept()
+	{
+		_MemSocketState* state = m_sock;
+
+		if (state->m_endpoint == nullptr ||
+			static_cast<_MemEndpointState>(state->m_endpoint->m_state.load(::std::memory_order_relaxed)) != _MemEndpointState::LISTENING)
+		{
+			IoCounterCells::bump(state->m_stats.rx.accept_failures);
+			return SocketAcceptError{ NetErrorKind::INVALID_ARGUMENT };
+		}
+
+		_MemPipe* pipe = nullptr;
+		_MemKey local{};
+		_MemKey peer{};
+		u32 spins = 0;
+		u64 deadline = 0;
+
+		while (!state->m_endpoint->m_accepts.pop([&pipe, &local, &peer](_MemAcceptCell& cell) {
+			pipe = cell.pipe;
+			local = cell.local;
+			peer = cell.peer;
+		}))
+		{
+			if (state->m_shutdown.load(::std::memory_order_acquire) != 0)
+			{
+				IoCounterCells::bump(state->m_stats.rx.accept_failures);
+				return SocketAcceptError{ NetErrorKind::CLOSED };
+			}
+
+			if (state->m_nonblocking)
+			{
+				IoCounterCells::bump(state->m_stats.rx.would_block);
+				IoCounterCells::bump(state->m_stats.rx.accept_failures);
+				return SocketAcceptError{ NetErrorKind::WOULD_BLOCK };
+			}
+
+			if (!spin_until(spins, state->m_recv_timeout_ms, deadline))
+			{
+				IoCounterCells::bump(state->m_stats.rx.accept_failures);
+				return SocketAcceptError{ NetErrorKind::TIMED_OUT };
+			}
+		}
+
+		_MemSocketState* accepted = new_socket_state(state->m_net, m_type);
+		attach_pipe(accepted, pipe, 1);
+
+		accepted->m_local = local;
+		accepted->m_has_local = true;
+		accepted->m_peer = peer;
+		accepted->m_has_peer = true;
+
+		IoCounterCells::bump(state->m_stats.rx.accepts);
+
+		return MemSocket{ accepted, m_family, m_type, m_proto };
+	}
+
+	Result<SockAddr, SocketError> MemSocket::addr() const
+	{
+		if (!m_sock->m_has_local)
+			return SocketError{ NetErrorKind::INVALID_ARGUMENT };
+
+		return key_to_addr(m_sock->m_local);
+	}
+
+	Result<SockAddr, SocketError> MemSocket::peer() const
+	{
+		if (!m_sock->m_has_peer)
+			return SocketError{ NetErrorKind::NOT_CONNECTED };
+
+		return key_to_addr(m_sock->m_peer);
+	}
+
+	bool MemSocket::is_connected() const noexcept
+	{
+		if (m_sock == nullptr || m_sock->m_is_closed)
+			return false;
+
+		if (m_type == SockType::DATAGRAM)
+			return m_sock->m_has_peer;
+
+		return m_sock->m_pipe != nullptr &&
+			m_sock->m_tx.control().reader_closed.load(::std::memory_order_acquire) == 0;
+	}
+
+	Result<Unit, SocketError> MemSocket::set_nonblocking(bool enable)
+	{
+		m_sock->m_nonblocking = enable;
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketError> MemSocket::set_send_timeout(u64 timeout_ms)
+	{
+		m_sock->m_send_timeout_ms = timeout_ms;
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketError> MemSocket::set_recv_timeout(u64 timeout_ms)
+	{
+		m_sock->m_recv_timeout_ms = timeout_ms;
+
+		return Unit{};
+	}
+
+	IoCounters MemSocket::stats() const noexcept
+	{
+		return m_sock->m_stats.snapshot();
+	}
+
+	Result<usize, SocketSendError> MemSocket::send(const u8* buffer, usize length)
+	{
+		_MemSocketState* state = m_sock;
+
+		if (m_type == SockType::DATAGRAM)
+		{
+			if (!state->m_has_peer)
+			{
+				IoCounterCells::bump(state->m_stats.tx.send_failures);
+				return SocketSendError{ NetErrorKind::NOT_CONNECTED };
+			}
+
+			return send_to(key_to_addr(state->m_peer), buffer, length);
+		}
+
+		if (state->m_is_closed)
+		{
+			IoCounterCells::bump(state->m_stats.tx.send_failures);
+			return SocketSendError{ NetErrorKind::CLOSED };
+		}
+
+		if (state->m_pipe == nullptr)
+		{
+			IoCounterCells::bump(state->m_stats.tx.send_failures);
+			return SocketSendError{ NetErrorKind::NOT_CONNECTED };
+		}
+
+		SpscRingControl& ctrl = state->m_tx.control();
+		u32 spins = 0;
+		u64 deadline = 0;
+
+		while (true)
+		{
+			if (ctrl.reader_closed.load(::std::memory_order_acquire) != 0)
+			{
+				IoCounterCells::bump(state->m_stats.tx.send_failures);
+				return SocketSendError{ NetErrorKind::CONNECTION_RESET };
+			}
+
+			usize written = state->m_tx.write(buffer, length);
+
+			if (written > 0 || length == 0)
+			{
+				IoCounterCells::bump(state->m_stats.tx.bytes_sent, written);
+
+				if (written < length)
+					IoCounterCells::bump(state->m_stats.tx.short_writes);
+
+				return move(written);
+			}
+
+			if (state->m_nonblocking)
+			{
+				IoCounterCells::bump(state->m_stats.tx.would_block);
+				IoCounterCells::bump(state->m_stats.tx.send_failures);
+				return SocketSendError{ NetErrorKind::WOULD_BLOCK };
+			}
+
+			if (!spin_until(spins, state->m_send_timeout_ms, deadline))
+			{
+				IoCounterCells::bump(state->m_stats.tx.send_failures);
+				return SocketSendError{ NetErrorKind::TIMED_OUT };
+			}
+		}
+	}
+
+	Result<usize, SocketSendError> MemSocket::send_vectored(const IoSlice* slices, usize count)
+	{
+		usize total = 0;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			Result<usize, SocketSendError> result = send(slices[i].data, slices[i].length);
+
+			if (result.is_error())
+			{
+				if (total != 0)
+					return move(total);
+
+				return result.expect_error();
+			}
+
+			usize written = result.expect();
+			total += written;
+
+			if (written < slices[i].length)
+				break;
+		}
+
+		return move(total);
+	}
+
+	Result<usize, SocketReceiveError> MemSocket::recv(u8* buffer, usize length)
+	{
+		_MemSocketState* state = m_sock;
+
+		if (m_type == SockType::DATAGRAM)
+		{
+			Result<Tuple<usize, SockAddr>, SocketReceiveError> result = recv_from(buffer, length);
+
+			if (result.is_error())
+				return result.expect_error();
+
+			Tuple<usize, SockAddr> value = result.expect();
+			usize received = get<0>(value);
+
+			return move(received);
+		}
+
+		if (state->m_is_closed)
+		{
+			IoCounterCells::bump(state->m_stats.rx.recv_failures);
+			return SocketReceiveError{ NetErrorKind::CLOSED };
+		}
+
+		if (state->m_pipe == nullptr)
+		{
+			IoCounterCells::bump(state->m_stats.rx.recv_failures);
+			return SocketReceiveError{ NetErrorKind::NOT_CONNECTED };
+		}
+
+		SpscRingControl& ctrl = state->m_rx.control();
+		u32 spins = 0;
+		u64 deadline = 0;
+
+		while (true)
+		{
+			usize received = state->m_rx.read(buffer, length);
+
+			if (received > 0 || length == 0)
+			{
+				IoCounterCells::bump(state->m_stats.rx.bytes_received, received);
+
+				return move(received);
+			}
+
+			if (ctrl.writer_closed.load(::std::memory_order_acquire) != 0)
+			{
+				if (state->m_rx.readable() == 0)
+					return static_cast<usize>(0);
+
+				continue;
+			}
+
+			if (state->m_nonblocking)
+			{
+				IoCounterCells::bump(state->m_stats.rx.would_block);
+				IoCounterCells::bump(state->m_stats.rx.recv_failures);
+				return SocketReceiveError{ NetErrorKind::WOULD_BLOCK };
+			}
+
+			if (!spin_until(spins, state->m_recv_timeout_ms, deadline))
+			{
+				IoCounterCells::bump(state->m_stats.rx.recv_failures);
+				return SocketReceiveError{ NetErrorKind::TIMED_OUT };
+			}
+		}
+	}
+
+	Result<bool, SocketError> MemSocket::wait_readable(u64 timeout_ms)
+	{
+		_MemSocketState* state = m_sock;
+
+		if (state->m_is_closed)
+			return SocketError{ NetErrorKind::CLOSED };
+
+		if (state->m_pipe == nullptr && state->m_endpoint == nullptr)
+			return SocketError{ NetErrorKind::NOT_CONNECTED };
+
+		u32 spins = 0;
+		u64 deadline = 0;
+
+		while (true)
+		{
+			if (state->m_shutdown.load(::std::memory_order_acquire) != 0)
+				return true;
+
+			if (state->m_pipe != nullptr)
+			{
+				if (state->m_rx.readable() != 0 || state->m_rx.control().writer_closed.load(::std::memory_order_acquire) != 0)
+					return true;
+			}
+			else if (m_type == SockType::DATAGRAM)
+			{
+				if (state->m_endpoint->m_datagrams.ready())
+					return true;
+			}
+			else if (state->m_endpoint->m_accepts.m_cells != nullptr && state->m_endpoint->m_accepts.ready())
+			{
+				return true;
+			}
+
+			if (!spin_until(spins, timeout_ms, deadline))
+				return false;
+		}
+	}
+
+	Result<usize, SocketSendError> MemSocket::send_to(const SockAddr& addr, const u8* buffer, usize length)
+	{
+		_MemSocketState* state = m_sock;
+		_MemKey target = make_key(addr, m_type);
+
+		if (state->m_is_closed)
+		{
+			IoCounterCells::bump(state->m_stats.tx.send_failures);
+			return SocketSendError{ NetErrorKind::CLOSED };
+		}
+
+		if (m_type != SockType::DATAGRAM)
+		{
+			IoCounterCells::bump(state->m_stats.tx.send_failures);
+			return SocketSendError{ NetErrorKind::INVALID_ARGUMENT };
+		}
+
+		if (length > state->m_net->m_config.max_datagram)
+		{
+			IoCounterCells::bump(state->m_stats.tx.send_failures);
+			return SocketSendError{ NetErrorKind::MESSAGE_TOO_LONG };
+		}
+
+		NetErrorKind error = NetErrorKind::UNKNOWN;
+
+		if (!state->m_has_local && !autobind_state(state, target, error))
+		{
+			IoCounterCells::bump(state->m_stats.tx.send_failures);
+			return SocketSendError{ error };
+		}
+
+		_MemEndpointState ep_state;
+		u32 ep_gen = 0;
+		_MemEndpoint* ep = find_endpoint(state->m_net, target, ep_state, ep_gen);
+
+		if (ep != nullptr && enter_endpoint(*ep, ep_gen))
+		{
+			_MemKey source = source_key(state->m_local);
+
+			static_cast<void>(ep->m_datagrams.push([buffer, length, &source](_MemDatagramCell& cell) {
+				::std::memcpy(cell.data, buffer, length);
+				cell.length = length;
+				cell.source = source;
+			}));
+
+			leave_endpoint(*ep);
+		}
+
+		IoCounterCells::bump(state->m_stats.tx.bytes_sent, length);
+
+		return move(length);
+	}
+
+	Result<Tuple<usize, SockAddr>, SocketReceiveError> MemSocket::recv_from(u8* buffer, usize length)
+	{
+		_MemSocketState* state = m_sock;
+
+		if (state->m_is_closed)
+		{
+			IoCounterCells::bump(state->m_stats.rx.recv_failures);
+			return SocketReceiveError{ NetErrorKind::CLOSED };
+		}
+
+		if (m_type != SockType::DATAGRAM || state->m_endpoint == nullptr)
+		{
+			IoCounterCells::bump(state->m_stats.rx.recv_failures);
+			return SocketReceiveError{ NetErrorKind::INVALID_ARGUMENT };
+		}
+
+		_MemKey source{};
+		usize received = 0;
+		u32 spins = 0;
+		u64 deadline = 0;
+
+		while (true)
+		{
+			bool popped = state->m_endpoint->m_datagrams.pop([buffer, length, &source, &received](_MemDatagramCell& cell) {
+				received = cell.length < length ? cell.length : length;
+				::std::memcpy(buffer, cell.data, received);
+				source = cell.source;
+			});
+
+			if (popped)
+			{
+				if (state->m_has_peer && !key_equals(source, state->m_peer))
+					continue;
+
+				break;
+			}
+
+			if (state->m_shutdown.load(::std::memory_order_acquire) != 0)
+			{
+				IoCounterCells::bump(state->m_stats.rx.recv_failures);
+				return SocketReceiveError{ NetErrorKind::CLOSED };
+			}
+
+			if (state->m_nonblocking)
+			{
+				IoCounterCells::bump(state->m_stats.rx.would_block);
+				IoCounterCells::bump(state->m_stats.rx.recv_failures);
+				return SocketReceiveError{ NetErrorKind::WOULD_BLOCK };
+			}
+
+			if (!spin_until(spins, state->m_recv_timeout_ms, deadline))
+			{
+				IoCounterCells::bump(state->m_stats.rx.recv_failures);
+				return SocketReceiveError{ NetErrorKind::TIMED_OUT };
+			}
+		}
+
+		IoCounterCells::bump(state->m_stats.rx.bytes_received, received);
+
+		return Tuple<usize, SockAddr>{ received, key_to_addr(source) };
+	}
+}
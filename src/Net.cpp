@@ -1,33 +1,124 @@
 #include "Net.hpp"
+#include "NetRecord.hpp"
+#include "MemNet.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <vector>
 
 //#define _WINSOCK_DEPRECATED_NO_WARNINGS
 
 #include <WinSock2.h>
 #include <WS2tcpip.h>
+#include <afunix.h>
+#include <MSWSock.h>
+#include <mstcpip.h>
+#include <qos2.h>
+
+#include <intrin.h>
 
 #pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "qwave.lib")
 
 namespace bsl::net
 {
-	void setup()
+	static NetErrorKind error_kind_of(int code) noexcept
+	{
+		switch (code)
+		{
+		case WSAEWOULDBLOCK: return NetErrorKind::WOULD_BLOCK;
+		case WSAEINTR: return NetErrorKind::INTERRUPTED;
+		case WSAEINVAL:
+		case WSAEFAULT:
+		case WSAENOTSOCK:
+		case WSAEAFNOSUPPORT:
+		case WSAEPROTONOSUPPORT:
+		case WSAESOCKTNOSUPPORT:
+		case WSAEOPNOTSUPP: return NetErrorKind::INVALID_ARGUMENT;
+		case WSAENOBUFS:
+		case WSAEMFILE: return NetErrorKind::NO_BUFFERS;
+		case WSAEMSGSIZE: return NetErrorKind::MESSAGE_TOO_LONG;
+		case WSAEADDRINUSE: return NetErrorKind::ADDRESS_IN_USE;
+		case WSAEADDRNOTAVAIL: return NetErrorKind::ADDRESS_UNAVAILABLE;
+		case WSAENETDOWN:
+		case WSAENETUNREACH: return NetErrorKind::NETWORK_UNREACHABLE;
+		case WSAEHOSTDOWN:
+		case WSAEHOSTUNREACH: return NetErrorKind::HOST_UNREACHABLE;
+		case WSAHOST_NOT_FOUND:
+		case WSATRY_AGAIN:
+		case WSANO_DATA: return NetErrorKind::HOST_NOT_FOUND;
+		case WSAECONNREFUSED: return NetErrorKind::CONNECTION_REFUSED;
+		case WSAENETRESET:
+		case WSAECONNRESET: return NetErrorKind::CONNECTION_RESET;
+		case WSAECONNABORTED: return NetErrorKind::CONNECTION_ABORTED;
+		case WSAENOTCONN:
+		case WSAESHUTDOWN: return NetErrorKind::NOT_CONNECTED;
+		case WSAETIMEDOUT: return NetErrorKind::TIMED_OUT;
+		default: return NetErrorKind::UNKNOWN;
+		}
+	}
+
+	template<class E>
+	static E native_error(int code) noexcept
+	{
+		return E{ error_kind_of(code), code };
+	}
+
+	template<class E>
+	static E last_error() noexcept
+	{
+		return native_error<E>(::WSAGetLastError());
+	}
+
+	template<class E>
+	static E invalid_argument() noexcept
+	{
+		return native_error<E>(WSAEINVAL);
+	}
+
+	Result<Unit, NetError> try_setup()
 	{
 		WSADATA data;
 
 		int result = WSAStartup(MAKEWORD(2, 2), &data);
 
 		if (result != 0)
-			throw NetError{};
+			return native_error<NetError>(result);
+
+		return Unit{};
 	}
 
-	void cleanup()
+	Result<Unit, NetError> try_cleanup()
 	{
 		int result = WSACleanup();
 
 		if (result != 0)
-			throw NetError{};
+			return last_error<NetError>();
+
+		return Unit{};
+	}
+
+	void setup()
+	{
+		Result<Unit, NetError> result = try_setup();
+
+		if (result.is_error())
+			throw result.expect_error();
+	}
+
+	void cleanup()
+	{
+		Result<Unit, NetError> result = try_cleanup();
+
+		if (result.is_error())
+			throw result.expect_error();
 	}
 
-	const AddrIPv4 AddrIPv4::LOCALHOST = AddrIPv4{ 127, 0, 0, 0 };
+	const AddrIPv4 AddrIPv4::LOCALHOST = AddrIPv4{ 127, 0, 0, 1 };
 	const AddrIPv4 AddrIPv4::UNSPECIFIED = AddrIPv4{ 0, 0, 0, 0 };
 	const AddrIPv4 AddrIPv4::BROADCAST = AddrIPv4{ 255, 255, 255, 255 };
 
@@ -46,7 +137,7 @@ namespace bsl::net
 			&addr_info);
 
 		if (result != 0)
-			return HostnameResolutionError{};
+			return native_error<HostnameResolutionError>(result);
 
 		for (::ADDRINFO* it = addr_info; it != NULL; it = it->ai_next)
 		{
@@ -93,12 +184,13 @@ namespace bsl::net
 			}
 		}
 
-		return HostnameResolutionError{};
+		return native_error<HostnameResolutionError>(WSAHOST_NOT_FOUND);
 	}
 
 	struct _NativeSockAddr
 	{
 		::SOCKADDR_STORAGE m_sock_addr;
+		int m_sock_addr_len;
 	};
 
 	_NativeSockAddr SockAddrV4::to_native() const noexcept
@@ -117,6 +209,8 @@ namespace bsl::net
 
 		native_sock_addr->sin_port = ::htons(static_cast<::u_short>(m_port));
 
+		result.m_sock_addr_len = sizeof(::SOCKADDR_IN);
+
 		return result;
 	}
 
@@ -158,6 +252,8 @@ namespace bsl::net
 
 		native_sock_addr->sin6_port = ::htons(static_cast<::u_short>(m_port));
 
+		result.m_sock_addr_len = sizeof(::SOCKADDR_IN6);
+
 		return result;
 	}
 
@@ -183,12 +279,73 @@ namespace bsl::net
 		};
 	}
 
+	_NativeSockAddr SockAddrUnix::to_native() const noexcept
+	{
+		_NativeSockAddr result;
+		ZeroMemory(&result.m_sock_addr, sizeof(result.m_sock_addr));
+
+		::PSOCKADDR_UN native_sock_addr = reinterpret_cast<::PSOCKADDR_UN>(&result.m_sock_addr);
+
+		native_sock_addr->sun_family = AF_UNIX;
+
+		usize offset = m_is_abstract ? 1 : 0;
+
+		for (usize i = 0; i < m_length; ++i)
+			native_sock_addr->sun_path[offset + i] = m_path[i];
+
+		result.m_sock_addr_len = static_cast<int>(offsetof(::SOCKADDR_UN, sun_path) + offset + m_length);
+
+		if (!m_is_abstract)
+			result.m_sock_addr_len += 1;
+
+		return result;
+	}
+
+	Maybe<SockAddrUnix> SockAddrUnix::from_native(const _NativeSockAddr& native) noexcept
+	{
+		if (native.m_sock_addr.ss_family != AF_UNIX)
+			return {};
+
+		const ::SOCKADDR_UN* native_sock_addr = reinterpret_cast<const ::SOCKADDR_UN*>(&native.m_sock_addr);
+
+		usize path_len = 0;
+
+		if (native.m_sock_addr_len > static_cast<int>(offsetof(::SOCKADDR_UN, sun_path)))
+			path_len = static_cast<usize>(native.m_sock_addr_len) - offsetof(::SOCKADDR_UN, sun_path);
+
+		if (path_len > sizeof(native_sock_addr->sun_path))
+			path_len = sizeof(native_sock_addr->sun_path);
+
+		if (path_len == 0)
+			return SockAddrUnix{ native_sock_addr->sun_path, 0, false };
+
+		if (native_sock_addr->sun_path[0] == '\0')
+		{
+			usize length = path_len - 1;
+
+			while (length > 0 && native_sock_addr->sun_path[length] == '\0')
+				--length;
+
+			return SockAddrUnix{ native_sock_addr->sun_path + 1, length, true };
+		}
+
+		usize length = ::strnlen(native_sock_addr->sun_path, path_len);
+
+		if (length > MAX_PATH_LENGTH)
+			return {};
+
+		return SockAddrUnix{ native_sock_addr->sun_path, length, false };
+	}
+
 	_NativeSockAddr SockAddr::to_native() const noexcept
 	{
-		if (m_addr.index() == 0)
-			return get<0>(m_addr).to_native();
-		
-		return get<1>(m_addr).to_native();
+		switch (m_addr.index())
+		{
+		case 0: return get<0>(m_addr).to_native();
+		case 1: return get<1>(m_addr).to_native();
+		}
+
+		return get<2>(m_addr).to_native();
 	}
 
 	Maybe<SockAddr> SockAddr::from_native(const _NativeSockAddr& native) noexcept
@@ -197,16 +354,382 @@ namespace bsl::net
 		{
 		case AF_INET: return Maybe<SockAddr>{ SockAddrV4::from_native(native) };
 		case AF_INET6: return Maybe<SockAddr>{ SockAddrV6::from_native(native) };
+		case AF_UNIX: return Maybe<SockAddr>{ SockAddrUnix::from_native(native) };
 		}
 
 		return {};
 	}
 
+	enum class _IoCounter
+	{
+		BYTES_SENT,
+		BYTES_RECEIVED,
+		SYSCALLS,
+		SHORT_WRITES,
+		WOULD_BLOCK,
+		CONNECTS,
+		CONNECT_FAILURES,
+		ACCEPTS,
+		ACCEPT_FAILURES,
+		SEND_FAILURES,
+		RECV_FAILURES,
+		SPIN_NS,
+		SPIN_HITS,
+		SPIN_MISSES,
+		POLL_WAIT_NS,
+		COUNT
+	};
+
+	struct _ThreadIoMetrics
+	{
+		::std::atomic<u64> m_counters[static_cast<usize>(_IoCounter::COUNT)];
+		::std::atomic<u64> m_latency[IO_OP_COUNT][IoLatencyHistogram::BUCKET_COUNT];
+
+		_ThreadIoMetrics() noexcept
+		{
+			for (::std::atomic<u64>& counter : m_counters)
+				counter.store(0, ::std::memory_order_relaxed);
+
+			for (usize op = 0; op < IO_OP_COUNT; ++op)
+				for (::std::atomic<u64>& bucket : m_latency[op])
+					bucket.store(0, ::std::memory_order_relaxed);
+		}
+
+		static void bump(::std::atomic<u64>& cell, u64 value) noexcept
+		{
+			cell.store(cell.load(::std::memory_order_relaxed) + value, ::std::memory_order_relaxed);
+		}
+
+		void add(_IoCounter counter, u64 value) noexcept
+		{
+			bump(m_counters[static_cast<usize>(counter)], value);
+		}
+
+		void add_latency(IoOp op, u64 ns) noexcept
+		{
+			bump(m_latency[static_cast<usize>(op)][IoLatencyHistogram::index_of(ns)], 1);
+		}
+
+		void accumulate_into(IoMetrics& out) const noexcept
+		{
+			const ::std::atomic<u64>* c = m_counters;
+			IoCounters counters;
+
+			counters.bytes_sent = c[static_cast<usize>(_IoCounter::BYTES_SENT)].load(::std::memory_order_relaxed);
+			counters.bytes_received = c[static_cast<usize>(_IoCounter::BYTES_RECEIVED)].load(::std::memory_order_relaxed);
+			counters.syscalls = c[static_cast<usize>(_IoCounter::SYSCALLS)].load(::std::memory_order_relaxed);
+			counters.short_writes = c[static_cast<usize>(_IoCounter::SHORT_WRITES)].load(::std::memory_order_relaxed);
+			counters.would_block = c[static_cast<usize>(_IoCounter::WOULD_BLOCK)].load(::std::memory_order_relaxed);
+			counters.connects = c[static_cast<usize>(_IoCounter::CONNECTS)].load(::std::memory_order_relaxed);
+			counters.connect_failures = c[static_cast<usize>(_IoCounter::CONNECT_FAILURES)].load(::std::memory_order_relaxed);
+			counters.accepts = c[static_cast<usize>(_IoCounter::ACCEPTS)].load(::std::memory_order_relaxed);
+			counters.accept_failures = c[static_cast<usize>(_IoCounter::ACCEPT_FAILURES)].load(::std::memory_order_relaxed);
+			counters.send_failures = c[static_cast<usize>(_IoCounter::SEND_FAILURES)].load(::std::memory_order_relaxed);
+			counters.recv_failures = c[static_cast<usize>(_IoCounter::RECV_FAILURES)].load(::std::memory_order_relaxed);
+			counters.spin_ns = c[static_cast<usize>(_IoCounter::SPIN_NS)].load(::std::memory_order_relaxed);
+			counters.spin_hits = c[static_cast<usize>(_IoCounter::SPIN_HITS)].load(::std::memory_order_relaxed);
+			counters.spin_misses = c[static_cast<usize>(_IoCounter::SPIN_MISSES)].load(::std::memory_order_relaxed);
+			counters.poll_wait_ns = c[static_cast<usize>(_IoCounter::POLL_WAIT_NS)].load(::std::memory_order_relaxed);
+
+			out.counters.merge(counters);
+
+			for (usize op = 0; op < IO_OP_COUNT; ++op)
+				for (usize i = 0; i < IoLatencyHistogram::BUCKET_COUNT; ++i)
+				{
+					u64 count = m_latency[op][i].load(::std::memory_order_relaxed);
+
+					if (count != 0)
+						out.latency[op].record(IoLatencyHistogram::highest_equivalent(i), count);
+				}
+		}
+
+		void absorb(const _ThreadIoMetrics& other) noexcept
+		{
+			for (usize i = 0; i < static_cast<usize>(_IoCounter::COUNT); ++i)
+				bump(m_counters[i], other.m_counters[i].load(::std::memory_order_relaxed));
+
+			for (usize op = 0; op < IO_OP_COUNT; ++op)
+				for (usize i = 0; i < IoLatencyHistogram::BUCKET_COUNT; ++i)
+					bump(m_latency[op][i], other.m_latency[op][i].load(::std::memory_order_relaxed));
+		}
+	};
+
+	struct _IoMetricsRegistry
+	{
+		::std::mutex m_mutex;
+		::std::vector<_ThreadIoMetrics*> m_threads;
+		_ThreadIoMetrics m_retired;
+		::std::atomic<bool> m_latency_enabled{ false };
+	};
+
+	static _IoMetricsRegistry& io_registry()
+	{
+		static _IoMetricsRegistry* registry = new _IoMetricsRegistry{};
+		return *registry;
+	}
+
+	struct _ThreadIoMetricsHandle
+	{
+		_ThreadIoMetrics* m_metrics;
+
+		_ThreadIoMetricsHandle()
+			: m_metrics{ new _ThreadIoMetrics{} }
+		{
+			_IoMetricsRegistry& registry = io_registry();
+			::std::lock_guard<::std::mutex> lock{ registry.m_mutex };
+			registry.m_threads.push_back(m_metrics);
+		}
+
+		~_ThreadIoMetricsHandle()
+		{
+			_IoMetricsRegistry& registry = io_registry();
+			::std::lock_guard<::std::mutex> lock{ registry.m_mutex };
+
+			registry.m_retired.absorb(*m_metrics);
+
+			for (usize i = 0; i < registry.m_threads.size(); ++i)
+				if (registry.m_threads[i] == m_metrics)
+				{
+					registry.m_threads[i] = registry.m_threads.back();
+					registry.m_threads.pop_back();
+					break;
+				}
+
+			delete m_metrics;
+		}
+	};
+
+	static _ThreadIoMetrics& thread_io_metrics()
+	{
+		thread_local _ThreadIoMetricsHandle handle;
+		return *handle.m_metrics;
+	}
+
+	static u64 steady_clock_ns() noexcept
+	{
+		return static_cast<u64>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(
+			::std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	static u64 io_clock_now() noexcept
+	{
+		if (!io_registry().m_latency_enabled.load(::std::memory_order_relaxed))
+			return 0;
+
+		return steady_clock_ns();
+	}
+
+	static void io_record_latency(_ThreadIoMetrics& metrics, IoOp op, u64 start) noexcept
+	{
+		if (start == 0)
+			return;
+
+		metrics.add_latency(op, steady_clock_ns() - start);
+	}
+
+	namespace metrics
+	{
+		void set_latency_enabled(bool enabled) noexcept
+		{
+			io_registry().m_latency_enabled.store(enabled, ::std::memory_order_relaxed);
+		}
+
+		bool latency_enabled() noexcept
+		{
+			return io_registry().m_latency_enabled.load(::std::memory_order_relaxed);
+		}
+
+		void snapshot(IoMetrics& out)
+		{
+			out = IoMetrics{};
+
+			_IoMetricsRegistry& registry = io_registry();
+			::std::lock_guard<::std::mutex> lock{ registry.m_mutex };
+
+			registry.m_retired.accumulate_into(out);
+
+			for (const _ThreadIoMetrics* metrics : registry.m_threads)
+				metrics->accumulate_into(out);
+		}
+	}
+
 	struct _NativeSocket
 	{
 		::SOCKET m_sock;
+		SocketIoCounters m_stats;
+		_TrafficRecorderState* m_recorder;
+		u32 m_session;
+		::HANDLE m_qos;
+		::QOS_FLOWID m_qos_flow;
+		u64 m_spin_budget_ns;
+		::LPFN_WSARECVMSG m_recv_msg;
+		::LPFN_CONNECTEX m_connect_ex;
+		MemSocket* m_mem;
 	};
 
+	static constexpr u64 ACCEPT_WAKE_MS = 100;
+	static constexpr u64 ACCEPT_CLOSE_MS = 1000;
+
+	static int load_extension(::SOCKET sock, ::GUID guid, void* function, usize size) noexcept
+	{
+		::DWORD bytes_returned = 0;
+
+		return ::WSAIoctl(
+			sock,
+			SIO_GET_EXTENSION_FUNCTION_POINTER,
+			&guid,
+			sizeof(guid),
+			function,
+			static_cast<::DWORD>(size),
+			&bytes_returned,
+			NULL,
+			NULL);
+	}
+
+	static void remove_pacing_flow(_NativeSocket& native) noexcept
+	{
+		if (native.m_qos_flow != 0)
+		{
+			::QOSRemoveSocketFromFlow(native.m_qos, native.m_sock, native.m_qos_flow, 0);
+			native.m_qos_flow = 0;
+		}
+	}
+
+	static void count_failure(_ThreadIoMetrics& metrics, IoCounterCells& stats, _IoCounter counter, ::std::atomic<u64>& stat)
+	{
+		if (::WSAGetLastError() == WSAEWOULDBLOCK)
+		{
+			metrics.add(_IoCounter::WOULD_BLOCK, 1);
+			IoCounterCells::bump(stats.would_block);
+			return;
+		}
+
+		metrics.add(counter, 1);
+		IoCounterCells::bump(stat);
+	}
+
+	static void count_syscall(_ThreadIoMetrics& metrics, IoCounterCells& stats) noexcept
+	{
+		metrics.add(_IoCounter::SYSCALLS, 1);
+		IoCounterCells::bump(stats.syscalls);
+	}
+
+	static void count_sent(_ThreadIoMetrics& metrics, IoCounterCells& stats, usize requested, usize sent) noexcept
+	{
+		metrics.add(_IoCounter::BYTES_SENT, sent);
+		IoCounterCells::bump(stats.bytes_sent, sent);
+
+		if (sent < requested)
+		{
+			metrics.add(_IoCounter::SHORT_WRITES, 1);
+			IoCounterCells::bump(stats.short_writes);
+		}
+	}
+
+	static void count_received(_ThreadIoMetrics& metrics, IoCounterCells& stats, usize received) noexcept
+	{
+		metrics.add(_IoCounter::BYTES_RECEIVED, received);
+		IoCounterCells::bump(stats.bytes_received, received);
+	}
+
+	static u64 qpc_to_ns(u64 ticks) noexcept
+	{
+		static const u64 frequency = [] {
+			::LARGE_INTEGER value;
+			::QueryPerformanceFrequency(&value);
+			return static_cast<u64>(value.QuadPart);
+		}();
+
+		return (ticks / frequency) * 1'000'000'000 + (ticks % frequency) * 1'000'000'000 / frequency;
+	}
+
+	static int recv_msg(const _NativeSocket& native, u8* buffer, usize length, _NativeSockAddr* from, u64& kernel_ns)
+	{
+		::WSABUF data;
+		data.len = static_cast<::ULONG>(length);
+		data.buf = reinterpret_cast<char*>(buffer);
+
+		alignas(::WSACMSGHDR) char control[WSA_CMSG_SPACE(sizeof(::UINT64))];
+
+		::WSAMSG msg{};
+		msg.name = from != nullptr ? reinterpret_cast<::LPSOCKADDR>(&from->m_sock_addr) : nullptr;
+		msg.namelen = from != nullptr ? sizeof(from->m_sock_addr) : 0;
+		msg.lpBuffers = &data;
+		msg.dwBufferCount = 1;
+		msg.Control.len = sizeof(control);
+		msg.Control.buf = control;
+
+		::DWORD received = 0;
+
+		int result = native.m_recv_msg(native.m_sock, &msg, &received, nullptr, nullptr);
+
+		if (result == SOCKET_ERROR)
+			return SOCKET_ERROR;
+
+		if (from != nullptr)
+			from->m_sock_addr_len = msg.namelen;
+
+		for (::WSACMSGHDR* header = WSA_CMSG_FIRSTHDR(&msg); header != nullptr; header = WSA_CMSG_NXTHDR(&msg, header))
+		{
+			if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SO_TIMESTAMP)
+				continue;
+
+			::UINT64 ticks;
+			::std::memcpy(&ticks, WSA_CMSG_DATA(header), sizeof(ticks));
+
+			kernel_ns = qpc_to_ns(ticks);
+		}
+
+		return static_cast<int>(received);
+	}
+
+	template<class Attempt>
+	static int busy_poll(const _NativeSocket& native, _ThreadIoMetrics& metrics, IoCounterCells& stats, Attempt&& attempt)
+	{
+		::WSAPOLLFD poll_fd{};
+		poll_fd.fd = native.m_sock;
+		poll_fd.events = POLLRDNORM;
+
+		u64 start = steady_clock_ns();
+		u64 now = start;
+		int ready = 0;
+
+		for (;;)
+		{
+			ready = ::WSAPoll(&poll_fd, 1, 0);
+
+			count_syscall(metrics, stats);
+			now = steady_clock_ns();
+
+			if (ready != 0 || now - start >= native.m_spin_budget_ns)
+				break;
+
+			_mm_pause();
+		}
+
+		metrics.add(_IoCounter::SPIN_NS, now - start);
+		IoCounterCells::bump(stats.spin_ns, now - start);
+
+		if (ready > 0)
+		{
+			metrics.add(_IoCounter::SPIN_HITS, 1);
+			IoCounterCells::bump(stats.spin_hits);
+			return attempt();
+		}
+
+		metrics.add(_IoCounter::SPIN_MISSES, 1);
+		IoCounterCells::bump(stats.spin_misses);
+
+		u64 wait_start = steady_clock_ns();
+		int result = attempt();
+		u64 waited = steady_clock_ns() - wait_start;
+
+		metrics.add(_IoCounter::POLL_WAIT_NS, waited);
+		IoCounterCells::bump(stats.poll_wait_ns, waited);
+
+		return result;
+	}
+
 	Maybe<Socket> Socket::from_native(const _NativeSocket& native)
 	{
 		::WSAPROTOCOL_INFOW proto_info;
@@ -232,6 +755,7 @@ namespace bsl::net
 		case AF_UNSPEC: af = AddrFamily::UNSPECIFIED; break;
 		case AF_INET: af = AddrFamily::IPv4; break;
 		case AF_INET6: af = AddrFamily::IPv6; break;
+		case AF_UNIX: af = AddrFamily::UNIX; break;
 		default: return {};
 		}
 
@@ -248,6 +772,7 @@ namespace bsl::net
 
 		switch (proto_info.iProtocol)
 		{
+		case 0: pt = Proto::UNSPECIFIED; break;
 		case ::IPPROTO_TCP: pt = Proto::TCP; break;
 		case ::IPPROTO_UDP: pt = Proto::UDP; break;
 		default: return {};
@@ -261,8 +786,7 @@ namespace bsl::net
 	{
 	}
 
-	Socket::Socket(AddrFamily family, SockType type, Proto proto)
-		: m_family{ family }, m_type{ type }, m_proto{ proto }
+	Result<Socket, SocketError> Socket::create(AddrFamily family, SockType type, Proto proto)
 	{
 		int af, ty, pt;
 
@@ -271,28 +795,53 @@ namespace bsl::net
 		case AddrFamily::UNSPECIFIED: af = AF_UNSPEC; break;
 		case AddrFamily::IPv4: af = AF_INET; break;
 		case AddrFamily::IPv6: af = AF_INET6; break;
-		default: throw SocketError{};
+		case AddrFamily::UNIX: af = AF_UNIX; break;
+		default: return invalid_argument<SocketError>();
 		}
 
 		switch (type)
 		{
 		case SockType::STREAM: ty = SOCK_STREAM; break;
 		case SockType::DATAGRAM: ty = SOCK_DGRAM; break;
-		default: throw SocketError{};
+		default: return invalid_argument<SocketError>();
 		}
 
 		switch (proto)
 		{
+		case Proto::UNSPECIFIED: pt = 0; break;
 		case Proto::TCP: pt = ::IPPROTO_TCP; break;
 		case Proto::UDP: pt = ::IPPROTO_UDP; break;
-		default: throw SocketError{};
+		default: return invalid_argument<SocketError>();
 		}
 
-		m_sock = new _NativeSocket{};
-		m_sock->m_sock = ::socket(af, ty, pt);
+		_NativeSocket native{};
+		native.m_sock = ::socket(af, ty, pt);
 
-		if (m_sock->m_sock == INVALID_SOCKET)
-			throw SocketError{};
+		if (native.m_sock == INVALID_SOCKET)
+			return last_error<SocketError>();
+
+		return Socket{ native, family, type, proto };
+	}
+
+	static Socket create_or_throw(AddrFamily family, SockType type, Proto proto)
+	{
+		Result<Socket, SocketError> result = Socket::create(family, type, proto);
+
+		if (result.is_error())
+			throw result.expect_error();
+
+		return result.expect();
+	}
+
+	Socket::Socket(AddrFamily family, SockType type, Proto proto)
+		: Socket{ create_or_throw(family, type, proto) }
+	{
+	}
+
+	Socket::Socket(MemSocket&& sock)
+		: m_sock{ new _NativeSocket{ INVALID_SOCKET } }, m_family{ sock.addr_family() }, m_type{ sock.sock_type() }, m_proto{ sock.proto() }
+	{
+		m_sock->m_mem = new MemSocket{ move(sock) };
 	}
 
 	Socket::Socket(Socket&& other) noexcept
@@ -305,13 +854,36 @@ namespace bsl::net
 	{
 		if (m_sock != nullptr)
 		{
-			::shutdown(m_sock->m_sock, SD_BOTH);
-			::closesocket(m_sock->m_sock);
+			if (m_sock->m_sock != INVALID_SOCKET)
+			{
+				remove_pacing_flow(*m_sock);
+
+				::shutdown(m_sock->m_sock, SD_BOTH);
+				::closesocket(m_sock->m_sock);
+			}
+
+			if (m_sock->m_qos != NULL)
+				::QOSCloseHandle(m_sock->m_qos);
 
+			if (m_sock->m_recorder != nullptr)
+				_traffic_session_close(m_sock->m_recorder, m_sock->m_session);
+
+			delete m_sock->m_mem;
 			delete m_sock;
 		}
 	}
 
+	void Socket::set_recorder(_TrafficRecorderState* recorder)
+	{
+		if (m_sock->m_recorder != nullptr)
+			_traffic_session_close(m_sock->m_recorder, m_sock->m_session);
+
+		m_sock->m_recorder = recorder;
+
+		if (recorder != nullptr)
+			m_sock->m_session = _traffic_session_open(recorder);
+	}
+
 	AddrFamily Socket::addr_family() const noexcept
 	{
 		return m_family;
@@ -329,116 +901,310 @@ namespace bsl::net
 
 	Result<Unit, SocketConnectError> Socket::connect(const SockAddr& addr)
 	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->connect(addr);
+
 		_NativeSockAddr native_sock_addr = addr.to_native();
 
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.tx;
+		u64 start = io_clock_now();
+
 		int result = ::connect(
 			m_sock->m_sock, 
 			reinterpret_cast<::sockaddr*>(&native_sock_addr.m_sock_addr),
-			sizeof(native_sock_addr.m_sock_addr));
+			native_sock_addr.m_sock_addr_len);
+
+		io_record_latency(metrics, IoOp::CONNECT, start);
+		count_syscall(metrics, stats);
 
 		if (result == SOCKET_ERROR)
-			return SocketConnectError{};
+		{
+			count_failure(metrics, stats, _IoCounter::CONNECT_FAILURES, stats.connect_failures);
+			return last_error<SocketConnectError>();
+		}
+
+		metrics.add(_IoCounter::CONNECTS, 1);
+		IoCounterCells::bump(stats.connects);
 
 		return Unit{};
 	}
 
-	Result<Unit, SocketCloseError> Socket::close()
+	Result<usize, SocketConnectError> Socket::connect_with_data(const SockAddr& addr, const u8* buffer, usize length)
 	{
-		int result = ::closesocket(m_sock->m_sock);
+		if (m_type != SockType::STREAM)
+			return invalid_argument<SocketConnectError>();
 
-		if (result == SOCKET_ERROR)
-			return SocketCloseError{};
+		if (m_sock->m_mem != nullptr)
+		{
+			Result<Unit, SocketConnectError> connected = m_sock->m_mem->connect(addr);
 
-		return Unit{};
-	}
+			if (connected.is_error())
+				return connected.expect_error();
 
-	Result<Unit, SocketBindError> Socket::bind(const SockAddr& addr)
-	{
-		_NativeSockAddr native_sock_addr = addr.to_native();
+			if (length == 0)
+				return static_cast<usize>(0);
 
-		int result = ::bind(
-			m_sock->m_sock, 
-			reinterpret_cast<const ::SOCKADDR*>(&native_sock_addr.m_sock_addr),
-			sizeof(native_sock_addr.m_sock_addr));
+			Result<usize, SocketSendError> sent = m_sock->m_mem->send(buffer, length);
+
+			if (sent.is_error())
+			{
+				SocketSendError error = sent.expect_error();
+				return SocketConnectError{ error.kind(), error.native_code() };
+			}
+
+			return sent.expect();
+		}
+
+		_NativeSockAddr native_sock_addr = addr.to_native();
+
+		_NativeSockAddr local_addr;
+		ZeroMemory(&local_addr.m_sock_addr, sizeof(local_addr.m_sock_addr));
+		local_addr.m_sock_addr.ss_family = native_sock_addr.m_sock_addr.ss_family;
+		local_addr.m_sock_addr_len = native_sock_addr.m_sock_addr_len;
+
+		if (::bind(m_sock->m_sock, reinterpret_cast<const ::SOCKADDR*>(&local_addr.m_sock_addr), local_addr.m_sock_addr_len) == SOCKET_ERROR
+			&& ::WSAGetLastError() != WSAEINVAL)
+			return last_error<SocketConnectError>();
+
+		if (m_sock->m_connect_ex == nullptr)
+		{
+			if (load_extension(m_sock->m_sock, WSAID_CONNECTEX, &m_sock->m_connect_ex, sizeof(m_sock->m_connect_ex)) == SOCKET_ERROR)
+			{
+				m_sock->m_connect_ex = nullptr;
+				return last_error<SocketConnectError>();
+			}
+		}
+
+		Result<Unit, SocketError> fast_open = set_fast_open(true);
+
+		if (fast_open.is_error())
+		{
+			SocketError error = fast_open.expect_error();
+			return SocketConnectError{ error.kind(), error.native_code() };
+		}
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.tx;
+		u64 start = io_clock_now();
+
+		::WSAOVERLAPPED overlapped{};
+		overlapped.hEvent = ::WSACreateEvent();
+
+		if (overlapped.hEvent == WSA_INVALID_EVENT)
+			return last_error<SocketConnectError>();
+
+		::DWORD sent = 0;
+		int error = 0;
+
+		::BOOL ok = m_sock->m_connect_ex(
+			m_sock->m_sock,
+			reinterpret_cast<const ::SOCKADDR*>(&native_sock_addr.m_sock_addr),
+			native_sock_addr.m_sock_addr_len,
+			const_cast<u8*>(buffer),
+			static_cast<::DWORD>(length),
+			&sent,
+			&overlapped);
+
+		if (!ok)
+		{
+			error = ::WSAGetLastError();
+
+			if (error == WSA_IO_PENDING)
+			{
+				::DWORD flags = 0;
+				ok = ::WSAGetOverlappedResult(m_sock->m_sock, &overlapped, &sent, TRUE, &flags);
+				error = ok ? 0 : ::WSAGetLastError();
+			}
+		}
+
+		::WSACloseEvent(overlapped.hEvent);
+
+		io_record_latency(metrics, IoOp::CONNECT, start);
+		count_syscall(metrics, stats);
+
+		if (!ok)
+		{
+			count_failure(metrics, stats, _IoCounter::CONNECT_FAILURES, stats.connect_failures);
+			return native_error<SocketConnectError>(error);
+		}
+
+		::setsockopt(m_sock->m_sock, SOL_SOCKET, SO_UPDATE_CONNECT_CONTEXT, NULL, 0);
+
+		metrics.add(_IoCounter::CONNECTS, 1);
+		IoCounterCells::bump(stats.connects);
+
+		if (length != 0)
+		{
+			count_sent(metrics, stats, length, static_cast<usize>(sent));
+
+			if (m_sock->m_recorder != nullptr)
+				_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::OUTBOUND, buffer, static_cast<usize>(sent));
+		}
+
+		return static_cast<usize>(sent);
+	}
+
+	Result<Unit, SocketCloseError> Socket::close()
+	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->close();
+
+		if (m_sock->m_sock == INVALID_SOCKET)
+			return Unit{};
+
+		remove_pacing_flow(*m_sock);
+
+		int result = ::closesocket(m_sock->m_sock);
+		m_sock->m_sock = INVALID_SOCKET;
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketCloseError>();
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketError> Socket::shutdown()
+	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->shutdown();
+
+		if (m_sock->m_sock == INVALID_SOCKET)
+			return Unit{};
+
+		int result = ::shutdown(m_sock->m_sock, SD_BOTH);
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketError>();
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketBindError> Socket::bind(const SockAddr& addr)
+	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->bind(addr);
+
+		_NativeSockAddr native_sock_addr = addr.to_native();
+
+		int result = ::bind(
+			m_sock->m_sock, 
+			reinterpret_cast<const ::SOCKADDR*>(&native_sock_addr.m_sock_addr),
+			native_sock_addr.m_sock_addr_len);
 
 		if (result == SOCKET_ERROR)
-			return SocketBindError{};
+			return last_error<SocketBindError>();
 
 		return Unit{};
 	}
 
 	Result<Unit, SocketListenError> Socket::listen(usize backlog)
 	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->listen(backlog);
+
 		int result = ::listen(m_sock->m_sock, static_cast<int>(backlog));
 
 		if (result == SOCKET_ERROR)
-			return SocketListenError{};
+			return last_error<SocketListenError>();
 
 		return Unit{};
 	}
 
 	[[nodiscard]] Result<Socket, SocketAcceptError> Socket::accept()
 	{
+		if (m_sock->m_mem != nullptr)
+		{
+			Result<MemSocket, SocketAcceptError> accepted = m_sock->m_mem->accept();
+
+			if (accepted.is_error())
+				return accepted.expect_error();
+
+			return Socket{ accepted.expect() };
+		}
+
 		_NativeSockAddr native_sock_addr;
-		int sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
+		native_sock_addr.m_sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
 
 		_NativeSocket native_sock;
 
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.rx;
+		u64 start = io_clock_now();
+
 		native_sock.m_sock = ::accept(
 			m_sock->m_sock, 
 			reinterpret_cast<::sockaddr*>(&native_sock_addr.m_sock_addr),
-			&sock_addr_len);
+			&native_sock_addr.m_sock_addr_len);
+
+		io_record_latency(metrics, IoOp::ACCEPT, start);
+		count_syscall(metrics, stats);
 
 		if (native_sock.m_sock == INVALID_SOCKET)
-			return SocketAcceptError{};
+		{
+			count_failure(metrics, stats, _IoCounter::ACCEPT_FAILURES, stats.accept_failures);
+			return last_error<SocketAcceptError>();
+		}
+
+		metrics.add(_IoCounter::ACCEPTS, 1);
+		IoCounterCells::bump(stats.accepts);
 
 		return Socket{ native_sock, m_family, m_type, m_proto };
 	}
 
 	Result<SockAddr, SocketError> Socket::addr() const
 	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->addr();
+
 		_NativeSockAddr native_sock_addr;
-		int storage_len = sizeof(native_sock_addr.m_sock_addr);
+		native_sock_addr.m_sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
 
 		int result = ::getsockname(
 			m_sock->m_sock, 
 			reinterpret_cast<::PSOCKADDR>(&native_sock_addr.m_sock_addr),
-			&storage_len);
+			&native_sock_addr.m_sock_addr_len);
 
 		if (result == SOCKET_ERROR)
-			return SocketError{};
+			return last_error<SocketError>();
 
 		Maybe<SockAddr> sock_addr = SockAddr::from_native(native_sock_addr);
 		
 		if (sock_addr.has_value())
 			return sock_addr.unwrap();
 
-		return SocketError{};
+		return invalid_argument<SocketError>();
 	}
 
 	Result<SockAddr, SocketError> Socket::peer() const
 	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->peer();
+
 		_NativeSockAddr native_sock_addr;
-		int storage_len = sizeof(native_sock_addr.m_sock_addr);
+		native_sock_addr.m_sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
 
 		int result = ::getpeername(
 			m_sock->m_sock, 
 			reinterpret_cast<::PSOCKADDR>(&native_sock_addr.m_sock_addr),
-			&storage_len);
+			&native_sock_addr.m_sock_addr_len);
 
 		if (result == SOCKET_ERROR)
-			return SocketError{};
+			return last_error<SocketError>();
 
 		Maybe<SockAddr> sock_addr = SockAddr::from_native(native_sock_addr);
 
 		if (sock_addr.has_value())
 			return sock_addr.unwrap();
 
-		return SocketError{};
+		return invalid_argument<SocketError>();
 	}
 
 	bool Socket::is_connected() const noexcept
 	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->is_connected();
+
 		::SOCKADDR_STORAGE native_sock_addr;
 		int storage_len = sizeof(native_sock_addr);
 
@@ -450,101 +1216,1094 @@ namespace bsl::net
 		return result == 0;
 	}
 
-	Result<usize, SocketSendError> Socket::send(const u8* buffer, usize length)
+	Result<Unit, SocketError> Socket::set_nonblocking(bool enable)
 	{
-		int result = ::send(
-			m_sock->m_sock, 
-			reinterpret_cast<const char*>(buffer), 
-			static_cast<int>(length), 0);
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->set_nonblocking(enable);
+
+		::u_long mode = enable ? 1 : 0;
+
+		int result = ::ioctlsocket(m_sock->m_sock, FIONBIO, &mode);
 
 		if (result == SOCKET_ERROR)
-			return SocketSendError{};
+			return last_error<SocketError>();
 
-		return static_cast<usize>(result);
+		return Unit{};
 	}
 
-	Result<usize, SocketReceiveError> Socket::recv(u8* buffer, usize length)
+	Result<Unit, SocketError> Socket::set_pacing_rate(const SockAddr& dest, u64 bits_per_second)
 	{
-		int result = ::recv(
-			m_sock->m_sock, 
-			reinterpret_cast<char*>(buffer), 
-			static_cast<int>(length), 
-			0);
+		if (m_type != SockType::DATAGRAM || dest.is_unix())
+			return invalid_argument<SocketError>();
 
-		if (result == SOCKET_ERROR)
-			return SocketReceiveError{};
+		remove_pacing_flow(*m_sock);
 
-		return static_cast<usize>(result);
+		if (bits_per_second == 0)
+			return Unit{};
+
+		if (m_sock->m_qos == NULL)
+		{
+			::QOS_VERSION version{ 1, 0 };
+
+			if (!::QOSCreateHandle(&version, &m_sock->m_qos))
+			{
+				m_sock->m_qos = NULL;
+				return last_error<SocketError>();
+			}
+		}
+
+		_NativeSockAddr native_sock_addr = dest.to_native();
+
+		::QOS_FLOWID flow = 0;
+
+		if (!::QOSAddSocketToFlow(
+			m_sock->m_qos,
+			m_sock->m_sock,
+			reinterpret_cast<::PSOCKADDR>(&native_sock_addr.m_sock_addr),
+			::QOSTrafficTypeBestEffort,
+			QOS_NON_ADAPTIVE_FLOW,
+			&flow))
+			return last_error<SocketError>();
+
+		m_sock->m_qos_flow = flow;
+
+		::QOS_FLOWRATE_OUTGOING rate{};
+		rate.Bandwidth = bits_per_second;
+		rate.ShapingBehavior = ::QOSShapeOnly;
+		rate.Reason = ::QOSFlowRateNotApplicable;
+
+		if (!::QOSSetFlow(m_sock->m_qos, flow, ::QOSSetOutgoingRate, sizeof(rate), &rate, 0, nullptr))
+		{
+			SocketError error = last_error<SocketError>();
+
+			remove_pacing_flow(*m_sock);
+			return error;
+		}
+
+		return Unit{};
 	}
 
-	Result<usize, SocketSendError> Socket::send_to(const SockAddr& addr, const u8* buffer, usize length)
+	Result<Unit, SocketError> Socket::set_busy_poll(u64 spin_budget_ns)
 	{
-		_NativeSockAddr native_sock_addr = addr.to_native();
+		m_sock->m_spin_budget_ns = spin_budget_ns;
 
-		int result = ::sendto(
+		return Unit{};
+	}
+
+	u64 Socket::busy_poll_budget() const noexcept
+	{
+		return m_sock->m_spin_budget_ns;
+	}
+
+	Result<Unit, SocketError> Socket::set_rx_timestamps(bool enable)
+	{
+		if (m_type != SockType::DATAGRAM)
+			return invalid_argument<SocketError>();
+
+		if (m_sock->m_recv_msg == nullptr)
+		{
+			if (load_extension(m_sock->m_sock, WSAID_WSARECVMSG, &m_sock->m_recv_msg, sizeof(m_sock->m_recv_msg)) == SOCKET_ERROR)
+			{
+				m_sock->m_recv_msg = nullptr;
+				return last_error<SocketError>();
+			}
+		}
+
+		::TIMESTAMPING_CONFIG config{};
+		config.Flags = enable ? TIMESTAMPING_FLAG_RX : 0;
+
+		::DWORD bytes_returned = 0;
+
+		int result = ::WSAIoctl(
 			m_sock->m_sock,
-			reinterpret_cast<const char*>(buffer),
-			static_cast<int>(length),
+			SIO_TIMESTAMPING,
+			&config,
+			sizeof(config),
+			NULL,
 			0,
-			reinterpret_cast<const ::SOCKADDR*>(&native_sock_addr.m_sock_addr),
-			sizeof(native_sock_addr.m_sock_addr));
+			&bytes_returned,
+			NULL,
+			NULL);
 
 		if (result == SOCKET_ERROR)
-			return SocketSendError{};
+			return last_error<SocketError>();
 
-		return static_cast<usize>(result);
+		return Unit{};
 	}
 
-	Result<Tuple<usize, SockAddr>, SocketReceiveError> Socket::recv_from(u8* buffer, usize length)
+	IoCounters Socket::stats() const noexcept
 	{
-		_NativeSockAddr native_sock_addr;
-		int native_sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->stats();
+
+		return m_sock->m_stats.snapshot();
+	}
+
+	Result<Unit, SocketError> Socket::set_nodelay(bool enable)
+	{
+		if (m_sock->m_mem != nullptr)
+			return Unit{};
+
+		::BOOL value = enable ? TRUE : FALSE;
 
-		int result = ::recvfrom(
+		int result = ::setsockopt(
 			m_sock->m_sock,
-			reinterpret_cast<char*>(buffer),
-			static_cast<int>(length),
-			0,
-			reinterpret_cast<::SOCKADDR*>(&native_sock_addr.m_sock_addr),
-			&native_sock_addr_len);
+			::IPPROTO_TCP,
+			TCP_NODELAY,
+			reinterpret_cast<const char*>(&value),
+			sizeof(value));
 
 		if (result == SOCKET_ERROR)
-			return SocketReceiveError{};
+			return last_error<SocketError>();
 
-		return Tuple<usize, SockAddr>{ static_cast<usize>(result), SockAddr::from_native(native_sock_addr).unwrap() };
+		return Unit{};
 	}
 
-	TCPServer::TCPServer(u16 port)
-		: m_sock{ AddrFamily::IPv4, SockType::STREAM, Proto::TCP }, m_port { port }
+	Result<Unit, SocketError> Socket::set_send_timeout(u64 timeout_ms)
 	{
-		Result<Unit, SocketBindError> result = m_sock.bind(SockAddrV4{ AddrIPv4::UNSPECIFIED, m_port });
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->set_send_timeout(timeout_ms);
 
-		if (result.is_error())
-			throw result.expect_error();
+		::DWORD value = timeout_ms > 0xFFFFFFFFull ? 0xFFFFFFFF : static_cast<::DWORD>(timeout_ms);
+
+		int result = ::setsockopt(
+			m_sock->m_sock,
+			SOL_SOCKET,
+			SO_SNDTIMEO,
+			reinterpret_cast<const char*>(&value),
+			sizeof(value));
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketError>();
+
+		return Unit{};
 	}
 
-	u16 TCPServer::port() const noexcept
+	Result<Unit, SocketError> Socket::set_recv_timeout(u64 timeout_ms)
 	{
-		return m_port;
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->set_recv_timeout(timeout_ms);
+
+		::DWORD value = timeout_ms > 0xFFFFFFFFull ? 0xFFFFFFFF : static_cast<::DWORD>(timeout_ms);
+
+		int result = ::setsockopt(
+			m_sock->m_sock,
+			SOL_SOCKET,
+			SO_RCVTIMEO,
+			reinterpret_cast<const char*>(&value),
+			sizeof(value));
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketError>();
+
+		return Unit{};
 	}
 
-	Result<SockAddr, SocketError> TCPServer::addr() const noexcept
+	Result<Unit, SocketError> Socket::set_fast_open(bool enable)
 	{
-		return m_sock.addr();
+		::DWORD value = enable ? 1 : 0;
+
+		int result = ::setsockopt(
+			m_sock->m_sock,
+			::IPPROTO_TCP,
+			TCP_FASTOPEN,
+			reinterpret_cast<const char*>(&value),
+			sizeof(value));
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketError>();
+
+		return Unit{};
 	}
 
-	Result<Unit, SocketListenError> TCPServer::listen(usize backlog)
+	Result<usize, SocketSendError> Socket::send(const u8* buffer, usize length)
 	{
-		return m_sock.listen(backlog);
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->send(buffer, length);
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.tx;
+		u64 start = io_clock_now();
+
+		int result = ::send(
+			m_sock->m_sock, 
+			reinterpret_cast<const char*>(buffer), 
+			static_cast<int>(length), 0);
+
+		io_record_latency(metrics, IoOp::SEND, start);
+		count_syscall(metrics, stats);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::SEND_FAILURES, stats.send_failures);
+			return last_error<SocketSendError>();
+		}
+
+		count_sent(metrics, stats, length, static_cast<usize>(result));
+
+		if (m_sock->m_recorder != nullptr)
+			_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::OUTBOUND, buffer, static_cast<usize>(result));
+
+		return static_cast<usize>(result);
 	}
 
-	Result<Socket, SocketAcceptError> TCPServer::accept()
+	Result<usize, SocketSendError> Socket::send_vectored(const IoSlice* slices, usize count)
 	{
-		return m_sock.accept();
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->send_vectored(slices, count);
+
+		::WSABUF buffers[MAX_IO_SLICES];
+		usize requested = 0;
+
+		if (count > MAX_IO_SLICES)
+			count = MAX_IO_SLICES;
+
+		for (usize i = 0; i < count; ++i)
+		{
+			buffers[i].len = static_cast<::ULONG>(slices[i].length);
+			buffers[i].buf = const_cast<char*>(reinterpret_cast<const char*>(slices[i].data));
+			requested += slices[i].length;
+		}
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.tx;
+		u64 start = io_clock_now();
+
+		::DWORD sent = 0;
+
+		int result = ::WSASend(m_sock->m_sock, buffers, static_cast<::DWORD>(count), &sent, 0, nullptr, nullptr);
+
+		io_record_latency(metrics, IoOp::SEND, start);
+		count_syscall(metrics, stats);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::SEND_FAILURES, stats.send_failures);
+			return last_error<SocketSendError>();
+		}
+
+		count_sent(metrics, stats, requested, static_cast<usize>(sent));
+
+		if (m_sock->m_recorder != nullptr)
+		{
+			usize remaining = sent;
+
+			for (usize i = 0; i < count && remaining != 0; ++i)
+			{
+				usize length = slices[i].length < remaining ? slices[i].length : remaining;
+
+				_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::OUTBOUND, slices[i].data, length);
+				remaining -= length;
+			}
+		}
+
+		return static_cast<usize>(sent);
 	}
 
-	Result<Unit, SocketCloseError> TCPServer::close()
+	Result<usize, SocketReceiveError> Socket::recv(u8* buffer, usize length)
+	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->recv(buffer, length);
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.rx;
+
+		u64 start = io_clock_now();
+
+		auto attempt = [&] {
+			return ::recv(
+				m_sock->m_sock, 
+				reinterpret_cast<char*>(buffer), 
+				static_cast<int>(length), 
+				0);
+		};
+
+		int result = m_sock->m_spin_budget_ns != 0 ? busy_poll(*m_sock, metrics, stats, attempt) : attempt();
+
+		count_syscall(metrics, stats);
+
+		io_record_latency(metrics, IoOp::RECV, start);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::RECV_FAILURES, stats.recv_failures);
+			return last_error<SocketReceiveError>();
+		}
+
+		count_received(metrics, stats, static_cast<usize>(result));
+
+		if (m_sock->m_recorder != nullptr)
+			_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::INBOUND, buffer, static_cast<usize>(result));
+
+		return static_cast<usize>(result);
+	}
+
+	Result<bool, SocketError> Socket::wait_readable(u64 timeout_ms)
 	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->wait_readable(timeout_ms);
+
+		::WSAPOLLFD poll_fd{};
+		poll_fd.fd = m_sock->m_sock;
+		poll_fd.events = POLLRDNORM;
+
+		int wait_ms = -1;
+
+		if (timeout_ms != 0)
+			wait_ms = static_cast<int>(timeout_ms < 0x7FFFFFFF ? timeout_ms : 0x7FFFFFFF);
+
+		int ready = ::WSAPoll(&poll_fd, 1, wait_ms);
+
+		count_syscall(thread_io_metrics(), m_sock->m_stats.rx);
+
+		if (ready == SOCKET_ERROR)
+			return last_error<SocketError>();
+
+		return ready > 0;
+	}
+
+	Result<usize, SocketSendError> Socket::send_to(const SockAddr& addr, const u8* buffer, usize length)
+	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->send_to(addr, buffer, length);
+
+		_NativeSockAddr native_sock_addr = addr.to_native();
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.tx;
+		u64 start = io_clock_now();
+
+		int result = ::sendto(
+			m_sock->m_sock,
+			reinterpret_cast<const char*>(buffer),
+			static_cast<int>(length),
+			0,
+			reinterpret_cast<const ::SOCKADDR*>(&native_sock_addr.m_sock_addr),
+			native_sock_addr.m_sock_addr_len);
+
+		io_record_latency(metrics, IoOp::SEND_TO, start);
+		count_syscall(metrics, stats);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::SEND_FAILURES, stats.send_failures);
+			return last_error<SocketSendError>();
+		}
+
+		count_sent(metrics, stats, length, static_cast<usize>(result));
+
+		if (m_sock->m_recorder != nullptr)
+			_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::OUTBOUND, buffer, static_cast<usize>(result));
+
+		return static_cast<usize>(result);
+	}
+
+	Result<Tuple<usize, SockAddr>, SocketReceiveError> Socket::recv_from(u8* buffer, usize length)
+	{
+		if (m_sock->m_mem != nullptr)
+			return m_sock->m_mem->recv_from(buffer, length);
+
+		_NativeSockAddr native_sock_addr;
+		native_sock_addr.m_sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.rx;
+		u64 start = io_clock_now();
+
+		auto attempt = [&] {
+			return ::recvfrom(
+				m_sock->m_sock,
+				reinterpret_cast<char*>(buffer),
+				static_cast<int>(length),
+				0,
+				reinterpret_cast<::SOCKADDR*>(&native_sock_addr.m_sock_addr),
+				&native_sock_addr.m_sock_addr_len);
+		};
+
+		int result = m_sock->m_spin_budget_ns != 0 ? busy_poll(*m_sock, metrics, stats, attempt) : attempt();
+
+		count_syscall(metrics, stats);
+
+		io_record_latency(metrics, IoOp::RECV_FROM, start);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::RECV_FAILURES, stats.recv_failures);
+			return last_error<SocketReceiveError>();
+		}
+
+		count_received(metrics, stats, static_cast<usize>(result));
+
+		if (m_sock->m_recorder != nullptr)
+			_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::INBOUND, buffer, static_cast<usize>(result));
+
+		return Tuple<usize, SockAddr>{ static_cast<usize>(result), SockAddr::from_native(native_sock_addr).unwrap() };
+	}
+
+	Result<Tuple<usize, RecvTimestamp>, SocketReceiveError> Socket::recv_timestamped(u8* buffer, usize length)
+	{
+		if (m_sock->m_recv_msg == nullptr)
+			return invalid_argument<SocketReceiveError>();
+
+		u64 kernel_ns = 0;
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.rx;
+		u64 start = io_clock_now();
+
+		auto attempt = [&] {
+			return recv_msg(*m_sock, buffer, length, nullptr, kernel_ns);
+		};
+
+		int result = m_sock->m_spin_budget_ns != 0 ? busy_poll(*m_sock, metrics, stats, attempt) : attempt();
+
+		count_syscall(metrics, stats);
+
+		u64 user_ns = steady_clock_ns();
+
+		io_record_latency(metrics, IoOp::RECV, start);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::RECV_FAILURES, stats.recv_failures);
+			return last_error<SocketReceiveError>();
+		}
+
+		count_received(metrics, stats, static_cast<usize>(result));
+
+		if (m_sock->m_recorder != nullptr)
+			_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::INBOUND, buffer, static_cast<usize>(result));
+
+		return Tuple<usize, RecvTimestamp>{ static_cast<usize>(result), RecvTimestamp{ kernel_ns, user_ns } };
+	}
+
+	Result<Tuple<usize, SockAddr, RecvTimestamp>, SocketReceiveError> Socket::recv_from_timestamped(u8* buffer, usize length)
+	{
+		if (m_sock->m_recv_msg == nullptr)
+			return invalid_argument<SocketReceiveError>();
+
+		_NativeSockAddr native_sock_addr;
+		native_sock_addr.m_sock_addr_len = sizeof(native_sock_addr.m_sock_addr);
+
+		u64 kernel_ns = 0;
+
+		_ThreadIoMetrics& metrics = thread_io_metrics();
+		IoCounterCells& stats = m_sock->m_stats.rx;
+		u64 start = io_clock_now();
+
+		auto attempt = [&] {
+			return recv_msg(*m_sock, buffer, length, &native_sock_addr, kernel_ns);
+		};
+
+		int result = m_sock->m_spin_budget_ns != 0 ? busy_poll(*m_sock, metrics, stats, attempt) : attempt();
+
+		count_syscall(metrics, stats);
+
+		u64 user_ns = steady_clock_ns();
+
+		io_record_latency(metrics, IoOp::RECV_FROM, start);
+
+		if (result == SOCKET_ERROR)
+		{
+			count_failure(metrics, stats, _IoCounter::RECV_FAILURES, stats.recv_failures);
+			return last_error<SocketReceiveError>();
+		}
+
+		count_received(metrics, stats, static_cast<usize>(result));
+
+		if (m_sock->m_recorder != nullptr)
+			_traffic_record(m_sock->m_recorder, m_sock->m_session, TrafficDirection::INBOUND, buffer, static_cast<usize>(result));
+
+		return Tuple<usize, SockAddr, RecvTimestamp>{
+			static_cast<usize>(result),
+			SockAddr::from_native(native_sock_addr).unwrap(),
+			RecvTimestamp{ kernel_ns, user_ns } };
+	}
+
+	Result<Unit, SocketSendError> Socket::send_socket(const Socket& sock)
+	{
+		if (m_family != AddrFamily::UNIX)
+			return invalid_argument<SocketSendError>();
+
+		::DWORD peer_pid = 0;
+		::DWORD bytes_returned = 0;
+
+		int result = ::WSAIoctl(
+			m_sock->m_sock,
+			SIO_AF_UNIX_GETPEERPID,
+			NULL,
+			0,
+			&peer_pid,
+			sizeof(peer_pid),
+			&bytes_returned,
+			NULL,
+			NULL);
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketSendError>();
+
+		::WSAPROTOCOL_INFOW proto_info;
+
+		result = ::WSADuplicateSocketW(sock.m_sock->m_sock, peer_pid, &proto_info);
+
+		if (result == SOCKET_ERROR)
+			return last_error<SocketSendError>();
+
+		const char* data = reinterpret_cast<const char*>(&proto_info);
+		int remaining = sizeof(proto_info);
+
+		while (remaining > 0)
+		{
+			result = ::send(m_sock->m_sock, data, remaining, 0);
+
+			if (result == SOCKET_ERROR)
+				return last_error<SocketSendError>();
+
+			data += result;
+			remaining -= result;
+		}
+
+		return Unit{};
+	}
+
+	Result<Socket, SocketReceiveError> Socket::recv_socket()
+	{
+		if (m_family != AddrFamily::UNIX)
+			return invalid_argument<SocketReceiveError>();
+
+		::WSAPROTOCOL_INFOW proto_info;
+
+		char* data = reinterpret_cast<char*>(&proto_info);
+		int remaining = sizeof(proto_info);
+
+		while (remaining > 0)
+		{
+			int result = ::recv(m_sock->m_sock, data, remaining, 0);
+
+			if (result == 0)
+				return SocketReceiveError{ NetErrorKind::CLOSED };
+
+			if (result == SOCKET_ERROR)
+				return last_error<SocketReceiveError>();
+
+			data += result;
+			remaining -= result;
+		}
+
+		_NativeSocket native_sock;
+
+		native_sock.m_sock = ::WSASocketW(
+			FROM_PROTOCOL_INFO,
+			FROM_PROTOCOL_INFO,
+			FROM_PROTOCOL_INFO,
+			&proto_info,
+			0,
+			WSA_FLAG_OVERLAPPED);
+
+		if (native_sock.m_sock == INVALID_SOCKET)
+			return last_error<SocketReceiveError>();
+
+		Maybe<Socket> sock = Socket::from_native(native_sock);
+
+		if (!sock.has_value())
+		{
+			::closesocket(native_sock.m_sock);
+			return invalid_argument<SocketReceiveError>();
+		}
+
+		return sock.unwrap();
+	}
+
+	struct _ConnTrackerState
+	{
+		::std::mutex m_mutex;
+		::std::condition_variable m_idle;
+		usize m_active;
+		usize m_accepting;
+		u64 m_total;
+		bool m_draining;
+		bool m_stopped;
+
+		::std::atomic<u32> m_refs;
+	};
+
+	static void release_tracker(_ConnTrackerState* state) noexcept
+	{
+		if (state->m_refs.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
+			delete state;
+	}
+
+	ConnGuard::ConnGuard(_ConnTrackerState* state) noexcept
+		: m_state{ state }
+	{
+	}
+
+	ConnGuard::ConnGuard(ConnGuard&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	ConnGuard::~ConnGuard()
+	{
+		if (m_state == nullptr)
+			return;
+
+		{
+			::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+			if (--m_state->m_active == 0)
+				m_state->m_idle.notify_all();
+		}
+
+		release_tracker(m_state);
+	}
+
+	ConnTracker::ConnTracker()
+		: m_state{ new _ConnTrackerState{} }
+	{
+		m_state->m_refs.store(1, ::std::memory_order_relaxed);
+	}
+
+	ConnTracker::ConnTracker(ConnTracker&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	ConnTracker::~ConnTracker()
+	{
+		if (m_state != nullptr)
+			release_tracker(m_state);
+	}
+
+	ConnGuard ConnTracker::enter() noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		++m_state->m_active;
+		++m_state->m_total;
+
+		m_state->m_refs.fetch_add(1, ::std::memory_order_relaxed);
+
+		return ConnGuard{ m_state };
+	}
+
+	void ConnTracker::begin_drain() noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		m_state->m_draining = true;
+	}
+
+	bool ConnTracker::is_draining() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_draining;
+	}
+
+	usize ConnTracker::active() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_active;
+	}
+
+	u64 ConnTracker::total() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_total;
+	}
+
+	bool ConnTracker::wait_idle(u64 timeout_ms) const
+	{
+		::std::unique_lock<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_idle.wait_for(lock, ::std::chrono::milliseconds{ timeout_ms }, [this] { return m_state->m_active == 0; });
+	}
+
+	bool ConnTracker::enter_accept() noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		if (m_state->m_draining || m_state->m_stopped)
+			return false;
+
+		++m_state->m_accepting;
+
+		return true;
+	}
+
+	void ConnTracker::leave_accept() noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		if (--m_state->m_accepting == 0)
+			m_state->m_idle.notify_all();
+	}
+
+	void ConnTracker::stop_accepts() noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		m_state->m_stopped = true;
+	}
+
+	bool ConnTracker::accepts_stopped() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_draining || m_state->m_stopped;
+	}
+
+	bool ConnTracker::wait_accepts(u64 timeout_ms) const
+	{
+		::std::unique_lock<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_idle.wait_for(lock, ::std::chrono::milliseconds{ timeout_ms }, [this] { return m_state->m_accepting == 0; });
+	}
+
+	struct _DeferredConn
+	{
+		Socket* m_sock;
+		u64 m_deadline_ns;
+		bool m_polling;
+	};
+
+	struct _DeferredAcceptState
+	{
+		::std::mutex m_mutex;
+		::std::vector<_DeferredConn> m_conns;
+	};
+
+	static constexpr usize DEFER_ACCEPT_MAX_PENDING = 1024;
+
+	static Socket take_deferred(_DeferredAcceptState& state, usize index)
+	{
+		Socket* pending = state.m_conns[index].m_sock;
+
+		state.m_conns[index] = state.m_conns.back();
+		state.m_conns.pop_back();
+
+		Socket sock{ move(*pending) };
+		delete pending;
+
+		return sock;
+	}
+
+	static void free_deferred(_DeferredAcceptState* state)
+	{
+		for (_DeferredConn& pending : state->m_conns)
+			delete pending.m_sock;
+
+		delete state;
+	}
+
+	TCPServer::TCPServer(Socket&& sock, u16 port)
+		: m_sock{ move(sock) }, m_port{ port }, m_defer_accept_ms{ 0 }, m_deferred{ nullptr }
+	{
+	}
+
+	TCPServer::TCPServer(TCPServer&& other) noexcept
+		: m_sock{ move(other.m_sock) }, m_port{ other.m_port }, m_defer_accept_ms{ other.m_defer_accept_ms }, m_deferred{ other.m_deferred }, m_conns{ move(other.m_conns) }
+	{
+		other.m_deferred = nullptr;
+	}
+
+	TCPServer::~TCPServer()
+	{
+		if (m_deferred != nullptr)
+			free_deferred(m_deferred);
+	}
+
+	Result<TCPServer, SocketError> TCPServer::create(u16 port)
+	{
+		Result<Socket, SocketError> created = Socket::create(AddrFamily::IPv4, SockType::STREAM, Proto::TCP);
+
+		if (created.is_error())
+			return created.expect_error();
+
+		Socket sock = created.expect();
+
+		Result<Unit, SocketBindError> bound = sock.bind(SockAddrV4{ AddrIPv4::UNSPECIFIED, port });
+
+		if (bound.is_error())
+			return bound.expect_error();
+
+		return TCPServer{ move(sock), port };
+	}
+
+	static TCPServer create_or_throw(u16 port)
+	{
+		Result<TCPServer, SocketError> result = TCPServer::create(port);
+
+		if (result.is_error())
+			throw result.expect_error();
+
+		return result.expect();
+	}
+
+	TCPServer::TCPServer(u16 port)
+		: TCPServer{ create_or_throw(port) }
+	{
+	}
+
+	Result<TCPServer, SocketReceiveError> TCPServer::inherit(Socket& channel)
+	{
+		Result<Socket, SocketReceiveError> received = channel.recv_socket();
+
+		if (received.is_error())
+			return received.expect_error();
+
+		Socket sock = received.expect();
+
+		if (sock.sock_type() != SockType::STREAM)
+			return invalid_argument<SocketReceiveError>();
+
+		Result<SockAddr, SocketError> addr = sock.addr();
+
+		if (addr.is_error())
+		{
+			SocketError error = addr.expect_error();
+			return SocketReceiveError{ error.kind(), error.native_code() };
+		}
+
+		SockAddr local = addr.expect();
+
+		if (local.is_ipv4())
+			return TCPServer{ move(sock), local.to_ipv4().value().port() };
+
+		if (local.is_ipv6())
+			return TCPServer{ move(sock), local.to_ipv6().value().port() };
+
+		return invalid_argument<SocketReceiveError>();
+	}
+
+	u16 TCPServer::port() const noexcept
+	{
+		return m_port;
+	}
+
+	Result<SockAddr, SocketError> TCPServer::addr() const noexcept
+	{
+		return m_sock.addr();
+	}
+
+	IoCounters TCPServer::stats() const noexcept
+	{
+		return m_sock.stats();
+	}
+
+	Result<Unit, SocketError> TCPServer::set_fast_open(bool enable)
+	{
+		return m_sock.set_fast_open(enable);
+	}
+
+	void TCPServer::set_defer_accept(u64 timeout_ms)
+	{
+		m_defer_accept_ms = timeout_ms;
+
+		if (timeout_ms == 0)
+		{
+			if (m_deferred != nullptr)
+				free_deferred(m_deferred);
+
+			m_deferred = nullptr;
+			return;
+		}
+
+		if (m_deferred == nullptr)
+			m_deferred = new _DeferredAcceptState{};
+	}
+
+	Result<Unit, SocketListenError> TCPServer::listen(usize backlog)
+	{
+		return m_sock.listen(backlog);
+	}
+
+	Result<Socket, SocketAcceptError> TCPServer::accept_when_ready()
+	{
+		if (m_deferred != nullptr)
+			return accept_deferred();
+
+		for (;;)
+		{
+			if (m_conns.accepts_stopped())
+				return SocketAcceptError{ NetErrorKind::CLOSED };
+
+			::WSAPOLLFD poll_fd{};
+			poll_fd.fd = m_sock.m_sock->m_sock;
+			poll_fd.events = POLLRDNORM;
+
+			int ready = ::WSAPoll(&poll_fd, 1, static_cast<int>(ACCEPT_WAKE_MS));
+
+			if (ready == SOCKET_ERROR)
+				return last_error<SocketAcceptError>();
+
+			if (ready != 0)
+				break;
+		}
+
+		return m_sock.accept();
+	}
+
+	Result<Socket, SocketAcceptError> TCPServer::accept_deferred()
+	{
+		_DeferredAcceptState& state = *m_deferred;
+
+		::std::vector<::WSAPOLLFD> poll_fds;
+		::std::vector<Socket*> polled;
+
+		for (;;)
+		{
+			if (m_conns.accepts_stopped())
+				return SocketAcceptError{ NetErrorKind::CLOSED };
+
+			u64 now = steady_clock_ns();
+			u64 wait_ms = ACCEPT_WAKE_MS;
+
+			poll_fds.clear();
+			polled.clear();
+
+			poll_fds.push_back(::WSAPOLLFD{ m_sock.m_sock->m_sock, POLLRDNORM, 0 });
+
+			{
+				::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+				for (usize i = 0; i < state.m_conns.size(); ++i)
+				{
+					if (!state.m_conns[i].m_polling && state.m_conns[i].m_deadline_ns <= now)
+						return take_deferred(state, i);
+				}
+
+				for (_DeferredConn& pending : state.m_conns)
+				{
+					if (pending.m_polling)
+						continue;
+
+					u64 remaining_ms = (pending.m_deadline_ns - now + 999'999) / 1'000'000;
+
+					if (remaining_ms < wait_ms)
+						wait_ms = remaining_ms;
+
+					pending.m_polling = true;
+					polled.push_back(pending.m_sock);
+					poll_fds.push_back(::WSAPOLLFD{ pending.m_sock->m_sock->m_sock, POLLRDNORM, 0 });
+				}
+			}
+
+			int ready = ::WSAPoll(poll_fds.data(), static_cast<::ULONG>(poll_fds.size()), static_cast<int>(wait_ms));
+			int error = ready == SOCKET_ERROR ? ::WSAGetLastError() : 0;
+
+			{
+				::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+				Socket* chosen = nullptr;
+
+				for (usize i = 1; i < poll_fds.size() && ready > 0; ++i)
+				{
+					if (poll_fds[i].revents != 0)
+					{
+						chosen = polled[i - 1];
+						break;
+					}
+				}
+
+				usize chosen_index = state.m_conns.size();
+
+				for (usize i = 0; i < state.m_conns.size(); ++i)
+				{
+					_DeferredConn& pending = state.m_conns[i];
+
+					for (Socket* claimed : polled)
+						if (pending.m_sock == claimed)
+							pending.m_polling = false;
+
+					if (pending.m_sock == chosen)
+						chosen_index = i;
+				}
+
+				if (chosen != nullptr)
+					return take_deferred(state, chosen_index);
+			}
+
+			if (ready == SOCKET_ERROR)
+				return native_error<SocketAcceptError>(error);
+
+			if (ready == 0 || poll_fds[0].revents == 0)
+				continue;
+
+			Result<Socket, SocketAcceptError> accepted = m_sock.accept();
+
+			if (accepted.is_error())
+				return accepted.expect_error();
+
+			::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+			if (state.m_conns.size() >= DEFER_ACCEPT_MAX_PENDING)
+				return accepted.expect();
+
+			state.m_conns.push_back(_DeferredConn{ new Socket{ accepted.expect() }, steady_clock_ns() + m_defer_accept_ms * 1'000'000, false });
+		}
+	}
+
+	Result<Socket, SocketAcceptError> TCPServer::accept()
+	{
+		if (!m_conns.enter_accept())
+			return SocketAcceptError{ NetErrorKind::CLOSED };
+
+		Result<Socket, SocketAcceptError> accepted = accept_when_ready();
+
+		m_conns.leave_accept();
+
+		if (accepted.is_error())
+			return accepted.expect_error();
+
+		return accepted.expect();
+	}
+
+	Result<TrackedConn, SocketAcceptError> TCPServer::accept_tracked()
+	{
+		Result<Socket, SocketAcceptError> accepted = accept();
+
+		if (accepted.is_error())
+			return accepted.expect_error();
+
+		return TrackedConn{ accepted.expect(), m_conns.enter() };
+	}
+
+	const ConnTracker& TCPServer::connections() const noexcept
+	{
+		return m_conns;
+	}
+
+	Result<Unit, SocketSendError> TCPServer::hand_off(Socket& channel)
+	{
+		return channel.send_socket(m_sock);
+	}
+
+	bool TCPServer::drain(u64 timeout_ms)
+	{
+		m_conns.begin_drain();
+
+		if (!m_conns.wait_accepts(timeout_ms))
+			return false;
+
+		if (m_sock.close().is_error())
+			return false;
+
+		return m_conns.wait_idle(timeout_ms);
+	}
+
+	Result<Unit, SocketCloseError> TCPServer::close()
+	{
+		m_conns.stop_accepts();
+
+		if (!m_conns.wait_accepts(ACCEPT_CLOSE_MS))
+			return SocketCloseError{ NetErrorKind::TIMED_OUT };
+
 		return m_sock.close();
 	}
 }
@@ -0,0 +1,822 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Net.hpp"
+#include "MemNet.hpp"
+#include "Resp.hpp"
+
+using namespace bsl;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr u64 UDP_RECV_TIMEOUT_MS = 1000;
+
+struct BenchConfig
+{
+	const char* filter = nullptr;
+	usize iterations = 100000;
+	usize warmup = 1000;
+	usize stream_bytes = 256ull << 20;
+	usize udp_packets = 1000000;
+	usize connections = 5000;
+	bool csv = false;
+};
+
+static u64 elapsed_ns(Clock::time_point start, Clock::time_point end)
+{
+	return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+template<class S>
+static bool send_all(S& sock, const u8* buffer, usize length)
+{
+	while (length > 0)
+	{
+		Result<usize, net::SocketSendError> result = sock.send(buffer, length);
+
+		if (result.is_error())
+			return false;
+
+		usize sent = result.expect();
+		buffer += sent;
+		length -= sent;
+	}
+
+	return true;
+}
+
+template<class S>
+static bool recv_all(S& sock, u8* buffer, usize length)
+{
+	while (length > 0)
+	{
+		Result<usize, net::SocketReceiveError> result = sock.recv(buffer, length);
+
+		if (result.is_error())
+			return false;
+
+		usize received = result.expect();
+
+		if (received == 0)
+			return false;
+
+		buffer += received;
+		length -= received;
+	}
+
+	return true;
+}
+
+static u16 local_port(const net::Socket& sock)
+{
+	return sock.addr().expect().to_ipv4().unwrap().port();
+}
+
+static u16 local_port(const net::TCPServer& server)
+{
+	return server.addr().expect().to_ipv4().unwrap().port();
+}
+
+static net::SockAddrV4 loopback(u16 port)
+{
+	return net::SockAddrV4{ net::AddrIPv4::LOCALHOST, port };
+}
+
+static net::Socket tcp_socket()
+{
+	return net::Socket{ net::AddrFamily::IPv4, net::SockType::STREAM, net::Proto::TCP };
+}
+
+static net::Socket udp_socket()
+{
+	return net::Socket{ net::AddrFamily::IPv4, net::SockType::DATAGRAM, net::Proto::UDP };
+}
+
+static void fill_pattern(std::vector<u8>& buffer)
+{
+	for (usize i = 0; i < buffer.size(); ++i)
+		buffer[i] = static_cast<u8>(i * 31 + 7);
+}
+
+static u64 percentile(const std::vector<u64>& sorted, f64 p)
+{
+	if (sorted.empty())
+		return 0;
+
+	usize idx = static_cast<usize>(p * static_cast<f64>(sorted.size()));
+
+	if (idx >= sorted.size())
+		idx = sorted.size() - 1;
+
+	return sorted[idx];
+}
+
+struct SpinStats
+{
+	u64 spin_ns = 0;
+	u64 spin_hits = 0;
+	u64 spin_misses = 0;
+	u64 poll_wait_ns = 0;
+};
+
+class Reporter
+{
+private:
+	bool m_csv;
+	bool m_header_written = false;
+
+public:
+	explicit Reporter(bool csv)
+		: m_csv{ csv }
+	{
+	}
+
+	void latency(const char* bench, usize size, std::vector<u64>& samples, u64 total_ns, const SpinStats& spin = SpinStats{})
+	{
+		std::sort(samples.begin(), samples.end());
+
+		f64 rate = total_ns == 0 ? 0.0 : static_cast<f64>(samples.size()) * 1e9 / static_cast<f64>(total_ns);
+
+		emit(bench, size, samples.size(), rate, 0.0,
+			percentile(samples, 0.50), percentile(samples, 0.90), percentile(samples, 0.99),
+			percentile(samples, 0.999), samples.empty() ? 0 : samples.back(), spin);
+	}
+
+	void throughput(const char* bench, usize size, usize count, u64 total_bytes, u64 total_ns)
+	{
+		f64 secs = static_cast<f64>(total_ns) / 1e9;
+		f64 rate = secs == 0.0 ? 0.0 : static_cast<f64>(count) / secs;
+		f64 bytes_per_sec = secs == 0.0 ? 0.0 : static_cast<f64>(total_bytes) / secs;
+
+		emit(bench, size, count, rate, bytes_per_sec, 0, 0, 0, 0, 0, SpinStats{});
+	}
+
+	void emit(const char* bench, usize size, usize count, f64 ops_per_sec, f64 bytes_per_sec,
+		u64 p50, u64 p90, u64 p99, u64 p999, u64 max, const SpinStats& spin)
+	{
+		if (m_csv)
+		{
+			if (!m_header_written)
+			{
+				std::printf("bench,size,count,ops_per_sec,bytes_per_sec,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,"
+					"spin_ns,spin_hits,spin_misses,poll_wait_ns\n");
+				m_header_written = true;
+			}
+
+			std::printf("%s,%zu,%zu,%.1f,%.1f,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+				bench, size, count, ops_per_sec, bytes_per_sec, p50, p90, p99, p999, max,
+				spin.spin_ns, spin.spin_hits, spin.spin_misses, spin.poll_wait_ns);
+		}
+		else
+		{
+			std::printf("{\"bench\":\"%s\",\"size\":%zu,\"count\":%zu,\"ops_per_sec\":%.1f,\"bytes_per_sec\":%.1f,"
+				"\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu,"
+				"\"spin_ns\":%llu,\"spin_hits\":%llu,\"spin_misses\":%llu,\"poll_wait_ns\":%llu}\n",
+				bench, size, count, ops_per_sec, bytes_per_sec, p50, p90, p99, p999, max,
+				spin.spin_ns, spin.spin_hits, spin.spin_misses, spin.poll_wait_ns);
+		}
+
+		std::fflush(stdout);
+	}
+};
+
+static void bench_tcp_pingpong(const BenchConfig& cfg, Reporter& reporter, usize size)
+{
+	net::TCPServer server{ 0 };
+	server.listen(1).expect_and_discard();
+
+	u16 port = local_port(server);
+	usize rounds = cfg.warmup + cfg.iterations;
+
+	std::thread echo{ [&server, size, rounds]() {
+		net::Socket conn = server.accept().expect();
+		conn.set_nodelay(true).discard();
+
+		std::vector<u8> buffer(size);
+
+		for (usize i = 0; i < rounds; ++i)
+			if (!recv_all(conn, buffer.data(), size) || !send_all(conn, buffer.data(), size))
+				break;
+	} };
+
+	net::Socket client = tcp_socket();
+	client.connect(loopback(port)).expect_and_discard();
+	client.set_nodelay(true).discard();
+
+	std::vector<u8> out(size), in(size);
+	fill_pattern(out);
+
+	std::vector<u64> samples;
+	samples.reserve(cfg.iterations);
+
+	Clock::time_point begin = Clock::now();
+
+	for (usize i = 0; i < rounds; ++i)
+	{
+		if (i == cfg.warmup)
+			begin = Clock::now();
+
+		Clock::time_point start = Clock::now();
+
+		if (!send_all(client, out.data(), size) || !recv_all(client, in.data(), size))
+			break;
+
+		if (i >= cfg.warmup)
+			samples.push_back(elapsed_ns(start, Clock::now()));
+	}
+
+	u64 total = elapsed_ns(begin, Clock::now());
+
+	client.close().discard();
+	echo.join();
+	server.close().discard();
+
+	reporter.latency("tcp_pingpong", size, samples, total);
+}
+
+static void bench_mem_pingpong(const BenchConfig& cfg, Reporter& reporter, usize size)
+{
+	net::MemNetwork network;
+
+	net::MemSocket server{ network, net::AddrFamily::IPv4, net::SockType::STREAM, net::Proto::TCP };
+	server.bind(loopback(0)).expect_and_discard();
+	server.listen(1).expect_and_discard();
+
+	net::SockAddr target = server.addr().expect();
+	usize rounds = cfg.warmup + cfg.iterations;
+
+	std::thread echo{ [&server, size, rounds]() {
+		net::MemSocket conn = server.accept().expect();
+
+		std::vector<u8> buffer(size);
+
+		for (usize i = 0; i < rounds; ++i)
+			if (!recv_all(conn, buffer.data(), size) || !send_all(conn, buffer.data(), size))
+				break;
+	} };
+
+	net::MemSocket client{ network, net::AddrFamily::IPv4, net::SockType::STREAM, net::Proto::TCP };
+	client.connect(target).expect_and_discard();
+
+	std::vector<u8> out(size), in(size);
+	fill_pattern(out);
+
+	std::vector<u64> samples;
+	samples.reserve(cfg.iterations);
+
+	Clock::time_point begin = Clock::now();
+
+	for (usize i = 0; i < rounds; ++i)
+	{
+		if (i == cfg.warmup)
+			begin = Clock::now();
+
+		Clock::time_point start = Clock::now();
+
+		if (!send_all(client, out.data(), size) || !recv_all(client, in.data(), size))
+			break;
+
+		if (i >= cfg.warmup)
+			samples.push_back(elapsed_ns(start, Clock::now()));
+	}
+
+	u64 total = elapsed_ns(begin, Clock::now());
+
+	client.close().discard();
+	echo.join();
+	server.close().discard();
+
+	reporter.latency("mem_pingpong", size, samples, total);
+}
+
+static void bench_tcp_stream(const BenchConfig& cfg, Reporter& reporter, usize size)
+{
+	net::TCPServer server{ 0 };
+	server.listen(1).expect_and_discard();
+
+	u16 port = local_port(server);
+	u64 total_bytes = cfg.stream_bytes;
+
+	std::atomic<u64> received_bytes{ 0 };
+	Clock::time_point end;
+
+	std::thread sink{ [&server, &received_bytes, &end, size, total_bytes]() {
+		net::Socket conn = server.accept().expect();
+
+		std::vector<u8> buffer(size);
+		u64 received = 0;
+
+		while (received < total_bytes)
+		{
+			Result<usize, net::SocketReceiveError> result = conn.recv(buffer.data(), buffer.size());
+
+			if (result.is_error())
+				break;
+
+			usize n = result.expect();
+
+			if (n == 0)
+				break;
+
+			received += n;
+		}
+
+		end = Clock::now();
+		received_bytes.store(received);
+	} };
+
+	net::Socket client = tcp_socket();
+	client.connect(loopback(port)).expect_and_discard();
+
+	std::vector<u8> buffer(size);
+	fill_pattern(buffer);
+
+	usize writes = 0;
+	u64 sent = 0;
+
+	Clock::time_point start = Clock::now();
+
+	while (sent < total_bytes)
+	{
+		usize chunk = static_cast<usize>(std::min<u64>(size, total_bytes - sent));
+
+		if (!send_all(client, buffer.data(), chunk))
+			break;
+
+		sent += chunk;
+		++writes;
+	}
+
+	sink.join();
+	client.close().discard();
+	server.close().discard();
+
+	reporter.throughput("tcp_stream", size, writes, received_bytes.load(), elapsed_ns(start, end));
+}
+
+static void bench_udp_pps(const BenchConfig& cfg, Reporter& reporter, usize size)
+{
+	net::Socket receiver = udp_socket();
+	receiver.bind(loopback(0)).expect_and_discard();
+	receiver.set_recv_timeout(UDP_RECV_TIMEOUT_MS).expect_and_discard();
+
+	u16 port = local_port(receiver);
+	usize packets = cfg.udp_packets;
+
+	usize received = 0;
+	Clock::time_point first, last;
+
+	std::thread sink{ [&receiver, &received, &first, &last, size]() {
+		std::vector<u8> buffer(size > 1 ? size : 2);
+
+		while (true)
+		{
+			Result<usize, net::SocketReceiveError> result = receiver.recv(buffer.data(), buffer.size());
+
+			if (result.is_error())
+				break;
+
+			if (result.expect() == 1)
+				break;
+
+			if (received == 0)
+				first = Clock::now();
+
+			last = Clock::now();
+			++received;
+		}
+	} };
+
+	net::Socket sender = udp_socket();
+	net::SockAddr target = loopback(port);
+
+	std::vector<u8> buffer(size);
+	fill_pattern(buffer);
+
+	Clock::time_point start = Clock::now();
+
+	for (usize i = 0; i < packets; ++i)
+		sender.send_to(target, buffer.data(), size).discard();
+
+	u64 send_ns = elapsed_ns(start, Clock::now());
+
+	const u8 terminator = 0;
+
+	for (usize i = 0; i < 16; ++i)
+	{
+		sender.send_to(target, &terminator, 1).discard();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	sink.join();
+	receiver.close().discard();
+	sender.close().discard();
+
+	reporter.throughput("udp_send_pps", size, packets, static_cast<u64>(packets) * size, send_ns);
+	reporter.throughput("udp_recv_pps", size, received, static_cast<u64>(received) * size, received > 1 ? elapsed_ns(first, last) : 0);
+}
+
+static void bench_udp_pingpong(const BenchConfig& cfg, Reporter& reporter, usize size, u64 spin_budget_ns)
+{
+	net::Socket echo_sock = udp_socket();
+	echo_sock.bind(loopback(0)).expect_and_discard();
+	echo_sock.set_busy_poll(spin_budget_ns).expect_and_discard();
+	echo_sock.set_recv_timeout(UDP_RECV_TIMEOUT_MS).expect_and_discard();
+
+	net::Socket client = udp_socket();
+	client.bind(loopback(0)).expect_and_discard();
+	client.set_busy_poll(spin_budget_ns).expect_and_discard();
+	client.set_recv_timeout(UDP_RECV_TIMEOUT_MS).expect_and_discard();
+
+	net::SockAddr echo_addr = loopback(local_port(echo_sock));
+	net::SockAddr client_addr = loopback(local_port(client));
+	usize rounds = cfg.warmup + cfg.iterations;
+
+	std::thread echo{ [&echo_sock, &client_addr, size, rounds]() {
+		std::vector<u8> buffer(size);
+
+		for (usize i = 0; i < rounds; ++i)
+		{
+			if (echo_sock.recv(buffer.data(), size).is_error())
+				break;
+
+			if (echo_sock.send_to(client_addr, buffer.data(), size).is_error())
+				break;
+		}
+	} };
+
+	std::vector<u8> out(size), in(size);
+	fill_pattern(out);
+
+	std::vector<u64> samples;
+	samples.reserve(cfg.iterations);
+
+	Clock::time_point begin = Clock::now();
+
+	for (usize i = 0; i < rounds; ++i)
+	{
+		if (i == cfg.warmup)
+			begin = Clock::now();
+
+		Clock::time_point start = Clock::now();
+
+		if (client.send_to(echo_addr, out.data(), size).is_error() || client.recv(in.data(), size).is_error())
+			break;
+
+		if (i >= cfg.warmup)
+			samples.push_back(elapsed_ns(start, Clock::now()));
+	}
+
+	u64 total = elapsed_ns(begin, Clock::now());
+
+	echo.join();
+
+	net::IoCounters stats = client.stats();
+
+	SpinStats spin;
+	spin.spin_ns = stats.spin_ns;
+	spin.spin_hits = stats.spin_hits;
+	spin.spin_misses = stats.spin_misses;
+	spin.poll_wait_ns = stats.poll_wait_ns;
+
+	client.close().discard();
+	echo_sock.close().discard();
+
+	reporter.latency(spin_budget_ns != 0 ? "udp_pingpong_busy" : "udp_pingpong", size, samples, total, spin);
+}
+
+static void bench_connect_accept(const BenchConfig& cfg, Reporter& reporter)
+{
+	net::TCPServer server{ 0 };
+	server.listen(1024).expect_and_discard();
+
+	u16 port = local_port(server);
+	usize connections = cfg.connections;
+
+	Clock::time_point accept_start, accept_end;
+	usize accepted = 0;
+
+	std::thread acceptor{ [&server, &accepted, &accept_start, &accept_end, connections]() {
+		for (usize i = 0; i < connections; ++i)
+		{
+			Result<net::Socket, net::SocketAcceptError> result = server.accept();
+
+			if (result.is_error())
+				break;
+
+			if (i == 0)
+				accept_start = Clock::now();
+
+			net::Socket conn = result.expect();
+			++accepted;
+		}
+
+		accept_end = Clock::now();
+	} };
+
+	std::vector<u64> samples;
+	samples.reserve(connections);
+
+	net::SockAddr target = loopback(port);
+
+	Clock::time_point begin = Clock::now();
+
+	for (usize i = 0; i < connections; ++i)
+	{
+		net::Socket client = tcp_socket();
+
+		Clock::time_point start = Clock::now();
+
+		if (client.connect(target).is_error())
+			break;
+
+		samples.push_back(elapsed_ns(start, Clock::now()));
+	}
+
+	u64 total = elapsed_ns(begin, Clock::now());
+
+	server.close().discard();
+	acceptor.join();
+
+	reporter.latency("tcp_connect", 0, samples, total);
+	reporter.throughput("tcp_accept", 0, accepted, 0, accepted > 1 ? elapsed_ns(accept_start, accept_end) : 0);
+}
+
+static void bench_short_exchange(const BenchConfig& cfg, Reporter& reporter, bool fast_open)
+{
+	constexpr usize SIZE = 64;
+
+	net::TCPServer server{ 0 };
+
+	if (fast_open)
+	{
+		server.set_fast_open(true).discard();
+		server.set_defer_accept(1000);
+	}
+
+	server.listen(1024).expect_and_discard();
+
+	usize connections = cfg.connections;
+
+	std::thread responder{ [&server, connections]() {
+		std::vector<u8> buffer(SIZE);
+
+		for (usize i = 0; i < connections; ++i)
+		{
+			Result<net::Socket, net::SocketAcceptError> result = server.accept();
+
+			if (result.is_error())
+				break;
+
+			net::Socket conn = result.expect();
+
+			if (recv_all(conn, buffer.data(), SIZE))
+				send_all(conn, buffer.data(), SIZE);
+		}
+	} };
+
+	std::vector<u8> out(SIZE), in(SIZE);
+	fill_pattern(out);
+
+	std::vector<u64> samples;
+	samples.reserve(connections);
+
+	net::SockAddr target = loopback(local_port(server));
+
+	Clock::time_point begin = Clock::now();
+
+	for (usize i = 0; i < connections; ++i)
+	{
+		net::Socket client = tcp_socket();
+
+		Clock::time_point start = Clock::now();
+
+		usize sent = 0;
+
+		if (fast_open)
+		{
+			Result<usize, net::SocketConnectError> connected = client.connect_with_data(target, out.data(), SIZE);
+
+			if (connected.is_error())
+				break;
+
+			sent = connected.expect();
+		}
+		else if (client.connect(target).is_error())
+		{
+			break;
+		}
+
+		if (!send_all(client, out.data() + sent, SIZE - sent) || !recv_all(client, in.data(), SIZE))
+			break;
+
+		samples.push_back(elapsed_ns(start, Clock::now()));
+	}
+
+	u64 total = elapsed_ns(begin, Clock::now());
+
+	server.close().discard();
+	responder.join();
+
+	reporter.latency(fast_open ? "tcp_short_exchange_tfo" : "tcp_short_exchange", SIZE, samples, total);
+}
+
+static bool bench_resp_pipeline(const BenchConfig& cfg, Reporter& reporter, usize depth)
+{
+	net::TCPServer server{ 0 };
+	server.listen(1).expect_and_discard();
+
+	net::RespServer cache;
+
+	std::thread acceptor{ [&server, &cache]() {
+		cache.run(server).discard();
+	} };
+
+	net::Socket sock = tcp_socket();
+	sock.connect(loopback(local_port(server))).expect_and_discard();
+
+	net::RespClient client{ sock };
+
+	constexpr usize KEYS = 1024;
+
+	std::vector<std::string> keys(KEYS), values(KEYS);
+
+	for (usize i = 0; i < KEYS; ++i)
+	{
+		keys[i] = "bench:" + std::to_string(i);
+		values[i] = std::string(32, static_cast<char>('a' + i % 26)) + std::to_string(i);
+
+		client.command("SET", net::RespArg{ keys[i].data(), keys[i].size() }, net::RespArg{ values[i].data(), values[i].size() });
+	}
+
+	usize mismatches = 0;
+
+	for (usize i = 0; i < KEYS; ++i)
+	{
+		Result<net::RespView, net::RespError> reply = client.next_reply();
+
+		if (reply.is_error() || !reply.expect().equals("OK", 2))
+			++mismatches;
+	}
+
+	usize rounds = (cfg.warmup + cfg.iterations + depth - 1) / depth;
+	usize warmup_rounds = cfg.warmup / depth;
+	usize completed = 0;
+
+	Clock::time_point begin = Clock::now();
+
+	for (usize round = 0; round < rounds && mismatches == 0; ++round)
+	{
+		if (round == warmup_rounds)
+			begin = Clock::now();
+
+		usize first = round * depth;
+
+		for (usize i = 0; i < depth; ++i)
+		{
+			const std::string& key = keys[(first + i) % KEYS];
+			client.command("GET", net::RespArg{ key.data(), key.size() });
+		}
+
+		for (usize i = 0; i < depth; ++i)
+		{
+			Result<net::RespView, net::RespError> reply = client.next_reply();
+
+			if (reply.is_error())
+			{
+				++mismatches;
+				break;
+			}
+
+			const std::string& expected = values[(first + i) % KEYS];
+
+			if (!reply.expect().equals(expected.data(), expected.size()))
+				++mismatches;
+		}
+
+		if (round >= warmup_rounds)
+			completed += depth;
+	}
+
+	u64 total = elapsed_ns(begin, Clock::now());
+
+	cache.shutdown();
+	server.close().discard();
+	acceptor.join();
+
+	if (mismatches != 0)
+		std::fprintf(stderr, "resp_pipeline depth %zu: %zu mismatched replies\n", depth, mismatches);
+
+	reporter.throughput("resp_pipeline", depth, completed, 0, total);
+
+	return mismatches == 0;
+}
+
+static bool selected(const BenchConfig& cfg, const char* name)
+{
+	return cfg.filter == nullptr || std::strstr(name, cfg.filter) != nullptr;
+}
+
+static bool parse_args(int argc, char** argv, BenchConfig& cfg)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (std::strcmp(arg, "--csv") == 0)
+		{
+			cfg.csv = true;
+			continue;
+		}
+
+		if (value == nullptr)
+			return false;
+
+		if (std::strcmp(arg, "--filter") == 0)
+			cfg.filter = value;
+		else if (std::strcmp(arg, "--iterations") == 0)
+			cfg.iterations = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--warmup") == 0)
+			cfg.warmup = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--stream-bytes") == 0)
+			cfg.stream_bytes = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--udp-packets") == 0)
+			cfg.udp_packets = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--connections") == 0)
+			cfg.connections = std::strtoull(value, nullptr, 10);
+		else
+			return false;
+
+		++i;
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BenchConfig cfg;
+
+	if (!parse_args(argc, argv, cfg))
+	{
+		std::fprintf(stderr,
+			"usage: bsl_net_bench [--filter NAME] [--csv] [--iterations N] [--warmup N]\n"
+			"                     [--stream-bytes N] [--udp-packets N] [--connections N]\n");
+		return 2;
+	}
+
+	net::setup();
+
+	Reporter reporter{ cfg.csv };
+
+	bool failed = false;
+
+	if (selected(cfg, "tcp_pingpong"))
+		for (usize size : { 1, 64, 1024, 16384 })
+			bench_tcp_pingpong(cfg, reporter, size);
+
+	if (selected(cfg, "mem_pingpong"))
+		for (usize size : { 1, 64, 1024, 16384 })
+			bench_mem_pingpong(cfg, reporter, size);
+
+	if (selected(cfg, "tcp_stream"))
+		for (usize size : { 1024, 4096, 16384, 65536, 262144 })
+			bench_tcp_stream(cfg, reporter, size);
+
+	if (selected(cfg, "udp_pps"))
+		for (usize size : { 64, 512, 1400 })
+			bench_udp_pps(cfg, reporter, size);
+
+	if (selected(cfg, "udp_pingpong"))
+		for (usize size : { 64, 1024 })
+			bench_udp_pingpong(cfg, reporter, size, 0);
+
+	if (selected(cfg, "udp_pingpong_busy"))
+		for (usize size : { 64, 1024 })
+			bench_udp_pingpong(cfg, reporter, size, 200'000);
+
+	if (selected(cfg, "tcp_connect") || selected(cfg, "tcp_accept"))
+		bench_connect_accept(cfg, reporter);
+
+	if (selected(cfg, "tcp_short_exchange"))
+		bench_short_exchange(cfg, reporter, false);
+
+	if (selected(cfg, "tcp_short_exchange_tfo"))
+		bench_short_exchange(cfg, reporter, true);
+
+	if (selected(cfg, "resp_pipeline"))
+		for (usize depth : { 1, 16, 128 })
+			failed |= !bench_resp_pipeline(cfg, reporter, depth);
+
+	net::cleanup();
+
+	return failed ? 1 : 0;
+}
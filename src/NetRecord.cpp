@@ -0,0 +1,514 @@
+#include "NetRecord.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bsl::net
+{
+	static constexpr char TRAFFIC_MAGIC[8] = { 'B', 'S', 'L', 'T', 'R', 'C', '1', '\0' };
+
+	enum class _TrafficRecord : u8
+	{
+		SESSION_OPEN = 1,
+		DATA = 2,
+		SESSION_CLOSE = 3
+	};
+
+	static u64 traffic_clock_ns()
+	{
+		return static_cast<u64>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(
+			::std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	static usize put_varint(u8* dest, u64 value)
+	{
+		usize n = 0;
+
+		while (value >= 0x80)
+		{
+			dest[n++] = static_cast<u8>(value) | 0x80;
+			value >>= 7;
+		}
+
+		dest[n++] = static_cast<u8>(value);
+
+		return n;
+	}
+
+	static bool get_varint(const u8*& it, const u8* end, u64& value)
+	{
+		value = 0;
+
+		for (u32 shift = 0; shift < 64 && it != end; shift += 7)
+		{
+			u8 byte = *it++;
+			value |= static_cast<u64>(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	struct _TrafficRecorderState
+	{
+		::std::mutex m_mutex;
+		::std::FILE* m_file;
+		::std::atomic<u32> m_refs;
+		u32 m_next_session;
+		u64 m_last_ns;
+		u64 m_sessions;
+		u64 m_bytes;
+		bool m_failed;
+	};
+
+	static void release_recorder(_TrafficRecorderState* state)
+	{
+		if (state->m_refs.fetch_sub(1, ::std::memory_order_acq_rel) != 1)
+			return;
+
+		::std::fclose(state->m_file);
+		delete state;
+	}
+
+	static void write_record_header(_TrafficRecorderState* state, _TrafficRecord type, u32 session)
+	{
+		u8 header[1 + 10 + 10];
+		usize n = 0;
+
+		u64 now = traffic_clock_ns();
+		u64 delta = state->m_last_ns == 0 ? 0 : now - state->m_last_ns;
+		state->m_last_ns = now;
+
+		header[n++] = static_cast<u8>(type);
+		n += put_varint(header + n, session);
+		n += put_varint(header + n, delta);
+
+		if (::std::fwrite(header, 1, n, state->m_file) != n)
+			state->m_failed = true;
+	}
+
+	u32 _traffic_session_open(_TrafficRecorderState* state)
+	{
+		state->m_refs.fetch_add(1, ::std::memory_order_relaxed);
+
+		::std::lock_guard<::std::mutex> lock{ state->m_mutex };
+
+		u32 session = state->m_next_session++;
+		++state->m_sessions;
+
+		write_record_header(state, _TrafficRecord::SESSION_OPEN, session);
+
+		return session;
+	}
+
+	void _traffic_session_close(_TrafficRecorderState* state, u32 session)
+	{
+		{
+			::std::lock_guard<::std::mutex> lock{ state->m_mutex };
+			write_record_header(state, _TrafficRecord::SESSION_CLOSE, session);
+		}
+
+		release_recorder(state);
+	}
+
+	void _traffic_record(_TrafficRecorderState* state, u32 session, TrafficDirection dir, const u8* buffer, usize length)
+	{
+		if (length == 0)
+			return;
+
+		::std::lock_guard<::std::mutex> lock{ state->m_mutex };
+
+		write_record_header(state, _TrafficRecord::DATA, session);
+
+		u8 header[1 + 10];
+		usize n = 0;
+
+		header[n++] = static_cast<u8>(dir);
+		n += put_varint(header + n, length);
+
+		if (::std::fwrite(header, 1, n, state->m_file) != n || ::std::fwrite(buffer, 1, length, state->m_file) != length)
+			state->m_failed = true;
+
+		state->m_bytes += length;
+	}
+
+	TrafficRecorder::TrafficRecorder(_TrafficRecorderState* state) noexcept
+		: m_state{ state }
+	{
+	}
+
+	Result<TrafficRecorder, RecordError> TrafficRecorder::create(const char* path)
+	{
+		::std::FILE* file = nullptr;
+
+		if (::fopen_s(&file, path, "wb") != 0 || file == nullptr)
+			return RecordError{};
+
+		if (::std::fwrite(TRAFFIC_MAGIC, 1, sizeof(TRAFFIC_MAGIC), file) != sizeof(TRAFFIC_MAGIC))
+		{
+			::std::fclose(file);
+			return RecordError{};
+		}
+
+		_TrafficRecorderState* state = new _TrafficRecorderState{};
+		state->m_file = file;
+		state->m_refs.store(1, ::std::memory_order_relaxed);
+
+		return TrafficRecorder{ state };
+	}
+
+	TrafficRecorder::TrafficRecorder(TrafficRecorder&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	TrafficRecorder::~TrafficRecorder()
+	{
+		if (m_state != nullptr)
+		{
+			flush().discard();
+			release_recorder(m_state);
+		}
+	}
+
+	void TrafficRecorder::attach(Socket& sock)
+	{
+		sock.set_recorder(m_state);
+	}
+
+	u64 TrafficRecorder::sessions() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+		return m_state->m_sessions;
+	}
+
+	u64 TrafficRecorder::bytes_recorded() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+		return m_state->m_bytes;
+	}
+
+	Result<Unit, RecordError> TrafficRecorder::flush()
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		if (::std::fflush(m_state->m_file) != 0 || m_state->m_failed)
+			return RecordError{};
+
+		return Unit{};
+	}
+
+	struct _TrafficEvent
+	{
+		u64 m_time_ns;
+		TrafficDirection m_dir;
+		usize m_offset;
+		usize m_length;
+	};
+
+	struct _TrafficSession
+	{
+		u64 m_open_ns;
+		::std::vector<_TrafficEvent> m_events;
+	};
+
+	struct _TrafficLogState
+	{
+		::std::vector<u8> m_payload;
+		::std::vector<_TrafficSession> m_sessions;
+		u64 m_bytes[2];
+		u64 m_duration_ns;
+	};
+
+	TrafficLog::TrafficLog(_TrafficLogState* state) noexcept
+		: m_state{ state }
+	{
+	}
+
+	Result<TrafficLog, ReplayError> TrafficLog::load(const char* path)
+	{
+		::std::FILE* file = nullptr;
+
+		if (::fopen_s(&file, path, "rb") != 0 || file == nullptr)
+			return ReplayError{};
+
+		::std::vector<u8> data;
+		u8 chunk[65536];
+		usize n;
+
+		while ((n = ::std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+			data.insert(data.end(), chunk, chunk + n);
+
+		::std::fclose(file);
+
+		if (data.size() < sizeof(TRAFFIC_MAGIC) || ::std::memcmp(data.data(), TRAFFIC_MAGIC, sizeof(TRAFFIC_MAGIC)) != 0)
+			return ReplayError{};
+
+		_TrafficLogState* state = new _TrafficLogState{};
+		TrafficLog log{ state };
+
+		const u8* it = data.data() + sizeof(TRAFFIC_MAGIC);
+		const u8* end = data.data() + data.size();
+
+		::std::vector<usize> session_index;
+		u64 now = 0;
+
+		while (it != end)
+		{
+			u8 type = *it++;
+			u64 session, delta;
+
+			if (!get_varint(it, end, session) || !get_varint(it, end, delta))
+				return ReplayError{};
+
+			now += delta;
+
+			bool is_open = static_cast<_TrafficRecord>(type) == _TrafficRecord::SESSION_OPEN;
+
+			if (is_open ? session != session_index.size() : session >= session_index.size())
+				return ReplayError{};
+
+			switch (static_cast<_TrafficRecord>(type))
+			{
+			case _TrafficRecord::SESSION_OPEN:
+			{
+				session_index.push_back(state->m_sessions.size());
+				state->m_sessions.push_back(_TrafficSession{ now, {} });
+				break;
+			}
+			case _TrafficRecord::SESSION_CLOSE:
+				break;
+			case _TrafficRecord::DATA:
+			{
+				if (it == end)
+					return ReplayError{};
+
+				u8 dir = *it++;
+				u64 length;
+
+				if (dir > 1 || !get_varint(it, end, length) || static_cast<u64>(end - it) < length)
+					return ReplayError{};
+
+				_TrafficSession& s = state->m_sessions[session_index[session]];
+
+				s.m_events.push_back(_TrafficEvent{
+					now,
+					static_cast<TrafficDirection>(dir),
+					state->m_payload.size(),
+					static_cast<usize>(length)
+				});
+
+				state->m_payload.insert(state->m_payload.end(), it, it + length);
+				state->m_bytes[dir] += length;
+				it += length;
+				break;
+			}
+			default:
+				return ReplayError{};
+			}
+		}
+
+		state->m_duration_ns = now;
+
+		return move(log);
+	}
+
+	TrafficLog::TrafficLog(TrafficLog&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	TrafficLog::~TrafficLog()
+	{
+		delete m_state;
+	}
+
+	usize TrafficLog::sessions() const noexcept
+	{
+		return m_state->m_sessions.size();
+	}
+
+	u64 TrafficLog::bytes(TrafficDirection dir) const noexcept
+	{
+		return m_state->m_bytes[static_cast<usize>(dir)];
+	}
+
+	u64 TrafficLog::duration_ns() const noexcept
+	{
+		return m_state->m_duration_ns;
+	}
+
+	static void replay_wait(::std::chrono::steady_clock::time_point start, u64 at_ns, f64 speed)
+	{
+		if (speed <= 0.0)
+			return;
+
+		::std::this_thread::sleep_until(start + ::std::chrono::nanoseconds{ static_cast<i64>(static_cast<f64>(at_ns) / speed) });
+	}
+
+	static bool replay_events(const _TrafficLogState& log, const _TrafficSession& session, Socket& sock,
+		const ReplayOptions& options, ::std::chrono::steady_clock::time_point start, ReplayReport& local)
+	{
+		using Clock = ::std::chrono::steady_clock;
+
+		bool ok = true;
+
+		Clock::time_point last_send{};
+		bool awaiting_reply = false;
+
+		u8 sink[16384];
+
+		for (const _TrafficEvent& event : session.m_events)
+		{
+			if (!ok)
+				break;
+
+			TrafficDirection dir = event.m_dir;
+
+			if (options.perspective == ReplayPerspective::MIRRORED)
+				dir = dir == TrafficDirection::OUTBOUND ? TrafficDirection::INBOUND : TrafficDirection::OUTBOUND;
+
+			if (dir == TrafficDirection::OUTBOUND)
+			{
+				replay_wait(start, event.m_time_ns, options.speed);
+
+				const u8* data = log.m_payload.data() + event.m_offset;
+				usize remaining = event.m_length;
+
+				while (ok && remaining > 0)
+				{
+					Result<usize, SocketSendError> sent = sock.send(data, remaining);
+
+					if (sent.is_error())
+					{
+						ok = false;
+						break;
+					}
+
+					usize n = sent.expect();
+					data += n;
+					remaining -= n;
+					local.bytes_sent += n;
+				}
+
+				last_send = Clock::now();
+				awaiting_reply = true;
+			}
+			else
+			{
+				usize remaining = event.m_length;
+
+				while (ok && remaining > 0)
+				{
+					Result<usize, SocketReceiveError> received = sock.recv(sink, remaining < sizeof(sink) ? remaining : sizeof(sink));
+
+					if (received.is_error())
+					{
+						ok = false;
+						break;
+					}
+
+					usize n = received.expect();
+
+					if (n == 0)
+					{
+						ok = false;
+						break;
+					}
+
+					remaining -= n;
+					local.bytes_received += n;
+				}
+
+				if (ok && awaiting_reply)
+				{
+					local.exchange_latency.record(static_cast<u64>(
+						::std::chrono::duration_cast<::std::chrono::nanoseconds>(Clock::now() - last_send).count()));
+					++local.exchanges;
+					awaiting_reply = false;
+				}
+			}
+		}
+
+		return ok;
+	}
+
+	static void replay_session(const _TrafficLogState& log, const _TrafficSession& session, const SockAddr& target,
+		const ReplayOptions& options, ::std::chrono::steady_clock::time_point start, ::std::mutex& mutex, ReplayReport& report)
+	{
+		ReplayReport local;
+
+		replay_wait(start, session.m_open_ns, options.speed);
+
+		Result<Socket, SocketError> created = Socket::create(target.is_ipv4() ? AddrFamily::IPv4 : AddrFamily::IPv6, SockType::STREAM, Proto::TCP);
+
+		bool ok = created.is_ok();
+
+		if (ok)
+		{
+			Socket sock = created.expect();
+
+			ok = sock.connect(target).is_ok();
+
+			if (ok)
+			{
+				sock.set_nodelay(true).discard();
+				ok = replay_events(log, session, sock, options, start, local);
+			}
+		}
+
+		::std::lock_guard<::std::mutex> lock{ mutex };
+
+		++report.sessions;
+
+		if (!ok)
+			++report.failed_sessions;
+
+		report.bytes_sent += local.bytes_sent;
+		report.bytes_received += local.bytes_received;
+		report.exchanges += local.exchanges;
+		report.exchange_latency.merge(local.exchange_latency);
+	}
+
+	Result<Unit, ReplayError> TrafficLog::replay(const SockAddr& target, const ReplayOptions& options, ReplayReport& report) const
+	{
+		using Clock = ::std::chrono::steady_clock;
+
+		if (target.is_unix())
+			return ReplayError{};
+
+		usize count = m_state->m_sessions.size();
+
+		if (options.max_sessions != 0 && options.max_sessions < count)
+			count = options.max_sessions;
+
+		::std::mutex mutex;
+		::std::vector<::std::thread> workers;
+		workers.reserve(count);
+
+		Clock::time_point start = Clock::now();
+
+		for (usize i = 0; i < count; ++i)
+			workers.emplace_back(replay_session, ::std::cref(*m_state), ::std::cref(m_state->m_sessions[i]),
+				::std::cref(target), ::std::cref(options), start, ::std::ref(mutex), ::std::ref(report));
+
+		for (::std::thread& worker : workers)
+			worker.join();
+
+		report.duration_ns = static_cast<u64>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(Clock::now() - start).count());
+
+		if (report.failed_sessions != 0)
+			return ReplayError{};
+
+		return Unit{};
+	}
+}
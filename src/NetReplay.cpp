@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Net.hpp"
+#include "NetRecord.hpp"
+
+using namespace bsl;
+
+struct ReplayConfig
+{
+	const char* path = nullptr;
+	const char* host = nullptr;
+	u16 port = 0;
+	net::ReplayOptions options;
+};
+
+static bool parse_args(int argc, char** argv, ReplayConfig& cfg)
+{
+	usize positional = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+
+		if (std::strcmp(arg, "--mirror") == 0)
+		{
+			cfg.options.perspective = net::ReplayPerspective::MIRRORED;
+			continue;
+		}
+
+		if (arg[0] != '-' || arg[1] != '-')
+		{
+			if (positional == 0)
+				cfg.path = arg;
+			else if (positional == 1)
+				cfg.host = arg;
+			else if (positional == 2)
+				cfg.port = static_cast<u16>(std::strtoul(arg, nullptr, 10));
+			else
+				return false;
+
+			++positional;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+			return false;
+
+		const char* value = argv[++i];
+
+		if (std::strcmp(arg, "--speed") == 0)
+			cfg.options.speed = std::strtod(value, nullptr);
+		else if (std::strcmp(arg, "--max-sessions") == 0)
+			cfg.options.max_sessions = std::strtoull(value, nullptr, 10);
+		else
+			return false;
+	}
+
+	return positional == 3 && cfg.port != 0 && cfg.options.speed >= 0.0;
+}
+
+int main(int argc, char** argv)
+{
+	ReplayConfig cfg;
+
+	if (!parse_args(argc, argv, cfg))
+	{
+		std::fprintf(stderr,
+			"usage: bsl_net_replay FILE HOST PORT [--speed X] [--mirror] [--max-sessions N]\n"
+			"  --speed X            time scale, 2 replays twice as fast, 0 as fast as possible (default 1)\n"
+			"  --mirror             send the recorded inbound side instead of the outbound side\n"
+			"  --max-sessions N     replay only the first N sessions (default all)\n");
+		return 2;
+	}
+
+	Result<net::TrafficLog, net::ReplayError> loaded = net::TrafficLog::load(cfg.path);
+
+	if (loaded.is_error())
+	{
+		std::fprintf(stderr, "Could not load %s\n", cfg.path);
+		return 1;
+	}
+
+	net::TrafficLog log = loaded.expect();
+
+	net::setup();
+
+	Result<net::IPAddr, net::HostnameResolutionError> resolved = net::resolve(cfg.host);
+
+	if (resolved.is_error())
+	{
+		std::fprintf(stderr, "Could not resolve %s\n", cfg.host);
+		net::cleanup();
+		return 1;
+	}
+
+	net::IPAddr ip = resolved.expect();
+	net::SockAddr target = ip.is_ipv4()
+		? net::SockAddr{ net::SockAddrV4{ ip.to_ipv4(), cfg.port } }
+		: net::SockAddr{ net::SockAddrV6{ ip.to_ipv6(), cfg.port } };
+
+	std::printf("Replaying %zu sessions (%llu bytes out, %llu bytes in, %.3f s recorded)\n",
+		log.sessions(),
+		static_cast<unsigned long long>(log.bytes(net::TrafficDirection::OUTBOUND)),
+		static_cast<unsigned long long>(log.bytes(net::TrafficDirection::INBOUND)),
+		static_cast<f64>(log.duration_ns()) / 1e9);
+
+	net::ReplayReport* report = new net::ReplayReport{};
+	bool ok = log.replay(target, cfg.options, *report).is_ok();
+
+	const Histogram& latency = report->exchange_latency;
+
+	std::printf("sessions %llu (failed %llu), sent %llu bytes, received %llu bytes in %.3f s\n",
+		static_cast<unsigned long long>(report->sessions),
+		static_cast<unsigned long long>(report->failed_sessions),
+		static_cast<unsigned long long>(report->bytes_sent),
+		static_cast<unsigned long long>(report->bytes_received),
+		static_cast<f64>(report->duration_ns) / 1e9);
+
+	std::printf("exchanges %llu, latency us: mean %.1f p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f\n",
+		static_cast<unsigned long long>(report->exchanges),
+		latency.mean() / 1e3,
+		static_cast<f64>(latency.percentile(50.0)) / 1e3,
+		static_cast<f64>(latency.percentile(90.0)) / 1e3,
+		static_cast<f64>(latency.percentile(99.0)) / 1e3,
+		static_cast<f64>(latency.percentile(99.9)) / 1e3,
+		static_cast<f64>(latency.max()) / 1e3);
+
+	delete report;
+
+	net::cleanup();
+
+	return ok ? 0 : 1;
+}
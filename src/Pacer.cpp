@@ -0,0 +1,240 @@
+#include "Pacer.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include <intrin.h>
+
+namespace bsl::net
+{
+	static constexpr u64 PACER_SLEEP_SLACK_NS = 2'000'000;
+	static constexpr u64 PACER_SPIN_NS = 50'000;
+
+	PacedSender::PacedSender(Socket& sock, u64 bits_per_second, usize burst_bytes) noexcept
+		: m_sock{ &sock }, m_bits_per_second{ 0 }, m_burst_ns{ 0 }, m_next_ns{ 0 }, m_mode{ PacingMode::USER_SPACE }, m_kernel_dest{}
+	{
+		apply_rate(bits_per_second, burst_bytes);
+	}
+
+	PacedSender::PacedSender(PacedSender&& other) noexcept
+		: m_sock{ other.m_sock }, m_bits_per_second{ other.m_bits_per_second }, m_burst_ns{ other.m_burst_ns }, m_next_ns{ other.m_next_ns },
+		m_mode{ other.m_mode }, m_kernel_dest{}
+	{
+		if (other.m_kernel_dest.has_value())
+			m_kernel_dest = other.m_kernel_dest.unwrap();
+
+		other.m_mode = PacingMode::USER_SPACE;
+	}
+
+	u64 PacedSender::now() noexcept
+	{
+		return static_cast<u64>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(
+			::std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	u64 PacedSender::wire_time_ns(usize length) const noexcept
+	{
+		if (m_bits_per_second == 0)
+			return 0;
+
+		return static_cast<u64>(length) * 8'000'000'000ull / m_bits_per_second;
+	}
+
+	bool PacedSender::is_kernel_dest(const SockAddr& addr) const noexcept
+	{
+		return m_mode != PacingMode::KERNEL || m_kernel_dest.value() == addr;
+	}
+
+	void PacedSender::apply_rate(u64 bits_per_second, usize burst_bytes) noexcept
+	{
+		m_bits_per_second = bits_per_second;
+		m_burst_ns = wire_time_ns(burst_bytes);
+	}
+
+	void PacedSender::wait_until(u64 deadline_ns) const noexcept
+	{
+		u64 current = now();
+
+		if (deadline_ns > current + PACER_SLEEP_SLACK_NS)
+		{
+			::std::this_thread::sleep_for(::std::chrono::nanoseconds{ static_cast<i64>(deadline_ns - current - PACER_SLEEP_SLACK_NS) });
+			current = now();
+		}
+
+		while (current < deadline_ns)
+		{
+			if (deadline_ns - current > PACER_SPIN_NS)
+				::std::this_thread::yield();
+			else
+				_mm_pause();
+
+			current = now();
+		}
+	}
+
+	u64 PacedSender::reserve() noexcept
+	{
+		u64 current = now();
+
+		if (m_next_ns + m_burst_ns < current)
+			m_next_ns = current - m_burst_ns;
+
+		return m_next_ns;
+	}
+
+	Result<Unit, SocketError> PacedSender::enable_kernel_pacing(const SockAddr& dest)
+	{
+		if (m_sock->is_connected())
+		{
+			Result<SockAddr, SocketError> peer = m_sock->peer();
+
+			if (peer.is_error())
+				return peer.expect_error();
+
+			if (!(peer.expect() == dest))
+				return SocketError{ NetErrorKind::INVALID_ARGUMENT };
+		}
+
+		Result<Unit, SocketError> result = m_sock->set_pacing_rate(dest, m_bits_per_second);
+
+		m_mode = PacingMode::USER_SPACE;
+		m_kernel_dest.reset();
+
+		if (result.is_error())
+			return result.expect_error();
+
+		if (m_bits_per_second != 0)
+		{
+			m_mode = PacingMode::KERNEL;
+			m_kernel_dest = dest;
+		}
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketError> PacedSender::disable_kernel_pacing()
+	{
+		if (m_mode != PacingMode::KERNEL)
+			return Unit{};
+
+		Result<Unit, SocketError> result = m_sock->set_pacing_rate(m_kernel_dest.value(), 0);
+
+		m_mode = PacingMode::USER_SPACE;
+		m_kernel_dest.reset();
+		m_next_ns = 0;
+
+		if (result.is_error())
+			return result.expect_error();
+
+		return Unit{};
+	}
+
+	PacingMode PacedSender::mode() const noexcept
+	{
+		return m_mode;
+	}
+
+	const Maybe<SockAddr>& PacedSender::kernel_destination() const noexcept
+	{
+		return m_kernel_dest;
+	}
+
+	u64 PacedSender::rate() const noexcept
+	{
+		return m_bits_per_second;
+	}
+
+	u64 PacedSender::next_departure() const noexcept
+	{
+		return m_next_ns;
+	}
+
+	Result<Unit, SocketError> PacedSender::set_rate(u64 bits_per_second, usize burst_bytes)
+	{
+		if (m_mode == PacingMode::KERNEL)
+		{
+			Result<Unit, SocketError> result = m_sock->set_pacing_rate(m_kernel_dest.value(), bits_per_second);
+
+			if (result.is_error())
+				return result.expect_error();
+
+			if (bits_per_second == 0)
+			{
+				m_mode = PacingMode::USER_SPACE;
+				m_kernel_dest.reset();
+				m_next_ns = 0;
+			}
+		}
+
+		apply_rate(bits_per_second, burst_bytes);
+
+		return Unit{};
+	}
+
+	Result<usize, SocketSendError> PacedSender::send(const u8* buffer, usize length)
+	{
+		if (m_mode == PacingMode::USER_SPACE && m_bits_per_second != 0)
+			wait_until(reserve());
+
+		Result<usize, SocketSendError> result = m_sock->send(buffer, length);
+
+		if (result.is_error())
+			return result;
+
+		usize sent = result.expect();
+
+		if (m_mode == PacingMode::USER_SPACE)
+			m_next_ns += wire_time_ns(sent);
+
+		return sent;
+	}
+
+	Result<usize, SocketSendError> PacedSender::send_to(const SockAddr& addr, const u8* buffer, usize length)
+	{
+		if (!is_kernel_dest(addr))
+			return SocketSendError{ NetErrorKind::INVALID_ARGUMENT };
+
+		if (m_mode == PacingMode::USER_SPACE && m_bits_per_second != 0)
+			wait_until(reserve());
+
+		Result<usize, SocketSendError> result = m_sock->send_to(addr, buffer, length);
+
+		if (result.is_error())
+			return result;
+
+		usize sent = result.expect();
+
+		if (m_mode == PacingMode::USER_SPACE)
+			m_next_ns += wire_time_ns(sent);
+
+		return sent;
+	}
+
+	Result<usize, SocketSendError> PacedSender::send_to_at(const SockAddr& addr, const u8* buffer, usize length, u64 departure_ns)
+	{
+		if (!is_kernel_dest(addr))
+			return SocketSendError{ NetErrorKind::INVALID_ARGUMENT };
+
+		if (m_mode == PacingMode::USER_SPACE && m_bits_per_second != 0)
+		{
+			u64 paced = reserve();
+
+			if (departure_ns < paced)
+				departure_ns = paced;
+		}
+
+		wait_until(departure_ns);
+
+		Result<usize, SocketSendError> result = m_sock->send_to(addr, buffer, length);
+
+		if (result.is_error())
+			return result;
+
+		usize sent = result.expect();
+
+		if (m_mode == PacingMode::USER_SPACE)
+			m_next_ns = departure_ns + wire_time_ns(sent);
+
+		return sent;
+	}
+}
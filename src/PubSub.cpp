@@ -0,0 +1,842 @@
+#include "PubSub.hpp"
+#include "ConnServer.hpp"
+#include "Framed.hpp"
+#include "StreamIo.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace bsl::net
+{
+	static constexpr usize PUBSUB_LENGTH_SIZE = 4;
+	static constexpr usize PUBSUB_MESSAGE_PREFIX = PUBSUB_LENGTH_SIZE + 1;
+	static constexpr usize PUBSUB_COMMAND_PREFIX = 2;
+
+	static constexpr u8 PUBSUB_SUBSCRIBE = 1;
+	static constexpr u8 PUBSUB_UNSUBSCRIBE = 2;
+	static constexpr u8 PUBSUB_PUBLISH = 3;
+
+	static constexpr u64 BROKER_RETRY_MS = 1;
+
+	struct _PubSubBuffer
+	{
+		::std::atomic<u32> m_refs;
+		usize m_size;
+
+		[[nodiscard]] u8* data() noexcept
+		{
+			return reinterpret_cast<u8*>(this + 1);
+		}
+	};
+
+	static _PubSubBuffer* allocate_buffer(usize size)
+	{
+		void* memory = ::operator new(sizeof(_PubSubBuffer) + size);
+
+		_PubSubBuffer* buffer = new (memory) _PubSubBuffer{};
+		buffer->m_refs.store(1, ::std::memory_order_relaxed);
+		buffer->m_size = size;
+
+		return buffer;
+	}
+
+	static void retain_buffer(_PubSubBuffer* buffer, u32 count = 1) noexcept
+	{
+		buffer->m_refs.fetch_add(count, ::std::memory_order_relaxed);
+	}
+
+	static void release_buffer(_PubSubBuffer* buffer, u32 count = 1) noexcept
+	{
+		if (buffer->m_refs.fetch_sub(count, ::std::memory_order_acq_rel) != count)
+			return;
+
+		buffer->~_PubSubBuffer();
+		::operator delete(buffer);
+	}
+
+	static ::std::string_view buffer_topic(_PubSubBuffer* buffer) noexcept
+	{
+		u8* data = buffer->data();
+
+		return ::std::string_view{ reinterpret_cast<const char*>(data + PUBSUB_MESSAGE_PREFIX), data[PUBSUB_LENGTH_SIZE] };
+	}
+
+	PubSubMessage::PubSubMessage(_PubSubBuffer* buffer) noexcept
+		: m_buffer{ buffer }
+	{
+	}
+
+	Maybe<PubSubMessage> PubSubMessage::create(const char* topic, usize topic_length, const u8* payload, usize length)
+	{
+		if (topic_length == 0 || topic_length > MAX_TOPIC_LENGTH)
+			return {};
+
+		_PubSubBuffer* buffer = allocate_buffer(PUBSUB_MESSAGE_PREFIX + topic_length + length);
+		u8* data = buffer->data();
+
+		_store_u32(data, static_cast<u32>(1 + topic_length + length));
+		data[PUBSUB_LENGTH_SIZE] = static_cast<u8>(topic_length);
+
+		::std::memcpy(data + PUBSUB_MESSAGE_PREFIX, topic, topic_length);
+
+		if (length != 0)
+			::std::memcpy(data + PUBSUB_MESSAGE_PREFIX + topic_length, payload, length);
+
+		return PubSubMessage{ buffer };
+	}
+
+	PubSubMessage::PubSubMessage(const PubSubMessage& other) noexcept
+		: m_buffer{ other.m_buffer }
+	{
+		if (m_buffer != nullptr)
+			retain_buffer(m_buffer);
+	}
+
+	PubSubMessage::PubSubMessage(PubSubMessage&& other) noexcept
+		: m_buffer{ other.m_buffer }
+	{
+		other.m_buffer = nullptr;
+	}
+
+	PubSubMessage::~PubSubMessage()
+	{
+		if (m_buffer != nullptr)
+			release_buffer(m_buffer);
+	}
+
+	PubSubMessage& PubSubMessage::operator=(const PubSubMessage& other) noexcept
+	{
+		if (other.m_buffer != nullptr)
+			retain_buffer(other.m_buffer);
+
+		if (m_buffer != nullptr)
+			release_buffer(m_buffer);
+
+		m_buffer = other.m_buffer;
+
+		return *this;
+	}
+
+	PubSubMessage& PubSubMessage::operator=(PubSubMessage&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		if (m_buffer != nullptr)
+			release_buffer(m_buffer);
+
+		m_buffer = other.m_buffer;
+		other.m_buffer = nullptr;
+
+		return *this;
+	}
+
+	const char* PubSubMessage::topic() const noexcept
+	{
+		return reinterpret_cast<const char*>(m_buffer->data() + PUBSUB_MESSAGE_PREFIX);
+	}
+
+	usize PubSubMessage::topic_length() const noexcept
+	{
+		return m_buffer->data()[PUBSUB_LENGTH_SIZE];
+	}
+
+	const u8* PubSubMessage::payload() const noexcept
+	{
+		return m_buffer->data() + PUBSUB_MESSAGE_PREFIX + topic_length();
+	}
+
+	usize PubSubMessage::payload_size() const noexcept
+	{
+		return m_buffer->m_size - PUBSUB_MESSAGE_PREFIX - topic_length();
+	}
+
+	const u8* PubSubMessage::wire_data() const noexcept
+	{
+		return m_buffer->data();
+	}
+
+	usize PubSubMessage::wire_size() const noexcept
+	{
+		return m_buffer->m_size;
+	}
+
+	u32 PubSubMessage::use_count() const noexcept
+	{
+		return m_buffer->m_refs.load(::std::memory_order_relaxed);
+	}
+
+	struct _PubSubConnection : _ServerConn
+	{
+		FramedStream m_stream;
+
+		::std::mutex m_mutex;
+		::std::deque<_PubSubBuffer*> m_queue;
+		usize m_queued_bytes;
+
+		bool m_scheduled;
+		bool m_closed;
+		bool m_stalled;
+
+		::std::vector<_PubSubBuffer*> m_batch;
+		::std::vector<IoSlice> m_slices;
+		usize m_slice;
+		u64 m_stalled_since;
+
+		::std::vector<::std::string> m_topics;
+
+		::std::atomic<u32> m_refs;
+
+		_PubSubConnection(Socket&& sock, const BrokerConfig& config)
+			: _ServerConn{ move(sock) }, m_stream{ m_sock, FrameConfig{ PUBSUB_COMMAND_PREFIX + PubSubMessage::MAX_TOPIC_LENGTH + config.max_message } },
+			m_queued_bytes{ 0 }, m_scheduled{ false }, m_closed{ false }, m_stalled{ false }, m_slice{ 0 }, m_stalled_since{ 0 }, m_refs{ 0 }
+		{
+		}
+
+		~_PubSubConnection()
+		{
+			for (_PubSubBuffer* buffer : m_batch)
+				release_buffer(buffer);
+		}
+
+		[[nodiscard]] bool is_finished() const noexcept
+		{
+			return m_done.load(::std::memory_order_acquire) && m_refs.load(::std::memory_order_acquire) == 0;
+		}
+	};
+
+	struct _TopicHash
+	{
+		using is_transparent = void;
+
+		[[nodiscard]] usize operator()(::std::string_view topic) const noexcept
+		{
+			return ::std::hash<::std::string_view>{}(topic);
+		}
+	};
+
+	struct _BrokerState
+	{
+		BrokerConfig m_config;
+
+		::std::shared_mutex m_topics_mutex;
+		::std::unordered_map<::std::string, ::std::vector<_PubSubConnection*>, _TopicHash, ::std::equal_to<>> m_topics;
+
+		::std::mutex m_mutex;
+		::std::condition_variable m_ready_cv;
+		::std::deque<_PubSubConnection*> m_ready;
+		usize m_stalled;
+
+		_ConnServer<_PubSubConnection> m_server;
+		::std::vector<::std::thread> m_writers;
+
+		bool m_stopping;
+
+		::std::atomic<u64> m_published;
+		::std::atomic<u64> m_delivered;
+		::std::atomic<u64> m_dropped;
+		::std::atomic<u64> m_disconnected;
+		::std::atomic<u64> m_bytes_published;
+		::std::atomic<u64> m_bytes_written;
+		::std::atomic<u64> m_batches_written;
+	};
+
+	static void drop_queue(_PubSubConnection& conn) noexcept
+	{
+		for (_PubSubBuffer* buffer : conn.m_queue)
+			release_buffer(buffer);
+
+		conn.m_queue.clear();
+		conn.m_queued_bytes = 0;
+	}
+
+	static u64 broker_clock_ms() noexcept
+	{
+		return static_cast<u64>(::std::chrono::duration_cast<::std::chrono::milliseconds>(
+			::std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	static void schedule(_BrokerState& state, _PubSubConnection& conn, bool stalled)
+	{
+		{
+			::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+			state.m_ready.push_back(&conn);
+
+			if (stalled)
+			{
+				conn.m_stalled = true;
+				++state.m_stalled;
+			}
+		}
+
+		if (!stalled)
+			state.m_ready_cv.notify_one();
+	}
+
+	static void release_batch(_PubSubConnection& conn) noexcept
+	{
+		for (_PubSubBuffer* buffer : conn.m_batch)
+			release_buffer(buffer);
+
+		conn.m_batch.clear();
+		conn.m_slices.clear();
+		conn.m_slice = 0;
+		conn.m_stalled_since = 0;
+	}
+
+	static bool enqueue(_BrokerState& state, _PubSubConnection& conn, _PubSubBuffer* buffer)
+	{
+		const BrokerConfig& config = state.m_config;
+
+		::std::lock_guard<::std::mutex> lock{ conn.m_mutex };
+
+		if (conn.m_closed)
+			return false;
+
+		while (conn.m_queue.size() >= config.max_queue || (conn.m_queued_bytes != 0 && conn.m_queued_bytes + buffer->m_size > config.max_queued_bytes))
+		{
+			if (config.policy == SlowSubscriberPolicy::DROP_NEWEST)
+			{
+				state.m_dropped.fetch_add(1, ::std::memory_order_relaxed);
+				return false;
+			}
+
+			if (config.policy == SlowSubscriberPolicy::DISCONNECT)
+			{
+				state.m_dropped.fetch_add(conn.m_queue.size() + 1, ::std::memory_order_relaxed);
+				state.m_disconnected.fetch_add(1, ::std::memory_order_relaxed);
+
+				conn.m_closed = true;
+				drop_queue(conn);
+
+				conn.m_sock.shutdown().discard();
+
+				return false;
+			}
+
+			_PubSubBuffer* oldest = conn.m_queue.front();
+			conn.m_queue.pop_front();
+			conn.m_queued_bytes -= oldest->m_size;
+
+			release_buffer(oldest);
+			state.m_dropped.fetch_add(1, ::std::memory_order_relaxed);
+		}
+
+		conn.m_queue.push_back(buffer);
+		conn.m_queued_bytes += buffer->m_size;
+
+		if (!conn.m_scheduled)
+		{
+			conn.m_scheduled = true;
+			conn.m_refs.fetch_add(1, ::std::memory_order_relaxed);
+
+			schedule(state, conn, false);
+		}
+
+		return true;
+	}
+
+	static usize fan_out(_BrokerState& state, _PubSubBuffer* buffer)
+	{
+		state.m_published.fetch_add(1, ::std::memory_order_relaxed);
+		state.m_bytes_published.fetch_add(buffer->m_size, ::std::memory_order_relaxed);
+
+		::std::shared_lock<::std::shared_mutex> lock{ state.m_topics_mutex };
+
+		auto it = state.m_topics.find(buffer_topic(buffer));
+
+		if (it == state.m_topics.end())
+			return 0;
+
+		const ::std::vector<_PubSubConnection*>& subscribers = it->second;
+
+		retain_buffer(buffer, static_cast<u32>(subscribers.size()));
+
+		usize delivered = 0;
+
+		for (_PubSubConnection* conn : subscribers)
+			if (enqueue(state, *conn, buffer))
+				++delivered;
+
+		if (delivered != subscribers.size())
+			release_buffer(buffer, static_cast<u32>(subscribers.size() - delivered));
+
+		state.m_delivered.fetch_add(delivered, ::std::memory_order_relaxed);
+
+		return delivered;
+	}
+
+	static void subscribe(_BrokerState& state, _PubSubConnection& conn, ::std::string_view topic)
+	{
+		for (const ::std::string& existing : conn.m_topics)
+			if (existing == topic)
+				return;
+
+		conn.m_topics.emplace_back(topic);
+
+		::std::unique_lock<::std::shared_mutex> lock{ state.m_topics_mutex };
+
+		auto it = state.m_topics.find(topic);
+
+		if (it == state.m_topics.end())
+			it = state.m_topics.emplace(::std::string{ topic }, ::std::vector<_PubSubConnection*>{}).first;
+
+		it->second.push_back(&conn);
+	}
+
+	static void unsubscribe(_BrokerState& state, _PubSubConnection& conn, ::std::string_view topic)
+	{
+		auto existing = ::std::find(conn.m_topics.begin(), conn.m_topics.end(), topic);
+
+		if (existing == conn.m_topics.end())
+			return;
+
+		conn.m_topics.erase(existing);
+
+		::std::unique_lock<::std::shared_mutex> lock{ state.m_topics_mutex };
+
+		auto it = state.m_topics.find(topic);
+
+		if (it == state.m_topics.end())
+			return;
+
+		::std::vector<_PubSubConnection*>& subscribers = it->second;
+		subscribers.erase(::std::find(subscribers.begin(), subscribers.end(), &conn));
+
+		if (subscribers.empty())
+			state.m_topics.erase(it);
+	}
+
+	static void broker_read_loop(_BrokerState& state, _PubSubConnection& conn)
+	{
+		for (;;)
+		{
+			Result<usize, SocketReceiveError> size = conn.m_stream.next_frame_size();
+
+			if (size.is_error())
+				break;
+
+			usize length = size.expect();
+
+			if (length < PUBSUB_COMMAND_PREFIX + 1)
+				break;
+
+			_PubSubBuffer* buffer = allocate_buffer(PUBSUB_LENGTH_SIZE - 1 + length);
+			u8* data = buffer->data();
+
+			Result<usize, SocketReceiveError> received = conn.m_stream.recv_frame(data + PUBSUB_LENGTH_SIZE - 1, length);
+
+			if (received.is_error())
+			{
+				release_buffer(buffer);
+				break;
+			}
+
+			u8 op = data[PUBSUB_LENGTH_SIZE - 1];
+			usize topic_length = data[PUBSUB_LENGTH_SIZE];
+
+			if (topic_length == 0 || PUBSUB_COMMAND_PREFIX + topic_length > length)
+			{
+				release_buffer(buffer);
+				break;
+			}
+
+			if (op == PUBSUB_PUBLISH)
+			{
+				_store_u32(data, static_cast<u32>(length - 1));
+				fan_out(state, buffer);
+			}
+			else if (op == PUBSUB_SUBSCRIBE)
+			{
+				subscribe(state, conn, buffer_topic(buffer));
+			}
+			else if (op == PUBSUB_UNSUBSCRIBE)
+			{
+				unsubscribe(state, conn, buffer_topic(buffer));
+			}
+			else
+			{
+				release_buffer(buffer);
+				break;
+			}
+
+			release_buffer(buffer);
+		}
+
+		while (!conn.m_topics.empty())
+			unsubscribe(state, conn, ::std::string{ conn.m_topics.back() });
+
+		{
+			::std::lock_guard<::std::mutex> lock{ conn.m_mutex };
+
+			conn.m_closed = true;
+			drop_queue(conn);
+		}
+
+		conn.m_done.store(true, ::std::memory_order_release);
+	}
+
+	static void run_writer(_BrokerState& state)
+	{
+		for (;;)
+		{
+			_PubSubConnection* conn;
+
+			{
+				::std::unique_lock<::std::mutex> lock{ state.m_mutex };
+
+				state.m_ready_cv.wait(lock, [&] { return state.m_stopping || !state.m_ready.empty(); });
+
+				if (!state.m_stopping && state.m_stalled == state.m_ready.size())
+				{
+					state.m_ready_cv.wait_for(lock, ::std::chrono::milliseconds{ BROKER_RETRY_MS }, [&] {
+						return state.m_stopping || state.m_stalled != state.m_ready.size();
+					});
+				}
+
+				if (state.m_stopping)
+					return;
+
+				if (state.m_ready.empty())
+					continue;
+
+				conn = state.m_ready.front();
+				state.m_ready.pop_front();
+
+				if (conn->m_stalled)
+				{
+					conn->m_stalled = false;
+					--state.m_stalled;
+				}
+			}
+
+			if (conn->m_batch.empty())
+			{
+				::std::lock_guard<::std::mutex> lock{ conn->m_mutex };
+
+				while (!conn->m_queue.empty() && conn->m_batch.size() < Socket::MAX_IO_SLICES)
+				{
+					_PubSubBuffer* buffer = conn->m_queue.front();
+					conn->m_queue.pop_front();
+					conn->m_queued_bytes -= buffer->m_size;
+
+					conn->m_batch.push_back(buffer);
+					conn->m_slices.push_back(IoSlice{ buffer->data(), buffer->m_size });
+				}
+			}
+
+			bool failed = false;
+			bool blocked = false;
+			usize written = 0;
+
+			while (conn->m_slice < conn->m_slices.size())
+			{
+				Result<usize, SocketSendError> result = conn->m_sock.send_vectored(conn->m_slices.data() + conn->m_slice, conn->m_slices.size() - conn->m_slice);
+
+				if (result.is_error())
+				{
+					blocked = result.expect_error().would_block();
+					failed = !blocked;
+					break;
+				}
+
+				usize sent = result.expect();
+
+				if (sent == 0)
+				{
+					failed = true;
+					break;
+				}
+
+				written += sent;
+
+				while (conn->m_slice < conn->m_slices.size() && sent >= conn->m_slices[conn->m_slice].length)
+					sent -= conn->m_slices[conn->m_slice++].length;
+
+				if (sent != 0)
+				{
+					conn->m_slices[conn->m_slice].data += sent;
+					conn->m_slices[conn->m_slice].length -= sent;
+				}
+			}
+
+			if (written != 0)
+				state.m_bytes_written.fetch_add(written, ::std::memory_order_relaxed);
+
+			if (blocked)
+			{
+				u64 now = broker_clock_ms();
+
+				if (written != 0 || conn->m_stalled_since == 0)
+					conn->m_stalled_since = now;
+				else if (state.m_config.send_timeout_ms != 0 && now - conn->m_stalled_since >= state.m_config.send_timeout_ms)
+					failed = true;
+			}
+			else if (!failed && !conn->m_batch.empty())
+			{
+				state.m_batches_written.fetch_add(1, ::std::memory_order_relaxed);
+			}
+
+			if (failed || !blocked)
+				release_batch(*conn);
+
+			bool reschedule;
+
+			{
+				::std::lock_guard<::std::mutex> lock{ conn->m_mutex };
+
+				if (failed && !conn->m_closed)
+				{
+					state.m_dropped.fetch_add(conn->m_queue.size(), ::std::memory_order_relaxed);
+					state.m_disconnected.fetch_add(1, ::std::memory_order_relaxed);
+
+					conn->m_closed = true;
+					drop_queue(*conn);
+
+					conn->m_sock.shutdown().discard();
+				}
+
+				if (conn->m_closed)
+					release_batch(*conn);
+
+				reschedule = !conn->m_closed && (!conn->m_batch.empty() || !conn->m_queue.empty());
+
+				if (!reschedule)
+					conn->m_scheduled = false;
+			}
+
+			if (reschedule)
+				schedule(state, *conn, blocked);
+			else
+				conn->m_refs.fetch_sub(1, ::std::memory_order_release);
+		}
+	}
+
+	Broker::Broker(const BrokerConfig& config)
+		: m_state{ new _BrokerState{} }
+	{
+		m_state->m_config = config;
+
+		if (m_state->m_config.max_queue == 0)
+			m_state->m_config.max_queue = 1;
+
+		usize writers = config.writers != 0 ? config.writers : 1;
+
+		for (usize i = 0; i < writers; ++i)
+			m_state->m_writers.emplace_back(run_writer, ::std::ref(*m_state));
+	}
+
+	Broker::Broker(Broker&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	Broker::~Broker()
+	{
+		if (m_state == nullptr)
+			return;
+
+		shutdown();
+
+		delete m_state;
+	}
+
+	usize Broker::publish(const PubSubMessage& message)
+	{
+		return fan_out(*m_state, message.m_buffer);
+	}
+
+	usize Broker::publish(const char* topic, usize topic_length, const u8* payload, usize length)
+	{
+		Maybe<PubSubMessage> message = PubSubMessage::create(topic, topic_length, payload, length);
+
+		if (!message.has_value())
+			return 0;
+
+		return publish(message.value());
+	}
+
+	void Broker::serve(Socket&& sock)
+	{
+		_BrokerState& state = *m_state;
+
+		_PubSubConnection* conn = new _PubSubConnection{ move(sock), state.m_config };
+		conn->m_sock.set_nonblocking(true).discard();
+
+		state.m_server.serve(conn, [&state](_PubSubConnection& conn) {
+			conn.m_reader = ::std::thread{ broker_read_loop, ::std::ref(state), ::std::ref(conn) };
+		});
+	}
+
+	Result<Unit, SocketAcceptError> Broker::run(TCPServer& server)
+	{
+		return m_state->m_server.run(server, [this](Socket&& sock) { serve(move(sock)); });
+	}
+
+	usize Broker::connections() const noexcept
+	{
+		return m_state->m_server.active();
+	}
+
+	usize Broker::subscribers(const char* topic, usize topic_length) const noexcept
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ m_state->m_topics_mutex };
+
+		auto it = m_state->m_topics.find(::std::string_view{ topic, topic_length });
+
+		return it != m_state->m_topics.end() ? it->second.size() : 0;
+	}
+
+	BrokerStats Broker::stats() const noexcept
+	{
+		BrokerStats stats{};
+		stats.published = m_state->m_published.load(::std::memory_order_relaxed);
+		stats.delivered = m_state->m_delivered.load(::std::memory_order_relaxed);
+		stats.dropped = m_state->m_dropped.load(::std::memory_order_relaxed);
+		stats.disconnected = m_state->m_disconnected.load(::std::memory_order_relaxed);
+		stats.bytes_published = m_state->m_bytes_published.load(::std::memory_order_relaxed);
+		stats.bytes_written = m_state->m_bytes_written.load(::std::memory_order_relaxed);
+		stats.batches_written = m_state->m_batches_written.load(::std::memory_order_relaxed);
+
+		return stats;
+	}
+
+	void Broker::shutdown()
+	{
+		_BrokerState& state = *m_state;
+
+		::std::vector<_PubSubConnection*> connections = state.m_server.stop();
+
+		{
+			::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+			state.m_stopping = true;
+			state.m_ready.clear();
+			state.m_stalled = 0;
+		}
+
+		for (_PubSubConnection* conn : connections)
+			conn->m_sock.shutdown().discard();
+
+		state.m_ready_cv.notify_all();
+
+		for (::std::thread& writer : state.m_writers)
+			writer.join();
+
+		state.m_writers.clear();
+
+		_ConnServer<_PubSubConnection>::join(connections);
+	}
+
+	struct _PubSubClientState
+	{
+		Socket m_sock;
+		FramedStream m_stream;
+
+		_PubSubClientState(Socket&& sock, usize max_message)
+			: m_sock{ move(sock) }, m_stream{ m_sock, FrameConfig{ 1 + PubSubMessage::MAX_TOPIC_LENGTH + max_message } }
+		{
+		}
+	};
+
+	PubSubClient::PubSubClient(Socket&& sock, usize max_message)
+		: m_state{ new _PubSubClientState{ move(sock), max_message } }
+	{
+		m_state->m_sock.set_nodelay(true).discard();
+	}
+
+	PubSubClient::PubSubClient(PubSubClient&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	PubSubClient::~PubSubClient()
+	{
+		delete m_state;
+	}
+
+	Result<Unit, SocketSendError> PubSubClient::send_command(u8 op, const char* topic, usize topic_length, const u8* payload, usize length)
+	{
+		if (topic_length == 0 || topic_length > PubSubMessage::MAX_TOPIC_LENGTH)
+			return SocketSendError{ NetErrorKind::INVALID_ARGUMENT };
+
+		if (length > 0x7FFFFFFFu - PUBSUB_COMMAND_PREFIX - topic_length)
+			return SocketSendError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		u8 header[PUBSUB_LENGTH_SIZE + PUBSUB_COMMAND_PREFIX];
+		_store_u32(header, static_cast<u32>(PUBSUB_COMMAND_PREFIX + topic_length + length));
+		header[PUBSUB_LENGTH_SIZE] = op;
+		header[PUBSUB_LENGTH_SIZE + 1] = static_cast<u8>(topic_length);
+
+		IoSlice slices[3];
+		slices[0] = IoSlice{ header, sizeof(header) };
+		slices[1] = IoSlice{ reinterpret_cast<const u8*>(topic), topic_length };
+		slices[2] = IoSlice{ payload, length };
+
+		Result<Unit, SocketSendError> sent = _write_slices(m_state->m_sock, slices, length != 0 ? 3 : 2);
+
+		if (sent.is_error())
+			return sent.expect_error();
+
+		return Unit{};
+	}
+
+	Result<Unit, SocketSendError> PubSubClient::subscribe(const char* topic, usize topic_length)
+	{
+		return send_command(PUBSUB_SUBSCRIBE, topic, topic_length, nullptr, 0);
+	}
+
+	Result<Unit, SocketSendError> PubSubClient::unsubscribe(const char* topic, usize topic_length)
+	{
+		return send_command(PUBSUB_UNSUBSCRIBE, topic, topic_length, nullptr, 0);
+	}
+
+	Result<Unit, SocketSendError> PubSubClient::publish(const char* topic, usize topic_length, const u8* payload, usize length)
+	{
+		return send_command(PUBSUB_PUBLISH, topic, topic_length, payload, length);
+	}
+
+	Result<PubSubMessage, SocketReceiveError> PubSubClient::recv()
+	{
+		Result<usize, SocketReceiveError> size = m_state->m_stream.next_frame_size();
+
+		if (size.is_error())
+			return size.expect_error();
+
+		usize length = size.expect();
+
+		if (length < 2)
+			return SocketReceiveError{ NetErrorKind::INVALID_ARGUMENT };
+
+		_PubSubBuffer* buffer = allocate_buffer(PUBSUB_LENGTH_SIZE + length);
+		PubSubMessage message{ buffer };
+
+		Result<usize, SocketReceiveError> received = m_state->m_stream.recv_frame(buffer->data() + PUBSUB_LENGTH_SIZE, length);
+
+		if (received.is_error())
+			return received.expect_error();
+
+		u8* data = buffer->data();
+		_store_u32(data, static_cast<u32>(length));
+
+		if (data[PUBSUB_LENGTH_SIZE] == 0 || 1 + static_cast<usize>(data[PUBSUB_LENGTH_SIZE]) > length)
+			return SocketReceiveError{ NetErrorKind::INVALID_ARGUMENT };
+
+		return move(message);
+	}
+}
@@ -0,0 +1,1204 @@
+#include "Resp.hpp"
+#include "ConnServer.hpp"
+#include "StreamIo.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace bsl::net
+{
+	static constexpr usize RESP_READ_CHUNK = 64 << 10;
+	static constexpr usize RESP_MAX_COUNT = 0x7FFFFFFF;
+	static constexpr usize RESP_MAX_COMMAND_NAME = 16;
+
+	static bool parse_integer(const u8* text, usize length, i64& value) noexcept
+	{
+		if (length == 0)
+			return false;
+
+		bool negative = text[0] == '-';
+		usize i = negative || text[0] == '+' ? 1 : 0;
+
+		if (i == length)
+			return false;
+
+		u64 limit = negative ? static_cast<u64>(::std::numeric_limits<i64>::max()) + 1 : static_cast<u64>(::std::numeric_limits<i64>::max());
+		u64 result = 0;
+
+		for (; i < length; ++i)
+		{
+			u8 digit = static_cast<u8>(text[i] - '0');
+
+			if (digit > 9 || result > (limit - digit) / 10)
+				return false;
+
+			result = result * 10 + digit;
+		}
+
+		value = negative ? static_cast<i64>(0 - result) : static_cast<i64>(result);
+
+		return true;
+	}
+
+	static usize format_integer(i64 value, char* out) noexcept
+	{
+		char digits[20];
+		usize count = 0;
+
+		u64 magnitude = value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+
+		do
+		{
+			digits[count++] = static_cast<char>('0' + magnitude % 10);
+			magnitude /= 10;
+		} while (magnitude != 0);
+
+		usize length = 0;
+
+		if (value < 0)
+			out[length++] = '-';
+
+		while (count != 0)
+			out[length++] = digits[--count];
+
+		return length;
+	}
+
+	struct _RespEncoderState
+	{
+		::std::vector<u8> m_buffer;
+
+		void append(const void* data, usize length)
+		{
+			const u8* bytes = static_cast<const u8*>(data);
+			m_buffer.insert(m_buffer.end(), bytes, bytes + length);
+		}
+
+		void header(char marker, i64 value)
+		{
+			char line[24];
+			line[0] = marker;
+
+			usize length = 1 + format_integer(value, line + 1);
+			line[length++] = '\r';
+			line[length++] = '\n';
+
+			append(line, length);
+		}
+
+		void line(char marker, const char* text, usize length)
+		{
+			usize offset = m_buffer.size();
+			m_buffer.resize(offset + length + 3);
+
+			u8* out = m_buffer.data() + offset;
+			out[0] = static_cast<u8>(marker);
+
+			if (length != 0)
+				::std::memcpy(out + 1, text, length);
+
+			out[length + 1] = '\r';
+			out[length + 2] = '\n';
+		}
+
+		void bulk(const void* data, usize length)
+		{
+			header('$', static_cast<i64>(length));
+
+			usize offset = m_buffer.size();
+			m_buffer.resize(offset + length + 2);
+
+			u8* out = m_buffer.data() + offset;
+
+			if (length != 0)
+				::std::memcpy(out, data, length);
+
+			out[length] = '\r';
+			out[length + 1] = '\n';
+		}
+	};
+
+	RespEncoder::RespEncoder()
+		: m_state{ new _RespEncoderState{} }
+	{
+	}
+
+	RespEncoder::RespEncoder(RespEncoder&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	RespEncoder::~RespEncoder()
+	{
+		delete m_state;
+	}
+
+	const u8* RespEncoder::data() const noexcept
+	{
+		return m_state->m_buffer.data();
+	}
+
+	usize RespEncoder::size() const noexcept
+	{
+		return m_state->m_buffer.size();
+	}
+
+	void RespEncoder::clear() noexcept
+	{
+		m_state->m_buffer.clear();
+	}
+
+	void RespEncoder::simple_string(const char* text, usize length)
+	{
+		m_state->line('+', text, length);
+	}
+
+	void RespEncoder::error(const char* text, usize length)
+	{
+		m_state->line('-', text, length);
+	}
+
+	void RespEncoder::integer(i64 value)
+	{
+		m_state->header(':', value);
+	}
+
+	void RespEncoder::bulk_string(const u8* data, usize length)
+	{
+		m_state->bulk(data, length);
+	}
+
+	void RespEncoder::null(bool resp3)
+	{
+		if (resp3)
+			m_state->append("_\r\n", 3);
+		else
+			m_state->append("$-1\r\n", 5);
+	}
+
+	void RespEncoder::boolean(bool value)
+	{
+		m_state->append(value ? "#t\r\n" : "#f\r\n", 4);
+	}
+
+	void RespEncoder::double_value(f64 value)
+	{
+		char text[32];
+		usize length;
+
+		if (::std::isnan(value))
+			length = static_cast<usize>(::std::snprintf(text, sizeof(text), "nan"));
+		else if (::std::isinf(value))
+			length = static_cast<usize>(::std::snprintf(text, sizeof(text), value < 0 ? "-inf" : "inf"));
+		else
+			length = static_cast<usize>(::std::snprintf(text, sizeof(text), "%.17g", value));
+
+		m_state->line(',', text, length);
+	}
+
+	void RespEncoder::array(usize count)
+	{
+		m_state->header('*', static_cast<i64>(count));
+	}
+
+	void RespEncoder::map(usize count)
+	{
+		m_state->header('%', static_cast<i64>(count));
+	}
+
+	void RespEncoder::set(usize count)
+	{
+		m_state->header('~', static_cast<i64>(count));
+	}
+
+	void RespEncoder::push(usize count)
+	{
+		m_state->header('>', static_cast<i64>(count));
+	}
+
+	void RespEncoder::command(const RespArg* args, usize count)
+	{
+		m_state->header('*', static_cast<i64>(count));
+
+		for (usize i = 0; i < count; ++i)
+			m_state->bulk(args[i].data, args[i].length);
+	}
+
+	struct _RespFrame
+	{
+		u32 node;
+		u32 remaining;
+		bool attribute;
+	};
+
+	struct _RespParserState
+	{
+		::std::vector<RespNode> m_nodes;
+		::std::vector<_RespFrame> m_stack;
+
+		usize m_position;
+		bool m_complete;
+	};
+
+	RespParser::RespParser()
+		: m_state{ new _RespParserState{} }
+	{
+		m_state->m_position = 0;
+		m_state->m_complete = false;
+	}
+
+	RespParser::RespParser(RespParser&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	RespParser::~RespParser()
+	{
+		delete m_state;
+	}
+
+	void RespParser::reset() noexcept
+	{
+		m_state->m_nodes.clear();
+		m_state->m_stack.clear();
+		m_state->m_position = 0;
+		m_state->m_complete = false;
+	}
+
+	RespView RespParser::root(const u8* base) const noexcept
+	{
+		return RespView{ m_state->m_nodes.data(), base, 0 };
+	}
+
+	usize RespParser::node_count() const noexcept
+	{
+		return m_state->m_nodes.size();
+	}
+
+	Result<usize, RespError> RespParser::parse(const u8* in, usize length)
+	{
+		_RespParserState& state = *m_state;
+
+		if (state.m_complete)
+			reset();
+
+		for (;;)
+		{
+			usize position = state.m_position;
+
+			if (position >= length)
+				return usize{ 0 };
+
+			const u8* start = in + position;
+			const u8* newline = static_cast<const u8*>(::std::memchr(start, '\n', length - position));
+
+			if (newline == nullptr)
+				return usize{ 0 };
+
+			if (newline - start < 2 || newline[-1] != '\r')
+				return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+			const u8* text = start + 1;
+			usize text_length = static_cast<usize>(newline - 1 - text);
+			usize next = static_cast<usize>(newline - in) + 1;
+
+			RespNode node{};
+			node.offset = position + 1;
+			node.length = text_length;
+
+			usize children = 0;
+			bool aggregate = false;
+			bool attribute = false;
+
+			switch (*start)
+			{
+			case '+':
+				node.type = RespType::SIMPLE_STRING;
+				break;
+			case '-':
+				node.type = RespType::ERROR;
+				break;
+			case ',':
+				node.type = RespType::DOUBLE;
+				break;
+			case '(':
+				node.type = RespType::BIG_NUMBER;
+				break;
+			case ':':
+				node.type = RespType::INTEGER;
+
+				if (!parse_integer(text, text_length, node.integer))
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				break;
+			case '_':
+				node.type = RespType::NULL_VALUE;
+
+				if (text_length != 0)
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				break;
+			case '#':
+				node.type = RespType::BOOLEAN;
+
+				if (text_length != 1 || (text[0] != 't' && text[0] != 'f'))
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				node.integer = text[0] == 't' ? 1 : 0;
+				break;
+			case '$':
+			case '!':
+			case '=':
+			{
+				i64 size;
+
+				if (!parse_integer(text, text_length, size) || size < -1 || (size == -1 && *start != '$'))
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				if (size == -1)
+				{
+					node.type = RespType::NULL_VALUE;
+					node.length = 0;
+					break;
+				}
+
+				usize body = static_cast<usize>(size);
+
+				if (length - next < 2 || length - next - 2 < body)
+					return usize{ 0 };
+
+				if (in[next + body] != '\r' || in[next + body + 1] != '\n')
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				node.type = *start == '$' ? RespType::BULK_STRING : *start == '!' ? RespType::BULK_ERROR : RespType::VERBATIM_STRING;
+				node.offset = next;
+				node.length = body;
+
+				if (node.type == RespType::VERBATIM_STRING)
+				{
+					if (body < 4 || in[next + 3] != ':')
+						return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+					node.offset += 4;
+					node.length -= 4;
+				}
+
+				next += body + 2;
+				break;
+			}
+			case '*':
+			case '~':
+			case '>':
+			case '%':
+			case '|':
+			{
+				i64 count;
+
+				if (!parse_integer(text, text_length, count) || count < -1 || (count == -1 && *start != '*'))
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				if (count == -1)
+				{
+					node.type = RespType::NULL_VALUE;
+					node.length = 0;
+					break;
+				}
+
+				bool paired = *start == '%' || *start == '|';
+
+				if (static_cast<u64>(count) > (paired ? RESP_MAX_COUNT / 2 : RESP_MAX_COUNT))
+					return RespError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+				children = static_cast<usize>(count) * (paired ? 2 : 1);
+				aggregate = true;
+				attribute = *start == '|';
+
+				node.type = *start == '*' ? RespType::ARRAY : *start == '~' ? RespType::SET : *start == '>' ? RespType::PUSH : RespType::MAP;
+				node.length = 0;
+				break;
+			}
+			default:
+				return RespError{ NetErrorKind::INVALID_ARGUMENT };
+			}
+
+			state.m_position = next;
+
+			if (attribute)
+			{
+				if (children == 0)
+					continue;
+
+				if (state.m_stack.size() >= MAX_DEPTH)
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				state.m_stack.push_back(_RespFrame{ static_cast<u32>(state.m_nodes.size()), static_cast<u32>(children), true });
+				continue;
+			}
+
+			u32 index = static_cast<u32>(state.m_nodes.size());
+
+			node.end = index + 1;
+			node.count = static_cast<u32>(children);
+			state.m_nodes.push_back(node);
+
+			if (aggregate && children != 0)
+			{
+				if (state.m_stack.size() >= MAX_DEPTH)
+					return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+				state.m_stack.push_back(_RespFrame{ index, static_cast<u32>(children), false });
+				continue;
+			}
+
+			while (!state.m_stack.empty())
+			{
+				_RespFrame& frame = state.m_stack.back();
+
+				if (--frame.remaining != 0)
+					break;
+
+				if (frame.attribute)
+				{
+					state.m_nodes.resize(frame.node);
+					state.m_stack.pop_back();
+					break;
+				}
+
+				state.m_nodes[frame.node].end = static_cast<u32>(state.m_nodes.size());
+				state.m_stack.pop_back();
+			}
+
+			if (state.m_stack.empty() && !state.m_nodes.empty())
+			{
+				state.m_complete = true;
+				return usize{ state.m_position };
+			}
+		}
+	}
+
+	static Result<Unit, RespError> send_buffer(Socket& sock, const u8* data, usize length)
+	{
+		IoSlice slice{ data, length };
+
+		Result<Unit, SocketSendError> result = _write_slices(sock, &slice, 1);
+
+		if (result.is_error())
+		{
+			SocketSendError error = result.expect_error();
+			return RespError{ error.kind(), error.native_code() };
+		}
+
+		return Unit{};
+	}
+
+	static Result<usize, RespError> recv_into(Socket& sock, ::std::vector<u8>& buffer, usize& begin, usize& end, usize limit)
+	{
+		if (begin == end)
+		{
+			begin = 0;
+			end = 0;
+		}
+
+		if (end == buffer.size())
+		{
+			if (begin != 0)
+			{
+				::std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+
+				end -= begin;
+				begin = 0;
+			}
+			else
+			{
+				if (buffer.size() >= limit)
+					return RespError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+				buffer.resize(::std::min(buffer.size() * 2, limit));
+			}
+		}
+
+		Result<usize, SocketReceiveError> result = sock.recv(buffer.data() + end, buffer.size() - end);
+
+		if (result.is_error())
+		{
+			SocketReceiveError error = result.expect_error();
+			return RespError{ error.kind(), error.native_code() };
+		}
+
+		usize received = result.expect();
+
+		if (received == 0)
+			return RespError{ NetErrorKind::CLOSED };
+
+		end += received;
+
+		return received;
+	}
+
+	struct _RespClientState
+	{
+		RespClientConfig m_config;
+
+		RespEncoder m_tx;
+		RespParser m_parser;
+
+		::std::vector<u8> m_rx;
+		usize m_begin;
+		usize m_end;
+		usize m_last;
+
+		usize m_queued;
+		usize m_pending;
+
+		explicit _RespClientState(const RespClientConfig& config)
+			: m_config{ config }, m_rx(RESP_READ_CHUNK), m_begin{ 0 }, m_end{ 0 }, m_last{ 0 }, m_queued{ 0 }, m_pending{ 0 }
+		{
+		}
+	};
+
+	RespClient::RespClient(Socket& sock, const RespClientConfig& config)
+		: m_sock{ &sock }, m_state{ new _RespClientState{ config } }
+	{
+		m_sock->set_nodelay(true).discard();
+	}
+
+	RespClient::RespClient(RespClient&& other) noexcept
+		: m_sock{ other.m_sock }, m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	RespClient::~RespClient()
+	{
+		delete m_state;
+	}
+
+	void RespClient::command_list(const RespArg* args, usize count)
+	{
+		m_state->m_tx.command(args, count);
+		++m_state->m_queued;
+	}
+
+	usize RespClient::queued() const noexcept
+	{
+		return m_state->m_queued;
+	}
+
+	usize RespClient::pending() const noexcept
+	{
+		return m_state->m_pending;
+	}
+
+	Result<Unit, RespError> RespClient::flush()
+	{
+		_RespClientState& state = *m_state;
+
+		if (state.m_queued == 0)
+			return Unit{};
+
+		Result<Unit, RespError> result = send_buffer(*m_sock, state.m_tx.data(), state.m_tx.size());
+
+		state.m_tx.clear();
+		state.m_pending += state.m_queued;
+		state.m_queued = 0;
+
+		if (result.is_error())
+			return result.expect_error();
+
+		return Unit{};
+	}
+
+	Result<RespView, RespError> RespClient::next_reply()
+	{
+		_RespClientState& state = *m_state;
+
+		if (state.m_queued != 0)
+		{
+			Result<Unit, RespError> flushed = flush();
+
+			if (flushed.is_error())
+				return flushed.expect_error();
+		}
+
+		if (state.m_pending == 0)
+			return RespError{ NetErrorKind::INVALID_ARGUMENT };
+
+		state.m_begin += state.m_last;
+		state.m_last = 0;
+
+		for (;;)
+		{
+			Result<usize, RespError> parsed = state.m_parser.parse(state.m_rx.data() + state.m_begin, state.m_end - state.m_begin);
+
+			if (parsed.is_error())
+				return parsed.expect_error();
+
+			usize size = parsed.expect();
+
+			if (size != 0)
+			{
+				RespView reply = state.m_parser.root(state.m_rx.data() + state.m_begin);
+
+				if (reply.type() == RespType::PUSH)
+				{
+					state.m_begin += size;
+					continue;
+				}
+
+				state.m_last = size;
+				--state.m_pending;
+
+				return reply;
+			}
+
+			Result<usize, RespError> received = recv_into(*m_sock, state.m_rx, state.m_begin, state.m_end, state.m_config.max_reply);
+
+			if (received.is_error())
+				return received.expect_error();
+		}
+	}
+
+	struct _KeyHash
+	{
+		using is_transparent = void;
+
+		[[nodiscard]] usize operator()(::std::string_view key) const noexcept
+		{
+			return ::std::hash<::std::string_view>{}(key);
+		}
+	};
+
+	struct _RespConnection : _ServerConn
+	{
+		::std::mutex m_mutex;
+		::std::condition_variable m_cv;
+		::std::condition_variable m_drained;
+		::std::vector<u8> m_out;
+		bool m_closed;
+
+		::std::thread m_writer;
+
+		explicit _RespConnection(Socket&& sock)
+			: _ServerConn{ move(sock) }, m_closed{ false }
+		{
+		}
+
+		[[nodiscard]] bool is_finished() const noexcept
+		{
+			return m_done.load(::std::memory_order_acquire);
+		}
+	};
+
+	struct _RespServerState
+	{
+		RespServerConfig m_config;
+
+		::std::shared_mutex m_store_mutex;
+		::std::unordered_map<::std::string, ::std::string, _KeyHash, ::std::equal_to<>> m_store;
+
+		_ConnServer<_RespConnection> m_server;
+
+		::std::atomic<u64> m_commands;
+		::std::atomic<u64> m_batches;
+		::std::atomic<u64> m_bytes_received;
+		::std::atomic<u64> m_bytes_sent;
+	};
+
+	static void reply_error(RespEncoder& out, const char* text)
+	{
+		out.error(text, ::std::strlen(text));
+	}
+
+	static void reply_ok(RespEncoder& out)
+	{
+		out.simple_string("OK", 2);
+	}
+
+	static void reply_bulk(RespEncoder& out, ::std::string_view text)
+	{
+		out.bulk_string(reinterpret_cast<const u8*>(text.data()), text.size());
+	}
+
+	static void incr_by(_RespServerState& state, RespEncoder& out, ::std::string_view key, i64 delta)
+	{
+		::std::unique_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+		auto it = state.m_store.find(key);
+
+		i64 value = 0;
+
+		if (it != state.m_store.end() && !parse_integer(reinterpret_cast<const u8*>(it->second.data()), it->second.size(), value))
+		{
+			reply_error(out, "ERR value is not an integer or out of range");
+			return;
+		}
+
+		if ((delta > 0 && value > ::std::numeric_limits<i64>::max() - delta) || (delta < 0 && value < ::std::numeric_limits<i64>::min() - delta))
+		{
+			reply_error(out, "ERR increment or decrement would overflow");
+			return;
+		}
+
+		value += delta;
+
+		char text[24];
+		usize length = format_integer(value, text);
+
+		if (it != state.m_store.end())
+			it->second.assign(text, length);
+		else
+			state.m_store.emplace(::std::string{ key }, ::std::string{ text, length });
+
+		out.integer(value);
+	}
+
+	static void execute(_RespServerState& state, const ::std::vector<::std::string_view>& args, RespEncoder& out, bool& resp3)
+	{
+		usize argc = args.size();
+
+		if (args[0].size() > RESP_MAX_COMMAND_NAME)
+		{
+			reply_error(out, "ERR unknown command");
+			return;
+		}
+
+		char name[RESP_MAX_COMMAND_NAME];
+
+		for (usize i = 0; i < args[0].size(); ++i)
+		{
+			char c = args[0][i];
+			name[i] = c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+		}
+
+		::std::string_view verb{ name, args[0].size() };
+
+		if (verb == "GET" && argc == 2)
+		{
+			::std::shared_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+			auto it = state.m_store.find(args[1]);
+
+			if (it == state.m_store.end())
+				out.null(resp3);
+			else
+				reply_bulk(out, it->second);
+		}
+		else if (verb == "SET" && argc == 3)
+		{
+			{
+				::std::unique_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+				auto it = state.m_store.find(args[1]);
+
+				if (it != state.m_store.end())
+					it->second.assign(args[2]);
+				else
+					state.m_store.emplace(::std::string{ args[1] }, ::std::string{ args[2] });
+			}
+
+			reply_ok(out);
+		}
+		else if (verb == "MGET" && argc >= 2)
+		{
+			out.array(argc - 1);
+
+			::std::shared_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+			for (usize i = 1; i < argc; ++i)
+			{
+				auto it = state.m_store.find(args[i]);
+
+				if (it == state.m_store.end())
+					out.null(resp3);
+				else
+					reply_bulk(out, it->second);
+			}
+		}
+		else if (verb == "MSET" && argc >= 3 && argc % 2 == 1)
+		{
+			{
+				::std::unique_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+				for (usize i = 1; i < argc; i += 2)
+				{
+					auto it = state.m_store.find(args[i]);
+
+					if (it != state.m_store.end())
+						it->second.assign(args[i + 1]);
+					else
+						state.m_store.emplace(::std::string{ args[i] }, ::std::string{ args[i + 1] });
+				}
+			}
+
+			reply_ok(out);
+		}
+		else if (verb == "DEL" && argc >= 2)
+		{
+			i64 count = 0;
+
+			{
+				::std::unique_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+				for (usize i = 1; i < argc; ++i)
+				{
+					auto it = state.m_store.find(args[i]);
+
+					if (it != state.m_store.end())
+					{
+						state.m_store.erase(it);
+						++count;
+					}
+				}
+			}
+
+			out.integer(count);
+		}
+		else if (verb == "EXISTS" && argc >= 2)
+		{
+			i64 count = 0;
+
+			{
+				::std::shared_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+				for (usize i = 1; i < argc; ++i)
+					count += state.m_store.find(args[i]) != state.m_store.end() ? 1 : 0;
+			}
+
+			out.integer(count);
+		}
+		else if ((verb == "INCR" || verb == "DECR") && argc == 2)
+		{
+			incr_by(state, out, args[1], verb == "INCR" ? 1 : -1);
+		}
+		else if ((verb == "INCRBY" || verb == "DECRBY") && argc == 3)
+		{
+			i64 delta;
+
+			if (!parse_integer(reinterpret_cast<const u8*>(args[2].data()), args[2].size(), delta) || (verb == "DECRBY" && delta == ::std::numeric_limits<i64>::min()))
+			{
+				reply_error(out, "ERR value is not an integer or out of range");
+				return;
+			}
+
+			incr_by(state, out, args[1], verb == "INCRBY" ? delta : -delta);
+		}
+		else if (verb == "DBSIZE" && argc == 1)
+		{
+			::std::shared_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+			out.integer(static_cast<i64>(state.m_store.size()));
+		}
+		else if (verb == "FLUSHALL" && argc == 1)
+		{
+			{
+				::std::unique_lock<::std::shared_mutex> lock{ state.m_store_mutex };
+
+				state.m_store.clear();
+			}
+
+			reply_ok(out);
+		}
+		else if (verb == "PING" && argc <= 2)
+		{
+			if (argc == 2)
+				reply_bulk(out, args[1]);
+			else
+				out.simple_string("PONG", 4);
+		}
+		else if (verb == "ECHO" && argc == 2)
+		{
+			reply_bulk(out, args[1]);
+		}
+		else if (verb == "HELLO" && argc <= 2)
+		{
+			if (argc == 2)
+			{
+				if (args[1] == "3")
+					resp3 = true;
+				else if (args[1] == "2")
+					resp3 = false;
+				else
+				{
+					reply_error(out, "NOPROTO unsupported protocol version");
+					return;
+				}
+			}
+
+			if (resp3)
+				out.map(3);
+			else
+				out.array(6);
+
+			reply_bulk(out, "server");
+			reply_bulk(out, "bsl");
+			reply_bulk(out, "proto");
+			out.integer(resp3 ? 3 : 2);
+			reply_bulk(out, "mode");
+			reply_bulk(out, "standalone");
+		}
+		else
+		{
+			reply_error(out, "ERR unknown command or wrong number of arguments");
+		}
+	}
+
+	static bool gather_args(const RespView& request, ::std::vector<::std::string_view>& args)
+	{
+		args.clear();
+
+		if (request.type() != RespType::ARRAY || request.size() == 0)
+			return false;
+
+		RespView arg = request.first_child();
+
+		for (usize i = 0; i < request.size(); ++i, arg = arg.next_sibling())
+		{
+			if (arg.type() != RespType::BULK_STRING)
+				return false;
+
+			args.emplace_back(arg.data(), arg.length());
+		}
+
+		return true;
+	}
+
+	static void resp_write_loop(_RespServerState& state, _RespConnection& conn)
+	{
+		::std::vector<u8> batch;
+
+		for (;;)
+		{
+			{
+				::std::unique_lock<::std::mutex> lock{ conn.m_mutex };
+
+				conn.m_cv.wait(lock, [&conn] { return !conn.m_out.empty() || conn.m_closed; });
+
+				if (conn.m_out.empty())
+					return;
+
+				batch.swap(conn.m_out);
+			}
+
+			conn.m_drained.notify_one();
+
+			if (send_buffer(conn.m_sock, batch.data(), batch.size()).is_error())
+			{
+				{
+					::std::lock_guard<::std::mutex> lock{ conn.m_mutex };
+
+					conn.m_closed = true;
+				}
+
+				conn.m_drained.notify_one();
+				conn.m_sock.shutdown().discard();
+				return;
+			}
+
+			state.m_batches.fetch_add(1, ::std::memory_order_relaxed);
+			state.m_bytes_sent.fetch_add(batch.size(), ::std::memory_order_relaxed);
+
+			batch.clear();
+		}
+	}
+
+	static bool wait_drained(_RespServerState& state, _RespConnection& conn, ::std::unique_lock<::std::mutex>& lock)
+	{
+		conn.m_drained.wait(lock, [&] { return conn.m_out.size() < state.m_config.max_output || conn.m_closed; });
+
+		return !conn.m_closed;
+	}
+
+	static bool hand_off(_RespServerState& state, _RespConnection& conn, RespEncoder& out)
+	{
+		{
+			::std::unique_lock<::std::mutex> lock{ conn.m_mutex };
+
+			if (!wait_drained(state, conn, lock))
+				return false;
+
+			conn.m_out.insert(conn.m_out.end(), out.data(), out.data() + out.size());
+		}
+
+		conn.m_cv.notify_one();
+		out.clear();
+
+		return true;
+	}
+
+	static void resp_read_loop(_RespServerState& state, _RespConnection& conn)
+	{
+		::std::vector<u8> rx(RESP_READ_CHUNK);
+		usize begin = 0;
+		usize end = 0;
+
+		RespParser parser;
+		RespEncoder out;
+		bool resp3 = false;
+
+		::std::vector<::std::string_view> args;
+
+		for (;;)
+		{
+			{
+				::std::unique_lock<::std::mutex> lock{ conn.m_mutex };
+
+				if (!wait_drained(state, conn, lock))
+					break;
+			}
+
+			Result<usize, RespError> received = recv_into(conn.m_sock, rx, begin, end, state.m_config.max_request);
+
+			if (received.is_error())
+				break;
+
+			state.m_bytes_received.fetch_add(received.expect(), ::std::memory_order_relaxed);
+
+			bool failed = false;
+			usize commands = 0;
+
+			for (;;)
+			{
+				Result<usize, RespError> parsed = parser.parse(rx.data() + begin, end - begin);
+
+				if (parsed.is_error())
+				{
+					reply_error(out, "ERR Protocol error");
+					failed = true;
+					break;
+				}
+
+				usize size = parsed.expect();
+
+				if (size == 0)
+					break;
+
+				if (!gather_args(parser.root(rx.data() + begin), args))
+				{
+					reply_error(out, "ERR Protocol error: expected array of bulk strings");
+					failed = true;
+					break;
+				}
+
+				execute(state, args, out, resp3);
+
+				begin += size;
+				++commands;
+
+				if (out.size() >= state.m_config.max_output && !hand_off(state, conn, out))
+				{
+					failed = true;
+					break;
+				}
+			}
+
+			state.m_commands.fetch_add(commands, ::std::memory_order_relaxed);
+
+			if (out.size() != 0 && !hand_off(state, conn, out))
+				failed = true;
+
+			if (failed)
+				break;
+		}
+
+		{
+			::std::lock_guard<::std::mutex> lock{ conn.m_mutex };
+
+			conn.m_closed = true;
+		}
+
+		conn.m_cv.notify_one();
+		conn.m_writer.join();
+
+		conn.m_done.store(true, ::std::memory_order_release);
+	}
+
+	RespServer::RespServer(const RespServerConfig& config)
+		: m_state{ new _RespServerState{} }
+	{
+		m_state->m_config = config;
+
+		if (m_state->m_config.max_request < RESP_READ_CHUNK)
+			m_state->m_config.max_request = RESP_READ_CHUNK;
+
+		if (m_state->m_config.max_output < RESP_READ_CHUNK)
+			m_state->m_config.max_output = RESP_READ_CHUNK;
+	}
+
+	RespServer::RespServer(RespServer&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	RespServer::~RespServer()
+	{
+		if (m_state == nullptr)
+			return;
+
+		shutdown();
+
+		delete m_state;
+	}
+
+	void RespServer::serve(Socket&& sock)
+	{
+		_RespServerState& state = *m_state;
+
+		state.m_server.serve(new _RespConnection{ move(sock) }, [&state](_RespConnection& conn) {
+			conn.m_writer = ::std::thread{ resp_write_loop, ::std::ref(state), ::std::ref(conn) };
+			conn.m_reader = ::std::thread{ resp_read_loop, ::std::ref(state), ::std::ref(conn) };
+		});
+	}
+
+	Result<Unit, SocketAcceptError> RespServer::run(TCPServer& server)
+	{
+		return m_state->m_server.run(server, [this](Socket&& sock) { serve(move(sock)); });
+	}
+
+	usize RespServer::connections() const noexcept
+	{
+		return m_state->m_server.active();
+	}
+
+	usize RespServer::keys() const noexcept
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ m_state->m_store_mutex };
+
+		return m_state->m_store.size();
+	}
+
+	RespServerStats RespServer::stats() const noexcept
+	{
+		RespServerStats stats{};
+		stats.commands = m_state->m_commands.load(::std::memory_order_relaxed);
+		stats.batches = m_state->m_batches.load(::std::memory_order_relaxed);
+		stats.bytes_received = m_state->m_bytes_received.load(::std::memory_order_relaxed);
+		stats.bytes_sent = m_state->m_bytes_sent.load(::std::memory_order_relaxed);
+
+		return stats;
+	}
+
+	void RespServer::shutdown()
+	{
+		::std::vector<_RespConnection*> connections = m_state->m_server.stop();
+
+		for (_RespConnection* conn : connections)
+			conn->m_sock.shutdown().discard();
+
+		_ConnServer<_RespConnection>::join(connections);
+	}
+}
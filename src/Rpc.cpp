@@ -0,0 +1,756 @@
+#include "Rpc.hpp"
+#include "ConnServer.hpp"
+#include "Framed.hpp"
+#include "StreamIo.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace bsl::net
+{
+	static constexpr usize RPC_LENGTH_SIZE = 4;
+	static constexpr usize RPC_REQUEST_PREFIX = 8;
+	static constexpr usize RPC_REPLY_PREFIX = 5;
+
+	struct _RpcWrite
+	{
+		IoSlice m_slices[2];
+
+		bool m_done;
+		bool m_ok;
+		NetErrorKind m_error;
+	};
+
+	struct _RpcWriter
+	{
+		Socket* m_sock;
+
+		::std::mutex m_mutex;
+		::std::condition_variable m_written;
+
+		::std::vector<_RpcWrite*> m_pending;
+		::std::vector<_RpcWrite*> m_batch;
+		::std::vector<IoSlice> m_slices;
+
+		bool m_flushing;
+		bool m_failed;
+		NetErrorKind m_error;
+
+		::std::atomic<u64> m_frames;
+		::std::atomic<u64> m_batches;
+	};
+
+	static bool rpc_write(_RpcWriter& writer, _RpcWrite& write)
+	{
+		::std::unique_lock<::std::mutex> lock{ writer.m_mutex };
+
+		if (writer.m_failed)
+		{
+			write.m_error = writer.m_error;
+			return false;
+		}
+
+		writer.m_pending.push_back(&write);
+		writer.m_written.wait(lock, [&] { return write.m_done || !writer.m_flushing; });
+
+		if (write.m_done)
+			return write.m_ok;
+
+		writer.m_flushing = true;
+		writer.m_batch.swap(writer.m_pending);
+
+		bool ok = !writer.m_failed;
+		NetErrorKind error = writer.m_error;
+
+		if (ok)
+		{
+			lock.unlock();
+
+			writer.m_slices.clear();
+
+			for (_RpcWrite* entry : writer.m_batch)
+				for (const IoSlice& slice : entry->m_slices)
+					if (slice.length != 0)
+						writer.m_slices.push_back(slice);
+
+			Result<Unit, SocketSendError> written = _write_slices(*writer.m_sock, writer.m_slices.data(), writer.m_slices.size());
+
+			ok = written.is_ok();
+
+			if (!ok)
+				error = written.expect_error().kind();
+
+			writer.m_frames.fetch_add(writer.m_batch.size(), ::std::memory_order_relaxed);
+			writer.m_batches.fetch_add(1, ::std::memory_order_relaxed);
+
+			lock.lock();
+
+			if (!ok)
+			{
+				writer.m_failed = true;
+				writer.m_error = error;
+			}
+		}
+
+		for (_RpcWrite* entry : writer.m_batch)
+		{
+			entry->m_done = true;
+			entry->m_ok = ok;
+			entry->m_error = error;
+		}
+
+		writer.m_batch.clear();
+		writer.m_flushing = false;
+		writer.m_written.notify_all();
+
+		return write.m_ok;
+	}
+
+	struct _RpcCallState
+	{
+		::std::atomic<u32> m_refs;
+		::std::atomic<u32> m_ready;
+
+		RpcStatus m_status;
+		NetErrorKind m_kind;
+
+		::std::vector<u8> m_reply;
+	};
+
+	static void release_call(_RpcCallState* call) noexcept
+	{
+		if (call->m_refs.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
+			delete call;
+	}
+
+	static void complete_call(_RpcCallState* call, RpcStatus status, NetErrorKind kind) noexcept
+	{
+		call->m_status = status;
+		call->m_kind = kind;
+
+		call->m_ready.store(1, ::std::memory_order_release);
+		call->m_ready.notify_all();
+
+		release_call(call);
+	}
+
+	struct _RpcClientState
+	{
+		Socket m_sock;
+		FramedStream m_stream;
+		_RpcWriter m_writer;
+
+		::std::mutex m_mutex;
+		::std::unordered_map<u32, _RpcCallState*> m_pending;
+
+		bool m_closed;
+		NetErrorKind m_close_kind;
+
+		::std::atomic<u32> m_next_id;
+		::std::atomic<bool> m_closing;
+
+		::std::atomic<u64> m_calls;
+		::std::atomic<u64> m_replies;
+
+		::std::thread m_reader;
+
+		_RpcClientState(Socket&& sock, const RpcClientConfig& config)
+			: m_sock{ move(sock) }, m_stream{ m_sock, FrameConfig{ config.max_reply + RPC_REPLY_PREFIX } }, m_writer{},
+			m_closed{ false }, m_close_kind{ NetErrorKind::UNKNOWN }, m_next_id{ 0 }, m_closing{ false }, m_calls{ 0 }, m_replies{ 0 }
+		{
+			m_writer.m_sock = &m_sock;
+		}
+	};
+
+	static void fail_pending(_RpcClientState& state, NetErrorKind kind)
+	{
+		::std::unordered_map<u32, _RpcCallState*> pending;
+
+		{
+			::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+			state.m_closed = true;
+			state.m_close_kind = kind;
+
+			pending.swap(state.m_pending);
+		}
+
+		for (const auto& [id, call] : pending)
+			complete_call(call, RpcStatus::CONNECTION_LOST, kind);
+	}
+
+	static void client_read_loop(_RpcClientState& state)
+	{
+		::std::vector<u8> frame;
+		NetErrorKind kind = NetErrorKind::CLOSED;
+
+		for (;;)
+		{
+			Result<usize, SocketReceiveError> size = state.m_stream.next_frame_size();
+
+			if (size.is_error())
+			{
+				kind = size.expect_error().kind();
+				break;
+			}
+
+			frame.resize(size.expect());
+
+			Result<usize, SocketReceiveError> received = state.m_stream.recv_frame(frame.data(), frame.size());
+
+			if (received.is_error())
+			{
+				kind = received.expect_error().kind();
+				break;
+			}
+
+			usize length = received.expect();
+
+			if (length < RPC_REPLY_PREFIX || frame[4] > static_cast<u8>(RpcStatus::CONNECTION_LOST))
+			{
+				kind = NetErrorKind::INVALID_ARGUMENT;
+				break;
+			}
+
+			u32 id = _load_u32(frame.data());
+			_RpcCallState* call = nullptr;
+
+			{
+				::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+				auto it = state.m_pending.find(id);
+
+				if (it != state.m_pending.end())
+				{
+					call = it->second;
+					state.m_pending.erase(it);
+				}
+			}
+
+			if (call == nullptr)
+				continue;
+
+			call->m_reply.assign(frame.data() + RPC_REPLY_PREFIX, frame.data() + length);
+			state.m_replies.fetch_add(1, ::std::memory_order_relaxed);
+
+			complete_call(call, static_cast<RpcStatus>(frame[4]), NetErrorKind::UNKNOWN);
+		}
+
+		fail_pending(state, kind);
+	}
+
+	RpcPendingCall::RpcPendingCall(_RpcCallState* call) noexcept
+		: m_call{ call }
+	{
+	}
+
+	RpcPendingCall::RpcPendingCall(RpcPendingCall&& other) noexcept
+		: m_call{ other.m_call }
+	{
+		other.m_call = nullptr;
+	}
+
+	RpcPendingCall::~RpcPendingCall()
+	{
+		if (m_call != nullptr)
+			release_call(m_call);
+	}
+
+	bool RpcPendingCall::is_ready() const noexcept
+	{
+		return m_call->m_ready.load(::std::memory_order_acquire) != 0;
+	}
+
+	RpcStatus RpcPendingCall::wait()
+	{
+		while (m_call->m_ready.load(::std::memory_order_acquire) == 0)
+			m_call->m_ready.wait(0, ::std::memory_order_acquire);
+
+		return m_call->m_status;
+	}
+
+	NetErrorKind RpcPendingCall::kind() const noexcept
+	{
+		return m_call->m_kind;
+	}
+
+	const u8* RpcPendingCall::payload() const noexcept
+	{
+		return m_call->m_reply.data();
+	}
+
+	usize RpcPendingCall::payload_size() const noexcept
+	{
+		return m_call->m_reply.size();
+	}
+
+	RpcClient::RpcClient(Socket&& sock, const RpcClientConfig& config)
+		: m_state{ new _RpcClientState{ move(sock), config } }
+	{
+		m_state->m_sock.set_nodelay(true).discard();
+		m_state->m_reader = ::std::thread{ client_read_loop, ::std::ref(*m_state) };
+	}
+
+	RpcClient::RpcClient(RpcClient&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	RpcClient::~RpcClient()
+	{
+		if (m_state == nullptr)
+			return;
+
+		close();
+
+		delete m_state;
+	}
+
+	RpcPendingCall RpcClient::start(u32 method, const u8* args, usize length)
+	{
+		_RpcClientState& state = *m_state;
+
+		_RpcCallState* call = new _RpcCallState{};
+		call->m_refs.store(2, ::std::memory_order_relaxed);
+
+		u32 id = state.m_next_id.fetch_add(1, ::std::memory_order_relaxed);
+
+		{
+			::std::unique_lock<::std::mutex> lock{ state.m_mutex };
+
+			if (state.m_closed)
+			{
+				NetErrorKind kind = state.m_close_kind;
+				lock.unlock();
+
+				complete_call(call, RpcStatus::CONNECTION_LOST, kind);
+
+				return RpcPendingCall{ call };
+			}
+
+			state.m_pending.emplace(id, call);
+		}
+
+		state.m_calls.fetch_add(1, ::std::memory_order_relaxed);
+
+		u8 header[RPC_LENGTH_SIZE + RPC_REQUEST_PREFIX];
+		_store_u32(header, static_cast<u32>(RPC_REQUEST_PREFIX + length));
+		_store_u32(header + 4, id);
+		_store_u32(header + 8, method);
+
+		_RpcWrite write{};
+		write.m_slices[0] = IoSlice{ header, sizeof(header) };
+		write.m_slices[1] = IoSlice{ args, length };
+
+		if (!rpc_write(state.m_writer, write))
+		{
+			_RpcCallState* failed = nullptr;
+
+			{
+				::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+				auto it = state.m_pending.find(id);
+
+				if (it != state.m_pending.end())
+				{
+					failed = it->second;
+					state.m_pending.erase(it);
+				}
+			}
+
+			if (failed != nullptr)
+				complete_call(failed, RpcStatus::CONNECTION_LOST, write.m_error);
+		}
+
+		return RpcPendingCall{ call };
+	}
+
+	bool RpcClient::is_connected() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		return !m_state->m_closed;
+	}
+
+	usize RpcClient::in_flight() const noexcept
+	{
+		::std::lock_guard<::std::mutex> lock{ m_state->m_mutex };
+
+		return m_state->m_pending.size();
+	}
+
+	RpcStats RpcClient::stats() const noexcept
+	{
+		RpcStats stats{};
+		stats.calls = m_state->m_calls.load(::std::memory_order_relaxed);
+		stats.replies = m_state->m_replies.load(::std::memory_order_relaxed);
+		stats.frames_written = m_state->m_writer.m_frames.load(::std::memory_order_relaxed);
+		stats.batches_written = m_state->m_writer.m_batches.load(::std::memory_order_relaxed);
+
+		return stats;
+	}
+
+	void RpcClient::close()
+	{
+		if (m_state->m_closing.exchange(true))
+			return;
+
+		m_state->m_sock.shutdown().discard();
+
+		if (m_state->m_reader.joinable())
+			m_state->m_reader.join();
+	}
+
+	struct _RpcHandler
+	{
+		u32 m_method;
+		usize m_reply_capacity;
+
+		void* m_handler;
+		_RpcInvokeFn m_invoke;
+		_RpcDestroyFn m_destroy;
+	};
+
+	struct _RpcConnection : _ServerConn
+	{
+		FramedStream m_stream;
+		_RpcWriter m_writer;
+
+		::std::mutex m_mutex;
+		::std::condition_variable m_drained;
+		bool m_stopped;
+
+		::std::atomic<u32> m_tasks;
+
+		_RpcConnection(Socket&& sock, const RpcServerConfig& config)
+			: _ServerConn{ move(sock) }, m_stream{ m_sock, FrameConfig{ config.max_request + RPC_REQUEST_PREFIX } }, m_writer{}, m_stopped{ false }, m_tasks{ 0 }
+		{
+			m_writer.m_sock = &m_sock;
+		}
+
+		[[nodiscard]] bool is_finished() const noexcept
+		{
+			return m_done.load(::std::memory_order_acquire) && m_tasks.load(::std::memory_order_acquire) == 0;
+		}
+	};
+
+	struct _RpcTask
+	{
+		_RpcConnection* m_conn;
+		const _RpcHandler* m_handler;
+		u32 m_id;
+
+		::std::vector<u8> m_args;
+	};
+
+	struct _RpcServerState
+	{
+		RpcServerConfig m_config;
+
+		::std::shared_mutex m_handlers_mutex;
+		::std::vector<_RpcHandler*> m_handlers;
+		::std::vector<_RpcHandler*> m_retired;
+
+		::std::mutex m_mutex;
+		::std::condition_variable m_work;
+		::std::deque<_RpcTask> m_queue;
+
+		_ConnServer<_RpcConnection> m_server;
+		::std::vector<::std::thread> m_workers;
+
+		bool m_stopping;
+
+		::std::atomic<u64> m_calls;
+		::std::atomic<u64> m_replies;
+	};
+
+	static const _RpcHandler* find_handler(_RpcServerState& state, u32 method) noexcept
+	{
+		::std::shared_lock<::std::shared_mutex> lock{ state.m_handlers_mutex };
+
+		auto it = ::std::lower_bound(state.m_handlers.begin(), state.m_handlers.end(), method, [](const _RpcHandler* handler, u32 value) {
+			return handler->m_method < value;
+		});
+
+		if (it == state.m_handlers.end() || (*it)->m_method != method)
+			return nullptr;
+
+		return *it;
+	}
+
+	static void finish_task(_RpcServerState& state, _RpcConnection& conn)
+	{
+		if (conn.m_tasks.fetch_sub(1, ::std::memory_order_release) != state.m_config.max_in_flight)
+			return;
+
+		::std::lock_guard<::std::mutex> lock{ conn.m_mutex };
+
+		conn.m_drained.notify_one();
+	}
+
+	static void send_reply(_RpcServerState& state, _RpcConnection& conn, u32 id, RpcStatus status, const u8* payload, usize length)
+	{
+		u8 header[RPC_LENGTH_SIZE + RPC_REPLY_PREFIX];
+		_store_u32(header, static_cast<u32>(RPC_REPLY_PREFIX + length));
+		_store_u32(header + 4, id);
+		header[8] = static_cast<u8>(status);
+
+		_RpcWrite write{};
+		write.m_slices[0] = IoSlice{ header, sizeof(header) };
+		write.m_slices[1] = IoSlice{ payload, length };
+
+		if (rpc_write(conn.m_writer, write))
+			state.m_replies.fetch_add(1, ::std::memory_order_relaxed);
+	}
+
+	static void server_read_loop(_RpcServerState& state, _RpcConnection& conn)
+	{
+		::std::vector<u8> frame;
+
+		usize max_in_flight = state.m_config.max_in_flight;
+
+		for (;;)
+		{
+			{
+				::std::unique_lock<::std::mutex> lock{ conn.m_mutex };
+
+				conn.m_drained.wait(lock, [&] { return conn.m_stopped || conn.m_tasks.load(::std::memory_order_acquire) < max_in_flight; });
+
+				if (conn.m_stopped)
+					break;
+			}
+
+			Result<usize, SocketReceiveError> size = conn.m_stream.next_frame_size();
+
+			if (size.is_error())
+				break;
+
+			frame.resize(size.expect());
+
+			Result<usize, SocketReceiveError> received = conn.m_stream.recv_frame(frame.data(), frame.size());
+
+			if (received.is_error())
+				break;
+
+			usize length = received.expect();
+
+			if (length < RPC_REQUEST_PREFIX)
+				break;
+
+			u32 id = _load_u32(frame.data());
+			u32 method = _load_u32(frame.data() + 4);
+
+			state.m_calls.fetch_add(1, ::std::memory_order_relaxed);
+
+			const _RpcHandler* handler = find_handler(state, method);
+
+			if (handler == nullptr)
+			{
+				send_reply(state, conn, id, RpcStatus::UNKNOWN_METHOD, nullptr, 0);
+				continue;
+			}
+
+			conn.m_tasks.fetch_add(1, ::std::memory_order_relaxed);
+
+			{
+				::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+				if (state.m_stopping)
+				{
+					conn.m_tasks.fetch_sub(1, ::std::memory_order_release);
+					break;
+				}
+
+				state.m_queue.push_back(_RpcTask{ &conn, handler, id, ::std::vector<u8>(frame.data() + RPC_REQUEST_PREFIX, frame.data() + length) });
+			}
+
+			state.m_work.notify_one();
+		}
+
+		conn.m_done.store(true, ::std::memory_order_release);
+	}
+
+	static void run_worker(_RpcServerState& state)
+	{
+		::std::vector<u8> reply;
+
+		for (;;)
+		{
+			_RpcTask task;
+
+			{
+				::std::unique_lock<::std::mutex> lock{ state.m_mutex };
+
+				state.m_work.wait(lock, [&] { return state.m_stopping || !state.m_queue.empty(); });
+
+				if (state.m_queue.empty())
+					return;
+
+				task = move(state.m_queue.front());
+				state.m_queue.pop_front();
+			}
+
+			const _RpcHandler& handler = *task.m_handler;
+
+			reply.resize(handler.m_reply_capacity + 1);
+
+			usize reply_length = 0;
+			RpcStatus status;
+
+			try
+			{
+				status = handler.m_invoke(handler.m_handler, task.m_args.data(), task.m_args.size(), reply.data(), reply_length);
+			}
+			catch (...)
+			{
+				status = RpcStatus::HANDLER_FAILED;
+				reply_length = 0;
+			}
+
+			send_reply(state, *task.m_conn, task.m_id, status, reply.data(), reply_length);
+
+			finish_task(state, *task.m_conn);
+		}
+	}
+
+	RpcServer::RpcServer(const RpcServerConfig& config)
+		: m_state{ new _RpcServerState{} }
+	{
+		m_state->m_config = config;
+
+		if (m_state->m_config.max_in_flight == 0)
+			m_state->m_config.max_in_flight = 1;
+
+		usize workers = config.workers != 0 ? config.workers : 1;
+
+		for (usize i = 0; i < workers; ++i)
+			m_state->m_workers.emplace_back(run_worker, ::std::ref(*m_state));
+	}
+
+	RpcServer::RpcServer(RpcServer&& other) noexcept
+		: m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	RpcServer::~RpcServer()
+	{
+		if (m_state == nullptr)
+			return;
+
+		shutdown();
+
+		for (_RpcHandler* handler : m_state->m_handlers)
+		{
+			handler->m_destroy(handler->m_handler);
+			delete handler;
+		}
+
+		for (_RpcHandler* handler : m_state->m_retired)
+		{
+			handler->m_destroy(handler->m_handler);
+			delete handler;
+		}
+
+		delete m_state;
+	}
+
+	void RpcServer::add_handler(u32 method, usize reply_capacity, void* handler, _RpcInvokeFn invoke, _RpcDestroyFn destroy)
+	{
+		_RpcHandler* entry = new _RpcHandler{ method, reply_capacity, handler, invoke, destroy };
+
+		::std::unique_lock<::std::shared_mutex> lock{ m_state->m_handlers_mutex };
+
+		::std::vector<_RpcHandler*>& handlers = m_state->m_handlers;
+
+		auto it = ::std::lower_bound(handlers.begin(), handlers.end(), method, [](const _RpcHandler* existing, u32 value) {
+			return existing->m_method < value;
+		});
+
+		if (it != handlers.end() && (*it)->m_method == method)
+		{
+			m_state->m_retired.push_back(*it);
+			*it = entry;
+
+			return;
+		}
+
+		handlers.insert(it, entry);
+	}
+
+	void RpcServer::serve(Socket&& sock)
+	{
+		_RpcServerState& state = *m_state;
+
+		state.m_server.serve(new _RpcConnection{ move(sock), state.m_config }, [&state](_RpcConnection& conn) {
+			conn.m_reader = ::std::thread{ server_read_loop, ::std::ref(state), ::std::ref(conn) };
+		});
+	}
+
+	Result<Unit, SocketAcceptError> RpcServer::run(TCPServer& server)
+	{
+		return m_state->m_server.run(server, [this](Socket&& sock) { serve(move(sock)); });
+	}
+
+	usize RpcServer::connections() const noexcept
+	{
+		return m_state->m_server.active();
+	}
+
+	RpcStats RpcServer::stats() const noexcept
+	{
+		RpcStats stats{};
+		stats.calls = m_state->m_calls.load(::std::memory_order_relaxed);
+		stats.replies = m_state->m_replies.load(::std::memory_order_relaxed);
+
+		m_state->m_server.for_each([&stats](const _RpcConnection& conn) {
+			stats.frames_written += conn.m_writer.m_frames.load(::std::memory_order_relaxed);
+			stats.batches_written += conn.m_writer.m_batches.load(::std::memory_order_relaxed);
+		});
+
+		return stats;
+	}
+
+	void RpcServer::shutdown()
+	{
+		_RpcServerState& state = *m_state;
+
+		::std::vector<_RpcConnection*> connections = state.m_server.stop();
+
+		{
+			::std::lock_guard<::std::mutex> lock{ state.m_mutex };
+
+			state.m_stopping = true;
+			state.m_queue.clear();
+		}
+
+		for (_RpcConnection* conn : connections)
+		{
+			{
+				::std::lock_guard<::std::mutex> lock{ conn->m_mutex };
+
+				conn->m_stopped = true;
+			}
+
+			conn->m_drained.notify_one();
+			conn->m_sock.shutdown().discard();
+		}
+
+		state.m_work.notify_all();
+
+		for (::std::thread& worker : state.m_workers)
+			worker.join();
+
+		state.m_workers.clear();
+
+		_ConnServer<_RpcConnection>::join(connections);
+	}
+}
@@ -0,0 +1,488 @@
+#include "Shm.hpp"
+
+#include <new>
+#include <cstdio>
+
+#include <Windows.h>
+#include <intrin.h>
+
+namespace bsl::net
+{
+	static constexpr u32 SHM_MAGIC = 0x4D485342;
+	static constexpr u32 SHM_VERSION = 1;
+
+	static constexpr u32 SHM_PEER_NONE = 0;
+	static constexpr u32 SHM_PEER_CONNECTED = 1;
+	static constexpr u32 SHM_PEER_GONE = 2;
+
+	struct _ShmHeader
+	{
+		::std::atomic<u32> magic;
+		u32 version;
+		u64 capacity;
+		::std::atomic<u32> connected;
+
+		SpscRingControl rings[2];
+	};
+
+	static constexpr usize SHM_HEADER_SIZE = (sizeof(_ShmHeader) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+
+	struct _NativeShm
+	{
+		::HANDLE m_mapping;
+		_ShmHeader* m_header;
+		::HANDLE m_data_events[2];
+		::HANDLE m_space_events[2];
+		usize m_tx;
+		bool m_is_closed;
+	};
+
+	static NetErrorKind shm_error_kind_of(::DWORD code) noexcept
+	{
+		switch (code)
+		{
+		case ERROR_FILE_NOT_FOUND: return NetErrorKind::CONNECTION_REFUSED;
+		case ERROR_ALREADY_EXISTS: return NetErrorKind::ADDRESS_IN_USE;
+		case ERROR_ACCESS_DENIED: return NetErrorKind::ADDRESS_UNAVAILABLE;
+		case ERROR_INVALID_PARAMETER: return NetErrorKind::INVALID_ARGUMENT;
+		case ERROR_NOT_ENOUGH_MEMORY:
+		case ERROR_COMMITMENT_LIMIT: return NetErrorKind::NO_BUFFERS;
+		default: return NetErrorKind::UNKNOWN;
+		}
+	}
+
+	static ShmError shm_last_error() noexcept
+	{
+		::DWORD code = ::GetLastError();
+
+		return ShmError{ shm_error_kind_of(code), static_cast<i32>(code) };
+	}
+
+	static void format_object_name(char* dest, usize dest_len, const ShmAddr& addr, const char* suffix)
+	{
+		::std::snprintf(dest, dest_len, "Local\\bsl-shm-%s%s", addr.name(), suffix);
+	}
+
+	static void destroy_native(_NativeShm* native)
+	{
+		for (usize i = 0; i < 2; ++i)
+		{
+			if (native->m_data_events[i] != NULL)
+				::CloseHandle(native->m_data_events[i]);
+
+			if (native->m_space_events[i] != NULL)
+				::CloseHandle(native->m_space_events[i]);
+		}
+
+		if (native->m_header != nullptr)
+			::UnmapViewOfFile(native->m_header);
+
+		if (native->m_mapping != NULL)
+			::CloseHandle(native->m_mapping);
+
+		delete native;
+	}
+
+	static bool open_events(_NativeShm* native, const ShmAddr& addr, bool create)
+	{
+		static const char* const data_suffixes[2] = { "-0d", "-1d" };
+		static const char* const space_suffixes[2] = { "-0s", "-1s" };
+
+		char name[128];
+
+		for (usize i = 0; i < 2; ++i)
+		{
+			format_object_name(name, sizeof(name), addr, data_suffixes[i]);
+
+			native->m_data_events[i] = create ?
+				::CreateEventA(NULL, FALSE, FALSE, name) :
+				::OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, name);
+
+			if (native->m_data_events[i] == NULL)
+				return false;
+
+			format_object_name(name, sizeof(name), addr, space_suffixes[i]);
+
+			native->m_space_events[i] = create ?
+				::CreateEventA(NULL, FALSE, FALSE, name) :
+				::OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, name);
+
+			if (native->m_space_events[i] == NULL)
+				return false;
+		}
+
+		return true;
+	}
+
+	static u8* ring_data(_ShmHeader* header, usize index)
+	{
+		return reinterpret_cast<u8*>(header) + SHM_HEADER_SIZE + index * static_cast<usize>(header->capacity);
+	}
+
+	ShmSocket::ShmSocket(_NativeShm* native, bool is_creator, ShmWaitMode mode) noexcept
+		: m_shm{ native }, m_mode{ mode }
+	{
+		_ShmHeader* header = native->m_header;
+		usize capacity = static_cast<usize>(header->capacity);
+
+		native->m_tx = is_creator ? 0 : 1;
+
+		usize rx = 1 - native->m_tx;
+
+		m_tx = SpscByteRing{ &header->rings[native->m_tx], ring_data(header, native->m_tx), capacity };
+		m_rx = SpscByteRing{ &header->rings[rx], ring_data(header, rx), capacity };
+	}
+
+	Result<ShmSocket, ShmError> ShmSocket::create(const ShmAddr& addr, usize capacity, ShmWaitMode mode)
+	{
+		if (!SpscByteRing::is_valid_capacity(capacity))
+			return ShmError{ NetErrorKind::INVALID_ARGUMENT };
+
+		u64 size = static_cast<u64>(SHM_HEADER_SIZE) + 2 * static_cast<u64>(capacity);
+
+		char name[128];
+		format_object_name(name, sizeof(name), addr, "");
+
+		_NativeShm* native = new _NativeShm{};
+
+		native->m_mapping = ::CreateFileMappingA(
+			INVALID_HANDLE_VALUE,
+			NULL,
+			PAGE_READWRITE,
+			static_cast<::DWORD>(size >> 32),
+			static_cast<::DWORD>(size & 0xFFFFFFFF),
+			name);
+
+		if (native->m_mapping == NULL || ::GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			ShmError error = native->m_mapping == NULL ? shm_last_error() : ShmError{ NetErrorKind::ADDRESS_IN_USE, ERROR_ALREADY_EXISTS };
+
+			destroy_native(native);
+			return error;
+		}
+
+		void* view = ::MapViewOfFile(native->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<::SIZE_T>(size));
+
+		if (view == NULL)
+		{
+			ShmError error = shm_last_error();
+
+			destroy_native(native);
+			return error;
+		}
+
+		native->m_header = reinterpret_cast<_ShmHeader*>(view);
+
+		if (!open_events(native, addr, true))
+		{
+			ShmError error = shm_last_error();
+
+			destroy_native(native);
+			return error;
+		}
+
+		_ShmHeader* header = ::new(view) _ShmHeader{};
+		header->version = SHM_VERSION;
+		header->capacity = static_cast<u64>(capacity);
+		header->magic.store(SHM_MAGIC, ::std::memory_order_release);
+
+		return ShmSocket{ native, true, mode };
+	}
+
+	Result<ShmSocket, ShmError> ShmSocket::connect(const ShmAddr& addr, ShmWaitMode mode)
+	{
+		char name[128];
+		format_object_name(name, sizeof(name), addr, "");
+
+		_NativeShm* native = new _NativeShm{};
+
+		native->m_mapping = ::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+
+		if (native->m_mapping == NULL)
+		{
+			ShmError error = shm_last_error();
+
+			destroy_native(native);
+			return error;
+		}
+
+		void* view = ::MapViewOfFile(native->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+
+		if (view == NULL)
+		{
+			ShmError error = shm_last_error();
+
+			destroy_native(native);
+			return error;
+		}
+
+		native->m_header = reinterpret_cast<_ShmHeader*>(view);
+
+		_ShmHeader* header = native->m_header;
+
+		if (header->magic.load(::std::memory_order_acquire) != SHM_MAGIC || header->version != SHM_VERSION)
+		{
+			destroy_native(native);
+			return ShmError{ NetErrorKind::CONNECTION_REFUSED };
+		}
+
+		u32 expected = SHM_PEER_NONE;
+
+		if (!header->connected.compare_exchange_strong(expected, SHM_PEER_CONNECTED, ::std::memory_order_acq_rel))
+		{
+			destroy_native(native);
+			return ShmError{ expected == SHM_PEER_GONE ? NetErrorKind::CLOSED : NetErrorKind::CONNECTION_REFUSED };
+		}
+
+		if (!open_events(native, addr, false))
+		{
+			ShmError error = shm_last_error();
+
+			header->connected.store(SHM_PEER_GONE, ::std::memory_order_release);
+			destroy_native(native);
+			return error;
+		}
+
+		return ShmSocket{ native, false, mode };
+	}
+
+	ShmSocket::ShmSocket(ShmSocket&& other) noexcept
+		: m_shm{ other.m_shm }, m_tx{ other.m_tx }, m_rx{ other.m_rx }, m_mode{ other.m_mode }
+	{
+		other.m_shm = nullptr;
+	}
+
+	ShmSocket::~ShmSocket()
+	{
+		if (m_shm != nullptr)
+		{
+			close().discard();
+			destroy_native(m_shm);
+		}
+	}
+
+	ShmWaitMode ShmSocket::wait_mode() const noexcept
+	{
+		return m_mode;
+	}
+
+	void ShmSocket::set_wait_mode(ShmWaitMode mode) noexcept
+	{
+		m_mode = mode;
+	}
+
+	usize ShmSocket::capacity() const noexcept
+	{
+		return m_tx.capacity();
+	}
+
+	bool ShmSocket::is_connected() const noexcept
+	{
+		if (m_shm == nullptr || m_shm->m_is_closed)
+			return false;
+
+		return m_shm->m_header->connected.load(::std::memory_order_acquire) == SHM_PEER_CONNECTED &&
+			m_rx.control().writer_closed.load(::std::memory_order_acquire) == 0;
+	}
+
+	Result<Unit, SocketCloseError> ShmSocket::close()
+	{
+		if (m_shm == nullptr || m_shm->m_is_closed)
+			return SocketCloseError{ NetErrorKind::CLOSED };
+
+		m_shm->m_is_closed = true;
+
+		if (m_shm->m_tx == 1)
+			m_shm->m_header->connected.store(SHM_PEER_GONE, ::std::memory_order_release);
+
+		usize rx = 1 - m_shm->m_tx;
+
+		m_tx.control().writer_closed.store(1, ::std::memory_order_release);
+		m_rx.control().reader_closed.store(1, ::std::memory_order_release);
+
+		::SetEvent(m_shm->m_data_events[m_shm->m_tx]);
+		::SetEvent(m_shm->m_space_events[rx]);
+
+		return Unit{};
+	}
+
+	void ShmSocket::wait_readable()
+	{
+		SpscRingControl& ctrl = m_rx.control();
+
+		if (m_mode == ShmWaitMode::BUSY_POLL)
+		{
+			while (m_rx.readable() == 0 && ctrl.writer_closed.load(::std::memory_order_acquire) == 0)
+				_mm_pause();
+
+			return;
+		}
+
+		ctrl.reader_waiting.store(1, ::std::memory_order_seq_cst);
+		::std::atomic_thread_fence(::std::memory_order_seq_cst);
+
+		if (m_rx.readable() == 0 && ctrl.writer_closed.load(::std::memory_order_acquire) == 0)
+			::WaitForSingleObject(m_shm->m_data_events[1 - m_shm->m_tx], INFINITE);
+
+		ctrl.reader_waiting.store(0, ::std::memory_order_relaxed);
+	}
+
+	void ShmSocket::wait_writable()
+	{
+		SpscRingControl& ctrl = m_tx.control();
+
+		if (m_mode == ShmWaitMode::BUSY_POLL)
+		{
+			while (m_tx.writable() == 0 && ctrl.reader_closed.load(::std::memory_order_acquire) == 0)
+				_mm_pause();
+
+			return;
+		}
+
+		ctrl.writer_waiting.store(1, ::std::memory_order_seq_cst);
+		::std::atomic_thread_fence(::std::memory_order_seq_cst);
+
+		if (m_tx.writable() == 0 && ctrl.reader_closed.load(::std::memory_order_acquire) == 0)
+			::WaitForSingleObject(m_shm->m_space_events[m_shm->m_tx], INFINITE);
+
+		ctrl.writer_waiting.store(0, ::std::memory_order_relaxed);
+	}
+
+	Result<usize, SocketSendError> ShmSocket::send(const u8* buffer, usize length)
+	{
+		if (m_shm == nullptr || m_shm->m_is_closed)
+			return SocketSendError{ NetErrorKind::CLOSED };
+
+		SpscRingControl& ctrl = m_tx.control();
+
+		while (true)
+		{
+			if (ctrl.reader_closed.load(::std::memory_order_acquire) != 0)
+				return SocketSendError{ NetErrorKind::CLOSED };
+
+			usize written = m_tx.write(buffer, length);
+
+			if (written > 0 || length == 0)
+			{
+				::std::atomic_thread_fence(::std::memory_order_seq_cst);
+
+				if (ctrl.reader_waiting.load(::std::memory_order_relaxed) != 0)
+					::SetEvent(m_shm->m_data_events[m_shm->m_tx]);
+
+				return move(written);
+			}
+
+			wait_writable();
+		}
+	}
+
+	Result<usize, SocketReceiveError> ShmSocket::recv(u8* buffer, usize length)
+	{
+		if (m_shm == nullptr || m_shm->m_is_closed)
+			return SocketReceiveError{ NetErrorKind::CLOSED };
+
+		SpscRingControl& ctrl = m_rx.control();
+
+		while (true)
+		{
+			usize received = m_rx.read(buffer, length);
+
+			if (received > 0 || length == 0)
+			{
+				::std::atomic_thread_fence(::std::memory_order_seq_cst);
+
+				if (ctrl.writer_waiting.load(::std::memory_order_relaxed) != 0)
+					::SetEvent(m_shm->m_space_events[1 - m_shm->m_tx]);
+
+				return move(received);
+			}
+
+			if (ctrl.writer_closed.load(::std::memory_order_acquire) != 0)
+			{
+				if (m_rx.readable() == 0)
+					return static_cast<usize>(0);
+
+				continue;
+			}
+
+			wait_readable();
+		}
+	}
+
+	StreamSocket::StreamSocket(Socket&& sock)
+		: m_conn{ InPlaceIndex<0>{}, move(sock) }
+	{
+	}
+
+	StreamSocket::StreamSocket(ShmSocket&& shm)
+		: m_conn{ InPlaceIndex<1>{}, move(shm) }
+	{
+	}
+
+	StreamSocket::StreamSocket(StreamSocket&& other)
+		: m_conn{ move(other.m_conn) }
+	{
+	}
+
+	Result<StreamSocket, SocketConnectError> StreamSocket::connect(const StreamAddr& target, ShmWaitMode mode)
+	{
+		if (target.is_shm())
+		{
+			Result<ShmSocket, ShmError> shm = ShmSocket::connect(target.to_shm().unwrap(), mode);
+
+			if (shm.is_error())
+			{
+				ShmError error = shm.expect_error();
+				return SocketConnectError{ error.kind(), error.native_code() };
+			}
+
+			return StreamSocket{ shm.expect() };
+		}
+
+		SockAddr addr = target.to_sock_addr().unwrap();
+
+		AddrFamily family = addr.is_ipv4() ? AddrFamily::IPv4 : addr.is_ipv6() ? AddrFamily::IPv6 : AddrFamily::UNIX;
+		Proto proto = addr.is_unix() ? Proto::UNSPECIFIED : Proto::TCP;
+
+		Result<Socket, SocketError> created = Socket::create(family, SockType::STREAM, proto);
+
+		if (created.is_error())
+		{
+			SocketError error = created.expect_error();
+			return SocketConnectError{ error.kind(), error.native_code() };
+		}
+
+		Socket sock = created.expect();
+		Result<Unit, SocketConnectError> connected = sock.connect(addr);
+
+		if (connected.is_error())
+			return connected.expect_error();
+
+		return StreamSocket{ move(sock) };
+	}
+
+	bool StreamSocket::is_shm() const noexcept
+	{
+		return m_conn.index() == 1;
+	}
+
+	bool StreamSocket::is_connected() const noexcept
+	{
+		return is_shm() ? get<1>(m_conn).is_connected() : get<0>(m_conn).is_connected();
+	}
+
+	Result<Unit, SocketCloseError> StreamSocket::close()
+	{
+		return is_shm() ? get<1>(m_conn).close() : get<0>(m_conn).close();
+	}
+
+	Result<usize, SocketSendError> StreamSocket::send(const u8* buffer, usize length)
+	{
+		return is_shm() ? get<1>(m_conn).send(buffer, length) : get<0>(m_conn).send(buffer, length);
+	}
+
+	Result<usize, SocketReceiveError> StreamSocket::recv(u8* buffer, usize length)
+	{
+		return is_shm() ? get<1>(m_conn).recv(buffer, length) : get<0>(m_conn).recv(buffer, length);
+	}
+}
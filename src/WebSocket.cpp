@@ -0,0 +1,650 @@
+#include "WebSocket.hpp"
+#include "Cpu.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include <intrin.h>
+#include <Windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+
+namespace bsl::net
+{
+	static constexpr usize WS_READ_CHUNK = 64 << 10;
+	static constexpr usize WS_MASK_KEY_BATCH = 64;
+
+	static u32 rotate_key(u32 mask_key, usize offset) noexcept
+	{
+		u32 shift = static_cast<u32>(offset & 3) * 8;
+
+		return shift == 0 ? mask_key : (mask_key >> shift) | (mask_key << (32 - shift));
+	}
+
+	static void mask_scalar(const u8* source, u8* dest, usize length, u32 mask_key) noexcept
+	{
+		u64 wide_key = static_cast<u64>(mask_key) | (static_cast<u64>(mask_key) << 32);
+		usize i = 0;
+
+		for (; i + 8 <= length; i += 8)
+		{
+			u64 word;
+			::std::memcpy(&word, source + i, sizeof(word));
+			word ^= wide_key;
+			::std::memcpy(dest + i, &word, sizeof(word));
+		}
+
+		for (; i < length; ++i)
+		{
+			dest[i] = source[i] ^ static_cast<u8>(mask_key >> ((i & 3) * 8));
+		}
+	}
+
+	static usize mask_sse2(const u8* source, u8* dest, usize length, u32 mask_key) noexcept
+	{
+		__m128i key = _mm_set1_epi32(static_cast<i32>(mask_key));
+		usize i = 0;
+
+		for (; i + 64 <= length; i += 64)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 16));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 32));
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 48));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_xor_si128(a, key));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 16), _mm_xor_si128(b, key));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 32), _mm_xor_si128(c, key));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 48), _mm_xor_si128(d, key));
+		}
+
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_xor_si128(a, key));
+		}
+
+		return i;
+	}
+
+	static usize mask_avx2(const u8* source, u8* dest, usize length, u32 mask_key) noexcept
+	{
+		__m256i key = _mm256_set1_epi32(static_cast<i32>(mask_key));
+		usize i = 0;
+
+		for (; i + 128 <= length; i += 128)
+		{
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 32));
+			__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 64));
+			__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 96));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_xor_si256(a, key));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 32), _mm256_xor_si256(b, key));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 64), _mm256_xor_si256(c, key));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 96), _mm256_xor_si256(d, key));
+		}
+
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_xor_si256(a, key));
+		}
+
+		return i;
+	}
+
+	void ws_mask_copy(const u8* source, u8* dest, usize length, u32 mask_key, usize offset) noexcept
+	{
+		mask_key = rotate_key(mask_key, offset);
+
+		usize done = 0;
+
+		if (length >= 64 && cpu::has_avx2())
+			done = mask_avx2(source, dest, length, mask_key);
+		else if (length >= 16)
+			done = mask_sse2(source, dest, length, mask_key);
+
+		mask_scalar(source + done, dest + done, length - done, mask_key);
+	}
+
+	void ws_mask(u8* data, usize length, u32 mask_key, usize offset) noexcept
+	{
+		ws_mask_copy(data, data, length, mask_key, offset);
+	}
+
+	usize ws_encode_header(const WsFrameHeader& header, u8* out) noexcept
+	{
+		usize size = 0;
+
+		out[size++] = static_cast<u8>((header.fin ? 0x80 : 0x00) | ((header.rsv & 0x7) << 4) | (static_cast<u8>(header.opcode) & 0xF));
+
+		u8 mask_bit = header.masked ? 0x80 : 0x00;
+
+		if (header.payload_length < 126)
+		{
+			out[size++] = static_cast<u8>(mask_bit | header.payload_length);
+		}
+		else if (header.payload_length <= 0xFFFF)
+		{
+			out[size++] = static_cast<u8>(mask_bit | 126);
+			out[size++] = static_cast<u8>(header.payload_length >> 8);
+			out[size++] = static_cast<u8>(header.payload_length);
+		}
+		else
+		{
+			out[size++] = static_cast<u8>(mask_bit | 127);
+
+			for (usize i = 0; i < 8; ++i)
+				out[size++] = static_cast<u8>(header.payload_length >> (56 - i * 8));
+		}
+
+		if (header.masked)
+		{
+			out[size++] = static_cast<u8>(header.mask_key);
+			out[size++] = static_cast<u8>(header.mask_key >> 8);
+			out[size++] = static_cast<u8>(header.mask_key >> 16);
+			out[size++] = static_cast<u8>(header.mask_key >> 24);
+		}
+
+		return size;
+	}
+
+	static bool utf8_valid(const u8* data, usize length) noexcept
+	{
+		usize i = 0;
+
+		while (i < length)
+		{
+			if (i + 8 <= length)
+			{
+				u64 word;
+				::std::memcpy(&word, data + i, sizeof(word));
+
+				if ((word & 0x8080808080808080ull) == 0)
+				{
+					i += 8;
+					continue;
+				}
+			}
+
+			u8 lead = data[i];
+
+			if (lead < 0x80)
+			{
+				++i;
+				continue;
+			}
+
+			usize count;
+			u8 low = 0x80;
+			u8 high = 0xBF;
+
+			if (lead >= 0xC2 && lead <= 0xDF)
+			{
+				count = 1;
+			}
+			else if (lead >= 0xE0 && lead <= 0xEF)
+			{
+				count = 2;
+				low = lead == 0xE0 ? 0xA0 : 0x80;
+				high = lead == 0xED ? 0x9F : 0xBF;
+			}
+			else if (lead >= 0xF0 && lead <= 0xF4)
+			{
+				count = 3;
+				low = lead == 0xF0 ? 0x90 : 0x80;
+				high = lead == 0xF4 ? 0x8F : 0xBF;
+			}
+			else
+			{
+				return false;
+			}
+
+			if (length - i <= count || data[i + 1] < low || data[i + 1] > high)
+				return false;
+
+			for (usize k = 2; k <= count; ++k)
+				if ((data[i + k] & 0xC0) != 0x80)
+					return false;
+
+			i += count + 1;
+		}
+
+		return true;
+	}
+
+	static bool close_code_valid(u16 code) noexcept
+	{
+		if (code >= 3000 && code <= 4999)
+			return true;
+
+		return code >= 1000 && code <= 1014 && code != 1004 && code != 1005 && code != 1006;
+	}
+
+	static usize header_size(const u8* in) noexcept
+	{
+		usize length_code = in[1] & 0x7F;
+		usize size = WsFrameHeader::MIN_SIZE + (length_code == 126 ? 2 : length_code == 127 ? 8 : 0);
+
+		return size + ((in[1] & 0x80) != 0 ? 4 : 0);
+	}
+
+	Result<usize, WebSocketError> ws_decode_header(const u8* in, usize length, WsFrameHeader& header) noexcept
+	{
+		if (length < WsFrameHeader::MIN_SIZE)
+			return usize{ 0 };
+
+		usize size = header_size(in);
+
+		if (length < size)
+			return usize{ 0 };
+
+		u8 opcode = in[0] & 0xF;
+
+		if ((opcode > 0x2 && opcode < 0x8) || opcode > 0xA)
+			return WebSocketError{ NetErrorKind::INVALID_ARGUMENT };
+
+		header.fin = (in[0] & 0x80) != 0;
+		header.rsv = (in[0] >> 4) & 0x7;
+		header.opcode = static_cast<WsOpcode>(opcode);
+		header.masked = (in[1] & 0x80) != 0;
+
+		usize length_code = in[1] & 0x7F;
+		usize cursor = WsFrameHeader::MIN_SIZE;
+
+		if (length_code == 126)
+		{
+			header.payload_length = (static_cast<u64>(in[2]) << 8) | in[3];
+			cursor += 2;
+		}
+		else if (length_code == 127)
+		{
+			header.payload_length = 0;
+
+			for (usize i = 0; i < 8; ++i)
+				header.payload_length = (header.payload_length << 8) | in[2 + i];
+
+			if ((header.payload_length >> 63) != 0)
+				return WebSocketError{ NetErrorKind::INVALID_ARGUMENT };
+
+			cursor += 8;
+		}
+		else
+		{
+			header.payload_length = length_code;
+		}
+
+		header.mask_key = 0;
+
+		if (header.masked)
+		{
+			header.mask_key = static_cast<u32>(in[cursor]) | (static_cast<u32>(in[cursor + 1]) << 8) | (static_cast<u32>(in[cursor + 2]) << 16) | (static_cast<u32>(in[cursor + 3]) << 24);
+		}
+
+		if (header.is_control() && (!header.fin || header.payload_length > WsFrameHeader::MAX_CONTROL_PAYLOAD))
+			return WebSocketError{ NetErrorKind::INVALID_ARGUMENT };
+
+		return size;
+	}
+
+	struct _WebSocketState
+	{
+		WsRole m_role;
+		WebSocketConfig m_config;
+
+		::std::vector<u8> m_rx;
+		usize m_parse;
+		usize m_end;
+
+		bool m_in_message;
+		WsOpcode m_message_opcode;
+		usize m_message_start;
+		usize m_message_length;
+
+		::std::vector<u8> m_tx;
+		u32 m_keys[WS_MASK_KEY_BATCH];
+		usize m_key_index;
+
+		bool m_failed;
+	};
+
+	static Result<u32, WebSocketError> next_mask_key(_WebSocketState& state) noexcept
+	{
+		if (state.m_key_index == WS_MASK_KEY_BATCH)
+		{
+			::NTSTATUS status = ::BCryptGenRandom(NULL, reinterpret_cast<::PUCHAR>(state.m_keys), sizeof(state.m_keys), BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+
+			if (!BCRYPT_SUCCESS(status))
+				return WebSocketError{ NetErrorKind::UNKNOWN, static_cast<i32>(status) };
+
+			state.m_key_index = 0;
+		}
+
+		u32 key = state.m_keys[state.m_key_index++];
+
+		return move(key);
+	}
+
+	static Result<Unit, WebSocketError> send_slices(Socket& sock, IoSlice* slices, usize count)
+	{
+		while (count != 0)
+		{
+			Result<usize, SocketSendError> result = sock.send_vectored(slices, count);
+
+			if (result.is_error())
+			{
+				SocketSendError error = result.expect_error();
+				return WebSocketError{ error.kind(), error.native_code() };
+			}
+
+			usize sent = result.expect();
+
+			if (sent == 0)
+				return WebSocketError{ NetErrorKind::CLOSED };
+
+			while (count != 0 && sent >= slices->length)
+			{
+				sent -= slices->length;
+				++slices;
+				--count;
+			}
+
+			if (count != 0)
+			{
+				slices->data += sent;
+				slices->length -= sent;
+			}
+		}
+
+		return Unit{};
+	}
+
+	WebSocket::WebSocket(Socket& sock, WsRole role, const WebSocketConfig& config)
+		: m_sock{ &sock }, m_state{ new _WebSocketState{} }
+	{
+		m_state->m_role = role;
+		m_state->m_config = config;
+		m_state->m_rx.resize(WS_READ_CHUNK);
+		m_state->m_key_index = WS_MASK_KEY_BATCH;
+	}
+
+	WebSocket::WebSocket(WebSocket&& other) noexcept
+		: m_sock{ other.m_sock }, m_state{ other.m_state }
+	{
+		other.m_state = nullptr;
+	}
+
+	WebSocket::~WebSocket()
+	{
+		delete m_state;
+	}
+
+	WsRole WebSocket::role() const noexcept
+	{
+		return m_state->m_role;
+	}
+
+	Result<Unit, WebSocketError> WebSocket::send_frame(WsOpcode opcode, const u8* payload, usize length, bool fin)
+	{
+		_WebSocketState& state = *m_state;
+
+		if (state.m_failed)
+			return WebSocketError{ NetErrorKind::CLOSED };
+
+		WsFrameHeader header{};
+		header.fin = fin;
+		header.opcode = opcode;
+		header.masked = state.m_role == WsRole::CLIENT;
+		header.mask_key = 0;
+		header.payload_length = length;
+
+		if (header.masked)
+		{
+			Result<u32, WebSocketError> key = next_mask_key(state);
+
+			if (key.is_error())
+				return key.expect_error();
+
+			header.mask_key = key.expect();
+		}
+
+		if (!header.masked)
+		{
+			u8 head[WsFrameHeader::MAX_SIZE];
+
+			IoSlice slices[2];
+			slices[0] = IoSlice{ head, ws_encode_header(header, head) };
+			slices[1] = IoSlice{ payload, length };
+
+			return send_slices(*m_sock, slices, length != 0 ? 2 : 1);
+		}
+
+		state.m_tx.resize(WsFrameHeader::MAX_SIZE + length);
+
+		usize head_size = ws_encode_header(header, state.m_tx.data());
+
+		if (length != 0)
+			ws_mask_copy(payload, state.m_tx.data() + head_size, length, header.mask_key);
+
+		IoSlice slice{ state.m_tx.data(), head_size + length };
+
+		return send_slices(*m_sock, &slice, 1);
+	}
+
+	Result<Unit, WebSocketError> WebSocket::send(WsOpcode opcode, const u8* payload, usize length)
+	{
+		if (opcode == WsOpcode::CONTINUATION)
+			return WebSocketError{ NetErrorKind::INVALID_ARGUMENT };
+
+		if ((static_cast<u8>(opcode) & 0x8) != 0 && length > WsFrameHeader::MAX_CONTROL_PAYLOAD)
+			return WebSocketError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		return send_frame(opcode, payload, length, true);
+	}
+
+	Result<Unit, WebSocketError> WebSocket::send_fragment(WsOpcode opcode, const u8* payload, usize length, bool fin)
+	{
+		if (opcode != WsOpcode::TEXT && opcode != WsOpcode::BINARY && opcode != WsOpcode::CONTINUATION)
+			return WebSocketError{ NetErrorKind::INVALID_ARGUMENT };
+
+		return send_frame(opcode, payload, length, fin);
+	}
+
+	Result<Unit, WebSocketError> WebSocket::ping(const u8* payload, usize length)
+	{
+		return send(WsOpcode::PING, payload, length);
+	}
+
+	Result<Unit, WebSocketError> WebSocket::close(WsCloseCode code, const char* reason, usize reason_length)
+	{
+		if (reason_length > WsFrameHeader::MAX_CONTROL_PAYLOAD - 2)
+			return WebSocketError{ NetErrorKind::MESSAGE_TOO_LONG };
+
+		u8 payload[WsFrameHeader::MAX_CONTROL_PAYLOAD];
+		payload[0] = static_cast<u8>(static_cast<u16>(code) >> 8);
+		payload[1] = static_cast<u8>(static_cast<u16>(code));
+
+		if (reason_length != 0)
+			::std::memcpy(payload + 2, reason, reason_length);
+
+		return send_frame(WsOpcode::CLOSE, payload, 2 + reason_length, true);
+	}
+
+	WebSocketError WebSocket::fail(WsCloseCode code, NetErrorKind kind)
+	{
+		if (!m_state->m_failed)
+		{
+			u8 payload[2] = { static_cast<u8>(static_cast<u16>(code) >> 8), static_cast<u8>(static_cast<u16>(code)) };
+
+			static_cast<void>(send_frame(WsOpcode::CLOSE, payload, sizeof(payload), true));
+
+			m_state->m_failed = true;
+		}
+
+		return WebSocketError{ kind };
+	}
+
+	Result<Unit, WebSocketError> WebSocket::fill(usize length)
+	{
+		_WebSocketState& state = *m_state;
+
+		if (state.m_end - state.m_parse >= length)
+			return Unit{};
+
+		if (state.m_parse + length > state.m_rx.size())
+		{
+			usize keep = state.m_in_message ? state.m_message_start : state.m_parse;
+
+			if (keep != 0)
+			{
+				::std::memmove(state.m_rx.data(), state.m_rx.data() + keep, state.m_end - keep);
+
+				state.m_parse -= keep;
+				state.m_end -= keep;
+				state.m_message_start -= state.m_in_message ? keep : 0;
+			}
+
+			if (state.m_parse + length > state.m_rx.size())
+				state.m_rx.resize(state.m_parse + length);
+		}
+
+		while (state.m_end - state.m_parse < length)
+		{
+			Result<usize, SocketReceiveError> result = m_sock->recv(state.m_rx.data() + state.m_end, state.m_rx.size() - state.m_end);
+
+			if (result.is_error())
+			{
+				SocketReceiveError error = result.expect_error();
+				return WebSocketError{ error.kind(), error.native_code() };
+			}
+
+			usize received = result.expect();
+
+			if (received == 0)
+				return WebSocketError{ NetErrorKind::CLOSED };
+
+			state.m_end += received;
+		}
+
+		return Unit{};
+	}
+
+	Result<WsMessage, WebSocketError> WebSocket::recv()
+	{
+		_WebSocketState& state = *m_state;
+
+		if (state.m_failed)
+			return WebSocketError{ NetErrorKind::CLOSED };
+
+		for (;;)
+		{
+			if (!state.m_in_message && state.m_parse == state.m_end)
+			{
+				state.m_parse = 0;
+				state.m_end = 0;
+			}
+
+			Result<Unit, WebSocketError> prefix_result = fill(WsFrameHeader::MIN_SIZE);
+
+			if (prefix_result.is_error())
+				return prefix_result.expect_error();
+
+			usize head_size = header_size(state.m_rx.data() + state.m_parse);
+
+			Result<Unit, WebSocketError> head_result = fill(head_size);
+
+			if (head_result.is_error())
+				return head_result.expect_error();
+
+			WsFrameHeader header;
+
+			Result<usize, WebSocketError> decoded = ws_decode_header(state.m_rx.data() + state.m_parse, state.m_end - state.m_parse, header);
+
+			if (decoded.is_error())
+				return fail(WsCloseCode::PROTOCOL_ERROR, decoded.expect_error().kind());
+
+			if (header.rsv != 0 || header.masked != (state.m_role == WsRole::SERVER))
+				return fail(WsCloseCode::PROTOCOL_ERROR, NetErrorKind::INVALID_ARGUMENT);
+
+			bool control = header.is_control();
+
+			if (!control)
+			{
+				if ((header.opcode == WsOpcode::CONTINUATION) != state.m_in_message)
+					return fail(WsCloseCode::PROTOCOL_ERROR, NetErrorKind::INVALID_ARGUMENT);
+
+				usize assembled = state.m_in_message ? state.m_message_length : 0;
+
+				if (header.payload_length > state.m_config.max_message - assembled)
+					return fail(WsCloseCode::MESSAGE_TOO_BIG, NetErrorKind::MESSAGE_TOO_LONG);
+			}
+
+			usize length = static_cast<usize>(header.payload_length);
+
+			Result<Unit, WebSocketError> body_result = fill(head_size + length);
+
+			if (body_result.is_error())
+				return body_result.expect_error();
+
+			usize payload = state.m_parse + head_size;
+			state.m_parse = payload + length;
+
+			if (header.masked)
+				ws_mask(state.m_rx.data() + payload, length, header.mask_key);
+
+			if (control)
+			{
+				if (header.opcode == WsOpcode::PING && state.m_config.auto_pong)
+				{
+					Result<Unit, WebSocketError> pong = send_frame(WsOpcode::PONG, state.m_rx.data() + payload, length, true);
+
+					if (pong.is_error())
+						return pong.expect_error();
+
+					continue;
+				}
+
+				if (header.opcode == WsOpcode::CLOSE && length != 0)
+				{
+					const u8* body = state.m_rx.data() + payload;
+
+					if (length == 1 || !close_code_valid(static_cast<u16>((body[0] << 8) | body[1])))
+						return fail(WsCloseCode::PROTOCOL_ERROR, NetErrorKind::INVALID_ARGUMENT);
+
+					if (!utf8_valid(body + 2, length - 2))
+						return fail(WsCloseCode::INVALID_PAYLOAD, NetErrorKind::INVALID_ARGUMENT);
+				}
+
+				return WsMessage{ header.opcode, state.m_rx.data() + payload, length };
+			}
+
+			if (!state.m_in_message)
+			{
+				state.m_in_message = true;
+				state.m_message_opcode = header.opcode;
+				state.m_message_start = payload;
+				state.m_message_length = 0;
+			}
+
+			usize tail = state.m_message_start + state.m_message_length;
+
+			if (tail != payload && length != 0)
+				::std::memmove(state.m_rx.data() + tail, state.m_rx.data() + payload, length);
+
+			state.m_message_length += length;
+
+			if (header.fin)
+			{
+				state.m_in_message = false;
+
+				if (state.m_message_opcode == WsOpcode::TEXT &&
+					!utf8_valid(state.m_rx.data() + state.m_message_start, state.m_message_length))
+					return fail(WsCloseCode::INVALID_PAYLOAD, NetErrorKind::INVALID_ARGUMENT);
+
+				return WsMessage{ state.m_message_opcode, state.m_rx.data() + state.m_message_start, state.m_message_length };
+			}
+		}
+	}
+}
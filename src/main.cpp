@@ -1,47 +1,574 @@
 #include <iostream>
 #include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Net.hpp"
+#include "Histogram.hpp"
+#include "NetRecord.hpp"
 
-int main()
+using namespace bsl;
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadConfig
 {
-	using namespace bsl;
-	
-	net::setup();
+	const char* host = "127.0.0.1";
+	u16 port = 8080;
+	const char* path = "/";
+	f64 rate = 1000.0;
+	usize connections = 16;
+	f64 duration = 10.0;
+	f64 warmup = 1.0;
+
+	bool serve = false;
+	usize body_size = 64;
+	u64 service_delay_us = 0;
+	const char* record_path = nullptr;
+};
+
+struct ConnStats
+{
+	Histogram corrected;
+	Histogram uncorrected;
+	u64 requests = 0;
+	u64 errors = 0;
+	u64 reconnects = 0;
+};
+
+static bool send_all(net::Socket& sock, const u8* buffer, usize length)
+{
+	while (length > 0)
+	{
+		Result<usize, net::SocketSendError> result = sock.send(buffer, length);
+
+		if (result.is_error())
+			return false;
+
+		usize sent = result.expect();
+		buffer += sent;
+		length -= sent;
+	}
+
+	return true;
+}
+
+class HttpReader
+{
+private:
+	std::vector<u8> m_buffer;
+	usize m_begin = 0;
+	usize m_end = 0;
+
+	bool fill(net::Socket& sock)
+	{
+		if (m_begin > 0 && m_begin == m_end)
+			m_begin = m_end = 0;
+
+		if (m_end == m_buffer.size())
+		{
+			if (m_begin == 0)
+				m_buffer.resize(m_buffer.size() * 2);
+			else
+			{
+				std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+				m_end -= m_begin;
+				m_begin = 0;
+			}
+		}
+
+		Result<usize, net::SocketReceiveError> result = sock.recv(m_buffer.data() + m_end, m_buffer.size() - m_end);
+
+		if (result.is_error())
+			return false;
+
+		usize received = result.expect();
+
+		if (received == 0)
+			return false;
+
+		m_end += received;
+
+		return true;
+	}
+
+	const char* find(const char* needle, usize from) const
+	{
+		usize needle_len = std::strlen(needle);
+
+		for (usize i = m_begin + from; i + needle_len <= m_end; ++i)
+			if (std::memcmp(m_buffer.data() + i, needle, needle_len) == 0)
+				return reinterpret_cast<const char*>(m_buffer.data() + i);
+
+		return nullptr;
+	}
+
+	bool read_line(net::Socket& sock, usize& line_len)
+	{
+		const char* eol;
+
+		while ((eol = find("\r\n", 0)) == nullptr)
+			if (!fill(sock))
+				return false;
+
+		line_len = static_cast<usize>(eol - reinterpret_cast<const char*>(m_buffer.data() + m_begin));
+
+		return true;
+	}
+
+	bool skip(net::Socket& sock, usize length)
+	{
+		while (m_end - m_begin < length)
+		{
+			length -= m_end - m_begin;
+			m_begin = m_end;
+
+			if (!fill(sock))
+				return false;
+		}
+
+		m_begin += length;
+
+		return true;
+	}
+
+	static bool header_is(const char* line, usize line_len, const char* name)
+	{
+		usize name_len = std::strlen(name);
+
+		if (line_len <= name_len || line[name_len] != ':')
+			return false;
+
+		for (usize i = 0; i < name_len; ++i)
+		{
+			char c = line[i];
+
+			if (c >= 'A' && c <= 'Z')
+				c = static_cast<char>(c - 'A' + 'a');
+
+			if (c != name[i])
+				return false;
+		}
 
-	net::AddrIPv4 addr = net::resolve("www.google.com", "http").expect().to_ipv4();
-	net::SockAddrV4 sock_addr{ addr, 80 };
+		return true;
+	}
 
-	net::Socket sock{
-		net::AddrFamily::IPv4,
+public:
+	HttpReader()
+		: m_buffer(16384)
+	{
+	}
+
+	bool read_response(net::Socket& sock, bool& keep_alive)
+	{
+		usize line_len;
+
+		if (!read_line(sock, line_len))
+			return false;
+
+		if (line_len < 12 || std::memcmp(m_buffer.data() + m_begin, "HTTP/1.", 7) != 0)
+			return false;
+
+		keep_alive = m_buffer[m_begin + 7] == '1';
+		m_begin += line_len + 2;
+
+		i64 content_length = -1;
+		bool chunked = false;
+
+		while (true)
+		{
+			if (!read_line(sock, line_len))
+				return false;
+
+			const char* line = reinterpret_cast<const char*>(m_buffer.data() + m_begin);
+
+			if (line_len == 0)
+			{
+				m_begin += 2;
+				break;
+			}
+
+			if (header_is(line, line_len, "content-length"))
+				content_length = std::strtoll(std::string{ line + 15, line_len - 15 }.c_str(), nullptr, 10);
+			else if (header_is(line, line_len, "transfer-encoding"))
+				chunked = std::string{ line, line_len }.find("chunked") != std::string::npos;
+			else if (header_is(line, line_len, "connection"))
+			{
+				std::string conn{ line + 11, line_len - 11 };
+
+				if (conn.find("close") != std::string::npos || conn.find("Close") != std::string::npos)
+					keep_alive = false;
+				else if (conn.find("keep-alive") != std::string::npos || conn.find("Keep-Alive") != std::string::npos)
+					keep_alive = true;
+			}
+
+			m_begin += line_len + 2;
+		}
+
+		if (chunked)
+		{
+			while (true)
+			{
+				if (!read_line(sock, line_len))
+					return false;
+
+				std::string size_line{ reinterpret_cast<const char*>(m_buffer.data() + m_begin), line_len };
+				m_begin += line_len + 2;
+
+				usize chunk = static_cast<usize>(std::strtoull(size_line.c_str(), nullptr, 16));
+
+				if (chunk == 0)
+				{
+					while (read_line(sock, line_len))
+					{
+						m_begin += line_len + 2;
+
+						if (line_len == 0)
+							return true;
+					}
+
+					return false;
+				}
+
+				if (!skip(sock, chunk + 2))
+					return false;
+			}
+		}
+
+		if (content_length >= 0)
+			return skip(sock, static_cast<usize>(content_length));
+
+		keep_alive = false;
+
+		while (fill(sock))
+			m_begin = m_end;
+
+		return true;
+	}
+
+	bool read_request(net::Socket& sock)
+	{
+		while (find("\r\n\r\n", 0) == nullptr)
+			if (!fill(sock))
+				return false;
+
+		const char* end = find("\r\n\r\n", 0);
+		m_begin = static_cast<usize>(reinterpret_cast<const u8*>(end) - m_buffer.data()) + 4;
+
+		return true;
+	}
+};
+
+static Maybe<net::SockAddr> resolve_target(const LoadConfig& cfg)
+{
+	Result<net::IPAddr, net::HostnameResolutionError> result = net::resolve(cfg.host);
+
+	if (result.is_error())
+		return {};
+
+	net::IPAddr ip = result.expect();
+
+	if (ip.is_ipv4())
+		return net::SockAddr{ net::SockAddrV4{ ip.to_ipv4(), cfg.port } };
+
+	return net::SockAddr{ net::SockAddrV6{ ip.to_ipv6(), cfg.port } };
+}
+
+static Maybe<net::Socket> open_connection(const net::SockAddr& target)
+{
+	Result<net::Socket, net::SocketError> created = net::Socket::create(
+		target.is_ipv4() ? net::AddrFamily::IPv4 : net::AddrFamily::IPv6,
 		net::SockType::STREAM,
-		net::Proto::TCP
-	};
+		net::Proto::TCP);
 
-	sock.connect(sock_addr).expect_and_discard();
+	if (created.is_error())
+		return {};
 
-	const u8 send_buffer[] = "HEAD / HTTP/1.1\n\n";
+	net::Socket sock = created.expect();
 
-	usize bytes_sent = sock.send(send_buffer, 17).expect();
+	if (sock.connect(target).is_error())
+		return {};
 
-	std::cout << "No. bytes sent: " << bytes_sent << "\n";
-	std::cout << ">>>>> REQUEST BEGIN >>>>>\n";
-	std::cout << send_buffer;
-	std::cout << "<<<<< REQUEST END <<<<<\n";
+	sock.set_nodelay(true).discard();
 
-	u8 recv_buffer[2048];
+	return move(sock);
+}
 
-	usize bytes_received = sock.recv(recv_buffer, sizeof(recv_buffer)).expect();
+static void wait_until(Clock::time_point deadline)
+{
+	Clock::time_point now = Clock::now();
 
-	std::cout << "No. bytes received: " << bytes_received << "\n";
+	if (deadline - now > std::chrono::milliseconds(2))
+		std::this_thread::sleep_until(deadline - std::chrono::milliseconds(1));
 
-	std::cout << ">>>>> RESPONSE BEGIN >>>>>\n";
-	std::cout.write(reinterpret_cast<const char*>(recv_buffer), bytes_received);
-	std::cout << "<<<<< RESPONSE END <<<<<\n";
+	while (Clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+static void run_connection(const LoadConfig& cfg, const net::SockAddr& target, const std::string& request,
+	Clock::time_point start, Clock::time_point measure_from, Clock::time_point stop, usize index, ConnStats& stats)
+{
+	std::chrono::nanoseconds interval{ static_cast<i64>(1e9 * static_cast<f64>(cfg.connections) / cfg.rate) };
+	Clock::time_point intended = start + std::chrono::nanoseconds{ interval.count() * static_cast<i64>(index) / static_cast<i64>(cfg.connections) };
+
+	while (intended < stop)
+	{
+		wait_until(intended);
+
+		Maybe<net::Socket> conn = open_connection(target);
+
+		if (!conn.has_value())
+		{
+			++stats.errors;
+			intended += interval;
+			continue;
+		}
+
+		++stats.reconnects;
+
+		net::Socket sock = conn.unwrap();
+		HttpReader reader;
+
+		bool keep_alive = true;
+
+		while (keep_alive && intended < stop)
+		{
+			wait_until(intended);
+
+			Clock::time_point sent_at = Clock::now();
+
+			bool ok = send_all(sock, reinterpret_cast<const u8*>(request.data()), request.size()) &&
+				reader.read_response(sock, keep_alive);
+
+			Clock::time_point done = Clock::now();
+
+			if (!ok)
+			{
+				++stats.errors;
+				keep_alive = false;
+			}
+			else if (intended >= measure_from)
+			{
+				stats.corrected.record(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count()));
+				stats.uncorrected.record(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - sent_at).count()));
+				++stats.requests;
+			}
+
+			intended += interval;
+		}
+	}
+}
+
+static void print_histogram(const char* title, const Histogram& hist)
+{
+	std::cout << title << "\n";
+	std::cout << std::fixed << std::setprecision(3);
+
+	const f64 percentiles[] = { 50.0, 75.0, 90.0, 99.0, 99.9, 99.99 };
+	const char* labels[] = { "p50   ", "p75   ", "p90   ", "p99   ", "p99.9 ", "p99.99" };
+
+	for (usize i = 0; i < 6; ++i)
+		std::cout << "  " << labels[i] << " " << std::setw(12) << static_cast<f64>(hist.percentile(percentiles[i])) / 1e3 << " us\n";
+
+	std::cout << "  max    " << std::setw(12) << static_cast<f64>(hist.max()) / 1e3 << " us\n";
+	std::cout << "  mean   " << std::setw(12) << hist.mean() / 1e3 << " us\n";
+}
+
+static int run_load(const LoadConfig& cfg)
+{
+	Maybe<net::SockAddr> target = resolve_target(cfg);
+
+	if (!target.has_value())
+	{
+		std::cerr << "Could not resolve " << cfg.host << "\n";
+		return 1;
+	}
+
+	std::string request = std::string{ "GET " } + cfg.path + " HTTP/1.1\r\nHost: " + cfg.host + "\r\nConnection: keep-alive\r\n\r\n";
+
+	std::vector<ConnStats> stats(cfg.connections);
+	std::vector<std::thread> workers;
+
+	Clock::time_point start = Clock::now() + std::chrono::milliseconds(100);
+	Clock::time_point measure_from = start + std::chrono::nanoseconds{ static_cast<i64>(cfg.warmup * 1e9) };
+	Clock::time_point stop = measure_from + std::chrono::nanoseconds{ static_cast<i64>(cfg.duration * 1e9) };
+
+	for (usize i = 0; i < cfg.connections; ++i)
+		workers.emplace_back([&, i]() {
+			run_connection(cfg, *target, request, start, measure_from, stop, i, stats[i]);
+		});
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	Histogram corrected, uncorrected;
+	u64 requests = 0, errors = 0, reconnects = 0;
+
+	for (const ConnStats& s : stats)
+	{
+		corrected.merge(s.corrected);
+		uncorrected.merge(s.uncorrected);
+		requests += s.requests;
+		errors += s.errors;
+		reconnects += s.reconnects;
+	}
+
+	std::cout << "Target:        " << cfg.host << ":" << cfg.port << cfg.path << "\n";
+	std::cout << "Connections:   " << cfg.connections << "\n";
+	std::cout << "Target rate:   " << cfg.rate << " req/s\n";
+	std::cout << "Achieved rate: " << static_cast<f64>(requests) / cfg.duration << " req/s\n";
+	std::cout << "Requests:      " << requests << "\n";
+	std::cout << "Errors:        " << errors << "\n";
+	std::cout << "Connects:      " << reconnects << "\n";
+
+	print_histogram("Latency (corrected for coordinated omission):", corrected);
+	print_histogram("Service time (uncorrected):", uncorrected);
+
+	return errors == 0 ? 0 : 1;
+}
+
+static void serve_connection(net::Socket sock, const LoadConfig& cfg, const std::string& response)
+{
+	sock.set_nodelay(true).discard();
+
+	HttpReader reader;
+
+	while (reader.read_request(sock))
+	{
+		if (cfg.service_delay_us > 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(cfg.service_delay_us));
+
+		if (!send_all(sock, reinterpret_cast<const u8*>(response.data()), response.size()))
+			break;
+	}
+}
+
+static int serve_forever(const LoadConfig& cfg, const std::string& response, net::TrafficRecorder* recorder)
+{
+	net::TCPServer server{ cfg.port };
+	server.listen(1024).expect_and_discard();
+
+	std::cout << "Serving on port " << cfg.port << "\n";
+
+	while (true)
+	{
+		Result<net::Socket, net::SocketAcceptError> result = server.accept();
+
+		if (result.is_error())
+			continue;
+
+		net::Socket sock = result.expect();
+
+		if (recorder != nullptr)
+			recorder->attach(sock);
+
+		std::thread{ serve_connection, move(sock), std::cref(cfg), std::cref(response) }.detach();
+	}
+}
+
+static int run_server(const LoadConfig& cfg)
+{
+	std::string body(cfg.body_size, 'x');
+	std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: " +
+		std::to_string(body.size()) + "\r\nConnection: keep-alive\r\n\r\n" + body;
+
+	if (cfg.record_path == nullptr)
+		return serve_forever(cfg, response, nullptr);
+
+	Result<net::TrafficRecorder, net::RecordError> recorder = net::TrafficRecorder::create(cfg.record_path);
+
+	if (recorder.is_error())
+	{
+		std::cerr << "Could not open " << cfg.record_path << " for recording\n";
+		return 1;
+	}
+
+	net::TrafficRecorder active = recorder.expect();
+
+	return serve_forever(cfg, response, &active);
+}
+
+static void print_usage()
+{
+	std::cerr <<
+		"usage: bsl [options]\n"
+		"  --host HOST          target host (default 127.0.0.1)\n"
+		"  --port PORT          target port (default 8080)\n"
+		"  --path PATH          request path (default /)\n"
+		"  --rate N             total requests per second (default 1000)\n"
+		"  --connections N      concurrent connections (default 16)\n"
+		"  --duration SECONDS   measured duration (default 10)\n"
+		"  --warmup SECONDS     unmeasured warmup (default 1)\n"
+		"  --serve              run the local stand-in HTTP server on --port\n"
+		"  --body-size N        stand-in response body size (default 64)\n"
+		"  --delay-us N         stand-in per-request service delay (default 0)\n"
+		"  --record FILE        record stand-in server sessions for bsl_net_replay\n";
+}
+
+static bool parse_args(int argc, char** argv, LoadConfig& cfg)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+
+		if (std::strcmp(arg, "--serve") == 0)
+		{
+			cfg.serve = true;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+			return false;
+
+		const char* value = argv[++i];
+
+		if (std::strcmp(arg, "--host") == 0)
+			cfg.host = value;
+		else if (std::strcmp(arg, "--port") == 0)
+			cfg.port = static_cast<u16>(std::strtoul(value, nullptr, 10));
+		else if (std::strcmp(arg, "--path") == 0)
+			cfg.path = value;
+		else if (std::strcmp(arg, "--rate") == 0)
+			cfg.rate = std::strtod(value, nullptr);
+		else if (std::strcmp(arg, "--connections") == 0)
+			cfg.connections = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--duration") == 0)
+			cfg.duration = std::strtod(value, nullptr);
+		else if (std::strcmp(arg, "--warmup") == 0)
+			cfg.warmup = std::strtod(value, nullptr);
+		else if (std::strcmp(arg, "--body-size") == 0)
+			cfg.body_size = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--delay-us") == 0)
+			cfg.service_delay_us = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(arg, "--record") == 0)
+			cfg.record_path = value;
+		else
+			return false;
+	}
+
+	return cfg.rate > 0.0 && cfg.connections > 0 && cfg.duration > 0.0;
+}
+
+int main(int argc, char** argv)
+{
+	LoadConfig cfg;
+
+	if (!parse_args(argc, argv, cfg))
+	{
+		print_usage();
+		return 2;
+	}
+
+	net::setup();
 
-	sock.close().expect_and_discard();
+	int status = cfg.serve ? run_server(cfg) : run_load(cfg);
 
 	net::cleanup();
 
-	return 0;
+	return status;
 }